@@ -30,6 +30,7 @@ namespace adnl {
 td::Result<td::actor::ActorOwn<AdnlChannel>> AdnlChannel::create(privkeys::Ed25519 pk_data, pubkeys::Ed25519 pub_data,
                                                                  AdnlNodeIdShort local_id, AdnlNodeIdShort peer_id,
                                                                  AdnlChannelIdShort &out_id, AdnlChannelIdShort &in_id,
+                                                                 std::shared_ptr<Decryptor> &decryptor,
                                                                  td::actor::ActorId<AdnlPeerPair> peer_pair) {
   td::Ed25519::PublicKey pub_k = pub_data.export_key();
   td::Ed25519::PrivateKey priv_k = pk_data.export_key();
@@ -58,16 +59,28 @@ td::Result<td::actor::ActorOwn<AdnlChannel>> AdnlChannel::create(privkeys::Ed255
   out_id = AdnlChannelIdShort{R.second.compute_short_id()};
 
   TRY_RESULT_PREFIX(encryptor, R.second.create_encryptor(), "failed to init channel encryptor: ");
-  TRY_RESULT_PREFIX(decryptor, R.first.create_decryptor(), "failed to init channel decryptor: ");
+  TRY_RESULT_PREFIX(channel_decryptor, R.first.create_decryptor(), "failed to init channel decryptor: ");
+  decryptor = std::move(channel_decryptor);
 
   return td::actor::create_actor<AdnlChannelImpl>("channel", local_id, peer_id, peer_pair, in_id, out_id,
-                                                  std::move(encryptor), std::move(decryptor));
+                                                  std::move(encryptor), decryptor);
+}
+
+td::Result<AdnlPacket> AdnlChannel::decrypt_packet(Decryptor &decryptor, AdnlNodeIdShort peer_id, td::Slice data) {
+  TRY_RESULT_PREFIX(decrypted, decryptor.decrypt(data), "failed to decrypt channel message: ");
+  TRY_RESULT_PREFIX(tl_packet, fetch_tl_object<ton_api::adnl_packetContents>(std::move(decrypted), true),
+                    "decrypted channel packet contains invalid TL scheme: ");
+  TRY_RESULT_PREFIX(packet, AdnlPacket::create(std::move(tl_packet)), "received bad packet: ");
+  if (packet.inited_from_short() && packet.from_short() != peer_id) {
+    return td::Status::Error(ErrorCode::protoviolation, "bad channel packet destination");
+  }
+  return std::move(packet);
 }
 
 AdnlChannelImpl::AdnlChannelImpl(AdnlNodeIdShort local_id, AdnlNodeIdShort peer_id,
                                  td::actor::ActorId<AdnlPeerPair> peer_pair, AdnlChannelIdShort in_id,
                                  AdnlChannelIdShort out_id, std::unique_ptr<Encryptor> encryptor,
-                                 std::unique_ptr<Decryptor> decryptor) {
+                                 std::shared_ptr<Decryptor> decryptor) {
   local_id_ = local_id;
   peer_id_ = peer_id;
 
@@ -83,16 +96,7 @@ AdnlChannelImpl::AdnlChannelImpl(AdnlNodeIdShort local_id, AdnlNodeIdShort peer_
 }
 
 void AdnlChannelImpl::decrypt(td::BufferSlice raw_data, td::Promise<AdnlPacket> promise) {
-  TRY_RESULT_PROMISE_PREFIX(promise, data, decryptor_->decrypt(raw_data.as_slice()),
-                            "failed to decrypt channel message: ");
-  TRY_RESULT_PROMISE_PREFIX(promise, tl_packet, fetch_tl_object<ton_api::adnl_packetContents>(std::move(data), true),
-                            "decrypted channel packet contains invalid TL scheme: ");
-  TRY_RESULT_PROMISE_PREFIX(promise, packet, AdnlPacket::create(std::move(tl_packet)), "received bad packet: ");
-  if (packet.inited_from_short() && packet.from_short() != peer_id_) {
-    promise.set_error(td::Status::Error(ErrorCode::protoviolation, "bad channel packet destination"));
-    return;
-  }
-  promise.set_value(std::move(packet));
+  promise.set_result(decrypt_packet(*decryptor_, peer_id_, raw_data.as_slice()));
 }
 
 void AdnlChannelImpl::send_message(td::uint32 priority, td::actor::ActorId<AdnlNetworkConnection> conn,
@@ -126,6 +130,47 @@ void AdnlChannelImpl::receive(td::IPAddress addr, td::BufferSlice data) {
   decrypt(std::move(data), std::move(P));
 }
 
+void AdnlChannelRouter::add_channel(AdnlChannelIdShort id, td::uint8 cat, AdnlNodeIdShort peer_id,
+                                    td::actor::ActorId<AdnlPeerPair> peer_pair, std::shared_ptr<Decryptor> decryptor) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  channels_[id] = Channel{cat, peer_id, std::move(peer_pair), std::move(decryptor)};
+}
+
+void AdnlChannelRouter::remove_channel(AdnlChannelIdShort id) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  channels_.erase(id);
+}
+
+bool AdnlChannelRouter::receive(td::IPAddress addr, const AdnlCategoryMask &cat_mask, td::BufferSlice &data) {
+  if (data.size() < 32) {
+    return false;
+  }
+  AdnlChannelIdShort id{AdnlNodeIdShort{data.as_slice().truncate(32)}.pubkey_hash()};
+  Channel channel;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = channels_.find(id);
+    if (it == channels_.end()) {
+      return false;
+    }
+    channel = it->second;
+  }
+  if (!cat_mask.test(channel.cat)) {
+    VLOG(ADNL_WARNING) << "[channelrouter]: dropping IN message to channel " << id << ": category mismatch";
+    return true;
+  }
+  auto R = AdnlChannel::decrypt_packet(*channel.decryptor, channel.peer_id, data.as_slice().substr(32));
+  if (R.is_error()) {
+    VLOG(ADNL_WARNING) << "[channelrouter]: dropping IN message to channel " << id
+                       << ": can not decrypt: " << R.move_as_error();
+    return true;
+  }
+  auto packet = R.move_as_ok();
+  packet.set_remote_addr(addr);
+  td::actor::send_closure(channel.peer_pair, &AdnlPeerPair::receive_packet_from_channel, id, std::move(packet));
+  return true;
+}
+
 }  // namespace adnl
 
 }  // namespace ton
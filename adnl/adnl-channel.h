@@ -22,6 +22,10 @@
 #include "adnl-peer.h"
 #include "adnl-peer-table.h"
 #include "adnl-network-manager.h"
+#include "keys/encryptor.h"
+
+#include <map>
+#include <shared_mutex>
 
 namespace ton {
 
@@ -34,13 +38,38 @@ class AdnlChannel : public td::actor::Actor {
   static td::Result<td::actor::ActorOwn<AdnlChannel>> create(privkeys::Ed25519 pk, pubkeys::Ed25519 pub,
                                                              AdnlNodeIdShort local_id, AdnlNodeIdShort peer_id,
                                                              AdnlChannelIdShort &out_id, AdnlChannelIdShort &in_id,
+                                                             std::shared_ptr<Decryptor> &decryptor,
                                                              td::actor::ActorId<AdnlPeerPair> peer_pair);
+  static td::Result<AdnlPacket> decrypt_packet(Decryptor &decryptor, AdnlNodeIdShort peer_id, td::Slice data);
   virtual void receive(td::IPAddress addr, td::BufferSlice data) = 0;
   virtual void send_message(td::uint32 priority, td::actor::ActorId<AdnlNetworkConnection> conn,
                             td::BufferSlice data) = 0;
   virtual ~AdnlChannel() = default;
 };
 
+// Thread-safe copy of the inbound channel table of AdnlPeerTable. Receiving sockets of AdnlNetworkManager use it to
+// decrypt and parse channel packets on their own threads; only parsed packets are sent to the peer actors.
+// Channel decryptors (AES) keep no state between calls, so they are shared with the channel actors
+class AdnlChannelRouter {
+ public:
+  void add_channel(AdnlChannelIdShort id, td::uint8 cat, AdnlNodeIdShort peer_id,
+                   td::actor::ActorId<AdnlPeerPair> peer_pair, std::shared_ptr<Decryptor> decryptor);
+  void remove_channel(AdnlChannelIdShort id);
+
+  // returns false if data is not addressed to a known channel and must take the usual path through AdnlPeerTable
+  bool receive(td::IPAddress addr, const AdnlCategoryMask &cat_mask, td::BufferSlice &data);
+
+ private:
+  struct Channel {
+    td::uint8 cat;
+    AdnlNodeIdShort peer_id;
+    td::actor::ActorId<AdnlPeerPair> peer_pair;
+    std::shared_ptr<Decryptor> decryptor;
+  };
+  std::shared_mutex mutex_;
+  std::map<AdnlChannelIdShort, Channel> channels_;
+};
+
 }  // namespace adnl
 
 }  // namespace ton
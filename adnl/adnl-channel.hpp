@@ -31,7 +31,7 @@ class AdnlChannelImpl : public AdnlChannel {
  public:
   AdnlChannelImpl(AdnlNodeIdShort local_id, AdnlNodeIdShort peer_id, td::actor::ActorId<AdnlPeerPair> peer_pair,
                   AdnlChannelIdShort in_id, AdnlChannelIdShort out_id, std::unique_ptr<Encryptor> encryptor,
-                  std::unique_ptr<Decryptor> decryptor);
+                  std::shared_ptr<Decryptor> decryptor);
   void decrypt(td::BufferSlice data, td::Promise<AdnlPacket> promise);
   void receive(td::IPAddress addr, td::BufferSlice data) override;
   void send_message(td::uint32 priority, td::actor::ActorId<AdnlNetworkConnection> conn, td::BufferSlice data) override;
@@ -53,7 +53,7 @@ class AdnlChannelImpl : public AdnlChannel {
   AdnlNodeIdShort local_id_;
   AdnlNodeIdShort peer_id_;
   std::unique_ptr<Encryptor> encryptor_;
-  std::unique_ptr<Decryptor> decryptor_;
+  std::shared_ptr<Decryptor> decryptor_;
   td::actor::ActorId<AdnlPeerPair> peer_pair_;
 };
 
@@ -267,7 +267,9 @@ void AdnlLocalId::alarm() {
 
 void AdnlLocalId::update_packet(AdnlPacket packet, bool update_id, bool sign, td::int32 update_addr_list_if,
                                 td::int32 update_priority_addr_list_if, td::Promise<AdnlPacket> promise) {
-  packet.init_random();
+  if (!packet.has_random()) {
+    packet.init_random();
+  }
   if (update_id) {
     packet.set_source(id_);
   }
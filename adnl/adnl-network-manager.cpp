@@ -27,8 +27,9 @@ namespace ton {
 
 namespace adnl {
 
-td::actor::ActorOwn<AdnlNetworkManager> AdnlNetworkManager::create(td::uint16 port) {
-  return td::actor::create_actor<AdnlNetworkManagerImpl>("NetworkManager", port);
+td::actor::ActorOwn<AdnlNetworkManager> AdnlNetworkManager::create(td::uint16 port, td::uint32 receive_sockets,
+                                                                  bool udp_offload) {
+  return td::actor::create_actor<AdnlNetworkManagerImpl>("NetworkManager", port, receive_sockets, udp_offload);
 }
 
 AdnlNetworkManagerImpl::OutDesc *AdnlNetworkManagerImpl::choose_out_iface(td::uint8 cat, td::uint32 priority) {
@@ -55,27 +56,65 @@ size_t AdnlNetworkManagerImpl::add_listening_udp_port(td::uint16 port) {
   }
   class Callback : public td::UdpServer::Callback {
    public:
-    Callback(td::actor::ActorShared<AdnlNetworkManagerImpl> manager, size_t idx)
-        : manager_(std::move(manager)), idx_(idx) {
+    Callback(td::actor::ActorShared<AdnlNetworkManagerImpl> manager, std::shared_ptr<ReceiveState> state, size_t idx)
+        : manager_(std::move(manager)), state_(std::move(state)), idx_(idx) {
     }
 
    private:
     td::actor::ActorShared<AdnlNetworkManagerImpl> manager_;
+    std::shared_ptr<ReceiveState> state_;
     size_t idx_;
     void on_udp_message(td::UdpMessage udp_message) override {
+      if (state_ && receive_inplace(udp_message)) {
+        return;
+      }
       td::actor::send_closure_later(manager_, &AdnlNetworkManagerImpl::receive_udp_message, std::move(udp_message),
                                     idx_);
     }
+    bool receive_inplace(td::UdpMessage &message) {
+      if (message.error.is_error()) {
+        return false;
+      }
+      std::shared_lock<std::shared_mutex> lock(state_->mutex);
+      auto it = state_->direct_cat_masks.find(idx_);
+      if (!state_->callback || it == state_->direct_cat_masks.end()) {
+        return false;
+      }
+      return state_->callback->receive_packet_inplace(message.address, it->second, message.data);
+    }
   };
 
+  // With a single socket per port all packets go through the manager, and decryption stays spread over the channel
+  // actors. With several sockets each one decrypts what it can on its own thread
+  bool reuse_port = receive_sockets_ > 1;
+  auto state = reuse_port ? receive_state_ : nullptr;
   auto idx = udp_sockets_.size();
-  auto X = td::UdpServer::create("udp server", port, std::make_unique<Callback>(actor_shared(this), idx));
+  auto X = td::UdpServer::create(PSLICE() << "udp server " << port, port,
+                                 std::make_unique<Callback>(actor_shared(this), state, idx), reuse_port,
+                                 udp_offload_);
   X.ensure();
   port_2_socket_[port] = idx;
   udp_sockets_.push_back(UdpSocketDesc{port, X.move_as_ok()});
+  for (td::uint32 i = 1; i < receive_sockets_; i++) {
+    auto Y = td::UdpServer::create(PSLICE() << "udp server " << port << "#" << i, port,
+                                   std::make_unique<Callback>(actor_shared(this), state, idx), true, udp_offload_);
+    Y.ensure();
+    udp_sockets_.back().receive_servers.push_back(Y.move_as_ok());
+  }
   return idx;
 }
 
+void AdnlNetworkManagerImpl::update_receive_state() {
+  std::unique_lock<std::shared_mutex> lock(receive_state_->mutex);
+  receive_state_->direct_cat_masks.clear();
+  for (size_t idx = 0; idx < udp_sockets_.size(); idx++) {
+    auto &socket = udp_sockets_[idx];
+    if (!socket.allow_proxy && socket.in_desc != std::numeric_limits<size_t>::max()) {
+      receive_state_->direct_cat_masks[idx] = in_desc_[socket.in_desc].cat_mask;
+    }
+  }
+}
+
 void AdnlNetworkManagerImpl::add_self_addr(td::IPAddress addr, AdnlCategoryMask cat_mask, td::uint32 priority) {
   auto port = td::narrow_cast<td::uint16>(addr.get_port());
   size_t idx = add_listening_udp_port(port);
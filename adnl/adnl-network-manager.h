@@ -63,8 +63,16 @@ class AdnlNetworkManager : public td::actor::Actor {
     virtual ~Callback() = default;
     //virtual void receive_packet(td::IPAddress addr, ConnHandle conn_handle, td::BufferSlice data) = 0;
     virtual void receive_packet(td::IPAddress addr, AdnlCategoryMask cat_mask, td::BufferSlice data) = 0;
+    // called on the thread of a receiving socket when there are several of them; may process the packet right
+    // there and return true, otherwise the packet is passed to receive_packet() as usual. Must be thread-safe
+    virtual bool receive_packet_inplace(td::IPAddress addr, const AdnlCategoryMask &cat_mask, td::BufferSlice &data) {
+      return false;
+    }
   };
-  static td::actor::ActorOwn<AdnlNetworkManager> create(td::uint16 out_port);
+  // receive_sockets > 1 opens that many SO_REUSEPORT sockets on every listening port, each drained by its own actor
+  // udp_offload enables UDP segmentation and receive offloads where the kernel supports them
+  static td::actor::ActorOwn<AdnlNetworkManager> create(td::uint16 out_port, td::uint32 receive_sockets = 1,
+                                                        bool udp_offload = false);
 
   virtual ~AdnlNetworkManager() = default;
 
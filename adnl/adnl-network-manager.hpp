@@ -28,6 +28,7 @@
 #include "adnl-received-mask.h"
 
 #include <map>
+#include <shared_mutex>
 
 namespace td {
 class UdpServer;
@@ -92,17 +93,31 @@ class AdnlNetworkManagerImpl : public AdnlNetworkManager {
     }
     td::uint16 port;
     td::actor::ActorOwn<td::UdpServer> server;
+    // additional SO_REUSEPORT sockets on the same port, used only for receiving
+    std::vector<td::actor::ActorOwn<td::UdpServer>> receive_servers;
     size_t in_desc{std::numeric_limits<size_t>::max()};
     bool allow_proxy{false};
   };
+  // read by the receiving sockets, which run on their own threads when there are several of them per port
+  struct ReceiveState {
+    std::shared_mutex mutex;
+    std::shared_ptr<Callback> callback;
+    // category masks of sockets whose packets can be processed without the manager (no proxy on the port)
+    std::map<size_t, AdnlCategoryMask> direct_cat_masks;
+  };
 
   OutDesc *choose_out_iface(td::uint8 cat, td::uint32 priority);
 
-  AdnlNetworkManagerImpl(td::uint16 out_udp_port) : out_udp_port_(out_udp_port) {
+  AdnlNetworkManagerImpl(td::uint16 out_udp_port, td::uint32 receive_sockets, bool udp_offload)
+      : out_udp_port_(out_udp_port)
+      , receive_sockets_(std::max<td::uint32>(receive_sockets, 1))
+      , udp_offload_(udp_offload) {
   }
 
   void install_callback(std::unique_ptr<Callback> callback) override {
     callback_ = std::move(callback);
+    std::unique_lock<std::shared_mutex> lock(receive_state_->mutex);
+    receive_state_->callback = callback_;
   }
 
   void alarm() override;
@@ -111,6 +126,10 @@ class AdnlNetworkManagerImpl : public AdnlNetworkManager {
   }
 
   void add_in_addr(InDesc desc, size_t socket_idx) {
+    add_in_addr_impl(std::move(desc), socket_idx);
+    update_receive_state();
+  }
+  void add_in_addr_impl(InDesc desc, size_t socket_idx) {
     for (size_t idx = 0; idx < in_desc_.size(); idx++) {
       if (in_desc_[idx] == desc) {
         in_desc_[idx].cat_mask |= desc.cat_mask;
@@ -126,6 +145,7 @@ class AdnlNetworkManagerImpl : public AdnlNetworkManager {
     }
     in_desc_.push_back(std::move(desc));
   }
+  void update_receive_state();
 
   void add_self_addr(td::IPAddress addr, AdnlCategoryMask cat_mask, td::uint32 priority) override;
   void add_proxy_addr(td::IPAddress addr, td::uint16 local_port, std::shared_ptr<AdnlProxy> proxy,
@@ -146,7 +166,8 @@ class AdnlNetworkManagerImpl : public AdnlNetworkManager {
   void proxy_register(OutDesc &desc);
 
  private:
-  std::unique_ptr<Callback> callback_;
+  std::shared_ptr<Callback> callback_;
+  std::shared_ptr<ReceiveState> receive_state_ = std::make_shared<ReceiveState>();
 
   std::map<td::uint32, std::vector<OutDesc>> out_desc_;
   std::vector<InDesc> in_desc_;
@@ -161,6 +182,8 @@ class AdnlNetworkManagerImpl : public AdnlNetworkManager {
   std::map<AdnlNodeIdShort, td::uint8> adnl_id_2_cat_;
 
   td::uint16 out_udp_port_;
+  td::uint32 receive_sockets_;
+  bool udp_offload_;
 };
 
 }  // namespace adnl
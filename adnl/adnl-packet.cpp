@@ -130,6 +130,13 @@ void AdnlPacket::init_random() {
   td::Random::secure_bytes(rand2_.as_slice());
 }
 
+void AdnlPacket::init_random_fixed_size() {
+  rand1_ = td::BufferSlice{15};
+  rand2_ = td::BufferSlice{15};
+  td::Random::secure_bytes(rand1_.as_slice());
+  td::Random::secure_bytes(rand2_.as_slice());
+}
+
 }  // namespace adnl
 
 }  // namespace ton
@@ -137,6 +137,11 @@ class AdnlPacket {
   }
 
   void init_random();
+  // random padding of the maximal size; packets with equal contents get equal sizes
+  void init_random_fixed_size();
+  bool has_random() const {
+    return !rand1_.empty();
+  }
 
   void set_signature(td::BufferSlice signature) {
     signature_ = std::move(signature);
@@ -263,14 +263,20 @@ void AdnlPeerTableImpl::register_network_manager(td::actor::ActorId<AdnlNetworkM
     void receive_packet(td::IPAddress addr, AdnlCategoryMask cat_mask, td::BufferSlice data) override {
       td::actor::send_closure(id_, &AdnlPeerTableImpl::receive_packet, addr, std::move(cat_mask), std::move(data));
     }
-    Cb(td::actor::ActorId<AdnlPeerTableImpl> id) : id_(id) {
+    bool receive_packet_inplace(td::IPAddress addr, const AdnlCategoryMask &cat_mask,
+                                td::BufferSlice &data) override {
+      return channel_router_->receive(addr, cat_mask, data);
+    }
+    Cb(td::actor::ActorId<AdnlPeerTableImpl> id, std::shared_ptr<AdnlChannelRouter> channel_router)
+        : id_(id), channel_router_(std::move(channel_router)) {
     }
 
    private:
     td::actor::ActorId<AdnlPeerTableImpl> id_;
+    std::shared_ptr<AdnlChannelRouter> channel_router_;
   };
 
-  auto cb = std::make_unique<Cb>(actor_id(this));
+  auto cb = std::make_unique<Cb>(actor_id(this), channel_router_);
   td::actor::send_closure(network_manager_, &AdnlNetworkManager::install_callback, std::move(cb));
 
   for (auto &id : local_ids_) {
@@ -296,17 +302,21 @@ void AdnlPeerTableImpl::get_self_node(AdnlNodeIdShort id, td::Promise<AdnlNode>
   td::actor::send_closure(it->second.local_id, &AdnlLocalId::get_self_node, std::move(promise));
 }
 
-void AdnlPeerTableImpl::register_channel(AdnlChannelIdShort id, AdnlNodeIdShort local_id,
-                                         td::actor::ActorId<AdnlChannel> channel) {
+void AdnlPeerTableImpl::register_channel(AdnlChannelIdShort id, AdnlNodeIdShort local_id, AdnlNodeIdShort peer_id,
+                                         td::actor::ActorId<AdnlChannel> channel,
+                                         td::actor::ActorId<AdnlPeerPair> peer_pair,
+                                         std::shared_ptr<Decryptor> decryptor) {
   auto it = local_ids_.find(local_id);
   auto cat = (it != local_ids_.end()) ? it->second.cat : 255;
   auto success = channels_.emplace(id, std::make_pair(channel, cat)).second;
   CHECK(success);
+  channel_router_->add_channel(id, cat, peer_id, std::move(peer_pair), std::move(decryptor));
 }
 
 void AdnlPeerTableImpl::unregister_channel(AdnlChannelIdShort id) {
   auto erased = channels_.erase(id);
   CHECK(erased == 1);
+  channel_router_->remove_channel(id);
 }
 
 void AdnlPeerTableImpl::start_up() {
@@ -333,6 +343,7 @@ void AdnlPeerTableImpl::get_addr_list_from_db(AdnlNodeIdShort local_id, AdnlNode
 AdnlPeerTableImpl::AdnlPeerTableImpl(std::string db_root, td::actor::ActorId<keyring::Keyring> keyring) {
   keyring_ = keyring;
   static_nodes_manager_ = AdnlStaticNodesManager::create();
+  channel_router_ = std::make_shared<AdnlChannelRouter>();
 
   if (!db_root.empty()) {
     db_ = AdnlDb::create(db_root + "/adnl");
@@ -33,6 +33,8 @@
 
 namespace ton {
 
+class Decryptor;
+
 namespace adnl {
 
 constexpr int VERBOSITY_NAME(ADNL_ERROR) = verbosity_WARNING;
@@ -80,6 +82,7 @@ using AdnlChannelIdShort = AdnlChannelIdShortImpl;
 
 class AdnlLocalId;
 class AdnlChannel;
+class AdnlPeerPair;
 
 class AdnlPeerTable : public Adnl {
  public:
@@ -93,8 +96,9 @@ class AdnlPeerTable : public Adnl {
   virtual void receive_decrypted_packet(AdnlNodeIdShort dst, AdnlPacket packet) = 0;
   virtual void send_message_in(AdnlNodeIdShort src, AdnlNodeIdShort dst, AdnlMessage message, td::uint32 flags) = 0;
 
-  virtual void register_channel(AdnlChannelIdShort id, AdnlNodeIdShort local_id,
-                                td::actor::ActorId<AdnlChannel> channel) = 0;
+  virtual void register_channel(AdnlChannelIdShort id, AdnlNodeIdShort local_id, AdnlNodeIdShort peer_id,
+                                td::actor::ActorId<AdnlChannel> channel, td::actor::ActorId<AdnlPeerPair> peer_pair,
+                                std::shared_ptr<Decryptor> decryptor) = 0;
   virtual void unregister_channel(AdnlChannelIdShort id) = 0;
 
   virtual void add_static_node(AdnlNode node) = 0;
@@ -36,6 +36,8 @@ namespace ton {
 
 namespace adnl {
 
+class AdnlChannelRouter;
+
 class AdnlPeerTableImpl : public AdnlPeerTable {
  public:
   AdnlPeerTableImpl(std::string db_root, td::actor::ActorId<keyring::Keyring> keyring);
@@ -73,8 +75,9 @@ class AdnlPeerTableImpl : public AdnlPeerTable {
   void get_addr_list(AdnlNodeIdShort id, td::Promise<AdnlAddressList> promise) override;
   void get_self_node(AdnlNodeIdShort id, td::Promise<AdnlNode> promise) override;
   void start_up() override;
-  void register_channel(AdnlChannelIdShort id, AdnlNodeIdShort local_id,
-                        td::actor::ActorId<AdnlChannel> channel) override;
+  void register_channel(AdnlChannelIdShort id, AdnlNodeIdShort local_id, AdnlNodeIdShort peer_id,
+                        td::actor::ActorId<AdnlChannel> channel, td::actor::ActorId<AdnlPeerPair> peer_pair,
+                        std::shared_ptr<Decryptor> decryptor) override;
   void unregister_channel(AdnlChannelIdShort id) override;
 
   void check_id_exists(AdnlNodeIdShort id, td::Promise<bool> promise) override {
@@ -130,6 +133,8 @@ class AdnlPeerTableImpl : public AdnlPeerTable {
   std::map<AdnlNodeIdShort, td::actor::ActorOwn<AdnlPeer>> peers_;
   std::map<AdnlNodeIdShort, LocalIdInfo> local_ids_;
   std::map<AdnlChannelIdShort, std::pair<td::actor::ActorId<AdnlChannel>, td::uint8>> channels_;
+  // the same channels, for receiving sockets that decrypt packets on their own threads
+  std::shared_ptr<AdnlChannelRouter> channel_router_;
 
   td::actor::ActorOwn<AdnlDb> db_;
 
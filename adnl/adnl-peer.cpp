@@ -299,6 +299,7 @@ void AdnlPeerPairImpl::send_messages_in(std::vector<OutboundAdnlMessage> message
         packet.set_received_priority_addr_list_version(priority_addr_list_.version());
       }
 
+      bool is_bulk = true;
       while (ptr < messages.size()) {
         auto &M = messages[ptr];
         if (!is_direct && (M.flags() & Adnl::SendFlags::direct_only)) {
@@ -308,12 +309,16 @@ void AdnlPeerPairImpl::send_messages_in(std::vector<OutboundAdnlMessage> message
         CHECK(M.size() <= get_mtu());
         if (s + M.size() <= AdnlNetworkManager::get_mtu()) {
           s += M.size();
+          is_bulk &= (M.flags() & Adnl::SendFlags::bulk) != 0;
           packet.add_message(M.release());
           ptr++;
         } else {
           break;
         }
       }
+      if (is_bulk && via_channel) {
+        packet.init_random_fixed_size();
+      }
 
       if (!via_channel) {
         packet.set_reinit_date(Adnl::adnl_start_time(), reinit_date_);
@@ -489,14 +494,15 @@ void AdnlPeerPairImpl::create_channel(pubkeys::Ed25519 pub, td::uint32 date) {
   peer_channel_pub_ = pub;
   peer_channel_date_ = date;
 
+  std::shared_ptr<Decryptor> decryptor;
   auto R = AdnlChannel::create(channel_pk_, peer_channel_pub_, local_id_, peer_id_short_, channel_out_id_,
-                               channel_in_id_, actor_id(this));
+                               channel_in_id_, decryptor, actor_id(this));
   if (R.is_ok()) {
     channel_ = R.move_as_ok();
     channel_inited_ = true;
 
     td::actor::send_closure_later(peer_table_, &AdnlPeerTable::register_channel, channel_in_id_, local_id_,
-                                  channel_.get());
+                                  peer_id_short_, channel_.get(), actor_id(this), std::move(decryptor));
   } else {
     VLOG(ADNL_WARNING) << this << ": failed to create channel: " << R.move_as_error();
   }
@@ -79,7 +79,9 @@ class Adnl : public AdnlSenderInterface {
   }
 
   struct SendFlags {
-    enum Flags : td::uint32 { direct_only = 1 };
+    // bulk: packets made only of such messages get padding of a fixed size, so that equal messages give equal
+    // datagrams, which can be coalesced by UDP segmentation offload
+    enum Flags : td::uint32 { direct_only = 1, bulk = 2 };
   };
   virtual void send_message_ex(AdnlNodeIdShort src, AdnlNodeIdShort dst, td::BufferSlice data, td::uint32 flags) = 0;
 
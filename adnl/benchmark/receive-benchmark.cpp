@@ -0,0 +1,182 @@
+/*
+    This file is part of TON Blockchain source code.
+
+    TON Blockchain is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    TON Blockchain is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with TON Blockchain.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give permission
+    to link the code of portions of this program with the OpenSSL library.
+    You must obey the GNU General Public License in all respects for all
+    of the code used other than OpenSSL. If you modify file(s) with this
+    exception, you may extend this exception to your version of the file(s),
+    but you are not obligated to do so. If you do not wish to do so, delete this
+    exception statement from your version. If you delete this exception statement
+    from all source files in the program, then also delete it here.
+*/
+// Loopback benchmark of the adnl receive path: sender threads flood a port with channel packets while N
+// SO_REUSEPORT sockets receive, decrypt and parse them, each on its own actor. Prints packets/sec for every N.
+#include "td/actor/actor.h"
+#include "td/net/UdpServer.h"
+#include "td/utils/OptionParser.h"
+#include "td/utils/Random.h"
+#include "td/utils/Time.h"
+#include "td/utils/port/UdpSocketFd.h"
+#include "td/utils/port/thread.h"
+#include "adnl/adnl-channel.h"
+#include "keys/keys.hpp"
+
+#include <atomic>
+#include <iostream>
+
+class ReceiveCallback : public td::UdpServer::Callback {
+ public:
+  ReceiveCallback(std::shared_ptr<ton::Decryptor> decryptor, ton::adnl::AdnlNodeIdShort peer_id,
+                  std::atomic<td::uint64> &received)
+      : decryptor_(std::move(decryptor)), peer_id_(peer_id), received_(received) {
+  }
+
+ private:
+  std::shared_ptr<ton::Decryptor> decryptor_;
+  ton::adnl::AdnlNodeIdShort peer_id_;
+  std::atomic<td::uint64> &received_;
+
+  void on_udp_message(td::UdpMessage message) override {
+    if (message.error.is_error() || message.data.size() < 32) {
+      return;
+    }
+    auto R = ton::adnl::AdnlChannel::decrypt_packet(*decryptor_, peer_id_, message.data.as_slice().substr(32));
+    if (R.is_ok()) {
+      received_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+};
+
+int main(int argc, char *argv[]) {
+#if TD_PORT_POSIX
+  td::uint32 max_sockets = 8;
+  td::uint32 senders = 16;
+  td::uint32 threads = 0;
+  double duration = 5.0;
+  int port = 16000;
+  size_t payload_size = 512;
+
+  td::OptionParser p;
+  p.set_description("loopback benchmark of receiving adnl channel packets with several SO_REUSEPORT sockets");
+  p.add_checked_option('n', "sockets", "maximal number of receiving sockets, runs 1, 2, 4, ... (default: 8)",
+                       [&](td::Slice arg) {
+                         TRY_RESULT_ASSIGN(max_sockets, td::to_integer_safe<td::uint32>(arg));
+                         return td::Status::OK();
+                       });
+  p.add_checked_option('s', "senders", "number of sending threads (default: 16)", [&](td::Slice arg) {
+    TRY_RESULT_ASSIGN(senders, td::to_integer_safe<td::uint32>(arg));
+    return td::Status::OK();
+  });
+  p.add_checked_option('t', "threads", "number of scheduler threads (default: number of sockets)", [&](td::Slice arg) {
+    TRY_RESULT_ASSIGN(threads, td::to_integer_safe<td::uint32>(arg));
+    return td::Status::OK();
+  });
+  p.add_option('d', "duration", "seconds to measure every configuration (default: 5)",
+               [&](td::Slice arg) { duration = td::to_double(arg); });
+  p.add_checked_option('p', "port", "first udp port to use (default: 16000)", [&](td::Slice arg) {
+    TRY_RESULT_ASSIGN(port, td::to_integer_safe<int>(arg));
+    return td::Status::OK();
+  });
+  p.add_checked_option('\0', "size", "payload size of a packet (default: 512)", [&](td::Slice arg) {
+    TRY_RESULT_ASSIGN(payload_size, td::to_integer_safe<size_t>(arg));
+    return td::Status::OK();
+  });
+  p.run(argc, argv).ensure();
+
+  td::SecureString secret{32};
+  td::Random::secure_bytes(secret.as_mutable_slice());
+  ton::PrivateKey channel_key{ton::privkeys::AES{secret.copy()}};
+  ton::PublicKey channel_pub{ton::pubkeys::AES{std::move(secret)}};
+  std::shared_ptr<ton::Decryptor> decryptor = channel_key.create_decryptor().move_as_ok();
+  auto encryptor = channel_pub.create_encryptor().move_as_ok();
+
+  td::Bits256 peer_hash;
+  td::Random::secure_bytes(peer_hash.as_slice());
+  ton::adnl::AdnlNodeIdShort peer_id{peer_hash};
+
+  ton::adnl::AdnlPacket packet;
+  packet.init_random();
+  packet.set_source(peer_id);
+  packet.set_seqno(1);
+  packet.add_message(ton::adnl::adnlmessage::AdnlMessageCustom{td::BufferSlice(payload_size)});
+  auto encrypted = encryptor->encrypt(ton::serialize_tl_object(packet.tl(), true).as_slice()).move_as_ok();
+  td::BufferSlice datagram(32 + encrypted.size());
+  datagram.as_slice().copy_from(channel_key.compute_short_id().as_slice());
+  datagram.as_slice().substr(32).copy_from(encrypted.as_slice());
+
+  for (td::uint32 sockets = 1; sockets <= max_sockets; sockets *= 2, port++) {
+    td::actor::Scheduler scheduler({threads ? threads : sockets});
+    std::atomic<td::uint64> received{0};
+    std::vector<td::actor::ActorOwn<td::UdpServer>> servers;
+    scheduler.run_in_context([&] {
+      for (td::uint32 i = 0; i < sockets; i++) {
+        servers.push_back(td::UdpServer::create(PSLICE() << "udp server #" << i, port,
+                                                std::make_unique<ReceiveCallback>(decryptor, peer_id, received), true)
+                              .move_as_ok());
+      }
+    });
+
+    td::IPAddress to;
+    to.init_ipv4_port("127.0.0.1", port).ensure();
+    std::atomic<bool> stop{false};
+    std::vector<td::thread> sender_threads;
+    for (td::uint32 i = 0; i < senders; i++) {
+      sender_threads.emplace_back([&, i] {
+        // every sender uses its own source port, so that the kernel spreads them between the receiving sockets
+        td::IPAddress from;
+        from.init_ipv4_port("127.0.0.1", port + 1000 + static_cast<int>(i)).ensure();
+        auto fd = td::UdpSocketFd::open(from).move_as_ok();
+        td::UdpSocketFd::OutboundMessage message{&to, datagram.as_slice()};
+        while (!stop.load(std::memory_order_relaxed)) {
+          bool is_sent = false;
+          fd.send_message(message, is_sent).ignore();
+          if (!is_sent) {
+            td::this_thread::yield();
+          }
+        }
+      });
+    }
+
+    auto run_for = [&](double seconds) {
+      auto deadline = td::Timestamp::in(seconds);
+      while (!deadline.is_in_past()) {
+        scheduler.run(0.1);
+      }
+    };
+    run_for(0.5);
+    auto start_received = received.load();
+    auto start_time = td::Time::now();
+    run_for(duration);
+    auto packets = received.load() - start_received;
+    auto elapsed = td::Time::now() - start_time;
+
+    stop = true;
+    for (auto &thread : sender_threads) {
+      thread.join();
+    }
+    scheduler.run_in_context([&] { servers.clear(); });
+    scheduler.stop();
+
+    std::cout << "sockets=" << sockets << " packets=" << packets
+              << " pps=" << static_cast<td::uint64>(static_cast<double>(packets) / elapsed) << std::endl;
+  }
+  return 0;
+#else
+  std::cerr << "not supported on this platform" << std::endl;
+  return 1;
+#endif
+}
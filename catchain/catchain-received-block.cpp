@@ -406,10 +406,11 @@ td::Status CatChainReceivedBlock::pre_validate_block(const CatChainReceiver *cha
     used.insert(X->src_);
   }
 
-  TRY_STATUS(chain->validate_block_sync(block->data_->prev_));
+  std::vector<const tl_object_ptr<ton_api::catchain_block_dep> *> deps{&block->data_->prev_};
   for (const auto &X : block->data_->deps_) {
-    TRY_STATUS(chain->validate_block_sync(X));
+    deps.push_back(&X);
   }
+  TRY_STATUS(chain->validate_block_deps_sync(deps));
 
   if (payload.empty()) {
     return td::Status::Error(ErrorCode::protoviolation, "empty payload");
@@ -225,24 +225,36 @@ CatChainReceivedBlock *CatChainReceiverImpl::create_block(tl_object_ptr<ton_api:
 }
 
 td::Status CatChainReceiverImpl::validate_block_sync(const tl_object_ptr<ton_api::catchain_block_dep> &dep) const {
-  TRY_STATUS_PREFIX(CatChainReceivedBlock::pre_validate_block(this, dep), "failed to validate block: ");
-
-  if (dep->height_ > 0) {
-    auto id = CatChainReceivedBlock::block_id(this, dep);
-    td::BufferSlice B = serialize_tl_object(id, true);
-    CatChainReceivedBlock *block = get_block(get_tl_object_sha_bits256(id));
-    if (block) {
-      return td::Status::OK();
+  return validate_block_deps_sync({&dep});
+}
+
+td::Status CatChainReceiverImpl::validate_block_deps_sync(
+    const std::vector<const tl_object_ptr<ton_api::catchain_block_dep> *> &deps) const {
+  std::vector<td::BufferSlice> ids;
+  std::vector<Encryptor::SignatureCheck> checks;
+  for (auto dep : deps) {
+    TRY_STATUS_PREFIX(CatChainReceivedBlock::pre_validate_block(this, *dep), "failed to validate block: ");
+    if ((*dep)->height_ == 0) {
+      continue;
+    }
+    auto id = CatChainReceivedBlock::block_id(this, *dep);
+    if (get_block(get_tl_object_sha_bits256(id))) {
+      continue;
     }
 
     CatChainReceiverSource *S = get_source_by_hash(PublicKeyHash{id->src_});
     CHECK(S != nullptr);
     Encryptor *E = S->get_encryptor_sync();
     CHECK(E != nullptr);
-    return E->check_signature(B.as_slice(), dep->signature_.as_slice());
-  } else {
-    return td::Status::OK();
+    ids.push_back(serialize_tl_object(id, true));
+    checks.push_back(Encryptor::SignatureCheck{E, ids.back().as_slice(), (*dep)->signature_.as_slice()});
+  }
+  auto bad = Encryptor::check_signatures(checks);
+  if (!bad.empty()) {
+    auto &check = checks[bad[0]];
+    return check.encryptor->check_signature(check.message, check.signature);
   }
+  return td::Status::OK();
 }
 
 td::Status CatChainReceiverImpl::validate_block_sync(const tl_object_ptr<ton_api::catchain_block> &block,
@@ -62,6 +62,9 @@ class CatChainReceiver : public CatChainReceiverInterface {
   virtual const CatChainOptions &opts() const = 0;
 
   virtual td::Status validate_block_sync(const tl_object_ptr<ton_api::catchain_block_dep> &dep) const = 0;
+  // same as validate_block_sync for each dep, but all signatures are checked as one batch
+  virtual td::Status validate_block_deps_sync(
+      const std::vector<const tl_object_ptr<ton_api::catchain_block_dep> *> &deps) const = 0;
   virtual td::Status validate_block_sync(const tl_object_ptr<ton_api::catchain_block> &block,
                                          const td::Slice &payload) const = 0;
 
@@ -86,6 +86,8 @@ class CatChainReceiverImpl final : public CatChainReceiver {
   CatChainReceivedBlock *create_block(tl_object_ptr<ton_api::catchain_block_dep> block) override;
 
   td::Status validate_block_sync(const tl_object_ptr<ton_api::catchain_block_dep> &dep) const override;
+  td::Status validate_block_deps_sync(
+      const std::vector<const tl_object_ptr<ton_api::catchain_block_dep> *> &deps) const override;
   td::Status validate_block_sync(const tl_object_ptr<ton_api::catchain_block> &block,
                                  const td::Slice &payload) const override;
 
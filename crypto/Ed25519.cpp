@@ -20,6 +20,8 @@
 
 #if TD_HAVE_OPENSSL
 
+#include "td/utils/port/thread.h"
+
 #include <openssl/opensslv.h>
 
 #if OPENSSL_VERSION_NUMBER >= 0x10101000L && OPENSSL_VERSION_NUMBER != 0x20000000L || defined(OPENSSL_IS_BORINGSSL)
@@ -57,6 +59,46 @@ SecureString Ed25519::PrivateKey::as_octet_string() const {
   return octet_string_.copy();
 }
 
+std::vector<size_t> Ed25519::verify_signatures(Span<SignatureCheck> batch, int threads) {
+  // A randomized batch equation is not used on purpose: it cannot tell apart signatures that differ by
+  // a small order component, which verify_signature rejects, and validators must agree on every signature
+  const size_t min_signatures_per_thread = 8;
+  std::vector<unsigned char> is_bad(batch.size(), 0);
+  auto check_range = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      auto &entry = batch[i];
+      is_bad[i] = entry.public_key->verify_signature(entry.data, entry.signature).is_error();
+    }
+  };
+  size_t workers_count = 1;
+  if (threads > 1) {
+    workers_count = std::min<size_t>(threads, batch.size() / min_signatures_per_thread);
+  }
+#if !TD_THREAD_UNSUPPORTED
+  if (workers_count > 1) {
+    size_t chunk = (batch.size() + workers_count - 1) / workers_count;
+    std::vector<td::thread> workers;
+    for (size_t begin = chunk; begin < batch.size(); begin += chunk) {
+      workers.emplace_back(check_range, begin, std::min(begin + chunk, batch.size()));
+    }
+    check_range(0, chunk);
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  } else
+#endif
+  {
+    check_range(0, batch.size());
+  }
+  std::vector<size_t> bad;
+  for (size_t i = 0; i < batch.size(); i++) {
+    if (is_bad[i]) {
+      bad.push_back(i);
+    }
+  }
+  return bad;
+}
+
 #if OPENSSL_VERSION_NUMBER >= 0x10101000L && OPENSSL_VERSION_NUMBER != 0x20000000L || defined(OPENSSL_IS_BORINGSSL)
 
 namespace detail {
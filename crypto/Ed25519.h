@@ -20,6 +20,7 @@
 
 #include "td/utils/common.h"
 #include "td/utils/SharedSlice.h"
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 
 #if TD_HAVE_OPENSSL
@@ -62,6 +63,17 @@ class Ed25519 {
     SecureString octet_string_;
   };
 
+  struct SignatureCheck {
+    const PublicKey *public_key;
+    Slice data;
+    Slice signature;
+  };
+
+  // returns the indices of entries with wrong signatures, in increasing order; every entry is accepted exactly
+  // when PublicKey::verify_signature accepts it. With threads > 1 large batches are split between worker threads,
+  // which are started by every call and joined before it returns
+  static std::vector<size_t> verify_signatures(Span<SignatureCheck> batch, int threads = 1);
+
   static Result<PrivateKey> generate_private_key();
 
   static Result<SecureString> compute_shared_secret(const PublicKey &public_key, const PrivateKey &private_key);
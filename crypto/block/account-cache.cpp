@@ -0,0 +1,174 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "block/account-cache.h"
+#include "td/utils/Timer.h"
+
+#include <tuple>
+
+namespace block {
+
+std::string AccountCache::Stats::to_str() const {
+  return PSTRING() << "hits=" << hits << " misses=" << misses << " saved_unpack_time=" << saved_time;
+}
+
+bool AccountCache::Key::operator<(const Key& other) const {
+  return std::tie(workchain, addr, last_trans_lt, hash) <
+         std::tie(other.workchain, other.addr, other.last_trans_lt, other.hash);
+}
+
+// remembers where the cells of a freshly unpacked account are in its Account cell; false if it cannot be cached
+bool AccountCache::init_entry(Entry& entry, const vm::CellSlice& account_cs) {
+  const auto& acc = entry.account;
+  auto find_ref = [&](const Ref<vm::Cell>& cell, int& pos) {
+    pos = -1;
+    if (cell.is_null()) {
+      return true;
+    }
+    for (unsigned i = 0; i < account_cs.size_refs(); i++) {
+      if (account_cs.prefetch_ref(i)->get_hash() == cell->get_hash()) {
+        if (pos >= 0) {
+          // two equal references, cannot tell which one is used
+          return false;
+        }
+        pos = (int)i;
+      }
+    }
+    return pos >= 0;
+  };
+  return find_ref(acc.code, entry.code_ref) && find_ref(acc.data, entry.data_ref) &&
+         find_ref(acc.library, entry.library_ref) && find_ref(acc.orig_library, entry.orig_library_ref);
+}
+
+// makes the cached account refer to the cells of the current state, as if it was unpacked from shard_account
+bool AccountCache::restore_account(Entry& entry, Ref<vm::Cell> account_root, const vm::CellSlice& shard_account,
+                                   ton::UnixTime now, bool special) {
+  // the only cell loaded by Account::unpack() for the accounts that are cached
+  auto account_cs = vm::load_cell_slice_ref(account_root);
+  if (account_cs->get_data_cell_hash() != entry.key.hash) {
+    return false;
+  }
+  auto& acc = entry.account;
+  auto rebase = [&](Ref<vm::CellSlice>& cs) {
+    if (cs.not_null() && cs->get_data_cell_hash() == entry.key.hash) {
+      cs = Ref<vm::CellSlice>{true, *account_cs, cs->cur_pos() + cs->size(), cs->cur_ref() + cs->size_refs(),
+                              cs->cur_pos(), cs->cur_ref()};
+    }
+  };
+  auto get_ref = [&](int pos) { return pos >= 0 ? account_cs->prefetch_ref(pos) : Ref<vm::Cell>{}; };
+  rebase(acc.my_addr);
+  rebase(acc.my_addr_exact);
+  rebase(acc.storage);
+  rebase(acc.inner_state);
+  acc.code = get_ref(entry.code_ref);
+  acc.data = get_ref(entry.data_ref);
+  acc.library = get_ref(entry.library_ref);
+  acc.orig_library = get_ref(entry.orig_library_ref);
+  acc.total_state = acc.orig_total_state = std::move(account_root);
+  acc.last_trans_hash_ = shard_account.data_bits();
+  acc.now_ = now;
+  acc.is_special = special;
+  return true;
+}
+
+bool AccountCache::unpack(Account& account, Ref<vm::CellSlice> shard_account, ton::UnixTime now, bool special) {
+  // account:^Account last_trans_hash:bits256 last_trans_lt:uint64
+  if (shard_account.is_null() || shard_account->size() != 256 + 64 || shard_account->size_refs() != 1) {
+    return account.unpack(std::move(shard_account), now, special);
+  }
+  td::Timer timer;
+  auto account_root = shard_account->prefetch_ref();
+  Entry entry;
+  entry.key = Key{account.workchain, account.addr, (shard_account->data_bits() + 256).get_uint(64),
+                  account_root->get_hash()};
+  bool found = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!capacity_) {
+      return account.unpack(std::move(shard_account), now, special);
+    }
+    auto it = entries_.find(entry.key);
+    if (it != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      entry = *it->second;
+      found = true;
+    }
+  }
+  if (found && restore_account(entry, account_root, *shard_account, now, special)) {
+    account = std::move(entry.account);
+    std::lock_guard<std::mutex> guard(mutex_);
+    stats_.hits++;
+    stats_.saved_time += std::max(entry.unpack_time - timer.elapsed(), 0.0);
+    return true;
+  }
+  bool res = account.unpack(std::move(shard_account), now, special);
+  entry.unpack_time = timer.elapsed();
+  bool cacheable = false;
+  if (res && account.status != Account::acc_nonexist && account.balance.extra.is_null()) {
+    entry.account = account;
+    cacheable = init_entry(entry, vm::load_cell_slice(account_root));
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  stats_.misses++;
+  if (cacheable && capacity_ > 0 && !entries_.count(entry.key)) {
+    lru_.push_front(std::move(entry));
+    entries_.emplace(lru_.front().key, lru_.begin());
+    evict();
+  }
+  return res;
+}
+
+void AccountCache::evict() {
+  while (entries_.size() > capacity_) {
+    entries_.erase(lru_.back().key);
+    lru_.pop_back();
+  }
+}
+
+AccountCache::Stats AccountCache::get_stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+std::size_t AccountCache::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.size();
+}
+
+std::size_t AccountCache::capacity() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return capacity_;
+}
+
+void AccountCache::set_capacity(std::size_t capacity) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  capacity_ = capacity;
+  evict();
+}
+
+AccountCache& AccountCache::shared() {
+  static AccountCache cache{0};
+  return cache;
+}
+
+bool AccountCache::unpack_shared(Account& account, Ref<vm::CellSlice> shard_account, ton::UnixTime now,
+                                 bool special) {
+  return shared().unpack(account, std::move(shard_account), now, special);
+}
+
+}  // namespace block
@@ -0,0 +1,86 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#pragma once
+#include "block/transaction.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace block {
+using td::Ref;
+
+// Accounts unpacked from previous shard states, shared by the collators and validators of consecutive blocks.
+// An entry is keyed by the address, last_trans_lt and the hash of the Account cell, so it is valid for every state
+// that contains this cell and never has to be invalidated when the state root changes; old entries are evicted in
+// LRU order. A hit returns a copy of the cached account that refers to the cells of the current state and loads
+// the Account cell exactly as Account::unpack() does, so cell usage trees (and the Merkle proofs built from them)
+// stay the same. Accounts with extra currencies are not cached, since unpacking them also loads the currency dict.
+class AccountCache {
+ public:
+  struct Stats {
+    td::uint64 hits{0};
+    td::uint64 misses{0};
+    double saved_time{0};  // unpack time of the accounts found in the cache minus the time spent on the hits
+    std::string to_str() const;
+  };
+  enum { default_capacity = 1 << 14 };
+
+  explicit AccountCache(std::size_t capacity = default_capacity) : capacity_(capacity) {
+  }
+  // same as account.unpack(shard_account, now, special) for an account created by Account(workchain, addr)
+  bool unpack(Account& account, Ref<vm::CellSlice> shard_account, ton::UnixTime now, bool special);
+  Stats get_stats() const;
+  std::size_t size() const;
+  std::size_t capacity() const;
+  void set_capacity(std::size_t capacity);
+
+  // process-wide instance used by Collator and ValidateQuery, disabled (capacity 0) by default
+  static AccountCache& shared();
+  static bool unpack_shared(Account& account, Ref<vm::CellSlice> shard_account, ton::UnixTime now, bool special);
+
+ private:
+  struct Key {
+    ton::WorkchainId workchain;
+    ton::StdSmcAddress addr;
+    ton::LogicalTime last_trans_lt;
+    vm::CellHash hash;
+    bool operator<(const Key& other) const;
+  };
+  struct Entry {
+    Key key;
+    Account account;
+    // positions of these cells among the references of the Account cell, -1 for null
+    int code_ref{-1}, data_ref{-1}, library_ref{-1}, orig_library_ref{-1};
+    double unpack_time{0};
+  };
+
+  mutable std::mutex mutex_;
+  std::size_t capacity_;
+  std::list<Entry> lru_;  // most recently used first
+  std::map<Key, std::list<Entry>::iterator> entries_;
+  Stats stats_;
+
+  static bool init_entry(Entry& entry, const vm::CellSlice& account_cs);
+  static bool restore_account(Entry& entry, Ref<vm::Cell> account_root, const vm::CellSlice& shard_account,
+                              ton::UnixTime now, bool special);
+  void evict();
+};
+
+}  // namespace block
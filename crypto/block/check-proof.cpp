@@ -158,6 +158,39 @@ td::Status check_shard_proof(ton::BlockIdExt blk, ton::BlockIdExt shard_blk, td:
   return td::Status::OK();
 }
 
+// checks the account state root against the (virtualized) ShardAccounts dictionary of a state proof;
+// may throw vm::VmError and vm::VmVirtError
+static td::Status check_account_in_proof(vm::AugmentedDictionary& accounts_dict, const block::StdAddress& addr,
+                                         const td::Ref<vm::Cell>& root, ton::LogicalTime* last_trans_lt,
+                                         ton::Bits256* last_trans_hash) {
+  auto acc_csr = accounts_dict.lookup(addr.addr);
+  if (acc_csr.not_null()) {
+    if (root.is_null()) {
+      return td::Status::Error(PSLICE() << "account state proof shows that account state for " << addr
+                                        << " must be non-empty, but it actually is empty");
+    }
+    block::gen::ShardAccount::Record acc_info;
+    if (!tlb::csr_unpack(std::move(acc_csr), acc_info)) {
+      return td::Status::Error("cannot unpack ShardAccount from proof");
+    }
+    if (acc_info.account->get_hash().bits().compare(root->get_hash().bits(), 256)) {
+      return td::Status::Error(PSLICE() << "account state hash mismatch: Merkle proof expects "
+                                        << acc_info.account->get_hash().bits().to_hex(256)
+                                        << " but received data has " << root->get_hash().bits().to_hex(256));
+    }
+    if (last_trans_hash) {
+      *last_trans_hash = acc_info.last_trans_hash;
+    }
+    if (last_trans_lt) {
+      *last_trans_lt = acc_info.last_trans_lt;
+    }
+  } else if (root.not_null()) {
+    return td::Status::Error(PSLICE() << "account state proof shows that account state for " << addr
+                                      << " must be empty, but it is not");
+  }
+  return td::Status::OK();
+}
+
 td::Status check_account_proof(td::Slice proof, ton::BlockIdExt shard_blk, const block::StdAddress& addr,
                                td::Ref<vm::Cell> root, ton::LogicalTime* last_trans_lt, ton::Bits256* last_trans_hash,
                                td::uint32* save_utime, ton::LogicalTime* save_lt) {
@@ -185,31 +218,7 @@ td::Status check_account_proof(td::Slice proof, ton::BlockIdExt shard_blk, const
     }
     vm::AugmentedDictionary accounts_dict{vm::load_cell_slice(sstate.accounts).prefetch_ref(), 256,
                                           block::tlb::aug_ShardAccounts};
-    auto acc_csr = accounts_dict.lookup(addr.addr);
-    if (acc_csr.not_null()) {
-      if (root.is_null()) {
-        return td::Status::Error(PSLICE() << "account state proof shows that account state for " << addr
-                                          << " must be non-empty, but it actually is empty");
-      }
-      block::gen::ShardAccount::Record acc_info;
-      if (!tlb::csr_unpack(std::move(acc_csr), acc_info)) {
-        return td::Status::Error("cannot unpack ShardAccount from proof");
-      }
-      if (acc_info.account->get_hash().bits().compare(root->get_hash().bits(), 256)) {
-        return td::Status::Error(PSLICE() << "account state hash mismatch: Merkle proof expects "
-                                          << acc_info.account->get_hash().bits().to_hex(256)
-                                          << " but received data has " << root->get_hash().bits().to_hex(256));
-      }
-      if (last_trans_hash) {
-        *last_trans_hash = acc_info.last_trans_hash;
-      }
-      if (last_trans_lt) {
-        *last_trans_lt = acc_info.last_trans_lt;
-      }
-    } else if (root.not_null()) {
-      return td::Status::Error(PSLICE() << "account state proof shows that account state for " << addr
-                                        << " must be empty, but it is not");
-    }
+    TRY_STATUS(check_account_in_proof(accounts_dict, addr, root, last_trans_lt, last_trans_hash));
   } catch (vm::VmError err) {
     return td::Status::Error(PSLICE() << "error while traversing account proof : " << err.get_msg());
   } catch (vm::VmVirtError err) {
@@ -256,6 +265,70 @@ td::Result<AccountState::Info> AccountState::validate(ton::BlockIdExt ref_blk, b
   return res;
 }
 
+td::Result<std::vector<AccountState::Info>> AccountStates::validate(ton::BlockIdExt ref_blk,
+                                                                   const std::vector<block::StdAddress>& addrs) const {
+  if (states.size() != addrs.size()) {
+    return td::Status::Error(PSLICE() << "obtained " << states.size() << " account states instead of requested "
+                                      << addrs.size());
+  }
+  if (blk != ref_blk && ref_blk.id.seqno != ~0U) {
+    return td::Status::Error(PSLICE() << "obtained getAccountStates() for a different reference block "
+                                      << blk.to_str() << " instead of requested " << ref_blk.to_str());
+  }
+  if (!shard_blk.is_valid_full()) {
+    return td::Status::Error(PSLICE() << "shard block id " << shard_blk.to_str() << " in answer is invalid");
+  }
+  for (auto& addr : addrs) {
+    if (!ton::shard_contains(shard_blk.shard_full(), ton::extract_addr_prefix(addr.workchain, addr.addr))) {
+      return td::Status::Error(PSLICE() << "received data from shard block " << shard_blk.to_str()
+                                        << " that cannot contain requested account " << addr);
+    }
+  }
+  TRY_STATUS(block::check_shard_proof(blk, shard_blk, shard_proof.as_slice()));
+
+  std::vector<AccountState::Info> res(addrs.size());
+  for (size_t i = 0; i < addrs.size(); i++) {
+    TRY_RESULT_PREFIX(root, vm::std_boc_deserialize(states[i].as_slice(), true), "cannot deserialize account state");
+    res[i].root = res[i].true_root = std::move(root);
+  }
+
+  // the state proof is deserialized and checked once for all accounts
+  TRY_RESULT_PREFIX(Q_roots, vm::std_boc_deserialize_multi(proof.as_slice()), "cannot deserialize account proof");
+  if (Q_roots.size() != 2) {
+    return td::Status::Error(PSLICE() << "account state proof must have exactly two roots");
+  }
+  try {
+    auto state_root = vm::MerkleProof::virtualize(std::move(Q_roots[1]), 1);
+    if (state_root.is_null()) {
+      return td::Status::Error("account state proof is invalid");
+    }
+    ton::Bits256 state_hash = state_root->get_hash().bits();
+    td::uint32 gen_utime = 0;
+    ton::LogicalTime gen_lt = 0;
+    TRY_STATUS_PREFIX(check_block_header_proof(vm::MerkleProof::virtualize(std::move(Q_roots[0]), 1), shard_blk,
+                                               &state_hash, true, &gen_utime, &gen_lt),
+                      "error in account shard block header proof : ");
+    block::gen::ShardStateUnsplit::Record sstate;
+    if (!(tlb::unpack_cell(std::move(state_root), sstate))) {
+      return td::Status::Error("cannot unpack state header");
+    }
+    vm::AugmentedDictionary accounts_dict{vm::load_cell_slice(sstate.accounts).prefetch_ref(), 256,
+                                          block::tlb::aug_ShardAccounts};
+    for (size_t i = 0; i < addrs.size(); i++) {
+      res[i].last_trans_hash.set_zero();
+      TRY_STATUS(check_account_in_proof(accounts_dict, addrs[i], res[i].root, &res[i].last_trans_lt,
+                                        &res[i].last_trans_hash));
+      res[i].gen_utime = gen_utime;
+      res[i].gen_lt = gen_lt;
+    }
+  } catch (vm::VmError err) {
+    return td::Status::Error(PSLICE() << "error while traversing account proof : " << err.get_msg());
+  } catch (vm::VmVirtError err) {
+    return td::Status::Error(PSLICE() << "virtualization error while traversing account proof : " << err.get_msg());
+  }
+  return std::move(res);
+}
+
 td::Result<Transaction::Info> Transaction::validate() {
   if (root.is_null()) {
     return td::Status::Error("transactions are expected to be non-empty");
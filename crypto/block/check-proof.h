@@ -57,6 +57,18 @@ struct AccountState {
   td::Result<Info> validate(ton::BlockIdExt ref_blk, block::StdAddress addr) const;
 };
 
+// answer to liteServer.getAccountStates: states of several accounts of one shard sharing a single proof
+struct AccountStates {
+  ton::BlockIdExt blk;
+  ton::BlockIdExt shard_blk;
+  td::BufferSlice shard_proof;
+  td::BufferSlice proof;
+  std::vector<td::BufferSlice> states;
+
+  td::Result<std::vector<AccountState::Info>> validate(ton::BlockIdExt ref_blk,
+                                                       const std::vector<block::StdAddress>& addrs) const;
+};
+
 struct Transaction {
   ton::BlockIdExt blkid;
   ton::LogicalTime lt;
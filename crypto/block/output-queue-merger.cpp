@@ -201,6 +201,18 @@ bool OutputQueueMerger::next() {
   }
 }
 
+OutputQueueMerger::MsgKeyValue* OutputQueueMerger::peek(std::size_t offset) {
+  if (eof) {
+    return nullptr;
+  }
+  while (pos + offset >= msg_list.size()) {
+    if (!load()) {
+      return nullptr;
+    }
+  }
+  return msg_list[pos + offset].get();
+}
+
 bool OutputQueueMerger::load() {
   if (heap.empty() || failed) {
     return false;
@@ -74,6 +74,8 @@ struct OutputQueueMerger {
   MsgKeyValue* cur();
   std::unique_ptr<MsgKeyValue> extract_cur();
   bool next();
+  // message `offset` positions after the current one (loads more messages if needed), nullptr if there is none
+  MsgKeyValue* peek(std::size_t offset);
 
  private:
   td::BitArray<32 + 64> common_pfx;
@@ -94,6 +94,47 @@ Ref<vm::Cell> ComputePhaseConfig::lookup_library(td::ConstBitPtr key) const {
   return libraries ? vm::lookup_library_in(key, libraries->get_root_cell()) : Ref<vm::Cell>{};
 }
 
+/**
+ * Creates a copy of the configuration.
+ * Dictionaries are re-created from their roots, because vm::Dictionary objects must not be shared between threads.
+ *
+ * @returns The copy of the configuration.
+ */
+ComputePhaseConfig ComputePhaseConfig::clone() const {
+  ComputePhaseConfig res;
+  res.gas_price = gas_price;
+  res.gas_limit = gas_limit;
+  res.special_gas_limit = special_gas_limit;
+  res.gas_credit = gas_credit;
+  res.flat_gas_limit = flat_gas_limit;
+  res.flat_gas_price = flat_gas_price;
+  res.special_gas_full = special_gas_full;
+  res.mc_gas_prices = mc_gas_prices;
+  res.gas_price256 = gas_price256;
+  res.max_gas_threshold = max_gas_threshold;
+  if (libraries) {
+    res.libraries = std::make_unique<vm::Dictionary>(libraries->get_root_cell(), libraries->get_key_bits());
+  }
+  res.global_config = global_config;
+  res.block_rand_seed = block_rand_seed;
+  res.ignore_chksig = ignore_chksig;
+  res.with_vm_log = with_vm_log;
+  res.max_vm_data_depth = max_vm_data_depth;
+  res.global_version = global_version;
+  res.prev_blocks_info = prev_blocks_info;
+  res.unpacked_config_tuple = unpacked_config_tuple;
+  if (suspended_addresses) {
+    res.suspended_addresses = std::make_unique<vm::Dictionary>(suspended_addresses->get_root_cell(),
+                                                               suspended_addresses->get_key_bits());
+  }
+  res.size_limits = size_limits;
+  res.vm_log_verbosity = vm_log_verbosity;
+  res.stop_on_accept_message = stop_on_accept_message;
+  res.precompiled_contracts = precompiled_contracts;
+  res.dont_run_precompiled_ = dont_run_precompiled_;
+  return res;
+}
+
 /*
  * 
  *   ACCOUNTS
@@ -146,6 +146,8 @@ struct ComputePhaseConfig {
   bool parse_GasLimitsPrices(Ref<vm::CellSlice> cs, td::RefInt256& freeze_due_limit, td::RefInt256& delete_due_limit);
   bool parse_GasLimitsPrices(Ref<vm::Cell> cell, td::RefInt256& freeze_due_limit, td::RefInt256& delete_due_limit);
   bool is_address_suspended(ton::WorkchainId wc, td::Bits256 addr) const;
+  // copy with its own dictionary objects, so that it can be used by another thread
+  ComputePhaseConfig clone() const;
 
  private:
   bool parse_GasLimitsPrices_internal(Ref<vm::CellSlice> cs, td::RefInt256& freeze_due_limit,
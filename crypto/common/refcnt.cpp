@@ -20,6 +20,8 @@
 
 #include "td/utils/ScopeGuard.h"
 
+#include <new>
+
 namespace td {
 
 Ref<CntObject> CntObject::clone() const {
@@ -56,5 +58,96 @@ void safe_delete(const CntObject *ptr) {
   init_thread_local<SafeDeleter>(deleter);
   deleter->retire(ptr);
 }
+
+struct CntPoolState {
+  struct Block {
+    Block *next;
+  };
+  Block *free_lists[CntPool::size_classes] = {};
+  int depth{0};
+  CntPool::Stats stats;
+
+  void release() {
+    for (auto &head : free_lists) {
+      while (head) {
+        auto *next = head->next;
+        ::operator delete(head);
+        head = next;
+      }
+    }
+  }
+  ~CntPoolState() {
+    release();
+  }
+};
+
+TD_THREAD_LOCAL CntPoolState *cnt_pool_state;
+std::atomic<bool> cnt_pool_enabled{false};
 }  // namespace detail
+
+void *CntPool::allocate(std::size_t size) {
+  if (size == 0 || size > max_size) {
+    if (detail::cnt_pool_state) {
+      detail::cnt_pool_state->stats.heap_allocations++;
+    }
+    return ::operator new(size);
+  }
+  auto cls = (size - 1) / granularity;
+  auto *state = detail::cnt_pool_state;
+  if (!state || state->depth == 0) {
+    // outside of a Scope (always when the pool is disabled) there is nothing to reuse; the block is still rounded
+    // up to its size class, because it may be freed into a free list by a later Scope
+    if (state) {
+      state->stats.heap_allocations++;
+    }
+    return ::operator new((cls + 1) * granularity);
+  }
+  auto *block = state->free_lists[cls];
+  if (block) {
+    state->free_lists[cls] = block->next;
+    state->stats.reused++;
+    return block;
+  }
+  state->stats.heap_allocations++;
+  return ::operator new((cls + 1) * granularity);
+}
+
+void CntPool::deallocate(void *ptr, std::size_t size) {
+  auto *state = detail::cnt_pool_state;
+  if (state && state->depth > 0 && size != 0 && size <= max_size) {
+    auto cls = (size - 1) / granularity;
+    auto *block = static_cast<detail::CntPoolState::Block *>(ptr);
+    block->next = state->free_lists[cls];
+    state->free_lists[cls] = block;
+    return;
+  }
+  ::operator delete(ptr);
+}
+
+bool CntPool::is_enabled() {
+  return detail::cnt_pool_enabled.load(std::memory_order_relaxed);
+}
+
+void CntPool::set_enabled(bool enabled) {
+  detail::cnt_pool_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+CntPool::Stats CntPool::get_stats() {
+  init_thread_local<detail::CntPoolState>(detail::cnt_pool_state);
+  return detail::cnt_pool_state->stats;
+}
+
+CntPool::Scope::Scope() {
+  if (is_enabled()) {
+    init_thread_local<detail::CntPoolState>(detail::cnt_pool_state);
+    detail::cnt_pool_state->depth++;
+    active_ = true;
+  }
+}
+
+CntPool::Scope::~Scope() {
+  if (active_ && --detail::cnt_pool_state->depth == 0) {
+    detail::cnt_pool_state->release();
+  }
+}
 }  // namespace td
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 #include <utility>
 #include <atomic>
 #include <iostream>
@@ -31,6 +32,52 @@ namespace td {
 template <class T>
 class Ref;
 
+// Thread-local free lists for the small refcounted objects that TVM creates and destroys in large numbers
+// (integers, tuples, cell slices and builders, continuations). Blocks are ordinary heap blocks rounded up to
+// a size class, so an object may outlive the run that created it or be destroyed on another thread. Freed blocks
+// are kept for reuse only inside a Scope (VmState::run() opens one while the pool is enabled) and are all returned
+// to the heap when the outermost Scope of the thread ends.
+class CntPool {
+ public:
+  enum { granularity = 16, max_size = 512, size_classes = max_size / granularity };
+  struct Stats {
+    unsigned long long heap_allocations{0};
+    unsigned long long reused{0};
+  };
+  class Scope {
+   public:
+    Scope();
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    bool active_{false};
+  };
+
+  static void* allocate(std::size_t size);
+  static void deallocate(void* ptr, std::size_t size);
+  static bool is_enabled();
+  static void set_enabled(bool enabled);
+  // allocation counters of the current thread, counted once the pool has been used by the thread
+  static Stats get_stats();
+};
+
+// Base class of CntObject subclasses allocated through CntPool
+struct CntPoolAllocated {
+  static void* operator new(std::size_t size) {
+    return CntPool::allocate(size);
+  }
+  static void operator delete(void* ptr, std::size_t size) {
+    CntPool::deallocate(ptr, size);
+  }
+  static void* operator new(std::size_t, void* place) noexcept {
+    return place;
+  }
+  static void operator delete(void*, void*) noexcept {
+  }
+};
+
 class CntObject {
  private:
   mutable std::atomic<int> cnt_;
@@ -89,7 +136,7 @@ class CntObject {
 typedef Ref<CntObject> RefAny;
 
 template <class T>
-class Cnt : public CntObject {
+class Cnt : public CntObject, public CntPoolAllocated {
   T value;
 
  public:
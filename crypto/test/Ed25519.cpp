@@ -17,8 +17,10 @@
     Copyright 2017-2020 Telegram Systems LLP
 */
 #include "crypto/Ed25519.h"
+#include "td/utils/benchmark.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
+#include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/tests.h"
 #include "td/utils/JsonBuilder.h"
@@ -217,3 +219,83 @@ TEST(Crypto, almost_zero) {
     }
   }
 }
+
+TEST(Crypto, ed25519_batch) {
+  std::vector<td::Ed25519::PublicKey> keys;
+  std::vector<std::string> messages;
+  std::vector<std::string> signatures;
+  for (int i = 0; i < 64; i++) {
+    auto pk = td::Ed25519::generate_private_key().move_as_ok();
+    keys.push_back(pk.get_public_key().move_as_ok());
+    messages.push_back(td::rand_string('a', 'z', td::Random::fast(0, 100)));
+    signatures.push_back(pk.sign(messages.back()).move_as_ok().as_slice().str());
+  }
+  // wrong signature, wrong message, zero signature, signature of another key
+  signatures[3][td::Random::fast(0, 63)] ^= 1;
+  messages[17] += "x";
+  signatures[40] = std::string(64, '\0');
+  std::swap(signatures[50], signatures[51]);
+
+  std::vector<size_t> expected;
+  std::vector<td::Ed25519::SignatureCheck> batch;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (keys[i].verify_signature(messages[i], signatures[i]).is_error()) {
+      expected.push_back(i);
+    }
+    batch.push_back(td::Ed25519::SignatureCheck{&keys[i], messages[i], signatures[i]});
+  }
+  ASSERT_EQ(5u, expected.size());
+  for (int threads : {1, 3, 8}) {
+    ASSERT_TRUE(expected == td::Ed25519::verify_signatures(batch, threads));
+    for (size_t size : {0, 1, 7, 20}) {
+      std::vector<size_t> expected_prefix;
+      for (auto i : expected) {
+        if (i < size) {
+          expected_prefix.push_back(i);
+        }
+      }
+      ASSERT_TRUE(expected_prefix ==
+                  td::Ed25519::verify_signatures(td::Span<td::Ed25519::SignatureCheck>(batch.data(), size), threads));
+    }
+  }
+}
+
+class BenchEd25519Batch : public td::Benchmark {
+ public:
+  BenchEd25519Batch(size_t batch_size, int threads) : batch_size_(batch_size), threads_(threads) {
+    for (size_t i = 0; i < batch_size; i++) {
+      auto pk = td::Ed25519::generate_private_key().move_as_ok();
+      keys_.push_back(pk.get_public_key().move_as_ok());
+      messages_.push_back(td::rand_string('a', 'z', 100));
+      signatures_.push_back(pk.sign(messages_.back()).move_as_ok().as_slice().str());
+    }
+    for (size_t i = 0; i < batch_size; i++) {
+      batch_.push_back(td::Ed25519::SignatureCheck{&keys_[i], messages_[i], signatures_[i]});
+    }
+  }
+
+  std::string get_description() const override {
+    return PSTRING() << "Ed25519 signatures in batches of " << batch_size_ << " with " << threads_ << " threads";
+  }
+
+  void run(int n) override {
+    for (int i = 0; i < n; i += static_cast<int>(batch_size_)) {
+      CHECK(td::Ed25519::verify_signatures(batch_, threads_).empty());
+    }
+  }
+
+ private:
+  size_t batch_size_;
+  int threads_;
+  std::vector<td::Ed25519::PublicKey> keys_;
+  std::vector<std::string> messages_;
+  std::vector<std::string> signatures_;
+  std::vector<td::Ed25519::SignatureCheck> batch_;
+};
+
+TEST(Crypto, ed25519_batch_benchmark) {
+  for (size_t batch_size : {1, 4, 16, 64, 256}) {
+    td::bench(BenchEd25519Batch(batch_size, 1));
+  }
+  td::bench(BenchEd25519Batch(256, 4));
+}
@@ -25,6 +25,7 @@
 #include "vm/cells/MerkleUpdate.h"
 #include "vm/db/CellStorage.h"
 #include "vm/db/CellHashTable.h"
+#include "vm/db/DataCellCache.h"
 #include "vm/db/TonDb.h"
 #include "vm/db/StaticBagOfCellsDb.h"
 
@@ -624,6 +625,31 @@ TEST(Cell, MerkleUpdateCombine) {
   }
 };
 
+TEST(Cell, MerkleUpdateFast) {
+  td::Random::Xorshift128plus rnd{123};
+  for (int t = 0; t < 1000; t++) {
+    bool with_prunned_branches = t % 2 == 0;
+    auto A = gen_random_cell(rnd.fast(1, 1000), rnd, with_prunned_branches);
+    auto size = rnd.fast(1, X);
+    auto seed = rnd();
+    // the same new cell is built on top of separate usage trees, from is passed with and without usage cells
+    auto gen_update = [&](bool fast, bool pure_from) {
+      td::Random::Xorshift128plus new_rnd{seed};
+      auto usage_tree = std::make_shared<CellUsageTree>();
+      auto usage_cell = UsageCell::create(A, usage_tree->root_ptr());
+      auto B = gen_random_cell(size, usage_cell, new_rnd, with_prunned_branches);
+      auto from = pure_from ? A : usage_cell;
+      auto update = fast ? MerkleUpdate::generate_fast(from, B, usage_tree.get())
+                         : MerkleUpdate::generate(from, B, usage_tree.get());
+      check_merkle_update(A, B, update);
+      return serialize_boc(update);
+    };
+    auto expected = gen_update(false, false);
+    ASSERT_EQ(expected, gen_update(true, false));
+    ASSERT_EQ(expected, gen_update(true, true));
+  }
+};
+
 class BenchCellBuilder : public td::Benchmark {
  public:
   std::string get_description() const override {
@@ -1364,6 +1390,88 @@ TEST(Cell, MerkleUpdateArray) {
   check_merkle_update(root, arr.root(), update);
 }
 
+TEST(Cell, MerkleUpdateFastDynamicBoc) {
+  size_t n = 1 << 14;
+  std::vector<td::uint64> data;
+  for (size_t i = 0; i < n; i++) {
+    data.push_back(i / 3);
+  }
+  auto kv = std::make_shared<td::MemoryKeyValue>();
+  auto root_hash = CompactArray(data).root()->get_hash().as_slice().str();
+  {
+    auto dboc = DynamicBagOfCellsDb::create();
+    dboc->set_loader(std::make_unique<CellLoader>(kv));
+    dboc->inc(CompactArray(data).root());
+    dboc->prepare_commit();
+    CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+  // reused cells of a state loaded from the db are not loaded by generate_fast(), the result must be the same
+  auto gen_update = [&](bool fast) {
+    auto dboc = DynamicBagOfCellsDb::create();
+    dboc->set_loader(std::make_unique<CellLoader>(kv));
+    auto root = dboc->load_cell(root_hash).move_as_ok();
+    auto usage_tree = std::make_shared<CellUsageTree>();
+    auto usage_cell = UsageCell::create(root, usage_tree->root_ptr());
+    CompactArray arr(n, usage_cell);
+    for (size_t i = 0; i < n; i += 97) {
+      arr.set(i, i * 7);
+    }
+    auto update = fast ? MerkleUpdate::generate_fast(root, arr.root(), usage_tree.get())
+                       : MerkleUpdate::generate(usage_cell, arr.root(), usage_tree.get());
+    check_merkle_update(root, arr.root(), update);
+    return serialize_boc(update);
+  };
+  ASSERT_EQ(gen_update(false), gen_update(true));
+}
+
+TEST(Cell, UsageTreeJournal) {
+  size_t n = 1 << 10;
+  std::vector<td::uint64> data;
+  for (size_t i = 0; i < n; i++) {
+    data.push_back(i / 3);
+  }
+  CompactArray arr(data);
+  auto root = arr.root();
+  auto make_proof = [&](bool concurrent) {
+    auto usage_tree = std::make_shared<CellUsageTree>();
+    auto usage_cell = UsageCell::create(root, usage_tree->root_ptr());
+    std::vector<CellUsageTree::LoadJournal> journals(4);
+    if (concurrent) {
+      // threads 0..2 read the used elements, thread 3 reads elements which must not get into the proof
+      usage_tree->set_concurrent(true);
+      std::vector<td::thread> threads;
+      for (size_t t = 0; t < journals.size(); t++) {
+        threads.emplace_back([&, t] {
+          CellUsageTree::AttachJournal attach{usage_tree.get(), &journals[t]};
+          CompactArray reader(n, usage_cell);
+          for (size_t i = t; i < n; i += 97) {
+            reader.get(t == 3 ? n - 1 - i : i);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      usage_tree->set_concurrent(false);
+      for (size_t t = 0; t < 3; t++) {
+        usage_tree->apply_journal(journals[t]);
+      }
+    } else {
+      CompactArray reader(n, usage_cell);
+      for (size_t t = 0; t < 3; t++) {
+        for (size_t i = t; i < n; i += 97) {
+          reader.get(i);
+        }
+      }
+    }
+    return MerkleProof::generate(usage_cell, usage_tree.get());
+  };
+  auto serial_proof = make_proof(false);
+  auto concurrent_proof = make_proof(true);
+  ASSERT_EQ(serialize_boc(serial_proof), serialize_boc(concurrent_proof));
+}
+
 TEST(Cell, MerkleUpdateCombineArray) {
   size_t n = 1 << 10;
   std::vector<td::uint64> data;
@@ -1435,6 +1543,98 @@ TEST(Cell, MerkleUpdateCombineArray) {
   validate(41);
 }
 
+Ref<Cell> gen_large_random_tree(int leaves, td::Random::Xorshift128plus &rnd) {
+  std::vector<Ref<Cell>> cells;
+  for (int i = 0; i < leaves; i++) {
+    vm::CellBuilder cb;
+    cb.store_long(rnd(), 64);
+    cb.store_long(i, 32);
+    cells.push_back(cb.finalize());
+  }
+  while (cells.size() > 1) {
+    std::vector<Ref<Cell>> next;
+    for (size_t i = 0; i < cells.size();) {
+      vm::CellBuilder cb;
+      cb.store_long(rnd(), 64);
+      auto refs = td::min<size_t>(rnd.fast(1, 4), cells.size() - i);
+      for (size_t j = 0; j < refs; j++) {
+        cb.store_ref(cells[i + j]);
+      }
+      // some cells are shared by several parents
+      if (refs < 4 && rnd.fast(0, 10) == 0) {
+        cb.store_ref(cells[rnd.fast(0, (int)cells.size() - 1)]);
+      }
+      i += refs;
+      next.push_back(cb.finalize());
+    }
+    cells = std::move(next);
+  }
+  return cells[0];
+}
+
+TEST(TonDb, BocDeserializeParallel) {
+  td::Random::Xorshift128plus rnd(123);
+  auto root = gen_large_random_tree(vm::BagOfCells::parallel_min_cells * 2, rnd);
+  // no crc32c, so that broken bags of cells get to the cell parsing
+  for (int mode : {0, 29}) {
+    auto serialized = serialize_boc(root, mode);
+    for (int threads : {1, 4}) {
+      vm::BagOfCells boc;
+      boc.deserialize(serialized, 1, threads).ensure();
+      ASSERT_EQ(root->get_hash(), boc.get_root_cell()->get_hash());
+    }
+    // a broken bag of cells must be reported in the same way by both paths
+    for (int step : {1, 7, 101}) {
+      auto broken = serialized;
+      for (size_t pos = broken.size() / 2; pos < broken.size(); pos += broken.size() / step / 16 + 1) {
+        broken[pos] ^= 0x55;
+      }
+      td::Result<long long> results[2];
+      for (int i = 0; i < 2; i++) {
+        vm::BagOfCells boc;
+        results[i] = boc.deserialize(broken, 1, i == 0 ? 1 : 4);
+        if (results[i].is_ok()) {
+          CHECK(boc.get_root_cell()->get_hash() != root->get_hash());
+        }
+      }
+      ASSERT_EQ(results[0].is_ok(), results[1].is_ok());
+      if (results[0].is_error()) {
+        ASSERT_EQ(results[0].error().to_string(), results[1].error().to_string());
+      } else {
+        ASSERT_EQ(results[0].ok(), results[1].ok());
+      }
+    }
+  }
+}
+
+class BenchBocDeserializeThreads : public td::Benchmark {
+ public:
+  explicit BenchBocDeserializeThreads(int threads) : threads_(threads) {
+    td::Random::Xorshift128plus rnd(123);
+    serialized_ = serialize_boc(gen_large_random_tree(1 << 18, rnd), 0);
+  }
+  std::string get_description() const override {
+    return PSTRING() << "BoC deserialization of " << serialized_.size() << " bytes with " << threads_ << " threads";
+  }
+  void run(int n) override {
+    for (int i = 0; i < n; i++) {
+      vm::BagOfCells boc;
+      boc.deserialize(serialized_, 1, threads_).ensure();
+      CHECK(boc.get_root_count() == 1);
+    }
+  }
+
+ private:
+  int threads_;
+  std::string serialized_;
+};
+
+TEST(TonDb, BenchBocDeserializeThreads) {
+  for (int threads : {1, 2, 4, 8}) {
+    td::bench(BenchBocDeserializeThreads(threads));
+  }
+}
+
 }  // namespace vm
 
 class BenchBocSerializerImport : public td::Benchmark {
@@ -1972,6 +2172,153 @@ TEST(TonDb, DynamicBocRespectsUsageCell) {
   ASSERT_STREQ(serialization, serialization_of_virtualized_cell);
 }
 
+TEST(TonDb, DynamicBocPrefetch) {
+  class InlineExecutor : public vm::DynamicBagOfCellsDb::AsyncExecutor {
+   public:
+    void execute_async(std::function<void()> f) override {
+      f();
+    }
+    void execute_sync(std::function<void()> f) override {
+      f();
+    }
+  };
+  td::Random::Xorshift128plus rnd(123);
+  auto kv = std::make_shared<td::MemoryKeyValue>();
+  auto dboc = vm::DynamicBagOfCellsDb::create();
+  dboc->set_loader(std::make_unique<vm::CellLoader>(kv));
+  auto cell = vm::gen_random_cell(1000, rnd);
+  auto serialization = serialize_boc(cell);
+  dboc->inc(cell);
+  {
+    vm::CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+
+  auto executor = std::make_shared<InlineExecutor>();
+  for (td::uint32 depth : {0, 1, 3}) {
+    dboc = vm::DynamicBagOfCellsDb::create();
+    dboc->set_prefetch_options({depth, 100}, executor);
+    dboc->set_loader(std::make_unique<vm::CellLoader>(kv));
+    td::Ref<vm::DataCell> root;
+    dboc->load_cell_async(cell->get_hash().as_slice(), executor, [&](td::Result<td::Ref<vm::DataCell>> r_root) {
+      root = r_root.move_as_ok();
+    });
+    ASSERT_TRUE(root.not_null());
+    ASSERT_STREQ(serialization, serialize_boc(root));
+    auto stats = dboc->get_prefetch_stats();
+    LOG(INFO) << "depth=" << depth << " prefetched=" << stats.prefetched << " hits=" << stats.hits
+              << " misses=" << stats.misses << " read amplification=" << stats.read_amplification();
+    if (depth == 0) {
+      ASSERT_EQ(0u, stats.prefetched + stats.hits + stats.misses);
+    } else {
+      ASSERT_TRUE(stats.hits > 0);
+      ASSERT_TRUE(stats.hits <= stats.prefetched);
+    }
+  }
+
+  // prefetched cells refer to their reader, it still must be freed when the loader is replaced
+  dboc = vm::DynamicBagOfCellsDb::create();
+  dboc->set_prefetch_options({3, 100}, executor);
+  dboc->set_loader(std::make_unique<vm::CellLoader>(kv));
+  std::weak_ptr<vm::CellDbReader> reader = dboc->get_cell_db_reader();
+  dboc->load_cell_async(cell->get_hash().as_slice(), executor,
+                        [](td::Result<td::Ref<vm::DataCell>> r_root) { r_root.ensure(); });
+  ASSERT_TRUE(dboc->get_prefetch_stats().prefetched > 0);
+  dboc->set_loader(std::make_unique<vm::CellLoader>(kv));
+  ASSERT_TRUE(reader.expired());
+}
+
+TEST(TonDb, DataCellCache) {
+  td::Random::Xorshift128plus rnd(123);
+  std::vector<td::Ref<vm::DataCell>> cells;
+  size_t total_size = 0;
+  for (int i = 0; i < 1000; i++) {
+    vm::CellBuilder cb;
+    cb.store_long(rnd(), 64);
+    cells.push_back(cb.finalize_novm());
+    total_size += vm::DataCellCache::get_cell_size(*cells.back());
+  }
+
+  auto dboc = vm::DynamicBagOfCellsDb::create();
+  auto &ext_cell_creator = dboc->as_ext_cell_creator();
+  vm::DataCellCache cache({total_size / 4});
+  for (auto &cell : cells) {
+    ASSERT_TRUE(cache.get(cell->get_hash().as_slice(), ext_cell_creator).is_null());
+    cache.put(cell);
+  }
+  auto stats = cache.get_stats();
+  ASSERT_TRUE(stats.bytes <= total_size / 4);
+  ASSERT_TRUE(stats.cells > 0);
+  ASSERT_EQ(cells.size(), stats.cells + stats.evictions);
+
+  // a small hot set survives a scan of cold cells
+  std::vector<td::Ref<vm::DataCell>> hot(cells.end() - 10, cells.end());
+  for (int round = 0; round < 10; round++) {
+    for (auto &cell : hot) {
+      auto cached = cache.get(cell->get_hash().as_slice(), ext_cell_creator);
+      if (cached.is_null()) {
+        cache.put(cell);
+      } else {
+        ASSERT_EQ(cell->get_hash(), cached->get_hash());
+      }
+    }
+    for (size_t i = round * 50; i < round * 50 + 50; i++) {
+      cache.put(cells[i]);
+    }
+  }
+  for (auto &cell : hot) {
+    ASSERT_TRUE(cache.get(cell->get_hash().as_slice(), ext_cell_creator).not_null());
+  }
+  stats = cache.get_stats();
+  LOG(INFO) << "hits=" << stats.hits << " misses=" << stats.misses << " hit_ratio=" << stats.hit_ratio()
+            << " cells=" << stats.cells << " bytes=" << stats.bytes << " evictions=" << stats.evictions;
+
+  vm::DataCellCache expiring_cache({total_size, -1.0});
+  expiring_cache.put(cells[0]);
+  ASSERT_TRUE(expiring_cache.get(cells[0]->get_hash().as_slice(), ext_cell_creator).is_null());
+  ASSERT_EQ(0u, expiring_cache.get_stats().cells);
+}
+
+TEST(TonDb, DynamicBocCellCache) {
+  td::Random::Xorshift128plus rnd(123);
+  auto kv = std::make_shared<td::MemoryKeyValue>();
+  auto dboc = vm::DynamicBagOfCellsDb::create();
+  dboc->set_loader(std::make_unique<vm::CellLoader>(kv));
+  auto cell = vm::gen_random_cell(1000, rnd);
+  auto serialization = serialize_boc(cell);
+  dboc->inc(cell);
+  {
+    vm::CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+
+  auto cache = std::make_shared<vm::DataCellCache>(vm::DataCellCache::Options{1 << 24});
+  td::uint64 prev_hits = 0;
+  for (int i = 0; i < 2; i++) {
+    dboc = vm::DynamicBagOfCellsDb::create();
+    dboc->set_cell_cache(cache);
+    dboc->set_loader(std::make_unique<vm::CellLoader>(kv));
+    auto root = dboc->get_cell_db_reader()->load_cell(cell->get_hash().as_slice()).move_as_ok();
+    ASSERT_STREQ(serialization, serialize_boc(root));
+    auto stats = cache->get_stats();
+    LOG(INFO) << "hits=" << stats.hits << " misses=" << stats.misses << " cells=" << stats.cells;
+    if (i == 0) {
+      ASSERT_EQ(stats.misses, stats.cells);
+    } else {
+      ASSERT_TRUE(stats.hits > prev_hits);
+    }
+    prev_hits = stats.hits;
+
+    // the cached copy does not keep the children loaded through the cell handed out above
+    auto cached = cache->get(cell->get_hash().as_slice(), dboc->as_ext_cell_creator());
+    ASSERT_TRUE(cached.not_null());
+    ASSERT_TRUE(cached->size_refs() > 0);
+    for (unsigned j = 0; j < cached->size_refs(); j++) {
+      ASSERT_TRUE(!cached->get_ref(j)->is_loaded());
+    }
+  }
+}
+
 TEST(TonDb, DoNotMakeListsPrunned) {
   auto cell = vm::CellBuilder().store_bytes("abc").finalize();
   auto is_prunned = [&](const td::Ref<vm::Cell> &cell) { return true; };
@@ -2094,3 +2441,159 @@ TEST(Ref, AtomicRef) {
 ////LOG(ERROR) << "D";
 //vm::test_boc_deserializer<vm::StaticBagOfCellsDbLazy>({cell}, 31);
 //}
+
+struct TestCellHashInfo {
+  std::string hash;
+  td::uint64 value{0};
+  bool operator<(const TestCellHashInfo &other) const {
+    return hash < other.hash;
+  }
+  friend bool operator<(const TestCellHashInfo &info, td::Slice hash) {
+    return info.hash < hash;
+  }
+  friend bool operator<(td::Slice hash, const TestCellHashInfo &info) {
+    return hash < info.hash;
+  }
+};
+
+TEST(TonDb, CellHashTable) {
+  td::Random::Xorshift128plus rnd(123);
+  vm::CellHashTable<TestCellHashInfo> table;
+  std::map<std::string, td::uint64> expected;
+  std::vector<std::string> keys;
+  for (int i = 0; i < 2000; i++) {
+    std::string key(32, '\0');
+    for (auto &c : key) {
+      c = static_cast<char>(rnd() & 255);
+    }
+    // some keys share a long prefix
+    if (i % 7 == 0 && !keys.empty()) {
+      td::MutableSlice(key).copy_from(td::Slice(keys.back()).substr(0, 8));
+    }
+    keys.push_back(std::move(key));
+  }
+  std::vector<TestCellHashInfo *> pointers(keys.size(), nullptr);
+  for (int t = 0; t < 100000; t++) {
+    auto i = static_cast<size_t>(rnd() % keys.size());
+    auto &key = keys[i];
+    auto op = rnd() % 10;
+    if (op < 5) {
+      auto &info = table.apply(key, [&](TestCellHashInfo &info) {
+        info.hash = key;
+        info.value++;
+      });
+      expected[key]++;
+      if (pointers[i]) {
+        CHECK(pointers[i] == &info);
+      }
+      pointers[i] = &info;
+    } else if (op < 8) {
+      auto *info = table.get_if_exists(key);
+      auto it = expected.find(key);
+      if (it == expected.end()) {
+        CHECK(info == nullptr);
+      } else {
+        CHECK(info != nullptr && info->hash == key && info->value == it->second);
+        CHECK(info == pointers[i]);
+      }
+    } else if (op < 9) {
+      if (expected.erase(key)) {
+        table.erase(key);
+        pointers[i] = nullptr;
+      }
+    } else if (t % 1000 == 0) {
+      auto bad = rnd() % 4;
+      table.filter([&](const TestCellHashInfo &info) { return info.value % 4 != bad; });
+      for (auto it = expected.begin(); it != expected.end();) {
+        if (it->second % 4 == bad) {
+          pointers[std::find(keys.begin(), keys.end(), it->first) - keys.begin()] = nullptr;
+          it = expected.erase(it);
+        } else {
+          it++;
+        }
+      }
+    }
+    CHECK(table.size() == expected.size());
+  }
+  size_t cnt = 0;
+  table.for_each([&](const TestCellHashInfo &info) {
+    CHECK(expected.at(info.hash) == info.value);
+    cnt++;
+  });
+  CHECK(cnt == expected.size());
+}
+
+template <class TableT>
+class BenchCellHashTable : public td::Benchmark {
+ public:
+  BenchCellHashTable(std::string name, size_t n) : name_(std::move(name)), n_(n) {
+    // filled once: start_up() is called for every measurement
+    td::Random::Xorshift128plus rnd(123);
+    keys_.resize(n_);
+    for (auto &key : keys_) {
+      for (auto &c : key.as_slice()) {
+        c = static_cast<char>(rnd() & 255);
+      }
+    }
+    for (auto &key : keys_) {
+      table_.insert(key);
+    }
+    LOG(INFO) << name_ << ": " << static_cast<double>(table_.memory_usage()) / static_cast<double>(n_)
+              << " bytes per entry";
+  }
+  std::string get_description() const override {
+    return PSTRING() << "CellHashTable lookup: " << name_ << ", " << n_ << " cells";
+  }
+
+  void run(int n) override {
+    td::Random::Xorshift128plus rnd(321);
+    td::uint64 res = 0;
+    for (int i = 0; i < n; i++) {
+      res += table_.get(keys_[rnd() % n_]);
+    }
+    td::do_not_optimize_away(res);
+  }
+
+ private:
+  std::string name_;
+  size_t n_;
+  std::vector<vm::CellHash> keys_;
+  TableT table_;
+};
+
+struct BenchOpenAddressingTable {
+  vm::CellHashTable<TestCellHashInfo> table;
+  void insert(const vm::CellHash &key) {
+    table.apply(key.as_slice(), [&](TestCellHashInfo &info) { info.hash = key.as_slice().str(); });
+  }
+  td::uint64 get(const vm::CellHash &key) {
+    return table.get_if_exists(key.as_slice())->value;
+  }
+  size_t memory_usage() const {
+    // every TestCellHashInfo additionally owns a 32-byte string buffer
+    return table.memory_usage() + table.size() * 32;
+  }
+};
+
+struct BenchStdSetTable {
+  std::set<TestCellHashInfo, std::less<>> table;
+  void insert(const vm::CellHash &key) {
+    TestCellHashInfo info;
+    info.hash = key.as_slice().str();
+    table.insert(std::move(info));
+  }
+  td::uint64 get(const vm::CellHash &key) {
+    return table.find(key.as_slice())->value;
+  }
+  size_t memory_usage() const {
+    // red-black tree node: three pointers and a color, plus the same string buffer
+    return table.size() * (sizeof(TestCellHashInfo) + 4 * sizeof(void *) + 32);
+  }
+};
+
+TEST(TonDb, BenchCellHashTable) {
+  for (size_t n : {1 << 16, 1 << 21}) {
+    td::bench(BenchCellHashTable<BenchStdSetTable>("std::set", n));
+    td::bench(BenchCellHashTable<BenchOpenAddressingTable>("open addressing", n));
+  }
+}
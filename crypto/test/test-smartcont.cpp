@@ -17,6 +17,10 @@
     Copyright 2017-2020 Telegram Systems LLP
 */
 #include "vm/dict.h"
+#include "vm/cp0.h"
+#include "vm/opctable.h"
+#include "vm/cells/MerkleProof.h"
+#include "vm/cells/UsageCell.h"
 #include "common/bigint.hpp"
 
 #include "Ed25519.h"
@@ -24,6 +28,7 @@
 #include "block/block-auto.h"
 #include "block/block.h"
 #include "block/block-parse.h"
+#include "block/account-cache.h"
 
 #include "fift/Fift.h"
 #include "fift/words.h"
@@ -41,6 +46,7 @@
 #include "smc-envelope/PaymentChannel.h"
 
 #include "td/utils/base64.h"
+#include "td/utils/benchmark.h"
 #include "td/utils/crypto.h"
 #include "td/utils/Random.h"
 #include "td/utils/tests.h"
@@ -1663,3 +1669,345 @@ TEST(Smarcont, Channel) {
 #undef expect_ok
 #undef expect_code
 }
+
+std::vector<unsigned> collect_smartcont_opcodes(const vm::OpcodeTable* table) {
+  std::vector<unsigned> opcodes;
+  std::vector<td::Ref<vm::Cell>> queue;
+  std::set<vm::CellHash> visited;
+  for (auto type : {ton::SmartContractCode::WalletV3, ton::SmartContractCode::HighloadWalletV1,
+                    ton::SmartContractCode::HighloadWalletV2, ton::SmartContractCode::ManualDns,
+                    ton::SmartContractCode::Multisig, ton::SmartContractCode::PaymentChannel,
+                    ton::SmartContractCode::RestrictedWallet, ton::SmartContractCode::WalletV4}) {
+    queue.push_back(ton::SmartContractCode::get_code(type));
+  }
+  while (!queue.empty()) {
+    auto cell = std::move(queue.back());
+    queue.pop_back();
+    if (!visited.insert(cell->get_hash()).second) {
+      continue;
+    }
+    auto cs = vm::load_cell_slice(cell);
+    for (unsigned i = 0; i < cs.size_refs(); i++) {
+      queue.push_back(cs.prefetch_ref(i));
+    }
+    while (cs.size() > 0) {
+      unsigned bits = std::min(cs.size(), (unsigned)vm::max_opcode_bits);
+      opcodes.push_back((unsigned)cs.prefetch_ulong(bits) << (vm::max_opcode_bits - bits));
+      int len = table->instr_len(cs);
+      if (len <= 0 || !cs.advance_ext(len)) {
+        break;
+      }
+    }
+  }
+  return opcodes;
+}
+
+TEST(Smartcont, OpcodeTablePrefixLookup) {
+  vm::init_vm().ensure();
+  auto table = vm::init_op_cp0();
+  for (unsigned opcode = 0; opcode < vm::top_opcode; opcode++) {
+    CHECK(table->lookup_instr(opcode, vm::max_opcode_bits) ==
+          table->lookup_instr_bsearch(opcode, vm::max_opcode_bits));
+  }
+}
+
+class BenchOpcodeLookup : public td::Benchmark {
+ public:
+  BenchOpcodeLookup(bool use_prefix_table) : use_prefix_table_(use_prefix_table) {
+  }
+  std::string get_description() const override {
+    return PSTRING() << "opcode lookup in smartcont code (" << (use_prefix_table_ ? "prefix table" : "binary search")
+                     << ")";
+  }
+
+  void start_up() override {
+    vm::init_vm().ensure();
+    table_ = vm::init_op_cp0();
+    opcodes_ = collect_smartcont_opcodes(table_);
+    CHECK(!opcodes_.empty());
+  }
+
+  void run(int n) override {
+    td::uint64 res = 0;
+    for (int i = 0; i < n; i++) {
+      for (auto opcode : opcodes_) {
+        auto instr = use_prefix_table_ ? table_->lookup_instr(opcode, vm::max_opcode_bits)
+                                       : table_->lookup_instr_bsearch(opcode, vm::max_opcode_bits);
+        res += instr->get_opcode_min();
+      }
+    }
+    td::do_not_optimize_away(res);
+  }
+
+ private:
+  bool use_prefix_table_;
+  const vm::OpcodeTable* table_{nullptr};
+  std::vector<unsigned> opcodes_;
+};
+
+TEST(Smartcont, BenchOpcodeLookup) {
+  td::bench(BenchOpcodeLookup(false));
+  td::bench(BenchOpcodeLookup(true));
+}
+
+class BenchGetMethods : public td::Benchmark {
+ public:
+  explicit BenchGetMethods(bool use_pool) : use_pool_(use_pool) {
+  }
+  std::string get_description() const override {
+    return PSTRING() << "smartcont get-methods (" << (use_pool_ ? "with" : "without") << " CntPool)";
+  }
+
+  void start_up() override {
+    vm::init_vm().ensure();
+    auto key = td::Ed25519::generate_private_key().move_as_ok();
+    ton::WalletV3::InitData init_data;
+    init_data.public_key = key.get_public_key().move_as_ok().as_octet_string();
+    init_data.wallet_id = 239;
+    wallet_ = ton::WalletV3::create(init_data, 2);
+
+    dns_ = ton::ManualDns::create(ton::ManualDns::create_init_data_fast(key.get_public_key().move_as_ok(), 123), -1);
+    CHECK(dns_.write().send_external_message(dns_->create_init_query(key).move_as_ok()).code == 0);
+    for (int i = 0; i < 16; i++) {
+      auto name = PSTRING() << "a" << '\0' << "b" << i << '\0';
+      auto value = vm::CellBuilder().store_bytes(PSLICE() << "value " << i).finalize();
+      auto query = dns_->sign(key, dns_->prepare(dns_->create_set_value_unsigned(intToCat(1), name, value).move_as_ok(),
+                                                 i + 1)
+                                       .move_as_ok())
+                       .move_as_ok();
+      CHECK(dns_.write().send_external_message(query).code == 0);
+    }
+    td::CntPool::set_enabled(use_pool_);
+  }
+
+  void tear_down() override {
+    td::CntPool::set_enabled(false);
+  }
+
+  void run(int n) override {
+    for (int i = 0; i < n; i++) {
+      CHECK(wallet_->get_seqno().move_as_ok() == 0);
+      CHECK(wallet_->get_wallet_id().move_as_ok() == 239);
+      wallet_->get_public_key().ensure();
+      auto name = vm::CellBuilder().store_bytes(PSLICE() << "a" << '\0' << "b" << i % 16 << '\0').finalize();
+      auto res = dns_->run_get_method("dnsresolve", {vm::load_cell_slice_ref(name), td::make_refint(1)});
+      CHECK(res.code == 0);
+    }
+  }
+
+ private:
+  bool use_pool_;
+  td::Ref<ton::WalletV3> wallet_;
+  td::Ref<ton::ManualDns> dns_;
+};
+
+TEST(Smartcont, BenchGetMethodAllocations) {
+  // heap allocations of refcounted TVM objects per iteration, then the time of an iteration
+  for (bool use_pool : {false, true}) {
+    BenchGetMethods bench(use_pool);
+    bench.start_up();
+    auto before = td::CntPool::get_stats();
+    const int n = 1000;
+    bench.run(n);
+    auto after = td::CntPool::get_stats();
+    bench.tear_down();
+    LOG(ERROR) << bench.get_description() << ": " << (after.heap_allocations - before.heap_allocations) / n
+               << " heap allocations and " << (after.reused - before.reused) / n << " reused blocks per iteration";
+    td::bench(BenchGetMethods(use_pool));
+  }
+}
+
+namespace {
+struct TestAccount {
+  ton::StdSmcAddress addr;  // key in the dictionary, i.e. the rewritten address
+  int state{block::Account::acc_active};
+  int split_depth{0};
+  bool ticktock{false};
+  bool due_payment{false};
+  td::Ref<vm::Cell> code, data, library;
+  ton::LogicalTime last_trans_lt{0};
+};
+
+td::Ref<vm::Cell> pack_test_account(const TestAccount& acc) {
+  // the original address differs from the key in the first split_depth bits
+  ton::StdSmcAddress addr_orig = acc.addr;
+  for (int i = 0; i < acc.split_depth; i++) {
+    addr_orig.bits()[i] = !addr_orig.bits()[i];
+  }
+  vm::CellBuilder cb;
+  CHECK(cb.store_long_bool(1, 1)       // account$1
+        && cb.store_long_bool(2, 2));  // addr_std$10
+  if (acc.split_depth) {
+    CHECK(cb.store_long_bool(1, 1) && cb.store_long_bool(acc.split_depth, 5) &&
+          cb.store_bits_bool(acc.addr.cbits(), acc.split_depth));
+  } else {
+    CHECK(cb.store_long_bool(0, 1));
+  }
+  CHECK(cb.store_long_bool(0, 8) && cb.store_bits_bool(addr_orig));
+  CHECK(block::tlb::t_VarUInteger_7.store_long(cb, 3) && block::tlb::t_VarUInteger_7.store_long(cb, 1000) &&
+        block::tlb::t_VarUInteger_7.store_long(cb, 0) && cb.store_long_bool(1000, 32));
+  if (acc.due_payment) {
+    CHECK(cb.store_long_bool(1, 1) && block::tlb::t_Grams.store_long(cb, 12345));
+  } else {
+    CHECK(cb.store_long_bool(0, 1));
+  }
+  CHECK(cb.store_long_bool(acc.last_trans_lt + 1, 64) && block::CurrencyCollection(1000000000).store(cb));
+  switch (acc.state) {
+    case block::Account::acc_uninit:
+      CHECK(cb.store_long_bool(0, 2));
+      break;
+    case block::Account::acc_frozen:
+      CHECK(cb.store_long_bool(1, 2) && cb.store_bits_bool(td::Bits256::zero()));
+      break;
+    default:
+      CHECK(cb.store_long_bool(1, 1));
+      if (acc.split_depth) {
+        CHECK(cb.store_long_bool(1, 1) && cb.store_long_bool(acc.split_depth, 5));
+      } else {
+        CHECK(cb.store_long_bool(0, 1));
+      }
+      if (acc.ticktock) {
+        CHECK(cb.store_long_bool(1, 1) && cb.store_long_bool(2, 2));
+      } else {
+        CHECK(cb.store_long_bool(0, 1));
+      }
+      CHECK(cb.store_maybe_ref(acc.code) && cb.store_maybe_ref(acc.data) && cb.store_maybe_ref(acc.library));
+  }
+  return cb.finalize();
+}
+
+// ShardAccounts-like dictionary of the accounts, other_key makes the root different for each state
+td::Ref<vm::Cell> pack_test_state(const std::vector<TestAccount>& accounts,
+                                  const std::vector<td::Ref<vm::Cell>>& account_cells, int other_key) {
+  vm::Dictionary dict{256};
+  for (size_t i = 0; i < accounts.size(); i++) {
+    vm::CellBuilder cb;
+    CHECK(cb.store_ref_bool(account_cells[i]) && cb.store_bits_bool(td::Bits256::zero()) &&
+          cb.store_long_bool(accounts[i].last_trans_lt, 64));
+    CHECK(dict.set_builder(accounts[i].addr.cbits(), 256, cb));
+  }
+  ton::StdSmcAddress other;
+  other.set_ones();
+  other.bits()[255] = other_key & 1;
+  CHECK(dict.set_builder(other.cbits(), 256, vm::CellBuilder().store_long(other_key, 32)));
+  return dict.get_root_cell();
+}
+
+void check_same_account(const block::Account& a, const block::Account& b) {
+  auto same_cs = [](const td::Ref<vm::CellSlice>& x, const td::Ref<vm::CellSlice>& y) {
+    return x.is_null() ? y.is_null() : y.not_null() && x->contents_equal(*y);
+  };
+  auto same_cell = [](const td::Ref<vm::Cell>& x, const td::Ref<vm::Cell>& y) {
+    return x.is_null() ? y.is_null() : y.not_null() && x->get_hash() == y->get_hash();
+  };
+  ASSERT_EQ(a.status, b.status);
+  ASSERT_EQ(a.orig_status, b.orig_status);
+  ASSERT_EQ(a.is_special, b.is_special);
+  ASSERT_EQ(a.tick, b.tick);
+  ASSERT_EQ(a.tock, b.tock);
+  ASSERT_EQ(a.split_depth_set_, b.split_depth_set_);
+  ASSERT_EQ(a.split_depth_, b.split_depth_);
+  ASSERT_EQ(a.now_, b.now_);
+  ASSERT_EQ(a.workchain, b.workchain);
+  CHECK(a.addr_rewrite == b.addr_rewrite);
+  CHECK(a.addr == b.addr);
+  CHECK(a.addr_orig == b.addr_orig);
+  CHECK(same_cs(a.my_addr, b.my_addr));
+  CHECK(same_cs(a.my_addr_exact, b.my_addr_exact));
+  ASSERT_EQ(a.last_trans_end_lt_, b.last_trans_end_lt_);
+  ASSERT_EQ(a.last_trans_lt_, b.last_trans_lt_);
+  CHECK(a.last_trans_hash_ == b.last_trans_hash_);
+  ASSERT_EQ(a.last_paid, b.last_paid);
+  ASSERT_EQ(a.storage_stat.cells, b.storage_stat.cells);
+  ASSERT_EQ(a.storage_stat.bits, b.storage_stat.bits);
+  ASSERT_EQ(a.storage_stat.public_cells, b.storage_stat.public_cells);
+  CHECK(a.balance == b.balance);
+  CHECK(td::cmp(a.due_payment, b.due_payment) == 0);
+  CHECK(same_cell(a.orig_total_state, b.orig_total_state));
+  CHECK(same_cell(a.total_state, b.total_state));
+  CHECK(same_cs(a.storage, b.storage));
+  CHECK(same_cs(a.inner_state, b.inner_state));
+  CHECK(a.state_hash == b.state_hash);
+  CHECK(same_cell(a.code, b.code));
+  CHECK(same_cell(a.data, b.data));
+  CHECK(same_cell(a.library, b.library));
+  CHECK(same_cell(a.orig_library, b.orig_library));
+  CHECK(a.transactions.empty() && b.transactions.empty());
+}
+}  // namespace
+
+TEST(Smartcont, AccountCache) {
+  td::Random::Xorshift128plus rnd(123);
+  auto random_cell = [&] { return vm::CellBuilder().store_long(rnd(), 64).finalize(); };
+  std::vector<TestAccount> accounts;
+  auto add_account = [&](int state) -> TestAccount& {
+    accounts.emplace_back();
+    auto& acc = accounts.back();
+    acc.addr.as_slice().copy_from(td::Slice(td::sha256(PSLICE() << "account " << accounts.size())));
+    acc.state = state;
+    acc.last_trans_lt = 1000 + accounts.size();
+    return acc;
+  };
+  add_account(block::Account::acc_active).code = random_cell();
+  add_account(block::Account::acc_active).data = random_cell();
+  {
+    auto& acc = add_account(block::Account::acc_active);
+    acc.code = random_cell();
+    acc.data = random_cell();
+    acc.library = random_cell();
+    acc.ticktock = true;
+    acc.due_payment = true;
+  }
+  {
+    auto& acc = add_account(block::Account::acc_active);
+    acc.code = random_cell();
+    acc.data = random_cell();
+    acc.split_depth = 5;
+  }
+  add_account(block::Account::acc_frozen).due_payment = true;
+  add_account(block::Account::acc_uninit);
+  add_account(block::Account::acc_uninit).split_depth = 3;
+  // equal code and data references cannot be told apart, such accounts are unpacked every time
+  {
+    auto& acc = add_account(block::Account::acc_active);
+    acc.code = acc.data = random_cell();
+  }
+  const size_t cacheable = accounts.size() - 1;
+
+  std::vector<td::Ref<vm::Cell>> account_cells;
+  for (auto& acc : accounts) {
+    account_cells.push_back(pack_test_account(acc));
+  }
+  auto state1 = pack_test_state(accounts, account_cells, 1);
+  auto state2 = pack_test_state(accounts, account_cells, 2);
+  CHECK(state1->get_hash() != state2->get_hash());
+
+  block::AccountCache cache;
+  for (auto& acc : accounts) {
+    block::Account account{0, acc.addr.cbits()};
+    CHECK(cache.unpack(account, vm::Dictionary{state1, 256}.lookup(acc.addr.cbits(), 256), 100, false));
+  }
+  ASSERT_EQ(cacheable, cache.size());
+  ASSERT_EQ(0u, cache.get_stats().hits);
+
+  // the cached accounts, unpacked in the next state, must be the same as freshly unpacked ones and touch the same
+  // cells of this state
+  for (auto& acc : accounts) {
+    for (bool special : {false, true}) {
+      auto unpack = [&](bool use_cache, block::Account& account) {
+        auto usage_tree = std::make_shared<vm::CellUsageTree>();
+        auto root = vm::UsageCell::create(state2, usage_tree->root_ptr());
+        auto shard_account = vm::Dictionary{root, 256}.lookup(acc.addr.cbits(), 256);
+        CHECK(use_cache ? cache.unpack(account, shard_account, 200, special)
+                        : account.unpack(shard_account, 200, special));
+        return vm::MerkleProof::generate(state2, usage_tree.get());
+      };
+      block::Account fresh{0, acc.addr.cbits()}, cached{0, acc.addr.cbits()};
+      auto fresh_proof = unpack(false, fresh);
+      auto cached_proof = unpack(true, cached);
+      check_same_account(fresh, cached);
+      CHECK(fresh_proof->get_hash() == cached_proof->get_hash());
+    }
+  }
+  ASSERT_EQ(2 * cacheable, cache.get_stats().hits);
+}
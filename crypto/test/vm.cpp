@@ -21,12 +21,18 @@
 #include "vm/dict.h"
 #include "fift/utils.h"
 #include "common/bigint.hpp"
+#include "common/refint.h"
 
 #include "td/utils/base64.h"
+#include "td/utils/Random.h"
 #include "td/utils/tests.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/StringBuilder.h"
 
+#include <limits>
+#include <map>
+#include <sstream>
+
 std::string run_vm(td::Ref<vm::Cell> cell) {
   vm::init_vm().ensure();
   vm::DictionaryBase::get_empty_dictionary();
@@ -207,6 +213,162 @@ TEST(VM, bigint) {
   REGRESSION_VERIFY(sb.as_cslice());
 }
 
+TEST(VM, small_int_fast_path) {
+  vm::init_vm().ensure();
+  // integers pushed by push_smallint() are kept inline and handled by the fast paths of arithmetic instructions,
+  // while those pushed by push_int() go through RefInt256: results and gas usage must be the same
+  auto run = [](td::Ref<vm::Cell> code, std::vector<long long> args, bool small) {
+    auto stack = td::make_ref<vm::Stack>();
+    for (auto x : args) {
+      if (small) {
+        stack.write().push_smallint(x);
+      } else {
+        stack.write().push_int(td::make_refint(x));
+      }
+    }
+    vm::GasLimits gas_limit(1000, 1000);
+    vm::VmState vm{vm::load_cell_slice_ref(std::move(code)), std::move(stack), gas_limit};
+    int exit_code = vm.run();
+    std::ostringstream os;
+    os << exit_code << " " << vm.gas_consumed() << " ";
+    vm.get_stack().dump(os, 0);
+    return os.str();
+  };
+  std::vector<long long> numbers{0,
+                                 1,
+                                 -1,
+                                 7,
+                                 (1LL << 31) - 1,
+                                 -(1LL << 31),
+                                 1LL << 31,
+                                 vm::StackEntry::small_int_max,
+                                 vm::StackEntry::small_int_min,
+                                 vm::StackEntry::small_int_max + 1,
+                                 vm::StackEntry::small_int_min - 1,
+                                 std::numeric_limits<long long>::max(),
+                                 std::numeric_limits<long long>::min()};
+  std::vector<std::string> unary_ops{"NEGATE", "INC", "DEC", "127 ADDCONST", "-128 MULCONST", "NOT", "ABS", "SGN",
+                                     "QINC", "-5 GTINT", "0 EQINT", "IF:<{ 1 INT }>ELSE<{ 2 INT }>"};
+  for (auto &op : unary_ops) {
+    auto code = fift::compile_asm(" " + op + " ").move_as_ok();
+    for (auto x : numbers) {
+      ASSERT_EQ(run(code, {x}, false), run(code, {x}, true));
+    }
+  }
+  std::vector<std::string> binary_ops{"ADD", "SUB", "SUBR", "MUL", "AND", "OR", "XOR", "MIN", "MAX", "MINMAX",
+                                      "LESS", "EQUAL", "CMP", "QADD", "QMUL", "DIV", "PICK", "ROLLX"};
+  for (auto &op : binary_ops) {
+    auto code = fift::compile_asm(" " + op + " ").move_as_ok();
+    for (auto x : numbers) {
+      for (auto y : numbers) {
+        ASSERT_EQ(run(code, {x, y}, false), run(code, {x, y}, true));
+      }
+    }
+  }
+}
+
+namespace {
+class SumAugmentation : public vm::AugmentationData {
+ public:
+  bool skip_extra(vm::CellSlice &cs) const override {
+    return cs.advance(32);
+  }
+  bool eval_leaf(vm::CellBuilder &cb, vm::CellSlice &val_cs) const override {
+    return cb.store_long_bool(val_cs.prefetch_ulong(32), 32);
+  }
+  bool eval_fork(vm::CellBuilder &cb, vm::CellSlice &left_cs, vm::CellSlice &right_cs) const override {
+    return cb.store_long_bool((left_cs.prefetch_ulong(32) + right_cs.prefetch_ulong(32)) & 0xffffffff, 32);
+  }
+  bool eval_empty(vm::CellBuilder &cb) const override {
+    return cb.store_long_bool(0, 32);
+  }
+};
+
+// build_from_sorted() and apply_updates() must produce exactly the same cells as the same changes done one by one
+template <class F>
+void check_dict_sorted_updates(F make_dict, int n, int size, td::Random::Xorshift128plus &rnd) {
+  using Update = vm::DictionaryFixed::Update;
+  auto mask = n == 64 ? ~0ULL : (1ULL << n) - 1;
+  auto make_key = [&](unsigned long long x) {
+    td::BitArray<64> key;
+    key.bits().store_uint(x, n);
+    return key;
+  };
+  auto make_value = [&] {
+    return vm::load_cell_slice_ref(vm::CellBuilder().store_long(rnd() & 0xffffffff, 32).finalize());
+  };
+  auto same_root = [](const vm::DictionaryFixed &a, const vm::DictionaryFixed &b) {
+    auto x = a.get_root_cell(), y = b.get_root_cell();
+    return x.is_null() ? y.is_null() : y.not_null() && x->get_hash() == y->get_hash();
+  };
+  // the maps keep the key bits referenced by updates
+  std::map<unsigned long long, td::BitArray<64>> keys;
+  while ((int)keys.size() < size) {
+    auto x = rnd() & mask;
+    keys.emplace(x, make_key(x));
+  }
+  auto dict = make_dict();
+  auto bulk = make_dict();
+  std::vector<Update> items;
+  for (auto &p : keys) {
+    auto value = make_value();
+    CHECK(dict.set(p.second.bits(), n, value, vm::Dictionary::SetMode::Add));
+    items.push_back(Update{p.second.bits(), value});
+  }
+  CHECK(bulk.build_from_sorted(items));
+  CHECK(same_root(dict, bulk));
+
+  std::map<unsigned long long, td::BitArray<64>> touched;
+  for (int i = 0; i <= size / 2; i++) {
+    auto x = rnd() & mask;
+    touched.emplace(x, make_key(x));
+  }
+  std::vector<Update> updates;
+  for (auto &p : touched) {
+    bool exists = keys.count(p.first) > 0;
+    if (exists && rnd() % 2) {
+      CHECK(dict.lookup_delete(p.second.bits(), n).not_null());
+      updates.push_back(Update{p.second.bits(), {}});
+      keys.erase(p.first);
+    } else {
+      auto value = make_value();
+      auto mode = exists ? vm::Dictionary::SetMode::Replace : vm::Dictionary::SetMode::Add;
+      CHECK(dict.set(p.second.bits(), n, value, mode));
+      updates.push_back(Update{p.second.bits(), value, mode});
+      keys.emplace(p.first, p.second);
+    }
+  }
+  CHECK(bulk.apply_updates(updates));
+  CHECK(same_root(dict, bulk));
+
+  if (!keys.empty()) {
+    // updates that are not sorted or not allowed by their mode are rejected and leave the dictionary unchanged
+    auto &p = *keys.begin();
+    CHECK(!bulk.apply_updates({Update{p.second.bits(), make_value(), vm::Dictionary::SetMode::Add}}));
+    CHECK(same_root(dict, bulk));
+    CHECK(!bulk.apply_updates({Update{p.second.bits(), {}}, Update{p.second.bits(), {}}}));
+    CHECK(same_root(dict, bulk));
+  }
+  std::vector<Update> deletions;
+  for (auto &p : keys) {
+    deletions.push_back(Update{p.second.bits(), {}});
+  }
+  CHECK(bulk.apply_updates(deletions));
+  CHECK(bulk.is_empty());
+}
+}  // namespace
+
+TEST(VM, dict_sorted_updates) {
+  td::Random::Xorshift128plus rnd(123);
+  SumAugmentation aug;
+  for (int n : {8, 20, 64}) {
+    for (int size : {0, 1, 2, 3, 10, 100, 200}) {
+      check_dict_sorted_updates([&] { return vm::Dictionary{n}; }, n, size, rnd);
+      check_dict_sorted_updates([&] { return vm::AugmentedDictionary{n, aug}; }, n, size, rnd);
+    }
+  }
+}
+
 TEST(VM, report3_1) {
   //WA: expect (1, 2, 6, 3)
   td::Slice test1 =
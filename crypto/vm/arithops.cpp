@@ -16,7 +16,9 @@
 
     Copyright 2017-2020 Telegram Systems LLP
 */
+#include <algorithm>
 #include <functional>
+#include <limits>
 #include "vm/arithops.h"
 #include "vm/log.h"
 #include "vm/opctable.h"
@@ -159,10 +161,21 @@ void register_int_const_ops(OpcodeTable& cp0) {
       .insert(OpcodeInstr::mkfixed(0x85, 8, 8, instr::dump_1c_l_add(1, "PUSHNEGPOW2 "), exec_push_negpow2));
 }
 
+// Integers kept inline in StackEntry are at most 63 bits wide, so their sums and differences, as well as products of
+// 32-bit values, are computed in long long without overflow; set_small_int() promotes results that do not fit back.
+static bool fits_int32(long long x) {
+  return x >= std::numeric_limits<td::int32>::min() && x <= std::numeric_limits<td::int32>::max();
+}
+
 int exec_add(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute ADD";
   stack.check_underflow(2);
+  if (stack.top_small_ints(2)) {
+    long long y = stack.pop_long();
+    stack.tos().set_small_int(stack.tos().small_int_value() + y);
+    return 0;
+  }
   auto y = stack.pop_int();
   stack.push_int_quiet(stack.pop_int() + std::move(y), quiet);
   return 0;
@@ -172,6 +185,11 @@ int exec_sub(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute SUB";
   stack.check_underflow(2);
+  if (stack.top_small_ints(2)) {
+    long long y = stack.pop_long();
+    stack.tos().set_small_int(stack.tos().small_int_value() - y);
+    return 0;
+  }
   auto y = stack.pop_int();
   stack.push_int_quiet(stack.pop_int() - std::move(y), quiet);
   return 0;
@@ -181,6 +199,11 @@ int exec_subr(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute SUBR";
   stack.check_underflow(2);
+  if (stack.top_small_ints(2)) {
+    long long y = stack.pop_long();
+    stack.tos().set_small_int(y - stack.tos().small_int_value());
+    return 0;
+  }
   auto y = stack.pop_int();
   stack.push_int_quiet(std::move(y) - stack.pop_int(), quiet);
   return 0;
@@ -190,6 +213,10 @@ int exec_negate(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute NEGATE";
   stack.check_underflow(1);
+  if (stack.top_small_ints(1)) {
+    stack.tos().set_small_int(-stack.tos().small_int_value());
+    return 0;
+  }
   stack.push_int_quiet(-stack.pop_int(), quiet);
   return 0;
 }
@@ -198,6 +225,10 @@ int exec_inc(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute INC";
   stack.check_underflow(1);
+  if (stack.top_small_ints(1)) {
+    stack.tos().set_small_int(stack.tos().small_int_value() + 1);
+    return 0;
+  }
   stack.push_int_quiet(stack.pop_int() + 1, quiet);
   return 0;
 }
@@ -206,6 +237,10 @@ int exec_dec(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute DEC";
   stack.check_underflow(1);
+  if (stack.top_small_ints(1)) {
+    stack.tos().set_small_int(stack.tos().small_int_value() - 1);
+    return 0;
+  }
   stack.push_int_quiet(stack.pop_int() - 1, quiet);
   return 0;
 }
@@ -215,6 +250,10 @@ int exec_add_tinyint8(VmState* st, unsigned args, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute ADDINT " << x;
   stack.check_underflow(1);
+  if (stack.top_small_ints(1)) {
+    stack.tos().set_small_int(stack.tos().small_int_value() + x);
+    return 0;
+  }
   stack.push_int_quiet(stack.pop_int() + x, quiet);
   return 0;
 }
@@ -224,6 +263,10 @@ int exec_mul_tinyint8(VmState* st, unsigned args, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute MULINT " << x;
   stack.check_underflow(1);
+  if (stack.top_small_ints(1) && fits_int32(stack.tos().small_int_value())) {
+    stack.tos().set_small_int(stack.tos().small_int_value() * x);
+    return 0;
+  }
   stack.push_int_quiet(stack.pop_int() * x, quiet);
   return 0;
 }
@@ -232,6 +275,11 @@ int exec_mul(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute MUL";
   stack.check_underflow(2);
+  if (stack.top_small_ints(2) && fits_int32(stack[0].small_int_value()) && fits_int32(stack[1].small_int_value())) {
+    long long y = stack.pop_long();
+    stack.tos().set_small_int(stack.tos().small_int_value() * y);
+    return 0;
+  }
   auto y = stack.pop_int();
   stack.push_int_quiet(stack.pop_int() * std::move(y), quiet);
   return 0;
@@ -770,6 +818,11 @@ int exec_and(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute AND";
   stack.check_underflow(2);
+  if (stack.top_small_ints(2)) {
+    long long y = stack.pop_long();
+    stack.tos().set_small_int(stack.tos().small_int_value() & y);
+    return 0;
+  }
   auto y = stack.pop_int();
   stack.push_int_quiet(stack.pop_int() & std::move(y), quiet);
   return 0;
@@ -779,6 +832,11 @@ int exec_or(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute OR";
   stack.check_underflow(2);
+  if (stack.top_small_ints(2)) {
+    long long y = stack.pop_long();
+    stack.tos().set_small_int(stack.tos().small_int_value() | y);
+    return 0;
+  }
   auto y = stack.pop_int();
   stack.push_int_quiet(stack.pop_int() | std::move(y), quiet);
   return 0;
@@ -788,6 +846,11 @@ int exec_xor(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute XOR";
   stack.check_underflow(2);
+  if (stack.top_small_ints(2)) {
+    long long y = stack.pop_long();
+    stack.tos().set_small_int(stack.tos().small_int_value() ^ y);
+    return 0;
+  }
   auto y = stack.pop_int();
   stack.push_int_quiet(stack.pop_int() ^ std::move(y), quiet);
   return 0;
@@ -797,6 +860,10 @@ int exec_not(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute NOT";
   stack.check_underflow(1);
+  if (stack.top_small_ints(1)) {
+    stack.tos().set_small_int(~stack.tos().small_int_value());
+    return 0;
+  }
   stack.push_int_quiet(~stack.pop_int(), quiet);
   return 0;
 }
@@ -915,6 +982,17 @@ int exec_minmax(VmState* st, int mode) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute " << (mode & 1 ? "Q" : "") << (mode & 2 ? "MIN" : "") << (mode & 4 ? "MAX" : "");
   stack.check_underflow(2);
+  if (stack.top_small_ints(2)) {
+    long long x = stack.pop_long();
+    long long y = stack.pop_long();
+    if (mode & 2) {
+      stack.push_smallint(std::min(x, y));
+    }
+    if (mode & 4) {
+      stack.push_smallint(std::max(x, y));
+    }
+    return 0;
+  }
   auto x = stack.pop_int();
   auto y = stack.pop_int();
   if (!x->is_valid()) {
@@ -937,6 +1015,11 @@ int exec_abs(VmState* st, bool quiet) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute " << (quiet ? "QABS" : "ABS");
   stack.check_underflow(1);
+  if (stack.top_small_ints(1)) {
+    long long x = stack.tos().small_int_value();
+    stack.tos().set_small_int(x < 0 ? -x : x);
+    return 0;
+  }
   auto x = stack.pop_int();
   if (x->is_valid() && x->sgn() < 0) {
     stack.push_int_quiet(-std::move(x), quiet);
@@ -962,6 +1045,12 @@ int exec_sgn(VmState* st, int mode, bool quiet, const char* name) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute " << name;
   stack.check_underflow(1);
+  if (stack.top_small_ints(1)) {
+    long long x = stack.tos().small_int_value();
+    int y = (x > 0) - (x < 0);
+    stack.tos().set_small_int(((mode >> (4 + y * 4)) & 15) - 8);
+    return 0;
+  }
   auto x = stack.pop_int();
   if (!x->is_valid()) {
     stack.push_int_quiet(std::move(x), quiet);
@@ -976,6 +1065,13 @@ int exec_cmp(VmState* st, int mode, bool quiet, const char* name) {
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute " << name;
   stack.check_underflow(2);
+  if (stack.top_small_ints(2)) {
+    long long y = stack.pop_long();
+    long long x = stack.tos().small_int_value();
+    int z = (x > y) - (x < y);
+    stack.tos().set_small_int(((mode >> (4 + z * 4)) & 15) - 8);
+    return 0;
+  }
   auto y = stack.pop_int();
   auto x = stack.pop_int();
   if (!x->is_valid() || !y->is_valid()) {
@@ -994,6 +1090,12 @@ int exec_cmp_int(VmState* st, unsigned args, int mode, bool quiet, const char* n
   Stack& stack = st->get_stack();
   VM_LOG(st) << "execute " << name << "INT " << y;
   stack.check_underflow(1);
+  if (stack.top_small_ints(1)) {
+    long long x = stack.tos().small_int_value();
+    int z = (x > y) - (x < y);
+    stack.tos().set_small_int(((mode >> (4 + z * 4)) & 15) - 8);
+    return 0;
+  }
   auto x = stack.pop_int();
   if (!x->is_valid()) {
     stack.push_int_quiet(std::move(x), quiet);
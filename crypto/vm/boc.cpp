@@ -28,6 +28,9 @@
 #include "td/utils/format.h"
 #include "td/utils/misc.h"
 #include "td/utils/Slice-decl.h"
+#include "td/utils/port/thread.h"
+
+#include <atomic>
 
 namespace vm {
 using td::Ref;
@@ -738,6 +741,131 @@ td::Result<td::Slice> BagOfCells::get_cell_slice(int idx, td::Slice data) {
   return data.substr(offs, td::narrow_cast<size_t>(offs_end - offs));
 }
 
+td::Status BagOfCells::deserialize_cells_parallel(td::Slice cells_slice, std::vector<Ref<DataCell>>& cell_list,
+                                                  std::vector<td::uint8>* cell_should_cache, int threads) {
+  // a broken bag of cells is deserialized again sequentially, so that the error is exactly the one reported
+  // by the sequential path (the first failing cell in its order, with the same text)
+  std::vector<td::uint8> initial_should_cache;
+  if (cell_should_cache) {
+    initial_should_cache = *cell_should_cache;
+  }
+  auto sequential_error = [&] {
+    if (cell_should_cache) {
+      *cell_should_cache = std::move(initial_should_cache);
+    }
+    auto status = deserialize_cells(cells_slice, cell_list, cell_should_cache);
+    LOG_CHECK(status.is_error()) << "parallel deserialization failed, while the sequential one succeeded";
+    return status;
+  };
+
+  // first pass: validate references, update cache bits and compute the height of every cell,
+  // i.e. the length of the longest path to a leaf
+  std::vector<td::uint32> height(cell_count, 0);
+  td::uint32 max_height = 0;
+  for (int idx = cell_count - 1; idx >= 0; idx--) {
+    auto r_cell_slice = get_cell_slice(idx, cells_slice);
+    CellSerializationInfo cell_info;
+    if (r_cell_slice.is_error() || cell_info.init(r_cell_slice.ok(), info.ref_byte_size).is_error()) {
+      return sequential_error();
+    }
+    auto cell_slice = r_cell_slice.move_as_ok();
+    for (int k = 0; k < cell_info.refs_cnt; k++) {
+      int ref_idx = (int)info.read_ref(cell_slice.ubegin() + cell_info.refs_offset + k * info.ref_byte_size);
+      if (ref_idx <= idx || ref_idx >= cell_count) {
+        return sequential_error();
+      }
+      height[idx] = std::max(height[idx], height[ref_idx] + 1);
+      if (cell_should_cache) {
+        auto& cnt = (*cell_should_cache)[ref_idx];
+        if (cnt < 2) {
+          cnt++;
+        }
+      }
+    }
+    max_height = std::max(max_height, height[idx]);
+  }
+
+  // group cells by height; all children of a cell have smaller height
+  std::vector<int> level_begin(max_height + 2, 0);
+  for (auto h : height) {
+    level_begin[h + 1]++;
+  }
+  for (td::uint32 h = 0; h <= max_height; h++) {
+    level_begin[h + 1] += level_begin[h];
+  }
+  std::vector<int> order(cell_count);
+  {
+    auto pos = level_begin;
+    for (int idx = cell_count - 1; idx >= 0; idx--) {
+      order[pos[height[idx]]++] = idx;
+    }
+  }
+
+  cell_list.clear();
+  cell_list.resize(cell_count);
+  std::atomic<bool> failed{false};
+  auto create_cells = [&](td::Span<int> idxs, std::atomic<size_t>& next) {
+    const size_t chunk = 256;
+    while (true) {
+      auto from = next.fetch_add(chunk, std::memory_order_relaxed);
+      if (from >= idxs.size()) {
+        break;
+      }
+      auto to = std::min(from + chunk, idxs.size());
+      for (auto i = from; i < to; i++) {
+        int idx = idxs[i];
+        auto r_cell = deserialize_cell(idx, cells_slice, cell_list, nullptr);
+        if (r_cell.is_error()) {
+          failed.store(true, std::memory_order_relaxed);
+          continue;
+        }
+        cell_list[cell_count - 1 - idx] = r_cell.move_as_ok();
+      }
+    }
+  };
+  for (td::uint32 h = 0; h <= max_height; h++) {
+    auto idxs = td::Span<int>(order).substr(level_begin[h], level_begin[h + 1] - level_begin[h]);
+    std::atomic<size_t> next{0};
+#if !TD_THREAD_UNSUPPORTED
+    if (idxs.size() >= parallel_min_level_cells) {
+      std::vector<td::thread> workers;
+      for (int i = 1; i < threads; i++) {
+        workers.emplace_back([&] { create_cells(idxs, next); });
+      }
+      create_cells(idxs, next);
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    } else
+#endif
+    {
+      create_cells(idxs, next);
+    }
+    if (failed.load(std::memory_order_relaxed)) {
+      return sequential_error();
+    }
+  }
+  return td::Status::OK();
+}
+
+td::Status BagOfCells::deserialize_cells(td::Slice cells_slice, std::vector<Ref<DataCell>>& cell_list,
+                                         std::vector<td::uint8>* cell_should_cache) {
+  cell_list.clear();
+  cell_list.reserve(cell_count);
+  for (int i = 0; i < cell_count; i++) {
+    // reconstruct cell with index cell_count - 1 - i
+    int idx = cell_count - 1 - i;
+    auto r_cell = deserialize_cell(idx, cells_slice, cell_list, cell_should_cache);
+    if (r_cell.is_error()) {
+      return td::Status::Error(PSLICE() << "invalid bag-of-cells failed to deserialize cell #" << idx << " "
+                                        << r_cell.error());
+    }
+    cell_list.push_back(r_cell.move_as_ok());
+    DCHECK(cell_list.back().not_null());
+  }
+  return td::Status::OK();
+}
+
 td::Result<td::Ref<vm::DataCell>> BagOfCells::deserialize_cell(int idx, td::Slice cells_slice,
                                                                td::Span<td::Ref<DataCell>> cells_span,
                                                                std::vector<td::uint8>* cell_should_cache) {
@@ -774,7 +902,7 @@ td::Result<td::Ref<vm::DataCell>> BagOfCells::deserialize_cell(int idx, td::Slic
   return cell_info.create_data_cell(cell_slice, refs);
 }
 
-td::Result<long long> BagOfCells::deserialize(const td::Slice& data, int max_roots) {
+td::Result<long long> BagOfCells::deserialize(const td::Slice& data, int max_roots, int threads) {
   clear();
   long long size_est = info.parse_serialized_header(data);
   //LOG(INFO) << "estimated size " << size_est << ", true size " << data.size();
@@ -857,18 +985,11 @@ td::Result<long long> BagOfCells::deserialize(const td::Slice& data, int max_roo
   }
   auto cells_slice = data.substr(info.data_offset, info.data_size);
   std::vector<Ref<DataCell>> cell_list;
-  cell_list.reserve(cell_count);
-  std::array<td::Ref<Cell>, 4> refs_buf;
-  for (int i = 0; i < cell_count; i++) {
-    // reconstruct cell with index cell_count - 1 - i
-    int idx = cell_count - 1 - i;
-    auto r_cell = deserialize_cell(idx, cells_slice, cell_list, info.has_cache_bits ? &cell_should_cache : nullptr);
-    if (r_cell.is_error()) {
-      return td::Status::Error(PSLICE() << "invalid bag-of-cells failed to deserialize cell #" << idx << " "
-                                        << r_cell.error());
-    }
-    cell_list.push_back(r_cell.move_as_ok());
-    DCHECK(cell_list.back().not_null());
+  if (threads > 1 && cell_count >= parallel_min_cells) {
+    TRY_STATUS(deserialize_cells_parallel(cells_slice, cell_list, info.has_cache_bits ? &cell_should_cache : nullptr,
+                                          threads));
+  } else {
+    TRY_STATUS(deserialize_cells(cells_slice, cell_list, info.has_cache_bits ? &cell_should_cache : nullptr));
   }
   if (info.has_cache_bits) {
     for (int idx = 0; idx < cell_count; idx++) {
@@ -930,12 +1051,12 @@ unsigned long long BagOfCells::get_idx_entry_raw(int index) {
  * 
  */
 
-td::Result<Ref<Cell>> std_boc_deserialize(td::Slice data, bool can_be_empty, bool allow_nonzero_level) {
+td::Result<Ref<Cell>> std_boc_deserialize(td::Slice data, bool can_be_empty, bool allow_nonzero_level, int threads) {
   if (data.empty() && can_be_empty) {
     return Ref<Cell>();
   }
   BagOfCells boc;
-  auto res = boc.deserialize(data, 1);
+  auto res = boc.deserialize(data, 1, threads);
   if (res.is_error()) {
     return res.move_as_error();
   }
@@ -190,6 +190,7 @@ class BagOfCells {
   enum { hash_bytes = vm::Cell::hash_bytes, default_max_roots = 16384 };
   enum Mode { WithIndex = 1, WithCRC32C = 2, WithTopHash = 4, WithIntHashes = 8, WithCacheBits = 16, max = 31 };
   enum { max_cell_whs = 64 };
+  enum { parallel_min_cells = 1 << 16, parallel_min_level_cells = 1 << 12 };
   using Hash = Cell::Hash;
   struct Info {
     enum : td::uint32 { boc_idx = 0x68ff65f3, boc_idx_crc32c = 0xacc3a728, boc_generic = 0xb5ee9c72 };
@@ -288,10 +289,12 @@ class BagOfCells {
   std::size_t serialize_to_impl(WriterT& writer, int mode = 0);
   std::string extract_string() const;
 
-  td::Result<long long> deserialize(const td::Slice& data, int max_roots = default_max_roots);
+  // with threads > 1 large bags are deserialized level by level: all cells at the same distance from the leaves
+  // are created (and hashed) concurrently
+  td::Result<long long> deserialize(const td::Slice& data, int max_roots = default_max_roots, int threads = 1);
   td::Result<long long> deserialize(const unsigned char* buffer, std::size_t buff_size,
-                                    int max_roots = default_max_roots) {
-    return deserialize(td::Slice{buffer, buff_size}, max_roots);
+                                    int max_roots = default_max_roots, int threads = 1) {
+    return deserialize(td::Slice{buffer, buff_size}, max_roots, threads);
   }
   int get_root_count() const {
     return root_count;
@@ -322,9 +325,14 @@ class BagOfCells {
   td::Result<td::Slice> get_cell_slice(int index, td::Slice data);
   td::Result<td::Ref<vm::DataCell>> deserialize_cell(int index, td::Slice data, td::Span<td::Ref<DataCell>> cells,
                                                      std::vector<td::uint8>* cell_should_cache);
+  td::Status deserialize_cells(td::Slice data, std::vector<Ref<DataCell>>& cell_list,
+                               std::vector<td::uint8>* cell_should_cache);
+  td::Status deserialize_cells_parallel(td::Slice data, std::vector<Ref<DataCell>>& cell_list,
+                                        std::vector<td::uint8>* cell_should_cache, int threads);
 };
 
-td::Result<Ref<Cell>> std_boc_deserialize(td::Slice data, bool can_be_empty = false, bool allow_nonzero_level = false);
+td::Result<Ref<Cell>> std_boc_deserialize(td::Slice data, bool can_be_empty = false, bool allow_nonzero_level = false,
+                                          int threads = 1);
 td::Result<td::BufferSlice> std_boc_serialize(Ref<Cell> root, int mode = 0);
 
 td::Result<std::vector<Ref<Cell>>> std_boc_deserialize_multi(td::Slice data,
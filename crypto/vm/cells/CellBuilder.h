@@ -29,7 +29,7 @@ namespace vm {
 class CellSlice;
 class DataCell;
 
-class CellBuilder : public td::CntObject {
+class CellBuilder : public td::CntObject, public td::CntPoolAllocated {
  public:
   struct CellWriteError {};
   struct CellCreateError {};
@@ -230,6 +230,11 @@ Ref<Cell> CellSlice::get_base_cell() const {
   return res;
 }
 
+Cell::Hash CellSlice::get_data_cell_hash() const {
+  CHECK(cell.not_null());
+  return cell->get_hash();
+}
+
 bool CellSlice::advance(unsigned bits) {
   if (have(bits)) {
     bits_st += bits;
@@ -31,7 +31,7 @@ struct NoVm {};
 struct NoVmOrd {};
 struct NoVmSpec {};
 
-class CellSlice : public td::CntObject {
+class CellSlice : public td::CntObject, public td::CntPoolAllocated {
   Cell::VirtualizationParameters virt;
   Ref<DataCell> cell;
   CellUsageTree::NodePtr tree_node;
@@ -140,6 +140,7 @@ class CellSlice : public td::CntObject {
   unsigned get_cell_level() const;
   unsigned get_level() const;
   Ref<Cell> get_base_cell() const;  // be careful with this one!
+  Cell::Hash get_data_cell_hash() const;  // hash of the underlying data cell, no virtualization or usage tracking
   int fetch_octet();
   int prefetch_octet() const;
   unsigned long long prefetch_ulong_top(unsigned& bits) const;
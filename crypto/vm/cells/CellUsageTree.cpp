@@ -19,6 +19,11 @@
 #include "vm/cells/CellUsageTree.h"
 
 namespace vm {
+namespace {
+thread_local const CellUsageTree* attached_tree;
+thread_local CellUsageTree::LoadJournal* attached_journal;
+}  // namespace
+
 //
 // CellUsageTree::NodePtr
 //
@@ -112,10 +117,27 @@ void CellUsageTree::set_use_mark_for_is_loaded(bool use_mark) {
 }
 
 void CellUsageTree::on_load(NodeId node_id) {
+  if (attached_tree == this) {
+    attached_journal->loaded_nodes.push_back(node_id);
+    return;
+  }
+  if (concurrent_) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    nodes_[node_id].is_loaded = true;
+    return;
+  }
   nodes_[node_id].is_loaded = true;
 }
 
 CellUsageTree::NodeId CellUsageTree::create_child(NodeId node_id, unsigned ref_id) {
+  if (concurrent_) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return create_child_impl(node_id, ref_id);
+  }
+  return create_child_impl(node_id, ref_id);
+}
+
+CellUsageTree::NodeId CellUsageTree::create_child_impl(NodeId node_id, unsigned ref_id) {
   DCHECK(ref_id < CellTraits::max_refs);
   NodeId res = nodes_[node_id].children[ref_id];
   if (res) {
@@ -133,4 +155,28 @@ CellUsageTree::NodeId CellUsageTree::create_node(NodeId parent) {
   return res;
 }
 
+void CellUsageTree::apply_journal(const LoadJournal& journal) {
+  for (NodeId node_id : journal.loaded_nodes) {
+    nodes_[node_id].is_loaded = true;
+  }
+}
+
+void CellUsageTree::set_concurrent(bool concurrent) {
+  concurrent_ = concurrent;
+}
+
+//
+// CellUsageTree::AttachJournal
+//
+CellUsageTree::AttachJournal::AttachJournal(const CellUsageTree* tree, LoadJournal* journal)
+    : prev_tree_(attached_tree), prev_journal_(attached_journal) {
+  attached_tree = tree;
+  attached_journal = journal;
+}
+
+CellUsageTree::AttachJournal::~AttachJournal() {
+  attached_tree = prev_tree_;
+  attached_journal = prev_journal_;
+}
+
 }  // namespace vm
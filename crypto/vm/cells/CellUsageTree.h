@@ -23,6 +23,8 @@
 #include "td/utils/int_types.h"
 #include "td/utils/logging.h"
 
+#include <mutex>
+
 namespace vm {
 class CellUsageTree : public std::enable_shared_from_this<CellUsageTree> {
  public:
@@ -59,6 +61,27 @@ class CellUsageTree : public std::enable_shared_from_this<CellUsageTree> {
   void set_use_mark_for_is_loaded(bool use_mark = true);
   NodeId create_child(NodeId node_id, unsigned ref_id);
 
+  // Cells loaded by one thread while a LoadJournal is attached to it are recorded in the journal instead of being
+  // marked as loaded. The loads can be applied to the tree later or discarded (e.g. for speculative execution).
+  struct LoadJournal {
+    std::vector<NodeId> loaded_nodes;
+  };
+  class AttachJournal {
+   public:
+    AttachJournal(const CellUsageTree* tree, LoadJournal* journal);
+    ~AttachJournal();
+    AttachJournal(const AttachJournal&) = delete;
+    AttachJournal& operator=(const AttachJournal&) = delete;
+
+   private:
+    const CellUsageTree* prev_tree_;
+    LoadJournal* prev_journal_;
+  };
+  void apply_journal(const LoadJournal& journal);
+  // Allows cells of the tree to be loaded from several threads. Must not be changed while other threads use the tree;
+  // is_loaded() and has_mark() must not be called while the tree is used concurrently.
+  void set_concurrent(bool concurrent = true);
+
  private:
   struct Node {
     bool is_loaded{false};
@@ -67,9 +90,12 @@ class CellUsageTree : public std::enable_shared_from_this<CellUsageTree> {
     std::array<td::uint32, CellTraits::max_refs> children{};
   };
   bool use_mark_{false};
+  bool concurrent_{false};
   std::vector<Node> nodes_{2};
+  std::mutex mutex_;
 
   void on_load(NodeId node_id);
+  NodeId create_child_impl(NodeId node_id, unsigned ref_id);
   NodeId create_node(NodeId parent);
 };
 }  // namespace vm
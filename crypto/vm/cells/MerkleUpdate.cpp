@@ -196,6 +196,23 @@ std::pair<Ref<Cell>, Ref<Cell>> MerkleUpdate::generate_raw(Ref<Cell> from, Ref<C
   return {std::move(update_from), std::move(update_to)};
 }
 
+std::pair<Ref<Cell>, Ref<Cell>> MerkleUpdate::generate_fast_raw(Ref<Cell> from, Ref<Cell> to,
+                                                                CellUsageTree *usage_tree) {
+  // same predicate as in generate_raw(): a reused cell with references is pruned and the path to it is marked,
+  // but both are decided without loading the cell (a cell has no references iff its depth is zero)
+  auto update_to = MerkleProof::generate_raw(to, [tree = usage_tree](const Ref<Cell> &cell) {
+    if (cell->get_depth() == 0) {
+      return false;
+    }
+    auto tree_node = cell->get_tree_node();
+    return !tree_node.empty() && tree_node.mark_path(tree);
+  });
+  usage_tree->set_use_mark_for_is_loaded(true);
+  auto update_from = MerkleProof::generate_raw(from, usage_tree);
+
+  return {std::move(update_from), std::move(update_to)};
+}
+
 td::Status MerkleUpdate::validate_raw(Ref<Cell> update_from, Ref<Cell> update_to, td::uint32 from_level,
                                       td::uint32 to_level) {
   return detail::MerkleUpdateValidator().validate(std::move(update_from), std::move(update_to), from_level, to_level);
@@ -227,6 +244,17 @@ Ref<Cell> MerkleUpdate::generate(Ref<Cell> from, Ref<Cell> to, CellUsageTree *us
   return CellBuilder::create_merkle_update(res.first, res.second);
 }
 
+Ref<Cell> MerkleUpdate::generate_fast(Ref<Cell> from, Ref<Cell> to, CellUsageTree *usage_tree) {
+  if (from->get_level() != 0 || to->get_level() != 0) {
+    return {};
+  }
+  auto res = generate_fast_raw(std::move(from), std::move(to), usage_tree);
+  if (res.first.is_null() || res.second.is_null()) {
+    return {};
+  }
+  return CellBuilder::create_merkle_update(res.first, res.second);
+}
+
 namespace detail {
 class MerkleCombine {
  public:
@@ -30,6 +30,10 @@ class MerkleUpdate {
  public:
   // from + update == to
   static Ref<Cell> generate(Ref<Cell> from, Ref<Cell> to, CellUsageTree *usage_tree);
+  // Same result as generate(), but cells of `from` reused in `to` are recognized by their usage tree nodes and are not
+  // loaded, so only the new cells and the paths to the reused ones are visited. `from` may be the original root without
+  // usage cells, then walking it does not touch the usage tree at all.
+  static Ref<Cell> generate_fast(Ref<Cell> from, Ref<Cell> to, CellUsageTree *usage_tree);
   // Returns empty Ref<Cell> if something go wrong. If validate(from).is_ok() and may_apply(from, to).is_ok(), then it
   // must not fail.
   static Ref<Cell> apply(Ref<Cell> from, Ref<Cell> update);
@@ -42,6 +46,7 @@ class MerkleUpdate {
   static Ref<Cell> apply_raw(Ref<Cell> from, Ref<Cell> update_from, Ref<Cell> update_to, td::uint32 from_level,
                              td::uint32 to_level);
   static std::pair<Ref<Cell>, Ref<Cell>> generate_raw(Ref<Cell> from, Ref<Cell> to, CellUsageTree *usage_tree);
+  static std::pair<Ref<Cell>, Ref<Cell>> generate_fast_raw(Ref<Cell> from, Ref<Cell> to, CellUsageTree *usage_tree);
   static td::Status validate_raw(Ref<Cell> update_from, Ref<Cell> update_to, td::uint32 from_level,
                                  td::uint32 to_level);
 
@@ -159,7 +159,7 @@ struct ControlData {
   bool deserialize(CellSlice& cs, int mode = 0);
 };
 
-class Continuation : public td::CntObject {
+class Continuation : public td::CntObject, public td::CntPoolAllocated {
  public:
   virtual int jump(VmState* st) const & = 0;
   virtual int jump_w(VmState* st) &;
@@ -18,61 +18,211 @@
 */
 #pragma once
 
+#include "td/utils/common.h"
 #include "td/utils/Slice.h"
 
-#include <set>
+#include <cstring>
+#include <deque>
+#include <utility>
+#include <vector>
 
 namespace vm {
+// Open addressing (Robin Hood) hash table of InfoT keyed by cell hashes.
+// Cell hashes are uniform, so the first 8 bytes of the key are used as the hash value directly
+// and are stored in the slot; InfoT itself is compared only when these prefixes match.
+// InfoT objects are kept in stable storage, so references returned by apply() and get_if_exists()
+// stay valid until the element is erased.
 template <class InfoT>
 class CellHashTable {
  public:
+  CellHashTable() = default;
+  CellHashTable(const CellHashTable &) = delete;
+  CellHashTable &operator=(const CellHashTable &) = delete;
+  CellHashTable(CellHashTable &&) = default;
+  CellHashTable &operator=(CellHashTable &&) = default;
+
   template <class F>
   InfoT &apply(td::Slice hash, F &&f) {
-    auto it = set_.find(hash);
-    if (it != set_.end()) {
-      auto &res = const_cast<InfoT &>(*it);
+    auto prefix = get_prefix(hash);
+    auto pos = find(prefix, hash);
+    if (pos != npos) {
+      auto &res = *slots_[pos].info;
       f(res);
       return res;
     }
     InfoT info;
     f(info);
-    auto &res = const_cast<InfoT &>(*(set_.insert(std::move(info)).first));
-    return res;
+    // f could have inserted the same key meanwhile
+    pos = find(prefix, hash);
+    if (pos != npos) {
+      return *slots_[pos].info;
+    }
+    auto *res = allocate(std::move(info));
+    reserve(size_ + 1);
+    insert_slot(Slot{prefix, res});
+    size_++;
+    return *res;
   }
 
   template <class F>
   void for_each(F &&f) {
-    for (auto &info : set_) {
-      f(info);
+    for (auto &slot : slots_) {
+      if (slot.info) {
+        f(*slot.info);
+      }
     }
   }
   template <class F>
   void filter(F &&f) {
-    for (auto it = set_.begin(); it != set_.end();) {
-      if (f(*it)) {
-        it++;
+    std::vector<Slot> kept;
+    kept.reserve(size_);
+    for (auto &slot : slots_) {
+      if (!slot.info) {
+        continue;
+      }
+      if (f(*slot.info)) {
+        kept.push_back(slot);
       } else {
-        it = set_.erase(it);
+        deallocate(slot.info);
       }
     }
+    rebuild(kept, slots_.size());
   }
   void erase(td::Slice hash) {
-    auto it = set_.find(hash);
-    CHECK(it != set_.end());
-    set_.erase(it);
+    auto pos = find(get_prefix(hash), hash);
+    CHECK(pos != npos);
+    deallocate(slots_[pos].info);
+    erase_slot(pos);
+    size_--;
   }
   size_t size() const {
-    return set_.size();
+    return size_;
   }
-  InfoT* get_if_exists(td::Slice hash) {
-    auto it = set_.find(hash);
-    if (it != set_.end()) {
-      return &const_cast<InfoT &>(*it);
+  InfoT *get_if_exists(td::Slice hash) {
+    auto pos = find(get_prefix(hash), hash);
+    if (pos != npos) {
+      return slots_[pos].info;
     }
     return nullptr;
   }
+  // approximate number of bytes used by the table itself, not counting memory owned by InfoT
+  size_t memory_usage() const {
+    return slots_.capacity() * sizeof(Slot) + nodes_.size() * sizeof(InfoT) + free_.capacity() * sizeof(InfoT *);
+  }
 
  private:
-  std::set<InfoT, std::less<>> set_;
+  struct Slot {
+    td::uint64 prefix{0};
+    InfoT *info{nullptr};
+  };
+  static constexpr size_t npos = static_cast<size_t>(-1);
+  static constexpr size_t min_capacity = 16;
+
+  std::vector<Slot> slots_;
+  std::deque<InfoT> nodes_;
+  std::vector<InfoT *> free_;
+  size_t size_{0};
+
+  static td::uint64 get_prefix(td::Slice hash) {
+    td::uint64 res = 0;
+    std::memcpy(&res, hash.data(), td::min(hash.size(), sizeof(res)));
+    return res;
+  }
+  static bool is_equal(const InfoT &info, td::Slice hash) {
+    return !(info < hash) && !(hash < info);
+  }
+  size_t mask() const {
+    return slots_.size() - 1;
+  }
+  size_t probe_distance(size_t pos, const Slot &slot) const {
+    return (pos - static_cast<size_t>(slot.prefix)) & mask();
+  }
+
+  size_t find(td::uint64 prefix, td::Slice hash) const {
+    if (slots_.empty()) {
+      return npos;
+    }
+    auto pos = static_cast<size_t>(prefix) & mask();
+    for (size_t dist = 0;; dist++) {
+      auto &slot = slots_[pos];
+      if (!slot.info || probe_distance(pos, slot) < dist) {
+        return npos;
+      }
+      if (slot.prefix == prefix && is_equal(*slot.info, hash)) {
+        return pos;
+      }
+      pos = (pos + 1) & mask();
+    }
+  }
+
+  void insert_slot(Slot slot) {
+    auto pos = static_cast<size_t>(slot.prefix) & mask();
+    for (size_t dist = 0;; dist++) {
+      auto &cur = slots_[pos];
+      if (!cur.info) {
+        cur = slot;
+        return;
+      }
+      auto cur_dist = probe_distance(pos, cur);
+      if (cur_dist < dist) {
+        std::swap(cur, slot);
+        dist = cur_dist;
+      }
+      pos = (pos + 1) & mask();
+    }
+  }
+
+  void erase_slot(size_t pos) {
+    // backward shift deletion keeps probe sequences free of tombstones
+    auto next = (pos + 1) & mask();
+    while (slots_[next].info && probe_distance(next, slots_[next]) != 0) {
+      slots_[pos] = slots_[next];
+      pos = next;
+      next = (next + 1) & mask();
+    }
+    slots_[pos] = Slot{};
+  }
+
+  void reserve(size_t new_size) {
+    // keep load factor below 7/8
+    if (new_size * 8 <= slots_.size() * 7) {
+      return;
+    }
+    size_t capacity = td::max(slots_.size() * 2, min_capacity);
+    while (new_size * 8 > capacity * 7) {
+      capacity *= 2;
+    }
+    std::vector<Slot> old_slots;
+    old_slots.reserve(size_);
+    for (auto &slot : slots_) {
+      if (slot.info) {
+        old_slots.push_back(slot);
+      }
+    }
+    rebuild(old_slots, capacity);
+  }
+
+  void rebuild(const std::vector<Slot> &slots, size_t capacity) {
+    slots_.assign(capacity, Slot{});
+    for (auto &slot : slots) {
+      insert_slot(slot);
+    }
+    size_ = slots.size();
+  }
+
+  InfoT *allocate(InfoT &&info) {
+    if (!free_.empty()) {
+      auto *res = free_.back();
+      free_.pop_back();
+      *res = std::move(info);
+      return res;
+    }
+    nodes_.push_back(std::move(info));
+    return &nodes_.back();
+  }
+  void deallocate(InfoT *info) {
+    *info = InfoT();
+    free_.push_back(info);
+  }
 };
 }  // namespace vm
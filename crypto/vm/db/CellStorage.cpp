@@ -158,7 +158,27 @@ td::Result<CellLoader::LoadResult> CellLoader::load(td::Slice hash, bool need_da
     DCHECK(get_status == KeyValue::GetStatus::NotFound);
     return res;
   }
+  return load_value(serialized, need_data, ext_cell_creator);
+}
+
+td::Result<std::vector<CellLoader::LoadResult>> CellLoader::load_multi(td::Span<td::Slice> hashes, bool need_data,
+                                                                       ExtCellCreator &ext_cell_creator) {
+  std::vector<std::string> serialized;
+  TRY_RESULT(get_statuses, reader_->get_multi(hashes, &serialized));
+  std::vector<LoadResult> res(hashes.size());
+  for (size_t i = 0; i < hashes.size(); i++) {
+    if (get_statuses[i] != KeyValue::GetStatus::Ok) {
+      DCHECK(get_statuses[i] == KeyValue::GetStatus::NotFound);
+      continue;
+    }
+    TRY_RESULT_ASSIGN(res[i], load_value(serialized[i], need_data, ext_cell_creator));
+  }
+  return std::move(res);
+}
 
+td::Result<CellLoader::LoadResult> CellLoader::load_value(td::Slice serialized, bool need_data,
+                                                          ExtCellCreator &ext_cell_creator) {
+  LoadResult res;
   res.status = LoadResult::Ok;
 
   RefcntCellParser refcnt_cell(need_data);
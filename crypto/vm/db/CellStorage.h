@@ -49,8 +49,13 @@ class CellLoader {
   };
   CellLoader(std::shared_ptr<KeyValueReader> reader, std::function<void(const LoadResult &)> on_load_callback = {});
   td::Result<LoadResult> load(td::Slice hash, bool need_data, ExtCellCreator &ext_cell_creator);
+  // reads all cells with a single KeyValueReader::get_multi, results are in the order of hashes
+  td::Result<std::vector<LoadResult>> load_multi(td::Span<td::Slice> hashes, bool need_data,
+                                                 ExtCellCreator &ext_cell_creator);
 
  private:
+  td::Result<LoadResult> load_value(td::Slice serialized, bool need_data, ExtCellCreator &ext_cell_creator);
+
   std::shared_ptr<KeyValueReader> reader_;
   std::function<void(const LoadResult &)> on_load_callback_;
 };
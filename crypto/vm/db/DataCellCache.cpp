@@ -0,0 +1,186 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vm/db/DataCellCache.h"
+#include "vm/db/DynamicBagOfCellsDb.h"
+#include "vm/cells/CellBuilder.h"
+#include "vm/cells/PrunnedCell.h"
+
+#include "td/utils/Time.h"
+
+#include <cstring>
+
+namespace vm {
+namespace {
+// copies the cell, creating every child anew from its level mask, hashes and depths
+template <class F>
+td::Result<Ref<DataCell>> copy_with_new_refs(const DataCell &cell, F &&create_ref) {
+  CellBuilder cb;
+  cb.store_bits(cell.get_data(), cell.get_bits());
+  for (unsigned i = 0; i < cell.size_refs(); i++) {
+    auto ref = cell.get_ref(i);
+    auto level_mask = ref->get_level_mask();
+    auto n = level_mask.get_hashes_count();
+    unsigned char hashes[(Cell::max_level + 1) * Cell::hash_bytes];
+    unsigned char depths[(Cell::max_level + 1) * Cell::depth_bytes];
+    for (unsigned level_i = 0, hash_i = 0; level_i <= level_mask.get_level(); level_i++) {
+      if (!level_mask.is_significant(level_i)) {
+        continue;
+      }
+      auto hash = ref->get_hash(level_i);
+      std::memcpy(hashes + hash_i * Cell::hash_bytes, hash.as_slice().data(), Cell::hash_bytes);
+      DataCell::store_depth(depths + hash_i * Cell::depth_bytes, ref->get_depth(level_i));
+      hash_i++;
+    }
+    TRY_RESULT(new_ref, create_ref(level_mask, td::Slice(hashes, n * Cell::hash_bytes),
+                                   td::Slice(depths, n * Cell::depth_bytes)));
+    cb.store_ref(std::move(new_ref));
+  }
+  return cb.finalize_novm_nothrow(cell.is_special());
+}
+}  // namespace
+
+DataCellCache::DataCellCache(Options options)
+    : options_(options), shard_max_bytes_(options.max_bytes / shards_count) {
+}
+
+Ref<DataCell> DataCellCache::get(td::Slice hash, ExtCellCreator &ext_cell_creator) {
+  auto &shard = get_shard(hash);
+  Ref<DataCell> cached;
+  {
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    auto it = shard.index.find(CellHash::from_slice(hash));
+    if (it != shard.index.end()) {
+      auto &entry = shard.entries[it->second];
+      if (td::Time::now() - entry.loaded_at <= options_.max_age) {
+        entry.referenced = true;
+        cached = entry.cell;
+      } else {
+        erase(shard, it->second);
+      }
+    }
+  }
+  if (cached.not_null()) {
+    auto r_cell = copy_with_new_refs(*cached, [&](Cell::LevelMask level_mask, td::Slice hashes, td::Slice depths) {
+      return ext_cell_creator.ext_cell(level_mask, hashes, depths);
+    });
+    if (r_cell.is_ok()) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return r_cell.move_as_ok();
+    }
+    LOG(ERROR) << "failed to restore cached cell: " << r_cell.error();
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  return {};
+}
+
+void DataCellCache::put(const Ref<DataCell> &cell) {
+  auto size = get_cell_size(*cell);
+  if (size > shard_max_bytes_) {
+    return;
+  }
+  auto r_pruned = copy_with_new_refs(*cell, [](Cell::LevelMask level_mask, td::Slice hashes, td::Slice depths) {
+    return PrunnedCell<td::Unit>::create(PrunnedCellInfo{level_mask, hashes, depths}, td::Unit());
+  });
+  if (r_pruned.is_error()) {
+    return;
+  }
+  auto pruned = r_pruned.move_as_ok();
+  auto hash = cell->get_hash();
+  auto &shard = get_shard(hash.as_slice());
+  auto now = td::Time::now();
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  auto it = shard.index.find(hash);
+  if (it != shard.index.end()) {
+    auto &entry = shard.entries[it->second];
+    entry.cell = std::move(pruned);
+    entry.loaded_at = now;
+    return;
+  }
+  while (shard.bytes + size > shard_max_bytes_) {
+    evict_one(shard);
+  }
+  size_t pos;
+  if (shard.free_entries.empty()) {
+    pos = shard.entries.size();
+    shard.entries.emplace_back();
+  } else {
+    pos = shard.free_entries.back();
+    shard.free_entries.pop_back();
+  }
+  auto &entry = shard.entries[pos];
+  entry.cell = std::move(pruned);
+  entry.loaded_at = now;
+  entry.size = size;
+  entry.referenced = false;
+  shard.bytes += size;
+  shard.index.emplace(hash, pos);
+}
+
+void DataCellCache::evict_one(Shard &shard) {
+  CHECK(!shard.index.empty());
+  while (true) {
+    if (shard.hand >= shard.entries.size()) {
+      shard.hand = 0;
+    }
+    auto &entry = shard.entries[shard.hand];
+    auto pos = shard.hand++;
+    if (entry.cell.is_null()) {
+      continue;
+    }
+    if (entry.referenced) {
+      entry.referenced = false;
+      continue;
+    }
+    erase(shard, pos);
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+}
+
+void DataCellCache::erase(Shard &shard, size_t pos) {
+  auto &entry = shard.entries[pos];
+  shard.index.erase(entry.cell->get_hash());
+  shard.bytes -= entry.size;
+  entry.cell.clear();
+  shard.free_entries.push_back(pos);
+}
+
+DataCellCache::Stats DataCellCache::get_stats() const {
+  Stats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.evictions = evictions_.load(std::memory_order_relaxed);
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    stats.cells += shard.index.size();
+    stats.bytes += shard.bytes;
+  }
+  return stats;
+}
+
+size_t DataCellCache::get_cell_size(const DataCell &cell) {
+  // every child is a PrunnedCell holding its hashes and depths
+  constexpr size_t pruned_cell_size = 64;
+  size_t size = sizeof(DataCell) + (cell.get_bits() + 7) / 8 +
+                (cell.get_level() + 1) * (Cell::hash_bytes + Cell::depth_bytes) + cell.size_refs() * sizeof(Cell *);
+  for (unsigned i = 0; i < cell.size_refs(); i++) {
+    size += pruned_cell_size + cell.get_ref(i)->get_level_mask().get_hashes_count() *
+                                   (Cell::hash_bytes + Cell::depth_bytes);
+  }
+  return size;
+}
+}  // namespace vm
@@ -0,0 +1,96 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "vm/cells.h"
+
+#include "td/utils/Slice.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace vm {
+class ExtCellCreator;
+
+// Size-bounded cache of deserialized cells keyed by hash, shared by cell db readers.
+// Cells are distributed between shards by hash; each shard has its own lock and evicts with the CLOCK policy.
+// The cache keeps its own copy of every cell with children replaced by pruned cells holding only their hashes,
+// so it pins neither the subtrees loaded through the cells it hands out nor the readers which loaded them.
+// get() returns a new cell whose children are unloaded ExtCells made by the caller's reader.
+// Cells older than max_age are treated as missing and get reloaded from the db.
+class DataCellCache {
+ public:
+  struct Options {
+    size_t max_bytes{0};
+    double max_age{60.0};
+  };
+  struct Stats {
+    td::uint64 hits{0};
+    td::uint64 misses{0};
+    td::uint64 evictions{0};
+    size_t cells{0};
+    size_t bytes{0};
+    double hit_ratio() const {
+      return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+  };
+
+  explicit DataCellCache(Options options);
+
+  Ref<DataCell> get(td::Slice hash, ExtCellCreator &ext_cell_creator);
+  void put(const Ref<DataCell> &cell);
+
+  Stats get_stats() const;
+
+  // approximate memory used by a cached cell together with its pruned children
+  static size_t get_cell_size(const DataCell &cell);
+
+ private:
+  static constexpr size_t shards_count = 64;
+
+  struct Entry {
+    Ref<DataCell> cell;
+    double loaded_at{0};
+    size_t size{0};
+    bool referenced{false};
+  };
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<CellHash, size_t> index;
+    std::vector<Entry> entries;
+    std::vector<size_t> free_entries;
+    size_t hand{0};
+    size_t bytes{0};
+  };
+
+  Options options_;
+  size_t shard_max_bytes_;
+  std::array<Shard, shards_count> shards_;
+  std::atomic<td::uint64> hits_{0};
+  std::atomic<td::uint64> misses_{0};
+  std::atomic<td::uint64> evictions_{0};
+
+  Shard &get_shard(td::Slice hash) {
+    return shards_[static_cast<td::uint8>(hash[0]) % shards_count];
+  }
+  void evict_one(Shard &shard);
+  void erase(Shard &shard, size_t pos);
+};
+}  // namespace vm
@@ -19,6 +19,7 @@
 #include "vm/db/DynamicBagOfCellsDb.h"
 #include "vm/db/CellStorage.h"
 #include "vm/db/CellHashTable.h"
+#include "vm/db/DataCellCache.h"
 
 #include "vm/cells/ExtCell.h"
 
@@ -28,6 +29,12 @@
 
 #include "vm/cellslice.h"
 
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace vm {
 namespace {
 
@@ -95,16 +102,28 @@ class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreat
       return;
     }
     SimpleExtCellCreator ext_cell_creator(cell_db_reader_);
+    if (cell_cache_) {
+      auto cell = cell_cache_->get(hash, ext_cell_creator);
+      if (cell.not_null()) {
+        promise.set_result(std::move(cell));
+        return;
+      }
+    }
     auto promise_ptr = std::make_shared<td::Promise<Ref<DataCell>>>(std::move(promise));
     executor->execute_async(
-        [executor, loader = *loader_, hash = CellHash::from_slice(hash), db = this,
-         ext_cell_creator = std::move(ext_cell_creator), promise = std::move(promise_ptr)]() mutable {
+        [executor, loader = *loader_, hash = CellHash::from_slice(hash), db = this, reader = cell_db_reader_,
+         cell_cache = cell_cache_, ext_cell_creator = std::move(ext_cell_creator),
+         promise = std::move(promise_ptr)]() mutable {
           TRY_RESULT_PROMISE((*promise), res, loader.load(hash.as_slice(), true, ext_cell_creator));
           if (res.status != CellLoader::LoadResult::Ok) {
             promise->set_error(td::Status::Error("cell not found"));
             return;
           }
           Ref<Cell> cell = res.cell();
+          reader->prefetch_children(res.cell());
+          if (cell_cache) {
+            cell_cache->put(res.cell());
+          }
           executor->execute_sync([hash, db, res = std::move(res),
                                   ext_cell_creator = std::move(ext_cell_creator)]() mutable {
             db->hash_table_.apply(hash.as_slice(), [&](CellInfo &info) {
@@ -206,6 +225,8 @@ class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreat
     // Temporary(?) fix to make ExtCell thread safe.
     // Downside(?) - loaded cells won't be cached
     cell_db_reader_ = std::make_shared<CellDbReaderImpl>(std::make_unique<CellLoader>(*loader_));
+    cell_db_reader_->set_prefetch_options(prefetch_options_, prefetch_executor_, prefetch_counters_);
+    cell_db_reader_->set_cell_cache(cell_cache_);
     stats_diff_ = {};
     return td::Status::OK();
   }
@@ -214,6 +235,26 @@ class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreat
     celldb_compress_depth_ = value;
   }
 
+  void set_prefetch_options(PrefetchOptions options, std::shared_ptr<AsyncExecutor> executor) override {
+    if (!executor) {
+      options.depth = 0;
+    }
+    prefetch_options_ = options;
+    prefetch_executor_ = std::move(executor);
+  }
+
+  void set_cell_cache(std::shared_ptr<DataCellCache> cell_cache) override {
+    cell_cache_ = std::move(cell_cache);
+  }
+
+  PrefetchStats get_prefetch_stats() const override {
+    PrefetchStats stats;
+    stats.prefetched = prefetch_counters_->prefetched.load(std::memory_order_relaxed);
+    stats.hits = prefetch_counters_->hits.load(std::memory_order_relaxed);
+    stats.misses = prefetch_counters_->misses.load(std::memory_order_relaxed);
+    return stats;
+  }
+
   vm::ExtCellCreator& as_ext_cell_creator() override {
     return *this;
   }
@@ -227,6 +268,16 @@ class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreat
   Stats stats_diff_;
   td::uint32 celldb_compress_depth_{0};
 
+  struct PrefetchCounters {
+    std::atomic<td::uint64> prefetched{0};
+    std::atomic<td::uint64> hits{0};
+    std::atomic<td::uint64> misses{0};
+  };
+  PrefetchOptions prefetch_options_;
+  std::shared_ptr<AsyncExecutor> prefetch_executor_;
+  std::shared_ptr<PrefetchCounters> prefetch_counters_ = std::make_shared<PrefetchCounters>();
+  std::shared_ptr<DataCellCache> cell_cache_;
+
   static td::NamedThreadSafeCounter::CounterRef get_thread_safe_counter() {
     static auto res = td::NamedThreadSafeCounter::get_default().get_counter("DynamicBagOfCellsDb");
     return res;
@@ -292,6 +343,65 @@ class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreat
       if (db_) {
         return db_->load_cell(hash);
       }
+      Ref<DataCell> cell;
+      if (cell_cache_) {
+        cell = cell_cache_->get(hash, *this);
+        if (cell.not_null()) {
+          return std::move(cell);
+        }
+      }
+      if (prefetch_options_.depth == 0) {
+        TRY_RESULT_ASSIGN(cell, do_load_cell(hash));
+      } else {
+        bool is_active = take_prefetched(CellHash::from_slice(hash), cell);
+        if (cell.not_null()) {
+          prefetch_counters_->hits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          TRY_RESULT_ASSIGN(cell, do_load_cell(hash));
+          if (is_active) {
+            prefetch_counters_->misses.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+        if (is_active) {
+          prefetch_children(cell);
+        }
+      }
+      if (cell_cache_) {
+        cell_cache_->put(cell);
+      }
+      return std::move(cell);
+    }
+
+    void set_cell_cache(std::shared_ptr<DataCellCache> cell_cache) {
+      cell_cache_ = std::move(cell_cache);
+    }
+
+    void set_prefetch_options(PrefetchOptions options, std::shared_ptr<AsyncExecutor> executor,
+                              std::shared_ptr<PrefetchCounters> counters) {
+      prefetch_options_ = options;
+      prefetch_executor_ = std::move(executor);
+      prefetch_counters_ = std::move(counters);
+    }
+
+    // Called when the reader is retired: prefetched cells hold ExtCells referring to the reader, so they must be
+    // dropped, and prefetches still in flight must not store anything.
+    void stop_prefetch() {
+      std::lock_guard<std::mutex> guard(prefetch_mutex_);
+      prefetch_stopped_ = true;
+      prefetched_.clear();
+      prefetched_order_.clear();
+      prefetch_pending_.clear();
+    }
+
+    // Schedules loading of the children of `cell` which are neither prefetched nor being prefetched yet.
+    void prefetch_children(const Ref<DataCell> &cell) {
+      if (cell.not_null()) {
+        prefetch_children(td::Span<Ref<DataCell>>(cell), prefetch_options_.depth);
+      }
+    }
+
+   private:
+    td::Result<Ref<DataCell>> do_load_cell(td::Slice hash) {
       TRY_RESULT(load_result, cell_loader_->load(hash, true, *this));
       if (load_result.status != CellLoader::LoadResult::Ok) {
         return td::Status::Error("cell not found");
@@ -299,13 +409,111 @@ class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreat
       return std::move(load_result.cell());
     }
 
-   private:
+    // returns false if prefetching is stopped
+    bool take_prefetched(const CellHash &hash, Ref<DataCell> &cell) {
+      std::lock_guard<std::mutex> guard(prefetch_mutex_);
+      if (prefetch_stopped_) {
+        return false;
+      }
+      auto it = prefetched_.find(hash);
+      if (it != prefetched_.end()) {
+        cell = std::move(it->second.cell);
+        prefetched_order_.erase(it->second.order_it);
+        prefetched_.erase(it);
+      }
+      return true;
+    }
+
+    void prefetch_children(td::Span<Ref<DataCell>> cells, td::uint32 depth) {
+      if (depth == 0 || !cell_loader_) {
+        return;
+      }
+      std::vector<CellHash> hashes;
+      {
+        std::lock_guard<std::mutex> guard(prefetch_mutex_);
+        if (prefetch_stopped_) {
+          return;
+        }
+        for (auto &cell : cells) {
+          for (unsigned i = 0; i < cell->size_refs(); i++) {
+            if (prefetch_pending_.size() >= prefetch_options_.max_cells) {
+              break;
+            }
+            auto hash = cell->get_ref(i)->get_hash();
+            if (prefetched_.count(hash) != 0 || !prefetch_pending_.insert(hash).second) {
+              continue;
+            }
+            hashes.push_back(hash);
+          }
+        }
+      }
+      if (hashes.empty()) {
+        return;
+      }
+      prefetch_executor_->execute_async(
+          [self = std::weak_ptr<CellDbReaderImpl>(shared_from_this()), hashes = std::move(hashes), depth] {
+            if (auto reader = self.lock()) {
+              reader->prefetch_cells(hashes, depth);
+            }
+          });
+    }
+
+    // all cells of one level are read with a single multi-get
+    void prefetch_cells(const std::vector<CellHash> &hashes, td::uint32 depth) {
+      std::vector<td::Slice> keys;
+      keys.reserve(hashes.size());
+      for (auto &hash : hashes) {
+        keys.push_back(hash.as_slice());
+      }
+      auto r_results = cell_loader_->load_multi(keys, true, *this);
+      std::vector<Ref<DataCell>> cells;
+      {
+        std::lock_guard<std::mutex> guard(prefetch_mutex_);
+        if (prefetch_stopped_) {
+          return;
+        }
+        for (size_t i = 0; i < hashes.size(); i++) {
+          prefetch_pending_.erase(hashes[i]);
+          if (r_results.is_error() || r_results.ok()[i].status != CellLoader::LoadResult::Ok) {
+            continue;
+          }
+          auto &cell = r_results.ok_ref()[i].cell();
+          auto it = prefetched_.emplace(hashes[i], PrefetchedCell{cell, {}});
+          if (!it.second) {
+            continue;
+          }
+          it.first->second.order_it = prefetched_order_.insert(prefetched_order_.end(), hashes[i]);
+          cells.push_back(std::move(cell));
+        }
+        while (prefetched_order_.size() > prefetch_options_.max_cells) {
+          prefetched_.erase(prefetched_order_.front());
+          prefetched_order_.pop_front();
+        }
+      }
+      prefetch_counters_->prefetched.fetch_add(cells.size(), std::memory_order_relaxed);
+      prefetch_children(cells, depth - 1);
+    }
+
     static td::NamedThreadSafeCounter::CounterRef get_thread_safe_counter() {
       static auto res = td::NamedThreadSafeCounter::get_default().get_counter("DynamicBagOfCellsDbLoader");
       return res;
     }
     DynamicBagOfCellsDb *db_;
     std::unique_ptr<CellLoader> cell_loader_;
+
+    std::shared_ptr<DataCellCache> cell_cache_;
+    PrefetchOptions prefetch_options_;
+    std::shared_ptr<AsyncExecutor> prefetch_executor_;
+    std::shared_ptr<PrefetchCounters> prefetch_counters_;
+    struct PrefetchedCell {
+      Ref<DataCell> cell;
+      std::list<CellHash>::iterator order_it;
+    };
+    std::mutex prefetch_mutex_;
+    bool prefetch_stopped_{false};
+    std::unordered_map<CellHash, PrefetchedCell> prefetched_;
+    std::list<CellHash> prefetched_order_;  // oldest first, taken cells are removed
+    std::unordered_set<CellHash> prefetch_pending_;
   };
 
   std::shared_ptr<CellDbReaderImpl> cell_db_reader_;
@@ -314,6 +522,7 @@ class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreat
     if (!cell_db_reader_) {
       return;
     }
+    cell_db_reader_->stop_prefetch();
     cell_db_reader_->set_loader(std::move(loader_));
     cell_db_reader_.reset();
     //EXPERIMENTAL: clear cache to drop all references to old reader.
@@ -26,6 +26,7 @@
 namespace vm {
 class CellLoader;
 class CellStorer;
+class DataCellCache;
 }  // namespace vm
 
 namespace vm {
@@ -78,6 +79,29 @@ class DynamicBagOfCellsDb {
 
   virtual void load_cell_async(td::Slice hash, std::shared_ptr<AsyncExecutor> executor,
                                td::Promise<Ref<DataCell>> promise) = 0;
+
+  // When a cell is loaded through the cell db reader (or load_cell_async), its children up to `depth` levels
+  // below are read ahead on the executor, so that a subsequent walk finds them in memory.
+  // At most `max_cells` prefetched cells are kept per reader; the oldest unused ones are dropped first.
+  struct PrefetchOptions {
+    td::uint32 depth{0};  // 0 disables prefetching
+    td::uint32 max_cells{1024};
+  };
+  struct PrefetchStats {
+    td::uint64 prefetched{0};  // cells read ahead of time
+    td::uint64 hits{0};        // loads served by a prefetched cell
+    td::uint64 misses{0};      // loads which had to read the db
+    double read_amplification() const {
+      return hits + misses == 0 ? 0.0 : double(prefetched + misses) / double(hits + misses);
+    }
+  };
+  // applied to readers created by subsequent set_loader calls
+  virtual void set_prefetch_options(PrefetchOptions options, std::shared_ptr<AsyncExecutor> executor) = 0;
+  virtual PrefetchStats get_prefetch_stats() const = 0;
+
+  // cells loaded through the cell db reader or load_cell_async are looked up in and added to the cache;
+  // applied to readers created by subsequent set_loader calls
+  virtual void set_cell_cache(std::shared_ptr<DataCellCache> cell_cache) = 0;
 };
 
 }  // namespace vm
@@ -25,6 +25,8 @@
 
 #include "td/utils/bits.h"
 
+#include <algorithm>
+
 namespace vm {
 
 /*
@@ -1758,6 +1760,192 @@ int DictionaryFixed::filter(DictionaryFixed::filter_func_t check_leaf) {
   return res.second;
 }
 
+/*
+ *
+ *  Bulk construction and batched modification from sorted keys
+ *
+ */
+
+bool DictionaryFixed::check_sorted_updates(const std::vector<Update>& updates) const {
+  for (std::size_t i = 0; i < updates.size(); i++) {
+    if (i > 0 && td::bitstring::bits_memcmp(updates[i - 1].key, updates[i].key, key_bits) >= 0) {
+      // keys must be strictly increasing
+      return false;
+    }
+  }
+  return true;
+}
+
+// creates the subdictionary for keys [first, last) with n bits after the common first pos bits, every node only once
+Ref<Cell> DictionaryFixed::dict_build_sorted(const Update* first, const Update* last, int pos, int n) const {
+  assert(first < last);
+  CellBuilder cb;
+  if (last - first == 1) {
+    append_dict_label(cb, first->key + pos, n, n);
+    return finish_create_leaf(cb, *first->value);
+  }
+  // the keys are sorted, so the common prefix of the first and the last key is common to all of them
+  std::size_t same_upto = 0;
+  td::bitstring::bits_memcmp(first->key + pos, (last - 1)->key + pos, n, &same_upto);
+  int l = (int)same_upto;
+  assert(l < n);
+  auto mid = std::partition_point(first, last, [&](const Update& upd) { return !upd.key[pos + l]; });
+  auto c1 = dict_build_sorted(first, mid, pos + l + 1, n - l - 1);
+  auto c2 = dict_build_sorted(mid, last, pos + l + 1, n - l - 1);
+  append_dict_label(cb, first->key + pos, l, n);
+  return finish_create_fork(cb, std::move(c1), std::move(c2), n - l);
+}
+
+// creates an edge labelled by prefix.bit followed by the label and the contents of child
+Ref<Cell> DictionaryFixed::dict_collapse_edge(td::ConstBitPtr prefix, int prefix_len, bool bit, Ref<Cell> child,
+                                              int n) const {
+  // NB: similar to code in lookup_delete()
+  unsigned char buffer[Dictionary::max_key_bytes];
+  td::BitPtr bw{buffer};
+  bw.concat(prefix, prefix_len);
+  bw.concat_same(bit, 1);
+  LabelParser label{std::move(child), n - prefix_len - 1, label_mode()};
+  bw += label.extract_label_to(bw);
+  assert(bw.offs >= 0 && bw.offs <= Dictionary::max_key_bits);
+  CellBuilder cb;
+  append_dict_label(cb, td::ConstBitPtr{buffer}, bw.offs, n);
+  if (!cell_builder_add_slice_bool(cb, *label.remainder)) {
+    throw VmError{Excno::cell_ov, "cannot change label of an old dictionary cell while merging edges"};
+  }
+  return cb.finalize();
+}
+
+// applies updates [first, last) to subdictionary dict; returns false if the mode of some update does not allow it
+std::pair<Ref<Cell>, bool> DictionaryFixed::dict_apply_updates(Ref<Cell> dict, const Update* first, const Update* last,
+                                                               int pos, int n) const {
+  if (first == last) {
+    // nothing to change in this subtree
+    return {std::move(dict), true};
+  }
+  if (dict.is_null()) {
+    // only new keys may be added to an empty subtree
+    for (auto it = first; it < last; ++it) {
+      if (it->value.is_null() || it->mode == SetMode::Replace) {
+        return {{}, false};
+      }
+    }
+    return {dict_build_sorted(first, last, pos, n), true};
+  }
+  LabelParser label{std::move(dict), n, label_mode()};
+  // the keys are sorted, so one of the extreme keys leaves the edge first
+  int l = std::min(label.common_prefix_len(first->key + pos, n), label.common_prefix_len((last - 1)->key + pos, n));
+  assert(l >= 0 && l <= label.l_bits && label.l_bits <= n);
+  if (l < label.l_bits) {
+    // some keys leave the edge at bit l, so a new fork is created there
+    // first, create the lower portion of the old edge
+    int m = n - l - 1;
+    int t = label.l_bits - l - 1;
+    bool old_bit = label.l_same ? (label.l_same & 1) : label.bits()[l];
+    auto cs = std::move(label.remainder);
+    CellBuilder cb;
+    if (label.l_same) {
+      append_dict_label_same(cb, label.l_same & 1, t, m);
+    } else {
+      cs.write().advance(l + 1);
+      append_dict_label(cb, cs->data_bits(), t, m);
+      cs.unique_write().advance(t);
+    }
+    if (!cell_builder_add_slice_bool(cb, *cs)) {
+      throw VmError{Excno::cell_ov, "cannot change label of an old dictionary cell (?)"};
+    }
+    cs.clear();
+    auto mid = std::partition_point(first, last, [&](const Update& upd) { return !upd.key[pos + l]; });
+    auto old_res = old_bit ? dict_apply_updates(cb.finalize(), mid, last, pos + l + 1, m)
+                           : dict_apply_updates(cb.finalize(), first, mid, pos + l + 1, m);
+    if (!old_res.second) {
+      return {{}, false};
+    }
+    auto new_res = old_bit ? dict_apply_updates({}, first, mid, pos + l + 1, m)
+                           : dict_apply_updates({}, mid, last, pos + l + 1, m);
+    if (!new_res.second) {
+      return {{}, false};
+    }
+    if (old_res.first.is_null()) {
+      // the old subtree is deleted completely
+      return {dict_collapse_edge(first->key + pos, l, !old_bit, std::move(new_res.first), n), true};
+    }
+    auto c1 = std::move(old_res.first), c2 = std::move(new_res.first);
+    if (old_bit) {
+      c1.swap(c2);
+    }
+    append_dict_label(cb, first->key + pos, l, n);
+    return {finish_create_fork(cb, std::move(c1), std::move(c2), n - l), true};
+  }
+  if (label.l_bits == n) {
+    // leaf node, the only remaining key coincides with its key
+    assert(last - first == 1);
+    if (first->value.is_null()) {
+      return {{}, true};
+    }
+    if (first->mode == SetMode::Add) {
+      return {{}, false};
+    }
+    CellBuilder cb;
+    append_dict_label(cb, first->key + pos, n, n);
+    return {finish_create_leaf(cb, *first->value), true};
+  }
+  // fork, every affected child is changed by one recursive call
+  auto mid = std::partition_point(first, last, [&](const Update& upd) { return !upd.key[pos + label.l_bits]; });
+  int m = n - label.l_bits - 1;
+  auto left_res = dict_apply_updates(label.remainder->prefetch_ref(0), first, mid, pos + label.l_bits + 1, m);
+  if (!left_res.second) {
+    return {{}, false};
+  }
+  auto right_res = dict_apply_updates(label.remainder->prefetch_ref(1), mid, last, pos + label.l_bits + 1, m);
+  if (!right_res.second) {
+    return {{}, false};
+  }
+  label.clear();
+  auto left = std::move(left_res.first), right = std::move(right_res.first);
+  if (left.not_null() && right.not_null()) {
+    CellBuilder cb;
+    append_dict_label(cb, first->key + pos, label.l_bits, n);
+    return {finish_create_fork(cb, std::move(left), std::move(right), n - label.l_bits), true};
+  }
+  if (left.is_null() && right.is_null()) {
+    return {{}, true};
+  }
+  // only one child remains, collapse an edge
+  bool bit = left.is_null();
+  return {dict_collapse_edge(first->key + pos, label.l_bits, bit, bit ? std::move(right) : std::move(left), n), true};
+}
+
+bool DictionaryFixed::build_from_sorted(const std::vector<Update>& items) {
+  if (!check_sorted_updates(items)) {
+    return false;
+  }
+  for (const auto& item : items) {
+    if (item.value.is_null()) {
+      return false;
+    }
+  }
+  reset();
+  if (!items.empty()) {
+    set_root_cell(dict_build_sorted(items.data(), items.data() + items.size(), 0, key_bits));
+  }
+  return true;
+}
+
+bool DictionaryFixed::apply_updates(const std::vector<Update>& updates) {
+  force_validate();
+  if (!check_sorted_updates(updates)) {
+    return false;
+  }
+  if (updates.empty()) {
+    return true;
+  }
+  auto res = dict_apply_updates(get_root_cell(), updates.data(), updates.data() + updates.size(), 0, key_bits);
+  if (res.second) {
+    set_root_cell(std::move(res.first));
+  }
+  return res.second;
+}
+
 void Dictionary::map(const map_func_t& map_func) {
   force_validate();
   int key_len = get_key_bits();
@@ -185,6 +185,11 @@ class DictionaryFixed : public DictionaryBase {
   typedef std::function<bool(CellBuilder&, Ref<CellSlice>, Ref<CellSlice>, td::ConstBitPtr, int)> combine_func_t;
   typedef std::function<bool(Ref<CellSlice>, td::ConstBitPtr, int)> foreach_func_t;
   typedef std::function<bool(td::ConstBitPtr, int, Ref<CellSlice>, Ref<CellSlice>)> scan_diff_func_t;
+  struct Update {
+    td::ConstBitPtr key;
+    Ref<CellSlice> value;  // null deletes the key
+    SetMode mode = SetMode::Set;
+  };
 
   DictionaryFixed(int _n, bool validate = true) : DictionaryBase(_n, validate) {
   }
@@ -229,6 +234,8 @@ class DictionaryFixed : public DictionaryBase {
   bool combine_with(DictionaryFixed& dict2, const simple_combine_func_t& simple_combine_func, int mode = 0);
   bool combine_with(DictionaryFixed& dict2);
   bool scan_diff(DictionaryFixed& dict2, const scan_diff_func_t& diff_func, int check_augm = 0);
+  bool build_from_sorted(const std::vector<Update>& items);
+  bool apply_updates(const std::vector<Update>& updates);
   bool validate_check(const foreach_func_t& foreach_func, bool invert_first = false);
   bool validate_all();
   DictIterator null_iterator();
@@ -301,6 +308,11 @@ class DictionaryFixed : public DictionaryBase {
                       const scan_diff_func_t& diff_func, int mode = 0, int skip1 = 0, int skip2 = 0) const;
   bool dict_validate_check(Ref<Cell> dict, td::BitPtr key_buffer, int n, int total_key_len,
                            const foreach_func_t& foreach_func, bool invert_first = false) const;
+  bool check_sorted_updates(const std::vector<Update>& updates) const;
+  Ref<Cell> dict_build_sorted(const Update* first, const Update* last, int pos, int n) const;
+  std::pair<Ref<Cell>, bool> dict_apply_updates(Ref<Cell> dict, const Update* first, const Update* last, int pos,
+                                                int n) const;
+  Ref<Cell> dict_collapse_edge(td::ConstBitPtr prefix, int prefix_len, bool bit, Ref<Cell> child, int n) const;
 };
 
 class DictIterator {
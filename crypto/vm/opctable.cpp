@@ -57,6 +57,23 @@ DispatchTable* OpcodeTable::finalize() {
   }
 
   instruction_list.shrink_to_fit();
+
+  // instruction_list covers [0; top_opcode) without gaps, so one sweep suffices
+  const unsigned prefix_shift = max_opcode_bits - prefix_bits;
+  prefix_table.clear();
+  prefix_table.reserve(1U << prefix_bits);
+  std::size_t i = 0;
+  for (unsigned prefix = 0; prefix < (1U << prefix_bits); prefix++) {
+    unsigned lo = prefix << prefix_shift, hi = (prefix + 1) << prefix_shift;
+    while (i + 1 < instruction_list.size() && instruction_list[i + 1].first <= lo) {
+      ++i;
+    }
+    std::size_t j = i + 1;
+    while (j < instruction_list.size() && instruction_list[j].first < hi) {
+      ++j;
+    }
+    prefix_table.emplace_back((unsigned)i, (unsigned)j);
+  }
   final = true;
   return this;
 }
@@ -101,6 +118,21 @@ bool OpcodeTable::insert_bool(const OpcodeInstr* instr) {
 }
 
 const OpcodeInstr* OpcodeTable::lookup_instr(unsigned opcode, unsigned bits) const {
+  const auto& range = prefix_table[opcode >> (max_opcode_bits - prefix_bits)];
+  std::size_t i = range.first, j = range.second;
+  // almost all prefixes are covered by a single instruction; only long opcodes need a (short) search
+  while (j - i > 1) {
+    auto k = ((j + i) >> 1);
+    if (instruction_list[k].first <= opcode) {
+      i = k;
+    } else {
+      j = k;
+    }
+  }
+  return instruction_list[i].second;
+}
+
+const OpcodeInstr* OpcodeTable::lookup_instr_bsearch(unsigned opcode, unsigned bits) const {
   std::size_t i = 0, j = instruction_list.size();
   assert(j);
   while (j - i > 1) {
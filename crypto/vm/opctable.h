@@ -89,8 +89,12 @@ dump_arg_instr_func_t dump_2c_add(unsigned add, std::string prefix, std::string
 }  // namespace instr
 
 class OpcodeTable : public DispatchTable {
+  enum { prefix_bits = 12 };
   std::map<unsigned, const OpcodeInstr*> instructions;
   std::vector<std::pair<unsigned, const OpcodeInstr*>> instruction_list;
+  // for every value of the top prefix_bits opcode bits: range [first, second) of instruction_list entries
+  // intersecting the corresponding opcode interval; computed by finalize()
+  std::vector<std::pair<unsigned, unsigned>> prefix_table;
   std::string name;
   Codepage codepage;
   bool final;
@@ -112,9 +116,11 @@ class OpcodeTable : public DispatchTable {
   int instr_len(const CellSlice& cs) const override;
   bool insert_bool(const OpcodeInstr*);
   OpcodeTable& insert(const OpcodeInstr*);
+  const OpcodeInstr* lookup_instr(unsigned opcode, unsigned bits) const;
+  // reference implementation (binary search over the whole instruction list), used for testing and benchmarks
+  const OpcodeInstr* lookup_instr_bsearch(unsigned opcode, unsigned bits) const;
 
  private:
-  const OpcodeInstr* lookup_instr(unsigned opcode, unsigned bits) const;
   const OpcodeInstr* lookup_instr(const CellSlice& cs, unsigned& opcode, unsigned& bits) const;
 };
 
@@ -452,10 +452,22 @@ td::RefInt256 Stack::pop_int_finite() {
 }
 
 bool Stack::pop_bool() {
+  check_underflow(1);
+  if (stack.back().is_small_int()) {
+    bool res = stack.back().small_int_value() != 0;
+    stack.pop_back();
+    return res;
+  }
   return sgn(pop_int_finite()) != 0;
 }
 
 long long Stack::pop_long() {
+  check_underflow(1);
+  if (stack.back().is_small_int()) {
+    long long res = stack.back().small_int_value();
+    stack.pop_back();
+    return res;
+  }
   return pop_int()->to_long();
 }
 
@@ -652,7 +664,7 @@ void Stack::push_builder(Ref<CellBuilder> cb) {
 }
 
 void Stack::push_smallint(long long val) {
-  push(td::make_refint(val));
+  push().set_small_int(val);
 }
 
 void Stack::push_bool(bool val) {
@@ -762,6 +774,10 @@ bool StackEntry::serialize(vm::CellBuilder& cb, int mode) const {
     case t_null:
       return cb.store_long_bool(0, 8);  // vm_stk_null#00 = VmStackValue;
     case t_int: {
+      if (small && !(mode & 1)) {
+        // vm_stk_tinyint#01 value:int64 = VmStackValue;
+        return cb.store_long_bool(1, 8) && cb.store_long_bool(small_value, 64);
+      }
       auto val = as_int();
       if (!val->is_valid()) {
         // vm_stk_nan#02ff = VmStackValue;
@@ -831,8 +847,8 @@ bool StackEntry::deserialize(CellSlice& cs, int mode) {
       return cs.advance(8);
     case 1: {
       // vm_stk_tinyint#01 value:int64 = VmStackValue;
-      td::RefInt256 val;
-      return !(mode & 1) && cs.advance(8) && cs.fetch_int256_to(64, val) && set_int(std::move(val));
+      long long val;
+      return !(mode & 1) && cs.advance(8) && cs.fetch_long_bool(64, val) && set_small_int(val);
     }
     case 2: {
       t = (int)cs.prefetch_ulong(16) & 0x1ff;
@@ -88,9 +88,15 @@ class StackEntry {
 
  private:
   RefAny ref;
+  // integers in [small_int_min, small_int_max] are kept here with a null ref, so that arithmetic on them does not
+  // allocate; as_int() converts them to RefInt256 on demand
+  long long small_value{0};
   Type tp;
+  bool small{false};
 
  public:
+  static constexpr long long small_int_min = -(1LL << 62);
+  static constexpr long long small_int_max = (1LL << 62) - 1;
   StackEntry() : ref(), tp(t_null) {
   }
   ~StackEntry() {
@@ -116,33 +122,54 @@ class StackEntry {
   StackEntry(const std::vector<StackEntry>& tuple_components);
   StackEntry(std::vector<StackEntry>&& tuple_components);
   StackEntry(Ref<Atom> atom_ref);
-  StackEntry(const StackEntry& se) : ref(se.ref), tp(se.tp) {
+  StackEntry(const StackEntry& se) : ref(se.ref), small_value(se.small_value), tp(se.tp), small(se.small) {
   }
-  StackEntry(StackEntry&& se) noexcept : ref(std::move(se.ref)), tp(se.tp) {
+  StackEntry(StackEntry&& se) noexcept
+      : ref(std::move(se.ref)), small_value(se.small_value), tp(se.tp), small(se.small) {
     se.tp = t_null;
+    se.small = false;
   }
   template <class T>
   StackEntry(from_object_t, Ref<T> obj_ref) : ref(std::move(obj_ref)), tp(t_object) {
   }
   StackEntry& operator=(const StackEntry& se) {
     ref = se.ref;
+    small_value = se.small_value;
     tp = se.tp;
+    small = se.small;
     return *this;
   }
   StackEntry& operator=(StackEntry&& se) {
     ref = std::move(se.ref);
+    small_value = se.small_value;
     tp = se.tp;
+    small = se.small;
     se.tp = t_null;
+    se.small = false;
     return *this;
   }
   StackEntry& clear() {
     ref.clear();
     tp = t_null;
+    small = false;
     return *this;
   }
   bool set_int(td::RefInt256 value) {
     return set(t_int, std::move(value));
   }
+  bool set_small_int(long long value) {
+    if (!fits_small_int(value)) {
+      return set_int(td::make_refint(value));
+    }
+    ref.clear();
+    small_value = value;
+    tp = t_int;
+    small = true;
+    return true;
+  }
+  static bool fits_small_int(long long value) {
+    return value >= small_int_min && value <= small_int_max;
+  }
   bool empty() const {
     return tp == t_null;
   }
@@ -155,6 +182,12 @@ class StackEntry {
   bool is_int() const {
     return tp == t_int;
   }
+  bool is_small_int() const {
+    return small;
+  }
+  long long small_int_value() const {
+    return small_value;
+  }
   bool is_cell() const {
     return tp == t_cell;
   }
@@ -172,13 +205,15 @@ class StackEntry {
   }
   void swap(StackEntry& se) {
     ref.swap(se.ref);
+    std::swap(small_value, se.small_value);
     std::swap(tp, se.tp);
+    std::swap(small, se.small);
   }
   bool operator==(const StackEntry& other) const {
-    return tp == other.tp && ref == other.ref;
+    return tp == other.tp && ref == other.ref && small == other.small && (!small || small_value == other.small_value);
   }
   bool operator!=(const StackEntry& other) const {
-    return !(tp == other.tp && ref == other.ref);
+    return !(*this == other);
   }
   Type type() const {
     return tp;
@@ -216,6 +251,7 @@ class StackEntry {
   }
   bool set(Type _tp, RefAny _ref) {
     tp = _tp;
+    small = false;
     ref = std::move(_ref);
     return ref.not_null() || tp == t_null;
   }
@@ -236,10 +272,10 @@ class StackEntry {
     }
   }
   td::RefInt256 as_int() const& {
-    return as<td::CntInt256, t_int>();
+    return small ? td::make_refint(small_value) : as<td::CntInt256, t_int>();
   }
   td::RefInt256 as_int() && {
-    return move_as<td::CntInt256, t_int>();
+    return small ? td::make_refint(small_value) : move_as<td::CntInt256, t_int>();
   }
   Ref<Cell> as_cell() const& {
     return as<Cell, t_cell>();
@@ -421,6 +457,19 @@ class Stack : public td::CntObject {
   bool at_least(int req, Args... args) const {
     return at_least(req) && at_least(args...);
   }
+  // true if the top cnt entries are integers kept inline (see StackEntry::set_small_int()), so that arithmetic
+  // instructions may operate on them without allocating
+  bool top_small_ints(int cnt) const {
+    if (!at_least(cnt)) {
+      return false;
+    }
+    for (int i = 0; i < cnt; i++) {
+      if (!(*this)[i].is_small_int()) {
+        return false;
+      }
+    }
+    return true;
+  }
   bool more_than(int req) const {
     return depth() > req;
   }
@@ -506,6 +506,8 @@ int VmState::run() {
     // throw VmError{Excno::fatal, "cannot run an uninitialized VM"};
     return (int)Excno::fatal;  // no ~ for unhandled exceptions
   }
+  // objects freed during the run are reused for new ones instead of going back to the global allocator
+  td::CntPool::Scope pool_scope;
   int res = 0;
   bool restore_parent = false;
   while (true) {
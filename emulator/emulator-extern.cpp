@@ -9,6 +9,13 @@
 #include "tvm-emulator.hpp"
 #include "crypto/vm/stack.hpp"
 #include "crypto/vm/memo.h"
+#include "crypto/common/refcnt.hpp"
+#include "td/utils/port/thread.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
 
 td::Result<td::Ref<vm::Cell>> boc_b64_to_cell(const char *boc) {
   TRY_RESULT_PREFIX(boc_decoded, td::base64_decode(td::Slice(boc)), "Can't decode base64 boc: ");
@@ -80,25 +87,16 @@ void *transaction_emulator_create(const char *config_params_boc, int vm_log_verb
   return new emulator::TransactionEmulator(global_config_res.move_as_ok(), vm_log_verbosity);
 }
 
-const char *transaction_emulator_emulate_transaction(void *transaction_emulator, const char *shard_account_boc, const char *message_boc) {
-  auto emulator = static_cast<emulator::TransactionEmulator *>(transaction_emulator);
-  
-  auto message_cell_r = boc_b64_to_cell(message_boc);
-  if (message_cell_r.is_error()) {
-    ERROR_RESPONSE(PSTRING() << "Can't deserialize message boc: " << message_cell_r.move_as_error());
-  }
-  auto message_cell = message_cell_r.move_as_ok();
+td::Result<block::Account> unpack_shard_account(td::Ref<vm::Cell> shard_account_cell, td::Ref<vm::Cell> message_cell,
+                                                ton::UnixTime now,
+                                                const std::function<bool(const ton::StdSmcAddress&)>& is_special_smc) {
   auto message_cs = vm::load_cell_slice(message_cell);
   int msg_tag = block::gen::t_CommonMsgInfo.get_tag(message_cs);
 
-  auto shard_account_cell = boc_b64_to_cell(shard_account_boc);
-  if (shard_account_cell.is_error()) {
-    ERROR_RESPONSE(PSTRING() << "Can't deserialize shard account boc: " << shard_account_cell.move_as_error());
-  }
-  auto shard_account_slice = vm::load_cell_slice(shard_account_cell.ok_ref());
+  auto shard_account_slice = vm::load_cell_slice(shard_account_cell);
   block::gen::ShardAccount::Record shard_account;
   if (!tlb::unpack(shard_account_slice, shard_account)) {
-    ERROR_RESPONSE(PSTRING() << "Can't unpack shard account cell");
+    return td::Status::Error("Can't unpack shard account cell");
   }
 
   td::Ref<vm::CellSlice> addr_slice;
@@ -108,53 +106,77 @@ const char *transaction_emulator_emulate_transaction(void *transaction_emulator,
     if (msg_tag == block::gen::CommonMsgInfo::ext_in_msg_info) {
       block::gen::CommonMsgInfo::Record_ext_in_msg_info info;
       if (!tlb::unpack(message_cs, info)) {
-        ERROR_RESPONSE(PSTRING() <<  "Can't unpack inbound external message");
+        return td::Status::Error("Can't unpack inbound external message");
       }
       addr_slice = std::move(info.dest);
     }
     else if (msg_tag == block::gen::CommonMsgInfo::int_msg_info) {
       block::gen::CommonMsgInfo::Record_int_msg_info info;
       if (!tlb::unpack(message_cs, info)) {
-          ERROR_RESPONSE(PSTRING() << "Can't unpack inbound internal message");
+        return td::Status::Error("Can't unpack inbound internal message");
       }
       addr_slice = std::move(info.dest);
     } else {
-      ERROR_RESPONSE(PSTRING() << "Only ext in and int message are supported");
+      return td::Status::Error("Only ext in and int message are supported");
     }
   } else if (block::gen::t_Account.get_tag(account_slice) == block::gen::Account::account) {
     block::gen::Account::Record_account account_record;
     if (!tlb::unpack(account_slice, account_record)) {
-      ERROR_RESPONSE(PSTRING() << "Can't unpack account cell");
+      return td::Status::Error("Can't unpack account cell");
     }
     addr_slice = std::move(account_record.addr);
   } else {
-    ERROR_RESPONSE(PSTRING() << "Can't parse account cell");
+    return td::Status::Error("Can't parse account cell");
   }
   ton::WorkchainId wc;
   ton::StdSmcAddress addr;
   if (!block::tlb::t_MsgAddressInt.extract_std_address(addr_slice, wc, addr)) {
-    ERROR_RESPONSE(PSTRING() << "Can't extract account address");
+    return td::Status::Error("Can't extract account address");
   }
 
   auto account = block::Account(wc, addr.bits());
-  ton::UnixTime now = emulator->get_unixtime();
-  if (!now) {
-    now = (unsigned)std::time(nullptr);
-  }
-  bool is_special = wc == ton::masterchainId && emulator->get_config().is_special_smartcontract(addr);
+  bool is_special = wc == ton::masterchainId && is_special_smc(addr);
   if (account_exists) {
-    if (!account.unpack(vm::load_cell_slice_ref(shard_account_cell.move_as_ok()), now, is_special)) {
-      ERROR_RESPONSE(PSTRING() << "Can't unpack shard account");
+    if (!account.unpack(vm::load_cell_slice_ref(std::move(shard_account_cell)), now, is_special)) {
+      return td::Status::Error("Can't unpack shard account");
     }
   } else {
     if (!account.init_new(now)) {
-      ERROR_RESPONSE(PSTRING() << "Can't init new account");
+      return td::Status::Error("Can't init new account");
     }
     account.last_trans_lt_ = shard_account.last_trans_lt;
     account.last_trans_hash_ = shard_account.last_trans_hash;
   }
+  return account;
+}
 
-  auto result = emulator->emulate_transaction(std::move(account), message_cell, now, 0, block::transaction::Transaction::tr_ord);
+const char *transaction_emulator_emulate_transaction(void *transaction_emulator, const char *shard_account_boc, const char *message_boc) {
+  auto emulator = static_cast<emulator::TransactionEmulator *>(transaction_emulator);
+  
+  auto message_cell_r = boc_b64_to_cell(message_boc);
+  if (message_cell_r.is_error()) {
+    ERROR_RESPONSE(PSTRING() << "Can't deserialize message boc: " << message_cell_r.move_as_error());
+  }
+  auto message_cell = message_cell_r.move_as_ok();
+
+  auto shard_account_cell = boc_b64_to_cell(shard_account_boc);
+  if (shard_account_cell.is_error()) {
+    ERROR_RESPONSE(PSTRING() << "Can't deserialize shard account boc: " << shard_account_cell.move_as_error());
+  }
+
+  ton::UnixTime now = emulator->get_unixtime();
+  if (!now) {
+    now = (unsigned)std::time(nullptr);
+  }
+  auto account_r = unpack_shard_account(shard_account_cell.move_as_ok(), message_cell, now,
+                                        [&](const ton::StdSmcAddress &addr) {
+                                          return emulator->get_config().is_special_smartcontract(addr);
+                                        });
+  if (account_r.is_error()) {
+    ERROR_RESPONSE(account_r.move_as_error().message().str());
+  }
+
+  auto result = emulator->emulate_transaction(account_r.move_as_ok(), message_cell, now, 0, block::transaction::Transaction::tr_ord);
   if (result.is_error()) {
     ERROR_RESPONSE(PSTRING() << "Emulate transaction failed: " << result.move_as_error());
   }
@@ -193,6 +215,189 @@ const char *transaction_emulator_emulate_transaction(void *transaction_emulator,
                           std::move(actions_boc_b64), emulation_success.elapsed_time);
 }
 
+namespace {
+
+void store_uint32(std::string &out, td::uint32 x) {
+  for (int i = 0; i < 4; i++) {
+    out.push_back(static_cast<char>((x >> (8 * i)) & 0xff));
+  }
+}
+
+void store_bytes(std::string &out, td::Slice data) {
+  store_uint32(out, static_cast<td::uint32>(data.size()));
+  out.append(data.data(), data.size());
+}
+
+void store_double(std::string &out, double x) {
+  td::uint64 bits;
+  static_assert(sizeof(bits) == sizeof(x), "unexpected double size");
+  std::memcpy(&bits, &x, sizeof(x));
+  store_uint32(out, static_cast<td::uint32>(bits));
+  store_uint32(out, static_cast<td::uint32>(bits >> 32));
+}
+
+bool fetch_bytes(td::Slice &data, td::Slice &res) {
+  if (data.size() < 4) {
+    return false;
+  }
+  td::uint32 len = 0;
+  for (int i = 0; i < 4; i++) {
+    len |= static_cast<td::uint32>(data.ubegin()[i]) << (8 * i);
+  }
+  data.remove_prefix(4);
+  if (data.size() < len) {
+    return false;
+  }
+  res = data.substr(0, len);
+  data.remove_prefix(len);
+  return true;
+}
+
+td::Result<td::BufferSlice> cell_to_boc(td::Ref<vm::Cell> cell) {
+  return vm::std_boc_serialize(std::move(cell), vm::BagOfCells::Mode::WithCRC32C);
+}
+
+enum BatchResultType : td::uint8 { batch_error = 0, batch_success = 1, batch_external_not_accepted = 2 };
+
+struct BatchEmulationContext {
+  const emulator::TransactionEmulator *emulator;
+  const emulator::TransactionEmulator::PreparedConfig *masterchain_config;
+  const emulator::TransactionEmulator::PreparedConfig *basechain_config;
+  std::vector<ton::StdSmcAddress> special_smcs;  // sorted
+  ton::UnixTime now;
+};
+
+td::Status emulate_batch_entry(const BatchEmulationContext &ctx, td::Slice shard_account_boc, td::Slice message_boc,
+                               std::string &out) {
+  TRY_RESULT_PREFIX(message_cell, vm::std_boc_deserialize(message_boc), "Can't deserialize message boc: ");
+  TRY_RESULT_PREFIX(shard_account_cell, vm::std_boc_deserialize(shard_account_boc),
+                    "Can't deserialize shard account boc: ");
+  TRY_RESULT(account, unpack_shard_account(std::move(shard_account_cell), message_cell, ctx.now,
+                                           [&](const ton::StdSmcAddress &addr) {
+                                             return std::binary_search(ctx.special_smcs.begin(),
+                                                                       ctx.special_smcs.end(), addr);
+                                           }));
+  auto &config = account.workchain == ton::masterchainId ? *ctx.masterchain_config : *ctx.basechain_config;
+  TRY_RESULT_PREFIX(emulation_result,
+                    ctx.emulator->emulate_transaction(config, std::move(account), message_cell, 0,
+                                                      block::transaction::Transaction::tr_ord),
+                    "Emulate transaction failed: ");
+
+  auto external_not_accepted =
+      dynamic_cast<emulator::TransactionEmulator::EmulationExternalNotAccepted *>(emulation_result.get());
+  if (external_not_accepted) {
+    out.push_back(static_cast<char>(batch_external_not_accepted));
+    store_double(out, external_not_accepted->elapsed_time);
+    store_uint32(out, static_cast<td::uint32>(external_not_accepted->vm_exit_code));
+    store_bytes(out, external_not_accepted->vm_log);
+    return td::Status::OK();
+  }
+
+  auto &emulation_success = dynamic_cast<emulator::TransactionEmulator::EmulationSuccess &>(*emulation_result);
+  TRY_RESULT_PREFIX(trans_boc, cell_to_boc(std::move(emulation_success.transaction)),
+                    "Can't serialize Transaction to boc ");
+  auto new_shard_account_cell = vm::CellBuilder().store_ref(emulation_success.account.total_state)
+                               .store_bits(emulation_success.account.last_trans_hash_.as_bitslice())
+                               .store_long(emulation_success.account.last_trans_lt_).finalize();
+  TRY_RESULT_PREFIX(new_shard_account_boc, cell_to_boc(std::move(new_shard_account_cell)),
+                    "Can't serialize ShardAccount to boc ");
+  td::BufferSlice actions_boc;
+  if (emulation_success.actions.not_null()) {
+    TRY_RESULT_PREFIX_ASSIGN(actions_boc, cell_to_boc(std::move(emulation_success.actions)),
+                             "Can't serialize actions list cell to boc ");
+  }
+
+  out.push_back(static_cast<char>(batch_success));
+  store_double(out, emulation_success.elapsed_time);
+  store_bytes(out, trans_boc);
+  store_bytes(out, new_shard_account_boc);
+  store_bytes(out, actions_boc);
+  store_bytes(out, emulation_success.vm_log);
+  return td::Status::OK();
+}
+
+}  // namespace
+
+const char *transaction_emulator_emulate_transactions_batch(void *transaction_emulator, const char *batch,
+                                                            size_t batch_len, int threads, size_t *result_len) {
+  auto emulator = static_cast<emulator::TransactionEmulator *>(transaction_emulator);
+
+  std::vector<std::pair<td::Slice, td::Slice>> entries;
+  td::Slice data(batch, batch_len);
+  while (!data.empty()) {
+    td::Slice shard_account_boc, message_boc;
+    if (!fetch_bytes(data, shard_account_boc) || !fetch_bytes(data, message_boc)) {
+      LOG(ERROR) << "Malformed emulation batch";
+      return nullptr;
+    }
+    entries.emplace_back(shard_account_boc, message_boc);
+  }
+
+  BatchEmulationContext ctx;
+  ctx.emulator = emulator;
+  ctx.now = emulator->get_unixtime();
+  if (!ctx.now) {
+    ctx.now = (unsigned)std::time(nullptr);
+  }
+  // fetch_config_params() only distinguishes the masterchain from all other workchains
+  auto masterchain_config = emulator->prepare_config(ton::masterchainId, ctx.now);
+  auto basechain_config = emulator->prepare_config(ton::basechainId, ctx.now);
+  auto special_smcs = emulator->get_config().get_special_smartcontracts();
+  if (masterchain_config.is_error() || basechain_config.is_error() || special_smcs.is_error()) {
+    LOG(ERROR) << "Can't prepare config params for emulation";
+    return nullptr;
+  }
+  ctx.masterchain_config = masterchain_config.ok().get();
+  ctx.basechain_config = basechain_config.ok().get();
+  ctx.special_smcs = special_smcs.move_as_ok();
+  std::sort(ctx.special_smcs.begin(), ctx.special_smcs.end());
+
+  std::vector<std::string> results(entries.size());
+  std::atomic<size_t> next_idx{0};
+  auto run = [&] {
+    while (true) {
+      size_t idx = next_idx.fetch_add(1);
+      if (idx >= entries.size()) {
+        break;
+      }
+      auto S = emulate_batch_entry(ctx, entries[idx].first, entries[idx].second, results[idx]);
+      if (S.is_error()) {
+        results[idx].clear();
+        results[idx].push_back(static_cast<char>(batch_error));
+        store_bytes(results[idx], S.message());
+      }
+    }
+  };
+#if !TD_THREAD_UNSUPPORTED
+  if (threads <= 0) {
+    threads = td::thread::hardware_concurrency();
+  }
+  std::vector<td::thread> workers;
+  for (int i = 1; i < threads && static_cast<size_t>(i) < entries.size(); i++) {
+    workers.emplace_back(run);
+  }
+  run();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+#else
+  run();
+#endif
+
+  std::string out;
+  store_uint32(out, static_cast<td::uint32>(entries.size()));
+  for (auto &result : results) {
+    out += result;
+  }
+  char *res = static_cast<char *>(malloc(out.size()));
+  if (res == nullptr) {
+    return nullptr;
+  }
+  std::memcpy(res, out.data(), out.size());
+  *result_len = out.size();
+  return res;
+}
+
 const char *transaction_emulator_emulate_tick_tock_transaction(void *transaction_emulator, const char *shard_account_boc, bool is_tock) {
   auto emulator = static_cast<emulator::TransactionEmulator *>(transaction_emulator);
   
@@ -386,6 +591,10 @@ bool emulator_set_verbosity_level(int verbosity_level) {
   return false;
 }
 
+void emulator_set_object_pool_enabled(bool enabled) {
+  td::CntPool::set_enabled(enabled);
+}
+
 void *tvm_emulator_create(const char *code, const char *data, int vm_log_verbosity) {
   auto code_cell = boc_b64_to_cell(code);
   if (code_cell.is_error()) {
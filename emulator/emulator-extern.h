@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include "emulator_export.h"
 
@@ -104,6 +105,26 @@ EMULATOR_EXPORT bool transaction_emulator_set_prev_blocks_info(void *transaction
  */
 EMULATOR_EXPORT const char *transaction_emulator_emulate_transaction(void *transaction_emulator, const char *shard_account_boc, const char *message_boc);
 
+/**
+ * @brief Emulate transactions of many independent accounts at once
+ * Config params are fetched once for the whole batch, entries are processed by a pool of threads.
+ * All integers are little-endian, "bytes" is a uint32 length followed by the data.
+ * @param transaction_emulator Pointer to TransactionEmulator object
+ * @param batch Sequence of entries, each is (bytes: BoC serialized ShardAccount, bytes: BoC serialized inbound Message)
+ * @param batch_len Length of batch in bytes
+ * @param threads Number of threads to use, 0 - number of hardware threads
+ * @param result_len Receives the length of the result
+ * @return Buffer allocated with malloc() (the caller must free() it) or nullptr in case of malformed batch. It contains
+ * uint32 number of entries followed by results of the entries in the same order. Each result starts with uint8 type:
+ * 0 - error: bytes error description;
+ * 1 - success: float64 elapsed time, bytes Transaction BoC, bytes new ShardAccount BoC,
+ *     bytes actions BoC (OutList n, empty if there are no actions), bytes VM log;
+ * 2 - external message not accepted: float64 elapsed time, int32 VM exit code, bytes VM log.
+ */
+EMULATOR_EXPORT const char *transaction_emulator_emulate_transactions_batch(void *transaction_emulator,
+                                                                            const char *batch, size_t batch_len,
+                                                                            int threads, size_t *result_len);
+
 /**
  * @brief Emulate tick tock transaction
  * @param transaction_emulator Pointer to TransactionEmulator object
@@ -139,6 +160,12 @@ EMULATOR_EXPORT void transaction_emulator_destroy(void *transaction_emulator);
  */
 EMULATOR_EXPORT bool emulator_set_verbosity_level(int verbosity_level);
 
+/**
+ * @brief Enable or disable reuse of memory of freed TVM objects during each VM run (disabled by default)
+ * @param enabled Whether the object pool is used by subsequent emulations
+ */
+EMULATOR_EXPORT void emulator_set_object_pool_enabled(bool enabled);
+
 /**
  * @brief Create TVM emulator
  * @param code_boc Base64 encoded BoC serialized smart contract code cell
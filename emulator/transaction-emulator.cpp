@@ -11,13 +11,6 @@ namespace emulator {
 td::Result<std::unique_ptr<TransactionEmulator::EmulationResult>> TransactionEmulator::emulate_transaction(
     block::Account&& account, td::Ref<vm::Cell> msg_root, ton::UnixTime utime, ton::LogicalTime lt, int trans_type) {
 
-    td::Ref<vm::Cell> old_mparams;
-    std::vector<block::StoragePrices> storage_prices;
-    block::StoragePhaseConfig storage_phase_cfg{&storage_prices};
-    block::ComputePhaseConfig compute_phase_cfg;
-    block::ActionPhaseConfig action_phase_cfg;
-    td::RefInt256 masterchain_create_fee, basechain_create_fee;
-    
     if (!utime) {
       utime = unixtime_;
     }
@@ -25,17 +18,39 @@ td::Result<std::unique_ptr<TransactionEmulator::EmulationResult>> TransactionEmu
       utime = (unsigned)std::time(nullptr);
     }
 
-    auto fetch_res = block::FetchConfigParams::fetch_config_params(config_, prev_blocks_info_, &old_mparams,
-                                                                   &storage_prices, &storage_phase_cfg,
-                                                                   &rand_seed_, &compute_phase_cfg,
-                                                                   &action_phase_cfg, &masterchain_create_fee,
-                                                                   &basechain_create_fee, account.workchain, utime);
+    TRY_RESULT(config, prepare_config(account.workchain, utime));
+    return emulate_transaction(*config, std::move(account), std::move(msg_root), lt, trans_type);
+}
+
+td::Result<std::unique_ptr<TransactionEmulator::PreparedConfig>> TransactionEmulator::prepare_config(
+    ton::WorkchainId wc, ton::UnixTime utime) {
+    auto config = std::make_unique<PreparedConfig>();
+    config->workchain = wc;
+    config->utime = utime;
+
+    auto fetch_res = block::FetchConfigParams::fetch_config_params(config_, prev_blocks_info_, &config->old_mparams,
+                                                                   &config->storage_prices, &config->storage_phase_cfg,
+                                                                   &rand_seed_, &config->compute_phase_cfg,
+                                                                   &config->action_phase_cfg,
+                                                                   &config->masterchain_create_fee,
+                                                                   &config->basechain_create_fee, wc, utime);
     if(fetch_res.is_error()) {
         return fetch_res.move_as_error_prefix("cannot fetch config params ");
     }
 
     TRY_STATUS(vm::init_vm(debug_enabled_));
 
+    config->compute_phase_cfg.libraries = std::make_unique<vm::Dictionary>(libraries_);
+    config->compute_phase_cfg.ignore_chksig = ignore_chksig_;
+    config->compute_phase_cfg.with_vm_log = true;
+    config->compute_phase_cfg.vm_log_verbosity = vm_log_verbosity_;
+    return config;
+}
+
+td::Result<std::unique_ptr<TransactionEmulator::EmulationResult>> TransactionEmulator::emulate_transaction(
+    const PreparedConfig& config, block::Account&& account, td::Ref<vm::Cell> msg_root, ton::LogicalTime lt,
+    int trans_type) const {
+
     if (!lt) {
       lt = lt_;
     }
@@ -44,13 +59,13 @@ td::Result<std::unique_ptr<TransactionEmulator::EmulationResult>> TransactionEmu
     }
     account.block_lt = lt - lt % block::ConfigInfo::get_lt_align();
 
-    compute_phase_cfg.libraries = std::make_unique<vm::Dictionary>(libraries_);
-    compute_phase_cfg.ignore_chksig = ignore_chksig_;
-    compute_phase_cfg.with_vm_log = true;
-    compute_phase_cfg.vm_log_verbosity = vm_log_verbosity_;
+    // the configs are copied, since transactions of other threads may use the same PreparedConfig
+    block::StoragePhaseConfig storage_phase_cfg = config.storage_phase_cfg;
+    block::ComputePhaseConfig compute_phase_cfg = config.compute_phase_cfg.clone();
+    block::ActionPhaseConfig action_phase_cfg = config.action_phase_cfg;
 
     double start_time = td::Time::now();
-    auto res = create_transaction(msg_root, &account, utime, lt, trans_type,
+    auto res = create_transaction(msg_root, &account, config.utime, lt, trans_type,
                                                     &storage_phase_cfg, &compute_phase_cfg,
                                                     &action_phase_cfg);
     double elapsed = td::Time::now() - start_time;
@@ -170,7 +185,7 @@ td::Result<std::unique_ptr<block::transaction::Transaction>> TransactionEmulator
                                                          ton::UnixTime utime, ton::LogicalTime lt, int trans_type,
                                                          block::StoragePhaseConfig* storage_phase_cfg,
                                                          block::ComputePhaseConfig* compute_phase_cfg,
-                                                         block::ActionPhaseConfig* action_phase_cfg) {
+                                                         block::ActionPhaseConfig* action_phase_cfg) const {
   bool external{false}, ihr_delivered{false}, need_credit_phase{false};
 
   if (msg_root.not_null()) {
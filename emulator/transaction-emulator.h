@@ -56,6 +56,19 @@ public:
     block::Account account;
   };
 
+  // Config params of one workchain fetched once for many transactions. Emulation only reads them,
+  // so several threads may share one PreparedConfig.
+  struct PreparedConfig {
+    ton::WorkchainId workchain;
+    ton::UnixTime utime;
+    td::Ref<vm::Cell> old_mparams;
+    std::vector<block::StoragePrices> storage_prices;
+    block::StoragePhaseConfig storage_phase_cfg{&storage_prices};
+    block::ComputePhaseConfig compute_phase_cfg;
+    block::ActionPhaseConfig action_phase_cfg;
+    td::RefInt256 masterchain_create_fee, basechain_create_fee;
+  };
+
   const block::Config& get_config() {
     return config_;
   }
@@ -67,6 +80,11 @@ public:
   td::Result<std::unique_ptr<EmulationResult>> emulate_transaction(
       block::Account&& account, td::Ref<vm::Cell> msg_root, ton::UnixTime utime, ton::LogicalTime lt, int trans_type);
 
+  td::Result<std::unique_ptr<PreparedConfig>> prepare_config(ton::WorkchainId wc, ton::UnixTime utime);
+  td::Result<std::unique_ptr<EmulationResult>> emulate_transaction(
+      const PreparedConfig& config, block::Account&& account, td::Ref<vm::Cell> msg_root, ton::LogicalTime lt,
+      int trans_type) const;
+
   td::Result<EmulationSuccess> emulate_transaction(block::Account&& account, td::Ref<vm::Cell> original_trans);
   td::Result<EmulationChain> emulate_transactions_chain(block::Account&& account, std::vector<td::Ref<vm::Cell>>&& original_transactions);
 
@@ -87,6 +105,6 @@ private:
                                                          ton::UnixTime utime, ton::LogicalTime lt, int trans_type,
                                                          block::StoragePhaseConfig* storage_phase_cfg,
                                                          block::ComputePhaseConfig* compute_phase_cfg,
-                                                         block::ActionPhaseConfig* action_phase_cfg);
+                                                         block::ActionPhaseConfig* action_phase_cfg) const;
 };
 } // namespace emulator
@@ -27,6 +27,8 @@
 #include "common/errorcode.h"
 #include "keys.hpp"
 
+#include <algorithm>
+
 namespace ton {
 
 td::Result<std::unique_ptr<Encryptor>> Encryptor::create(const ton_api::PublicKey *id) {
@@ -90,6 +92,26 @@ td::Result<td::BufferSlice> EncryptorEd25519::encrypt(td::Slice data) {
   return std::move(msg);
 }
 
+std::vector<size_t> Encryptor::check_signatures(td::Span<SignatureCheck> batch, int threads) {
+  std::vector<td::Ed25519::SignatureCheck> ed25519_batch;
+  std::vector<size_t> ed25519_idx;
+  std::vector<size_t> bad;
+  for (size_t i = 0; i < batch.size(); i++) {
+    auto E = dynamic_cast<EncryptorEd25519 *>(batch[i].encryptor);
+    if (E) {
+      ed25519_batch.push_back(td::Ed25519::SignatureCheck{&E->public_key(), batch[i].message, batch[i].signature});
+      ed25519_idx.push_back(i);
+    } else if (batch[i].encryptor->check_signature(batch[i].message, batch[i].signature).is_error()) {
+      bad.push_back(i);
+    }
+  }
+  for (size_t i : td::Ed25519::verify_signatures(ed25519_batch, threads)) {
+    bad.push_back(ed25519_idx[i]);
+  }
+  std::sort(bad.begin(), bad.end());
+  return bad;
+}
+
 td::Status EncryptorEd25519::check_signature(td::Slice message, td::Slice signature) {
   return td::status_prefix(pub_.verify_signature(message, signature), "bad signature: ");
 }
@@ -20,6 +20,7 @@
 
 #include "td/actor/actor.h"
 #include "td/utils/buffer.h"
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 #include "td/actor/PromiseFuture.h"
 #include "auto/tl/ton_api.h"
@@ -28,10 +29,18 @@ namespace ton {
 
 class Encryptor {
  public:
+  struct SignatureCheck {
+    Encryptor *encryptor;
+    td::Slice message;
+    td::Slice signature;
+  };
+
   virtual td::Result<td::BufferSlice> encrypt(td::Slice data) = 0;
   virtual td::Status check_signature(td::Slice message, td::Slice signature) = 0;
   virtual ~Encryptor() = default;
   static td::Result<std::unique_ptr<Encryptor>> create(const ton_api::PublicKey *id);
+  // returns the indices of entries with wrong signatures, in increasing order
+  static std::vector<size_t> check_signatures(td::Span<SignatureCheck> batch, int threads = 1);
 };
 
 class Decryptor {
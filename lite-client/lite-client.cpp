@@ -923,6 +923,8 @@ bool TestNode::show_help(std::string command) {
          "status\tShow connection and local database status\n"
          "getaccount <addr> [<block-id-ext>]\tLoads the most recent state of specified account; <addr> is in "
          "[<workchain>:]<hex-or-base64-addr> format\n"
+         "getaccounts <addr> <addr>...\tLoads the most recent states of several accounts of one shard with a single "
+         "query and shows their balances\n"
          "saveaccount[code|data] <filename> <addr> [<block-id-ext>]\tSaves into specified file the most recent state "
          "(StateInit) or just the code or data of specified account; <addr> is in "
          "[<workchain>:]<hex-or-base64-addr> format\n"
@@ -1011,6 +1013,15 @@ bool TestNode::do_parse_line() {
            (seekeoln() ? get_account_state(workchain, addr, mc_last_id_, addr_ext, "", -1, prunned)
                        : parse_block_id_ext(blkid) && seekeoln() &&
                              get_account_state(workchain, addr, blkid, addr_ext, "", -1, prunned));
+  } else if (word == "getaccounts") {
+    std::vector<block::StdAddress> addrs;
+    while (!seekeoln()) {
+      if (!parse_account_addr(workchain, addr)) {
+        return false;
+      }
+      addrs.emplace_back(workchain, addr);
+    }
+    return get_account_states(std::move(addrs), mc_last_id_);
   } else if (word == "saveaccount" || word == "saveaccountcode" || word == "saveaccountdata") {
     std::string filename;
     int mode = ((word.c_str()[11] >> 1) & 3);
@@ -1222,6 +1233,77 @@ bool TestNode::get_account_state(ton::WorkchainId workchain, ton::StdSmcAddress
   });
 }
 
+bool TestNode::get_account_states(std::vector<block::StdAddress> addrs, ton::BlockIdExt ref_blkid) {
+  if (!ref_blkid.is_valid()) {
+    return set_error("must obtain last block information before making other queries");
+  }
+  if (!(ready_ && !client_.empty())) {
+    return set_error("server connection not ready");
+  }
+  if (addrs.empty()) {
+    return set_error("no accounts specified");
+  }
+  if (!(server_capabilities_ & 8)) {
+    return set_error("server does not support getAccountStates queries");
+  }
+  std::vector<ton::tl_object_ptr<ton::lite_api::liteServer_accountId>> accounts;
+  for (auto& addr : addrs) {
+    accounts.push_back(ton::create_tl_object<ton::lite_api::liteServer_accountId>(addr.workchain, addr.addr));
+  }
+  auto b = ton::serialize_tl_object(ton::create_tl_object<ton::lite_api::liteServer_getAccountStates>(
+                                        ton::create_tl_lite_block_id(ref_blkid), std::move(accounts)),
+                                    true);
+  LOG(INFO) << "requesting states of " << addrs.size() << " accounts with respect to " << ref_blkid.to_str();
+  return envelope_send_query(
+      std::move(b),
+      [Self = actor_id(this), addrs = std::move(addrs), ref_blkid](td::Result<td::BufferSlice> R) mutable {
+        if (R.is_error()) {
+          return;
+        }
+        auto F = ton::fetch_tl_object<ton::lite_api::liteServer_accountStates>(R.move_as_ok(), true);
+        if (F.is_error()) {
+          LOG(ERROR) << "cannot parse answer to liteServer.getAccountStates";
+          return;
+        }
+        auto f = F.move_as_ok();
+        block::AccountStates account_states;
+        account_states.blk = ton::create_block_id(f->id_);
+        account_states.shard_blk = ton::create_block_id(f->shardblk_);
+        account_states.shard_proof = std::move(f->shard_proof_);
+        account_states.proof = std::move(f->proof_);
+        account_states.states = std::move(f->states_);
+        td::actor::send_closure_later(Self, &TestNode::got_account_states, ref_blkid, std::move(addrs),
+                                      std::move(account_states));
+      });
+}
+
+void TestNode::got_account_states(ton::BlockIdExt ref_blk, std::vector<block::StdAddress> addrs,
+                                  block::AccountStates account_states) {
+  LOG(INFO) << "got states of " << addrs.size() << " accounts with respect to blocks " << account_states.blk.to_str()
+            << " and " << account_states.shard_blk.to_str();
+  auto r_infos = account_states.validate(ref_blk, addrs);
+  if (r_infos.is_error()) {
+    LOG(ERROR) << r_infos.error().message();
+    return;
+  }
+  auto infos = r_infos.move_as_ok();
+  auto out = td::TerminalIO::out();
+  for (size_t i = 0; i < addrs.size(); i++) {
+    out << addrs[i].workchain << ":" << addrs[i].addr.to_hex() << " ";
+    block::gen::Account::Record_account acc;
+    block::gen::AccountStorage::Record store;
+    block::CurrencyCollection balance;
+    if (infos[i].root.is_null()) {
+      out << "account state is empty" << std::endl;
+    } else if (tlb::unpack_cell(infos[i].root, acc) && tlb::csr_unpack(acc.storage, store) &&
+               balance.unpack(store.balance)) {
+      out << "balance " << balance.to_str() << " last transaction lt = " << infos[i].last_trans_lt << std::endl;
+    } else {
+      out << "error unpacking account state" << std::endl;
+    }
+  }
+}
+
 td::int64 TestNode::compute_method_id(std::string method) {
   td::int64 method_id;
   if (!convert_int64(method, method_id)) {
@@ -34,6 +34,7 @@
 #include "vm/stack.hpp"
 #include "block/block.h"
 #include "block/mc-config.h"
+#include "block/check-proof.h"
 #include "td/utils/filesystem.h"
 
 using td::Ref;
@@ -196,6 +197,9 @@ class TestNode : public td::actor::Actor {
                          td::BufferSlice shard_proof, td::BufferSlice proof, td::BufferSlice state,
                          ton::WorkchainId workchain, ton::StdSmcAddress addr, std::string filename, int mode,
                          bool prunned);
+  bool get_account_states(std::vector<block::StdAddress> addrs, ton::BlockIdExt ref_blkid);
+  void got_account_states(ton::BlockIdExt ref_blk, std::vector<block::StdAddress> addrs,
+                          block::AccountStates account_states);
   bool parse_run_method(ton::WorkchainId workchain, ton::StdSmcAddress addr, ton::BlockIdExt ref_blkid, int addr_ext,
                         std::string method_name, bool ext_mode);
   bool after_parse_run_method(ton::WorkchainId workchain, ton::StdSmcAddress addr, ton::BlockIdExt ref_blkid,
@@ -60,7 +60,7 @@ class RldpConnectionActor : public td::actor::Actor, private ConnectionCallback
   }
 
   void send_raw(td::BufferSlice data) override {
-    send_closure(adnl_, &adnl::Adnl::send_message, src_, dst_, std::move(data));
+    send_closure(adnl_, &adnl::Adnl::send_message_ex, src_, dst_, std::move(data), adnl::Adnl::SendFlags::bulk);
   }
   void receive(TransferId transfer_id, td::Result<td::BufferSlice> data) override {
     send_closure(rldp_, &RldpIn::receive_message, dst_, src_, transfer_id, std::move(data));
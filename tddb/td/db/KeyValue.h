@@ -18,7 +18,11 @@
 */
 #pragma once
 #include "td/utils/Status.h"
+#include "td/utils/Span.h"
 #include "td/utils/logging.h"
+
+#include <functional>
+
 namespace td {
 class KeyValueReader {
  public:
@@ -27,6 +31,42 @@ class KeyValueReader {
 
   virtual Result<GetStatus> get(Slice key, std::string &value) = 0;
   virtual Result<size_t> count(Slice prefix) = 0;
+
+  // Looks up all keys at once. On success, values->size() == keys.size() and the i-th status and value
+  // correspond to keys[i]; the value of a missing key is left empty.
+  virtual Result<std::vector<GetStatus>> get_multi(Span<Slice> keys, std::vector<std::string> *values) {
+    std::vector<GetStatus> res;
+    res.reserve(keys.size());
+    values->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      (*values)[i].clear();
+      TRY_RESULT(status, get(keys[i], (*values)[i]));
+      res.push_back(status);
+    }
+    return std::move(res);
+  }
+
+  // Calls f for every key in [begin, end) in increasing order, an empty end means no upper bound.
+  // Iteration stops at the first error returned by f, and the error is returned.
+  using ForEachFunction = std::function<Status(Slice key, Slice value)>;
+  virtual Status for_each_in_range(Slice begin, Slice end, const ForEachFunction &f) = 0;
+
+  Status for_each(Slice prefix, const ForEachFunction &f) {
+    auto end = prefix_end(prefix);
+    return for_each_in_range(prefix, end, f);
+  }
+
+  // the smallest key greater than all keys starting with prefix, or an empty string if there is none
+  static std::string prefix_end(Slice prefix) {
+    std::string end = prefix.str();
+    while (!end.empty() && static_cast<unsigned char>(end.back()) == 0xff) {
+      end.pop_back();
+    }
+    if (!end.empty()) {
+      end.back() = static_cast<char>(static_cast<unsigned char>(end.back()) + 1);
+    }
+    return end;
+  }
 };
 
 class PrefixedKeyValueReader : public KeyValueReader {
@@ -40,6 +80,21 @@ class PrefixedKeyValueReader : public KeyValueReader {
   Result<size_t> count(Slice prefix) override {
     return reader_->count(PSLICE() << prefix_ << prefix);
   }
+  Result<std::vector<GetStatus>> get_multi(Span<Slice> keys, std::vector<std::string> *values) override {
+    std::vector<std::string> prefixed_keys;
+    prefixed_keys.reserve(keys.size());
+    for (auto &key : keys) {
+      prefixed_keys.push_back(PSTRING() << prefix_ << key);
+    }
+    std::vector<Slice> prefixed_key_slices(prefixed_keys.begin(), prefixed_keys.end());
+    return reader_->get_multi(prefixed_key_slices, values);
+  }
+  Status for_each_in_range(Slice begin, Slice end, const ForEachFunction &f) override {
+    std::string prefixed_begin = PSTRING() << prefix_ << begin;
+    std::string prefixed_end = end.empty() ? prefix_end(prefix_) : PSTRING() << prefix_ << end;
+    return reader_->for_each_in_range(prefixed_begin, prefixed_end,
+                                      [&](Slice key, Slice value) { return f(key.substr(prefix_.size()), value); });
+  }
 
  private:
   std::shared_ptr<KeyValueReader> reader_;
@@ -83,6 +138,21 @@ class PrefixedKeyValue : public KeyValue {
   Result<size_t> count(Slice prefix) override {
     return kv_->count(PSLICE() << prefix_ << prefix);
   }
+  Result<std::vector<GetStatus>> get_multi(Span<Slice> keys, std::vector<std::string> *values) override {
+    std::vector<std::string> prefixed_keys;
+    prefixed_keys.reserve(keys.size());
+    for (auto &key : keys) {
+      prefixed_keys.push_back(PSTRING() << prefix_ << key);
+    }
+    std::vector<Slice> prefixed_key_slices(prefixed_keys.begin(), prefixed_keys.end());
+    return kv_->get_multi(prefixed_key_slices, values);
+  }
+  Status for_each_in_range(Slice begin, Slice end, const ForEachFunction &f) override {
+    std::string prefixed_begin = PSTRING() << prefix_ << begin;
+    std::string prefixed_end = end.empty() ? prefix_end(prefix_) : PSTRING() << prefix_ << end;
+    return kv_->for_each_in_range(prefixed_begin, prefixed_end,
+                                  [&](Slice key, Slice value) { return f(key.substr(prefix_.size()), value); });
+  }
   Status set(Slice key, Slice value) override {
     return kv_->set(PSLICE() << prefix_ << key, value);
   }
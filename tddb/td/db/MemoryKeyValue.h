@@ -28,6 +28,7 @@ class MemoryKeyValue : public KeyValue {
   Status set(Slice key, Slice value) override;
   Status erase(Slice key) override;
   Result<size_t> count(Slice prefix) override;
+  Status for_each_in_range(Slice begin, Slice end, const ForEachFunction &f) override;
 
   Status begin_write_batch() override;
   Status commit_write_batch() override;
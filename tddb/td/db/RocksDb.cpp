@@ -19,12 +19,17 @@
 #include "td/db/RocksDb.h"
 
 #include "rocksdb/db.h"
+#include "rocksdb/filter_policy.h"
 #include "rocksdb/table.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/write_batch.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "rocksdb/utilities/transaction.h"
 
+#include "td/utils/misc.h"
+
+#include <limits>
+
 namespace td {
 namespace {
 static Status from_rocksdb(rocksdb::Status status) {
@@ -39,8 +44,107 @@ static Slice from_rocksdb(rocksdb::Slice slice) {
 static rocksdb::Slice to_rocksdb(Slice slice) {
   return rocksdb::Slice(slice.data(), slice.size());
 }
+static rocksdb::CompressionType to_rocksdb(RocksDbOptions::Compression compression) {
+  switch (compression) {
+    case RocksDbOptions::Compression::None:
+      return rocksdb::kNoCompression;
+    case RocksDbOptions::Compression::Snappy:
+      return rocksdb::kSnappyCompression;
+    case RocksDbOptions::Compression::Lz4:
+      return rocksdb::kLZ4Compression;
+    case RocksDbOptions::Compression::Zstd:
+      return rocksdb::kZSTD;
+  }
+  UNREACHABLE();
+}
+static Result<size_t> parse_size(Slice str) {
+  size_t shift = 0;
+  if (!str.empty()) {
+    switch (str.back()) {
+      case 'K':
+        shift = 10;
+        break;
+      case 'M':
+        shift = 20;
+        break;
+      case 'G':
+        shift = 30;
+        break;
+    }
+  }
+  if (shift != 0) {
+    str.remove_suffix(1);
+  }
+  TRY_RESULT(size, to_integer_safe<size_t>(str));
+  if (size > (std::numeric_limits<size_t>::max() >> shift)) {
+    return Status::Error("Size is too big");
+  }
+  return size << shift;
+}
+static Result<bool> parse_flag(Slice str) {
+  if (str.empty() || str == "1" || str == "true") {
+    return true;
+  }
+  if (str == "0" || str == "false") {
+    return false;
+  }
+  return Status::Error(PSLICE() << "Invalid boolean value \"" << str << '"');
+}
 }  // namespace
 
+Result<RocksDbOptions> RocksDbOptions::parse(Slice str) {
+  RocksDbOptions res;
+  for (auto option : full_split(str, ',')) {
+    if (option.empty()) {
+      continue;
+    }
+    auto key_value = split(option, '=');
+    auto key = key_value.first;
+    auto value = key_value.second;
+    if (key == "cache_size") {
+      TRY_RESULT(size, parse_size(value));
+      res.block_cache = RocksDb::create_block_cache(size);
+    } else if (key == "filter") {
+      if (value == "none") {
+        res.filter = Filter::None;
+      } else if (value == "bloom") {
+        res.filter = Filter::Bloom;
+      } else if (value == "ribbon") {
+        res.filter = Filter::Ribbon;
+      } else {
+        return Status::Error(PSLICE() << "Unknown filter \"" << value << '"');
+      }
+    } else if (key == "filter_bits") {
+      res.filter_bits_per_key = to_double(value);
+      if (!(res.filter_bits_per_key > 0 && res.filter_bits_per_key <= 100)) {
+        return Status::Error(PSLICE() << "Invalid filter_bits \"" << value << '"');
+      }
+    } else if (key == "partitioned_index") {
+      TRY_RESULT_ASSIGN(res.partitioned_index, parse_flag(value));
+    } else if (key == "point_lookup") {
+      TRY_RESULT_ASSIGN(res.optimize_for_point_lookup, parse_flag(value));
+    } else if (key == "compression") {
+      res.compression_per_level.clear();
+      for (auto level : full_split(value, ':')) {
+        if (level == "none") {
+          res.compression_per_level.push_back(Compression::None);
+        } else if (level == "snappy") {
+          res.compression_per_level.push_back(Compression::Snappy);
+        } else if (level == "lz4") {
+          res.compression_per_level.push_back(Compression::Lz4);
+        } else if (level == "zstd") {
+          res.compression_per_level.push_back(Compression::Zstd);
+        } else {
+          return Status::Error(PSLICE() << "Unknown compression \"" << level << '"');
+        }
+      }
+    } else {
+      return Status::Error(PSLICE() << "Unknown RocksDb option \"" << key << '"');
+    }
+  }
+  return std::move(res);
+}
+
 Status RocksDb::destroy(Slice path) {
   return from_rocksdb(rocksdb::DestroyDB(path.str(), {}));
 }
@@ -59,17 +163,50 @@ RocksDb RocksDb::clone() const {
   return RocksDb{db_, statistics_};
 }
 
-Result<RocksDb> RocksDb::open(std::string path) {
+std::shared_ptr<rocksdb::Cache> RocksDb::create_block_cache(size_t capacity) {
+  return rocksdb::NewLRUCache(capacity);
+}
+
+Result<RocksDb> RocksDb::open(std::string path, RocksDbOptions db_options) {
   rocksdb::OptimisticTransactionDB *db;
   auto statistics = rocksdb::CreateDBStatistics();
   {
     rocksdb::Options options;
 
-    static auto cache = rocksdb::NewLRUCache(1 << 30);
+    static auto cache = create_block_cache(1 << 30);
 
     rocksdb::BlockBasedTableOptions table_options;
-    table_options.block_cache = cache;
+    table_options.block_cache = db_options.block_cache ? db_options.block_cache : cache;
+    if (db_options.optimize_for_point_lookup && db_options.filter == RocksDbOptions::Filter::None) {
+      db_options.filter = RocksDbOptions::Filter::Bloom;
+    }
+    switch (db_options.filter) {
+      case RocksDbOptions::Filter::None:
+        break;
+      case RocksDbOptions::Filter::Bloom:
+        table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(db_options.filter_bits_per_key, false));
+        break;
+      case RocksDbOptions::Filter::Ribbon:
+        table_options.filter_policy.reset(rocksdb::NewRibbonFilterPolicy(db_options.filter_bits_per_key));
+        break;
+    }
+    if (db_options.partitioned_index) {
+      table_options.index_type = rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+      table_options.partition_filters = table_options.filter_policy != nullptr;
+      table_options.cache_index_and_filter_blocks = true;
+      table_options.cache_index_and_filter_blocks_with_high_priority = true;
+      table_options.pin_top_level_index_and_filter = true;
+    }
+    if (db_options.optimize_for_point_lookup) {
+      table_options.data_block_index_type = rocksdb::BlockBasedTableOptions::kDataBlockBinaryAndHash;
+      table_options.data_block_hash_table_util_ratio = 0.75;
+      options.memtable_whole_key_filtering = true;
+      options.memtable_prefix_bloom_size_ratio = 0.02;
+    }
     options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+    for (auto compression : db_options.compression_per_level) {
+      options.compression_per_level.push_back(to_rocksdb(compression));
+    }
 
     options.manual_wal_flush = true;
     options.create_if_missing = true;
@@ -101,11 +238,22 @@ std::unique_ptr<KeyValueReader> RocksDb::snapshot() {
 }
 
 std::string RocksDb::stats() const {
-  std::string out;
-  db_->GetProperty("rocksdb.stats", &out);
-  //db_->GetProperty("rocksdb.cur-size-all-mem-tables", &out);
-  return out;
-  return statistics_->ToString();
+  auto hit_rate = [&](rocksdb::Tickers hit_ticker, rocksdb::Tickers miss_ticker) {
+    auto hits = statistics_->getTickerCount(hit_ticker);
+    auto total = hits + statistics_->getTickerCount(miss_ticker);
+    return PSTRING() << hits << "/" << total << " ("
+                     << (total == 0 ? 0.0 : 100.0 * static_cast<double>(hits) / static_cast<double>(total)) << "%)";
+  };
+  std::string out = PSTRING() << "Block cache hits: data "
+                              << hit_rate(rocksdb::BLOCK_CACHE_DATA_HIT, rocksdb::BLOCK_CACHE_DATA_MISS)
+                              << ", index " << hit_rate(rocksdb::BLOCK_CACHE_INDEX_HIT, rocksdb::BLOCK_CACHE_INDEX_MISS)
+                              << ", filter "
+                              << hit_rate(rocksdb::BLOCK_CACHE_FILTER_HIT, rocksdb::BLOCK_CACHE_FILTER_MISS)
+                              << "; bloom filter useful: " << statistics_->getTickerCount(rocksdb::BLOOM_FILTER_USEFUL)
+                              << "\n";
+  std::string db_stats;
+  db_->GetProperty("rocksdb.stats", &db_stats);
+  return out + db_stats;
 }
 
 Result<RocksDb::GetStatus> RocksDb::get(Slice key, std::string &value) {
@@ -129,6 +277,42 @@ Result<RocksDb::GetStatus> RocksDb::get(Slice key, std::string &value) {
   return from_rocksdb(status);
 }
 
+Result<std::vector<RocksDb::GetStatus>> RocksDb::get_multi(Span<Slice> keys, std::vector<std::string> *values) {
+  std::vector<rocksdb::Slice> rocksdb_keys;
+  rocksdb_keys.reserve(keys.size());
+  for (auto &key : keys) {
+    rocksdb_keys.push_back(to_rocksdb(key));
+  }
+  std::vector<rocksdb::PinnableSlice> pinnable_values(keys.size());
+  std::vector<rocksdb::Status> statuses(keys.size());
+  rocksdb::ReadOptions options;
+  if (snapshot_) {
+    options.snapshot = snapshot_.get();
+    db_->MultiGet(options, db_->DefaultColumnFamily(), keys.size(), rocksdb_keys.data(), pinnable_values.data(),
+                  statuses.data());
+  } else if (transaction_) {
+    transaction_->MultiGet(options, db_->DefaultColumnFamily(), keys.size(), rocksdb_keys.data(),
+                           pinnable_values.data(), statuses.data());
+  } else {
+    db_->MultiGet(options, db_->DefaultColumnFamily(), keys.size(), rocksdb_keys.data(), pinnable_values.data(),
+                  statuses.data());
+  }
+  std::vector<GetStatus> res(keys.size(), GetStatus::NotFound);
+  values->resize(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    auto &value = (*values)[i];
+    if (statuses[i].ok()) {
+      value.assign(pinnable_values[i].data(), pinnable_values[i].size());
+      res[i] = GetStatus::Ok;
+    } else if (statuses[i].code() == rocksdb::Status::kNotFound) {
+      value.clear();
+    } else {
+      return from_rocksdb(statuses[i]);
+    }
+  }
+  return std::move(res);
+}
+
 Status RocksDb::set(Slice key, Slice value) {
   if (write_batch_) {
     return from_rocksdb(write_batch_->Put(to_rocksdb(key), to_rocksdb(value)));
@@ -172,6 +356,30 @@ Result<size_t> RocksDb::count(Slice prefix) {
   return res;
 }
 
+Status RocksDb::for_each_in_range(Slice begin, Slice end, const ForEachFunction &f) {
+  rocksdb::ReadOptions options;
+  options.snapshot = snapshot_.get();
+  rocksdb::Slice upper_bound = to_rocksdb(end);
+  if (!end.empty()) {
+    options.iterate_upper_bound = &upper_bound;
+  }
+  std::unique_ptr<rocksdb::Iterator> iterator;
+  if (snapshot_ || !transaction_) {
+    iterator.reset(db_->NewIterator(options));
+  } else {
+    iterator.reset(transaction_->GetIterator(options));
+  }
+
+  for (iterator->Seek(to_rocksdb(begin)); iterator->Valid(); iterator->Next()) {
+    auto key = from_rocksdb(iterator->key());
+    if (!end.empty() && !(key < end)) {
+      break;
+    }
+    TRY_STATUS(f(key, from_rocksdb(iterator->value())));
+  }
+  return from_rocksdb(iterator->status());
+}
+
 Status RocksDb::begin_write_batch() {
   CHECK(!transaction_);
   write_batch_ = std::make_unique<rocksdb::WriteBatch>();
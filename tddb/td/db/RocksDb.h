@@ -26,6 +26,7 @@
 #include "td/utils/Status.h"
 
 namespace rocksdb {
+class Cache;
 class OptimisticTransactionDB;
 class Transaction;
 class WriteBatch;
@@ -34,16 +35,42 @@ class Statistics;
 }  // namespace rocksdb
 
 namespace td {
+struct RocksDbOptions {
+  // all dbs opened with the same block_cache share it; if empty, the process-wide 1 GB cache is used
+  std::shared_ptr<rocksdb::Cache> block_cache;
+
+  enum class Filter : int32 { None, Bloom, Ribbon };
+  Filter filter{Filter::None};
+  double filter_bits_per_key{10.0};
+
+  // two-level index and filter blocks, only the top level is kept pinned in the cache
+  bool partitioned_index{false};
+  // hash index in data blocks and whole key memtable filter, for dbs read by exact keys only (e.g. celldb)
+  bool optimize_for_point_lookup{false};
+
+  enum class Compression : int32 { None, Snappy, Lz4, Zstd };
+  // compression of levels L0, L1, ..., the last one is used for all deeper levels; empty means rocksdb default
+  std::vector<Compression> compression_per_level;
+
+  // Parses comma-separated options, e.g. "cache_size=4G,filter=ribbon,point_lookup,compression=none:lz4:zstd".
+  // Keys: cache_size (creates a new block cache), filter (none, bloom, ribbon), filter_bits, partitioned_index,
+  // point_lookup, compression (none, snappy, lz4 or zstd for each level, separated by ':')
+  static Result<RocksDbOptions> parse(Slice str);
+};
+
 class RocksDb : public KeyValue {
  public:
   static Status destroy(Slice path);
   RocksDb clone() const;
-  static Result<RocksDb> open(std::string path);
+  static Result<RocksDb> open(std::string path, RocksDbOptions options = {});
+  static std::shared_ptr<rocksdb::Cache> create_block_cache(size_t capacity);
 
   Result<GetStatus> get(Slice key, std::string &value) override;
   Status set(Slice key, Slice value) override;
   Status erase(Slice key) override;
   Result<size_t> count(Slice prefix) override;
+  Result<std::vector<GetStatus>> get_multi(Span<Slice> keys, std::vector<std::string> *values) override;
+  Status for_each_in_range(Slice begin, Slice end, const ForEachFunction &f) override;
 
   Status begin_write_batch() override;
   Status commit_write_batch() override;
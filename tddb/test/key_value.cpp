@@ -20,13 +20,17 @@
 
 #include "td/db/KeyValueAsync.h"
 #include "td/db/KeyValue.h"
+#include "td/db/MemoryKeyValue.h"
 #include "td/db/RocksDb.h"
 
 #include "td/utils/benchmark.h"
 #include "td/utils/buffer.h"
 #include "td/utils/optional.h"
+#include "td/utils/Random.h"
 #include "td/utils/UInt.h"
 
+#include <map>
+
 TEST(KeyValue, simple) {
   td::Slice db_name = "testdb";
   td::RocksDb::destroy(db_name).ignore();
@@ -65,6 +69,119 @@ TEST(KeyValue, simple) {
   ensure_value(as_slice(x), as_slice(x));
 };
 
+static void check_get_multi_and_range(td::KeyValue &kv) {
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 100; i++) {
+    auto key = PSTRING() << (i % 3 == 0 ? "a" : "b") << td::Random::fast(0, 1000);
+    if (i == 0) {
+      key = "b\xff\xff";
+    }
+    auto value = PSTRING() << "value" << i;
+    kv.set(key, value).ensure();
+    expected[key] = value;
+  }
+
+  std::vector<std::string> keys;
+  for (auto &it : expected) {
+    keys.push_back(it.first);
+    keys.push_back(it.first + "missing");
+  }
+  std::vector<td::Slice> key_slices(keys.begin(), keys.end());
+  std::vector<std::string> values;
+  auto statuses = kv.get_multi(key_slices, &values).move_as_ok();
+  ASSERT_EQ(keys.size(), statuses.size());
+  ASSERT_EQ(keys.size(), values.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (i % 2 == 0) {
+      ASSERT_EQ(td::int32(td::KeyValue::GetStatus::Ok), td::int32(statuses[i]));
+      ASSERT_EQ(expected[keys[i]], values[i]);
+    } else {
+      ASSERT_EQ(td::int32(td::KeyValue::GetStatus::NotFound), td::int32(statuses[i]));
+    }
+  }
+
+  auto check_range = [&](td::Slice begin, td::Slice end) {
+    std::vector<std::pair<std::string, std::string>> got;
+    kv.for_each_in_range(begin, end, [&](td::Slice key, td::Slice value) {
+        got.emplace_back(key.str(), value.str());
+        return td::Status::OK();
+      }).ensure();
+    std::vector<std::pair<std::string, std::string>> want;
+    for (auto it = expected.lower_bound(begin.str()); it != expected.end() && (end.empty() || it->first < end.str());
+         it++) {
+      want.emplace_back(it->first, it->second);
+    }
+    ASSERT_TRUE(want == got);
+  };
+  check_range("", "");
+  check_range("a", "b");
+  check_range("b5", "b7");
+  check_range("b", "");
+
+  size_t count = 0;
+  kv.for_each("b", [&](td::Slice key, td::Slice value) {
+      count++;
+      return td::Status::OK();
+    }).ensure();
+  ASSERT_EQ(kv.count("b").move_as_ok(), count);
+
+  count = 0;
+  auto status = kv.for_each("", [&](td::Slice key, td::Slice value) {
+    if (++count == 5) {
+      return td::Status::Error("stop");
+    }
+    return td::Status::OK();
+  });
+  ASSERT_TRUE(status.is_error());
+  ASSERT_EQ(5u, count);
+
+  td::PrefixedKeyValue prefixed(std::shared_ptr<td::KeyValue>(&kv, [](td::KeyValue *) {}), "b");
+  count = 0;
+  prefixed.for_each_in_range("", "", [&](td::Slice key, td::Slice value) {
+      ASSERT_EQ(expected["b" + key.str()], value.str());
+      count++;
+      return td::Status::OK();
+    }).ensure();
+  ASSERT_EQ(kv.count("b").move_as_ok(), count);
+}
+
+TEST(KeyValue, get_multi_and_range) {
+  td::MemoryKeyValue memory_kv;
+  check_get_multi_and_range(memory_kv);
+
+  td::Slice db_name = "testdb";
+  td::RocksDb::destroy(db_name).ignore();
+  auto rocks_db = td::RocksDb::open(db_name.str()).move_as_ok();
+  check_get_multi_and_range(rocks_db);
+}
+
+TEST(KeyValue, rocksdb_options) {
+  auto options = td::RocksDbOptions::parse("cache_size=16M,filter=ribbon,filter_bits=12,point_lookup,"
+                                           "partitioned_index=0,compression=none:lz4:zstd")
+                     .move_as_ok();
+  ASSERT_TRUE(options.block_cache != nullptr);
+  ASSERT_TRUE(options.filter == td::RocksDbOptions::Filter::Ribbon);
+  ASSERT_EQ(12.0, options.filter_bits_per_key);
+  ASSERT_TRUE(options.optimize_for_point_lookup);
+  ASSERT_TRUE(!options.partitioned_index);
+  ASSERT_EQ(3u, options.compression_per_level.size());
+  ASSERT_TRUE(options.compression_per_level[2] == td::RocksDbOptions::Compression::Zstd);
+
+  ASSERT_TRUE(td::RocksDbOptions::parse("filter=cuckoo").is_error());
+  ASSERT_TRUE(td::RocksDbOptions::parse("cache_size=1X").is_error());
+  ASSERT_TRUE(td::RocksDbOptions::parse("unknown=1").is_error());
+
+  td::Slice db_name = "testdb";
+  td::RocksDb::destroy(db_name).ignore();
+  auto db = td::RocksDb::open(db_name.str(), options).move_as_ok();
+  db.set("key", "value").ensure();
+  db.flush().ensure();
+  std::string value;
+  ASSERT_EQ(td::int32(td::KeyValue::GetStatus::Ok), td::int32(db.get("key", value).move_as_ok()));
+  ASSERT_EQ("value", value);
+  ASSERT_TRUE(!db.stats().empty());
+}
+
 TEST(KeyValue, async_simple) {
   td::Slice db_name = "testdb";
   td::RocksDb::destroy(db_name).ignore();
@@ -171,6 +288,63 @@ TEST(KeyValue, Bench) {
   td::bench(KeyValueBenchmark());
 }
 
+// random point lookups in batches of `batch_size`, either one get per key or one get_multi per batch
+class KeyValueGetMultiBenchmark : public td::Benchmark {
+ public:
+  KeyValueGetMultiBenchmark(size_t batch_size, bool use_get_multi)
+      : batch_size_(batch_size), use_get_multi_(use_get_multi) {
+  }
+  std::string get_description() const override {
+    return PSTRING() << "kv " << (use_get_multi_ ? "get_multi" : "get") << " benchmark, batch_size=" << batch_size_;
+  }
+
+  void start_up() override {
+    td::RocksDb::destroy("ttt").ignore();
+    db_ = td::RocksDb::open("ttt").move_as_ok();
+    db_.value().begin_write_batch().ensure();
+    for (size_t i = 0; i < keys_count; i++) {
+      db_.value().set(PSLICE() << "key" << i, td::rand_string('a', 'z', 256)).ensure();
+    }
+    db_.value().commit_write_batch().ensure();
+    db_.value().flush().ensure();
+  }
+  void tear_down() override {
+    db_ = {};
+  }
+  void run(int n) override {
+    std::vector<std::string> keys(batch_size_);
+    std::vector<td::Slice> key_slices(batch_size_);
+    std::vector<std::string> values;
+    std::string value;
+    for (int i = 0; i < n; i += static_cast<int>(batch_size_)) {
+      for (size_t j = 0; j < batch_size_; j++) {
+        keys[j] = PSTRING() << "key" << td::Random::fast(0, static_cast<int>(keys_count) - 1);
+        key_slices[j] = keys[j];
+      }
+      if (use_get_multi_) {
+        db_.value().get_multi(key_slices, &values).ensure();
+      } else {
+        for (auto &key : key_slices) {
+          db_.value().get(key, value).ensure();
+        }
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t keys_count = 1 << 18;
+  size_t batch_size_;
+  bool use_get_multi_;
+  td::optional<td::RocksDb> db_;
+};
+
+TEST(KeyValue, BenchGetMulti) {
+  for (size_t batch_size : {1, 16, 128}) {
+    td::bench(KeyValueGetMultiBenchmark(batch_size, false));
+    td::bench(KeyValueGetMultiBenchmark(batch_size, true));
+  }
+}
+
 TEST(KeyValue, Stress) {
   return;
   td::Slice db_name = "testdb";
@@ -35,6 +35,8 @@
 #include "td/fec/algebra/Octet.h"
 #include "td/fec/algebra/GaussianElimination.h"
 #include "td/fec/algebra/Simd.h"
+#include "td/fec/raptorq/Decoder.h"
+#include "td/fec/raptorq/Encoder.h"
 #include <cstdio>
 
 template <class Simd, size_t size = 256>
@@ -235,49 +237,81 @@ class FecBenchmark : public td::Benchmark {
 template <template <class T, size_t size> class O, size_t size = 256 * 8>
 void bench_simd() {
   bench(O<td::Simd_null, size>("baseline"));
-#if TD_SSSE3
-  bench(O<td::Simd_sse, size>("SSE"));
-#endif
-#if TD_AVX2
-  bench(O<td::Simd_avx, size>("AVX"));
-#endif
+  auto &active_backend = td::Simd::backend();
+  for (auto *backend : td::Simd::supported_backends()) {
+    td::Simd::set_backend(*backend);
+    bench(O<td::Simd, size>(backend->name));
+  }
+  td::Simd::set_backend(active_backend);
 }
 
-void run_encode_benchmark() {
+void run_raptorq_benchmark() {
   constexpr size_t TARGET_TOTAL_BYTES = 100 * 1024 * 1024;
-  constexpr size_t SYMBOLS_COUNT[11] = {10, 100, 250, 500, 1000, 2000, 4000, 10000, 20000, 40000, 56403};
+  constexpr size_t SYMBOLS_COUNT[] = {10, 100, 1000, 10000, 50000};
+  constexpr size_t SYMBOL_SIZE = 512;
 
+  auto &active_backend = td::Simd::backend();
   td::uint64 junk = 0;
-  for (int it = 0; it < 11; it++) {
-    //for (int it = 0; true;) {
-    auto symbol_count = SYMBOLS_COUNT[it];
-    auto symbol_size = 512;
-    auto elements = symbol_count * symbol_size;
-    td::BufferSlice data(elements);
-
-    td::Random::Xorshift128plus rnd(123);
-    for (auto &c : data.as_slice()) {
-      c = static_cast<td::uint8>(rnd());
-    }
+  for (auto *backend : td::Simd::supported_backends()) {
+    td::Simd::set_backend(*backend);
+    for (auto symbols_count : SYMBOLS_COUNT) {
+      auto elements = symbols_count * SYMBOL_SIZE;
+      auto iterations = td::max<size_t>(TARGET_TOTAL_BYTES / elements / 4, 1);
+      td::BufferSlice data(elements);
+      td::Random::Xorshift128plus rnd(123);
+      for (auto &c : data.as_slice()) {
+        c = static_cast<td::uint8>(rnd());
+      }
+
+      // the decoder gets repair symbols only, so it always has to solve the whole system
+      auto encoder = td::raptorq::Encoder::create(SYMBOL_SIZE, data.clone()).move_as_ok();
+      encoder->precalc();
+      auto parameters = encoder->get_parameters();
+      std::vector<std::string> symbols(parameters.symbols_count + 10, std::string(SYMBOL_SIZE, '\0'));
+      for (size_t i = 0; i < symbols.size(); i++) {
+        encoder->gen_symbol(td::narrow_cast<td::uint32>((1 << 20) + i), symbols[i]).ensure();
+      }
+
+      std::string symbol(SYMBOL_SIZE, '\0');
+      double now = td::Time::now();
+      for (size_t i = 0; i < iterations; i++) {
+        encoder = td::raptorq::Encoder::create(SYMBOL_SIZE, data.clone()).move_as_ok();
+        encoder->precalc();
+        encoder->gen_symbol(1 << 20, symbol).ensure();
+        junk += symbol[0];
+      }
+      double encode_elapsed = td::Time::now() - now;
+
+      now = td::Time::now();
+      for (size_t i = 0; i < iterations; i++) {
+        auto decoder = td::raptorq::Decoder::create(parameters).move_as_ok();
+        bool decoded = false;
+        for (size_t j = 0; j < symbols.size() && !decoded; j++) {
+          decoder->add_symbol({td::narrow_cast<td::uint32>((1 << 20) + j), td::Slice(symbols[j])}).ensure();
+          if (decoder->may_try_decode()) {
+            auto r = decoder->try_decode(false);
+            if (r.is_ok()) {
+              junk += r.ok().data.as_slice()[0];
+              decoded = true;
+            }
+          }
+        }
+        CHECK(decoded);
+      }
+      double decode_elapsed = td::Time::now() - now;
 
-    double now = td::Time::now();
-    auto iterations = TARGET_TOTAL_BYTES / elements;
-    for (size_t i = 0; i < iterations; i++) {
-      auto encoder = td::fec::RaptorQEncoder::create(data.clone(), symbol_size);
-      encoder->prepare_more_symbols();
-      junk += encoder->gen_symbol(10000000).data.as_slice()[0];
+      auto megabits = static_cast<double>(elements) * static_cast<double>(iterations) * 8.0 / 1024 / 1024;
+      fprintf(stderr, "%s: symbol count = %d, encode %.1lfMbit/s, decode %.1lfMbit/s\n", backend->name,
+              static_cast<int>(symbols_count), megabits / encode_elapsed, megabits / decode_elapsed);
     }
-    double elapsed = td::Time::now() - now;
-    double throughput = ((double)elements * (double)iterations * 8.0) / 1024 / 1024 / elapsed;
-    fprintf(stderr, "symbol count = %d, encoded %d MB in %.3lfsecs, throughtput: %.1lfMbit/s\n", (int)symbol_count,
-            (int)(elements * iterations / 1024 / 1024), elapsed, throughput);
   }
+  td::Simd::set_backend(active_backend);
   td::do_not_optimize_away(junk);
 }
 
 int main(void) {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
-  run_encode_benchmark();
+  run_raptorq_benchmark();
   bench_simd<Simd_gf256_mul, 32>();
   bench_simd<Simd_gf256_add_mul, 32>();
   bench_simd<Simd_gf256_add, 32>();
@@ -0,0 +1,445 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "td/fec/algebra/Simd.h"
+
+#include <array>
+
+#if TD_FEC_HAVE_TARGET_ATTRIBUTE
+// every kernel is compiled with its own target attribute and used only if the CPU supports it
+#define TD_FEC_TARGET(features) __attribute__((target(features)))
+#define TD_FEC_SSSE3 1
+#define TD_FEC_AVX2 1
+#define TD_FEC_AVX512 1
+#define TD_FEC_GFNI 1
+#else
+// no per-function targets, so only kernels allowed by the global compiler flags are available
+#define TD_FEC_TARGET(features)
+#if __SSSE3__ || __AVX__
+#define TD_FEC_SSSE3 1
+#endif
+#if __AVX2__
+#define TD_FEC_AVX2 1
+#endif
+#if __AVX512BW__
+#define TD_FEC_AVX512 1
+#endif
+#if __GFNI__ && __AVX512BW__
+#define TD_FEC_GFNI 1
+#endif
+#endif
+
+#if TD_FEC_SSSE3
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace td {
+namespace {
+
+#if TD_FEC_SSSE3
+struct CpuFeatures {
+  bool ssse3{false};
+  bool avx2{false};
+  bool avx512bw{false};
+  bool gfni{false};
+};
+
+void cpuid(int leaf, int subleaf, unsigned regs[4]) {
+#if defined(_MSC_VER)
+  int res[4];
+  __cpuidex(res, leaf, subleaf);
+  for (int i = 0; i < 4; i++) {
+    regs[i] = static_cast<unsigned>(res[i]);
+  }
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+uint64 xgetbv() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32 eax;
+  uint32 edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64>(edx) << 32) | eax;
+#endif
+}
+
+CpuFeatures detect_cpu_features() {
+  CpuFeatures res;
+  unsigned regs[4];
+  cpuid(0, 0, regs);
+  auto max_leaf = regs[0];
+  if (max_leaf < 1) {
+    return res;
+  }
+  cpuid(1, 0, regs);
+  res.ssse3 = (regs[2] & (1u << 9)) != 0;
+  bool has_osxsave = (regs[2] & (1u << 27)) != 0;
+  if (!has_osxsave || max_leaf < 7) {
+    return res;
+  }
+  // the OS must save YMM (and ZMM with opmask) registers on context switches
+  auto xcr0 = xgetbv();
+  bool ymm_enabled = (xcr0 & 0x06) == 0x06;
+  bool zmm_enabled = (xcr0 & 0xe6) == 0xe6;
+  cpuid(7, 0, regs);
+  res.avx2 = ymm_enabled && (regs[1] & (1u << 5)) != 0;
+  res.avx512bw = zmm_enabled && (regs[1] & (1u << 16)) != 0 && (regs[1] & (1u << 30)) != 0;
+  res.gfni = ymm_enabled && (regs[2] & (1u << 8)) != 0;
+  return res;
+}
+#endif
+
+#if TD_FEC_SSSE3
+struct Simd_ssse3 {
+  TD_FEC_TARGET("ssse3") static void gf256_add(void *a, const void *b, size_t size) {
+    __m128i *ap128 = reinterpret_cast<__m128i *>(a);
+    const __m128i *bp128 = reinterpret_cast<const __m128i *>(b);
+    for (size_t idx = 0; idx < size; idx += 16) {
+      _mm_storeu_si128(ap128, _mm_xor_si128(_mm_loadu_si128(ap128), _mm_loadu_si128(bp128)));
+      ap128++;
+      bp128++;
+    }
+  }
+
+  TD_FEC_TARGET("ssse3") static void gf256_mul(void *a, uint8 u, size_t size) {
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i urow_hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Octet::OctMulHi[u]));
+    const __m128i urow_lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Octet::OctMulLo[u]));
+
+    __m128i *ap128 = reinterpret_cast<__m128i *>(a);
+    for (size_t idx = 0; idx < size; idx += 16) {
+      __m128i ax = _mm_loadu_si128(ap128);
+      __m128i lo = _mm_and_si128(ax, mask);
+      ax = _mm_srli_epi64(ax, 4);
+      __m128i hi = _mm_and_si128(ax, mask);
+      lo = _mm_shuffle_epi8(urow_lo, lo);
+      hi = _mm_shuffle_epi8(urow_hi, hi);
+
+      _mm_storeu_si128(ap128, _mm_xor_si128(lo, hi));
+      ap128++;
+    }
+  }
+
+  TD_FEC_TARGET("ssse3") static void gf256_add_mul(void *a, const void *b, uint8 u, size_t size) {
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i urow_hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Octet::OctMulHi[u]));
+    const __m128i urow_lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Octet::OctMulLo[u]));
+
+    __m128i *ap128 = reinterpret_cast<__m128i *>(a);
+    const __m128i *bp128 = reinterpret_cast<const __m128i *>(b);
+    for (size_t idx = 0; idx < size; idx += 16) {
+      __m128i bx = _mm_loadu_si128(bp128++);
+      __m128i lo = _mm_and_si128(bx, mask);
+      bx = _mm_srli_epi64(bx, 4);
+      __m128i hi = _mm_and_si128(bx, mask);
+      lo = _mm_shuffle_epi8(urow_lo, lo);
+      hi = _mm_shuffle_epi8(urow_hi, hi);
+
+      _mm_storeu_si128(ap128, _mm_xor_si128(_mm_loadu_si128(ap128), _mm_xor_si128(lo, hi)));
+      ap128++;
+    }
+  }
+};
+#endif  // SSSE3
+
+#if TD_FEC_AVX2
+struct Simd_avx2 {
+  TD_FEC_TARGET("avx2") static void gf256_add(void *a, const void *b, size_t size) {
+    __m256i *ap256 = reinterpret_cast<__m256i *>(a);
+    const __m256i *bp256 = reinterpret_cast<const __m256i *>(b);
+    for (size_t idx = 0; idx < size; idx += 32) {
+      _mm256_storeu_si256(ap256, _mm256_xor_si256(_mm256_loadu_si256(ap256), _mm256_loadu_si256(bp256)));
+      ap256++;
+      bp256++;
+    }
+  }
+
+  TD_FEC_TARGET("avx2") static __m256i get_mask(const uint32 mask) {
+    // abcd -> abcd * 8
+    __m256i vmask(_mm256_set1_epi32(mask));
+
+    // abcd * 8 -> aaaaaaaabbbbbbbbccccccccdddddddd
+    const __m256i shuffle(
+        _mm256_setr_epi64x(0x0000000000000000, 0x0101010101010101, 0x0202020202020202, 0x0303030303030303));
+    vmask = _mm256_shuffle_epi8(vmask, shuffle);
+
+    const __m256i bit_mask(_mm256_set1_epi64x(0x7fbfdfeff7fbfdfe));
+    vmask = _mm256_or_si256(vmask, bit_mask);
+    return _mm256_and_si256(_mm256_cmpeq_epi8(vmask, _mm256_set1_epi64x(-1)), _mm256_set1_epi8(1));
+  }
+
+  TD_FEC_TARGET("avx2") static void gf256_from_gf2(void *a, const void *b, size_t size) {
+    DCHECK(size % 4 == 0);
+    __m256i *ap256 = reinterpret_cast<__m256i *>(a);
+    const uint32 *bp = reinterpret_cast<const uint32 *>(b);
+    size /= 4;
+    for (size_t i = 0; i < size; i++, bp++, ap256++) {
+      _mm256_store_si256(ap256, get_mask(*bp));
+    }
+  }
+
+  TD_FEC_TARGET("avx2") static void gf256_mul(void *a, uint8 u, size_t size) {
+    const __m128i urow_hi_small = _mm_load_si128(reinterpret_cast<const __m128i *>(Octet::OctMulHi[u]));
+    const __m256i urow_hi = _mm256_broadcastsi128_si256(urow_hi_small);
+    const __m128i urow_lo_small = _mm_load_si128(reinterpret_cast<const __m128i *>(Octet::OctMulLo[u]));
+    const __m256i urow_lo = _mm256_broadcastsi128_si256(urow_lo_small);
+
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    __m256i *ap256 = reinterpret_cast<__m256i *>(a);
+    for (size_t idx = 0; idx < size; idx += 32) {
+      __m256i ax = _mm256_load_si256(ap256);
+      __m256i lo = _mm256_and_si256(ax, mask);
+      ax = _mm256_srli_epi64(ax, 4);
+      __m256i hi = _mm256_and_si256(ax, mask);
+      lo = _mm256_shuffle_epi8(urow_lo, lo);
+      hi = _mm256_shuffle_epi8(urow_hi, hi);
+
+      _mm256_store_si256(ap256, _mm256_xor_si256(lo, hi));
+      ap256++;
+    }
+  }
+
+  TD_FEC_TARGET("avx2") static void gf256_add_mul(void *a, const void *b, uint8 u, size_t size) {
+    const __m128i urow_hi_small = _mm_load_si128(reinterpret_cast<const __m128i *>(Octet::OctMulHi[u]));
+    const __m256i urow_hi = _mm256_broadcastsi128_si256(urow_hi_small);
+    const __m128i urow_lo_small = _mm_load_si128(reinterpret_cast<const __m128i *>(Octet::OctMulLo[u]));
+    const __m256i urow_lo = _mm256_broadcastsi128_si256(urow_lo_small);
+
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    __m256i *ap256 = reinterpret_cast<__m256i *>(a);
+    const __m256i *bp256 = reinterpret_cast<const __m256i *>(b);
+    for (size_t idx = 0; idx < size; idx += 32) {
+      __m256i bx = _mm256_load_si256(bp256++);
+      __m256i lo = _mm256_and_si256(bx, mask);
+      bx = _mm256_srli_epi64(bx, 4);
+      __m256i hi = _mm256_and_si256(bx, mask);
+      lo = _mm256_shuffle_epi8(urow_lo, lo);
+      hi = _mm256_shuffle_epi8(urow_hi, hi);
+
+      _mm256_store_si256(ap256, _mm256_xor_si256(_mm256_load_si256(ap256), _mm256_xor_si256(lo, hi)));
+      ap256++;
+    }
+  }
+};
+#endif  // AVX2
+
+#if TD_FEC_AVX512
+// rows are only 32-byte aligned and sized, so the last half of a 64-byte block is processed with AVX2
+struct Simd_avx512 {
+  TD_FEC_TARGET("avx512bw") static void gf256_add(void *a, const void *b, size_t size) {
+    uint8 *ap = reinterpret_cast<uint8 *>(a);
+    const uint8 *bp = reinterpret_cast<const uint8 *>(b);
+    size_t idx = 0;
+    for (; idx + 64 <= size; idx += 64) {
+      _mm512_storeu_si512(ap + idx, _mm512_xor_si512(_mm512_loadu_si512(ap + idx), _mm512_loadu_si512(bp + idx)));
+    }
+    if (idx < size) {
+      auto *ap256 = reinterpret_cast<__m256i *>(ap + idx);
+      auto *bp256 = reinterpret_cast<const __m256i *>(bp + idx);
+      _mm256_store_si256(ap256, _mm256_xor_si256(_mm256_load_si256(ap256), _mm256_load_si256(bp256)));
+    }
+  }
+
+  TD_FEC_TARGET("avx512bw") static void gf256_mul(void *a, uint8 u, size_t size) {
+    const __m512i urow_hi = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i *>(Octet::OctMulHi[u])));
+    const __m512i urow_lo = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i *>(Octet::OctMulLo[u])));
+    const __m512i mask = _mm512_set1_epi8(0x0f);
+
+    uint8 *ap = reinterpret_cast<uint8 *>(a);
+    size_t idx = 0;
+    for (; idx + 64 <= size; idx += 64) {
+      __m512i ax = _mm512_loadu_si512(ap + idx);
+      __m512i lo = _mm512_shuffle_epi8(urow_lo, _mm512_and_si512(ax, mask));
+      __m512i hi = _mm512_shuffle_epi8(urow_hi, _mm512_and_si512(_mm512_srli_epi64(ax, 4), mask));
+      _mm512_storeu_si512(ap + idx, _mm512_xor_si512(lo, hi));
+    }
+    if (idx < size) {
+      Simd_avx2::gf256_mul(ap + idx, u, size - idx);
+    }
+  }
+
+  TD_FEC_TARGET("avx512bw") static void gf256_add_mul(void *a, const void *b, uint8 u, size_t size) {
+    const __m512i urow_hi = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i *>(Octet::OctMulHi[u])));
+    const __m512i urow_lo = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i *>(Octet::OctMulLo[u])));
+    const __m512i mask = _mm512_set1_epi8(0x0f);
+
+    uint8 *ap = reinterpret_cast<uint8 *>(a);
+    const uint8 *bp = reinterpret_cast<const uint8 *>(b);
+    size_t idx = 0;
+    for (; idx + 64 <= size; idx += 64) {
+      __m512i bx = _mm512_loadu_si512(bp + idx);
+      __m512i lo = _mm512_shuffle_epi8(urow_lo, _mm512_and_si512(bx, mask));
+      __m512i hi = _mm512_shuffle_epi8(urow_hi, _mm512_and_si512(_mm512_srli_epi64(bx, 4), mask));
+      _mm512_storeu_si512(ap + idx, _mm512_xor_si512(_mm512_loadu_si512(ap + idx), _mm512_xor_si512(lo, hi)));
+    }
+    if (idx < size) {
+      Simd_avx2::gf256_add_mul(ap + idx, bp + idx, u, size - idx);
+    }
+  }
+};
+#endif  // AVX512
+
+#if TD_FEC_GFNI
+// vgf2p8mulb is hardwired to the AES polynomial 0x11b, while RaptorQ uses 0x11d (RFC 6330, 5.7.3).
+// Multiplication by a fixed u is still GF(2)-linear, so it is done by vgf2p8affineqb with an 8x8 bit matrix.
+struct Simd_gfni {
+  static uint64 affine_matrix(uint8 u) {
+    static const std::array<uint64, 256> matrices = [] {
+      std::array<uint64, 256> res;
+      for (uint32 u = 0; u < 256; u++) {
+        uint64 matrix = 0;
+        for (int j = 0; j < 8; j++) {
+          // column j is u * x^j; bit i of the result is taken from byte 7 - i of the matrix
+          auto column = (Octet(static_cast<uint8>(1 << j)) * Octet(static_cast<uint8>(u))).value();
+          for (int i = 0; i < 8; i++) {
+            if ((column >> i) & 1) {
+              matrix |= static_cast<uint64>(1) << ((7 - i) * 8 + j);
+            }
+          }
+        }
+        res[u] = matrix;
+      }
+      return res;
+    }();
+    return matrices[u];
+  }
+
+  TD_FEC_TARGET("avx2,gfni") static void gf256_mul_256(void *a, uint8 u, size_t size) {
+    const __m256i matrix = _mm256_set1_epi64x(static_cast<long long>(affine_matrix(u)));
+    __m256i *ap256 = reinterpret_cast<__m256i *>(a);
+    for (size_t idx = 0; idx < size; idx += 32) {
+      _mm256_store_si256(ap256, _mm256_gf2p8affine_epi64_epi8(_mm256_load_si256(ap256), matrix, 0));
+      ap256++;
+    }
+  }
+
+  TD_FEC_TARGET("avx2,gfni") static void gf256_add_mul_256(void *a, const void *b, uint8 u, size_t size) {
+    const __m256i matrix = _mm256_set1_epi64x(static_cast<long long>(affine_matrix(u)));
+    __m256i *ap256 = reinterpret_cast<__m256i *>(a);
+    const __m256i *bp256 = reinterpret_cast<const __m256i *>(b);
+    for (size_t idx = 0; idx < size; idx += 32) {
+      __m256i prod = _mm256_gf2p8affine_epi64_epi8(_mm256_load_si256(bp256++), matrix, 0);
+      _mm256_store_si256(ap256, _mm256_xor_si256(_mm256_load_si256(ap256), prod));
+      ap256++;
+    }
+  }
+
+  TD_FEC_TARGET("avx512bw,gfni") static void gf256_mul_512(void *a, uint8 u, size_t size) {
+    const __m512i matrix = _mm512_set1_epi64(static_cast<long long>(affine_matrix(u)));
+    uint8 *ap = reinterpret_cast<uint8 *>(a);
+    size_t idx = 0;
+    for (; idx + 64 <= size; idx += 64) {
+      _mm512_storeu_si512(ap + idx, _mm512_gf2p8affine_epi64_epi8(_mm512_loadu_si512(ap + idx), matrix, 0));
+    }
+    if (idx < size) {
+      gf256_mul_256(ap + idx, u, size - idx);
+    }
+  }
+
+  TD_FEC_TARGET("avx512bw,gfni") static void gf256_add_mul_512(void *a, const void *b, uint8 u, size_t size) {
+    const __m512i matrix = _mm512_set1_epi64(static_cast<long long>(affine_matrix(u)));
+    uint8 *ap = reinterpret_cast<uint8 *>(a);
+    const uint8 *bp = reinterpret_cast<const uint8 *>(b);
+    size_t idx = 0;
+    for (; idx + 64 <= size; idx += 64) {
+      __m512i prod = _mm512_gf2p8affine_epi64_epi8(_mm512_loadu_si512(bp + idx), matrix, 0);
+      _mm512_storeu_si512(ap + idx, _mm512_xor_si512(_mm512_loadu_si512(ap + idx), prod));
+    }
+    if (idx < size) {
+      gf256_add_mul_256(ap + idx, bp + idx, u, size - idx);
+    }
+  }
+};
+#endif  // GFNI
+
+constexpr Simd_dispatch::Backend null_backend{"Without simd", &Simd_null::gf256_add, &Simd_null::gf256_mul,
+                                              &Simd_null::gf256_add_mul, &Simd_null::gf256_from_gf2};
+#if TD_FEC_SSSE3
+constexpr Simd_dispatch::Backend ssse3_backend{"SSSE3", &Simd_ssse3::gf256_add, &Simd_ssse3::gf256_mul,
+                                               &Simd_ssse3::gf256_add_mul, &Simd_null::gf256_from_gf2};
+#endif
+#if TD_FEC_AVX2
+constexpr Simd_dispatch::Backend avx2_backend{"AVX2", &Simd_avx2::gf256_add, &Simd_avx2::gf256_mul,
+                                              &Simd_avx2::gf256_add_mul, &Simd_avx2::gf256_from_gf2};
+#endif
+#if TD_FEC_GFNI
+constexpr Simd_dispatch::Backend gfni_avx2_backend{"AVX2+GFNI", &Simd_avx2::gf256_add, &Simd_gfni::gf256_mul_256,
+                                                   &Simd_gfni::gf256_add_mul_256, &Simd_avx2::gf256_from_gf2};
+#endif
+#if TD_FEC_AVX512
+constexpr Simd_dispatch::Backend avx512_backend{"AVX-512BW", &Simd_avx512::gf256_add, &Simd_avx512::gf256_mul,
+                                                &Simd_avx512::gf256_add_mul, &Simd_avx2::gf256_from_gf2};
+#endif
+#if TD_FEC_GFNI && TD_FEC_AVX512
+constexpr Simd_dispatch::Backend gfni_avx512_backend{"AVX-512BW+GFNI", &Simd_avx512::gf256_add,
+                                                     &Simd_gfni::gf256_mul_512, &Simd_gfni::gf256_add_mul_512,
+                                                     &Simd_avx2::gf256_from_gf2};
+#endif
+
+}  // namespace
+
+const std::vector<const Simd_dispatch::Backend *> &Simd_dispatch::supported_backends() {
+  static const std::vector<const Backend *> backends = [] {
+    std::vector<const Backend *> res{&null_backend};
+#if TD_FEC_SSSE3
+    auto features = detect_cpu_features();
+    if (features.ssse3) {
+      res.push_back(&ssse3_backend);
+    }
+#if TD_FEC_AVX2
+    if (features.avx2) {
+      res.push_back(&avx2_backend);
+    }
+#endif
+#if TD_FEC_GFNI
+    if (features.avx2 && features.gfni) {
+      res.push_back(&gfni_avx2_backend);
+    }
+#endif
+#if TD_FEC_AVX512
+    if (features.avx512bw) {
+      res.push_back(&avx512_backend);
+    }
+#endif
+#if TD_FEC_GFNI && TD_FEC_AVX512
+    if (features.avx512bw && features.gfni) {
+      res.push_back(&gfni_avx512_backend);
+    }
+#endif
+#endif
+    return res;
+  }();
+  return backends;
+}
+
+// starts with the scalar backend, so that Simd is usable even from other static initializers
+std::atomic<const Simd_dispatch::Backend *> Simd_dispatch::active_backend_{&null_backend};
+
+static const bool best_simd_backend_selected TD_UNUSED = [] {
+  Simd_dispatch::set_backend(*Simd_dispatch::supported_backends().back());
+  return true;
+}();
+
+}  // namespace td
@@ -42,7 +42,7 @@ TEST(Fec, Simd) {
   alignas(td::Simd::alignment()) td::uint8 d[8 * size];
 
   td::Random::Xorshift128plus rnd(123);
-  for (auto k_size : {1, 2, 10, 1024}) {
+  for (auto k_size : {1, 2, 3, 10, 1024}) {
     auto a_size = k_size * td::Simd::alignment();
     LOG(ERROR) << a_size;
     for (size_t i = 0; i < a_size; i++) {
@@ -90,13 +90,12 @@ TEST(Fec, Simd) {
       }
     };
     run(td::Simd_null());
-#if TD_SSE3
-    run(td::Simd_sse());
-#endif
-#if TD_AVX2
-    run(td::Simd_avx());
-#endif
-    run(td::Simd());
+    auto &active_backend = td::Simd::backend();
+    for (auto *backend : td::Simd::supported_backends()) {
+      td::Simd::set_backend(*backend);
+      run(td::Simd());
+    }
+    td::Simd::set_backend(active_backend);
   }
 }
 
@@ -167,6 +166,45 @@ TEST(Fec, RaptorQRandomSymbols) {
   UNREACHABLE();
 }
 
+TEST(Fec, RaptorQSimdBackends) {
+  auto data = get_long_string();
+  auto &active_backend = td::Simd::backend();
+  std::vector<std::string> reference_symbols;
+  for (auto *backend : td::Simd::supported_backends()) {
+    LOG(ERROR) << backend->name;
+    td::Simd::set_backend(*backend);
+    auto encoder = td::raptorq::Encoder::create(200, td::BufferSlice(data)).move_as_ok();
+    encoder->precalc();
+    auto parameters = encoder->get_parameters();
+    auto decoder = td::raptorq::Decoder::create(parameters).move_as_ok();
+
+    std::vector<std::string> symbols;
+    bool decoded = false;
+    for (td::uint32 id = 0; id < parameters.symbols_count + 10 && !decoded; id++) {
+      // replace every third source symbol with a repair symbol
+      auto symbol_id = id < parameters.symbols_count && id % 3 == 0 ? id + (1 << 20) : id;
+      std::string symbol(parameters.symbol_size, '\0');
+      encoder->gen_symbol(symbol_id, symbol);
+      decoder->add_symbol({symbol_id, td::Slice(symbol)});
+      symbols.push_back(std::move(symbol));
+      if (decoder->may_try_decode()) {
+        auto r = decoder->try_decode(false);
+        if (r.is_ok()) {
+          ASSERT_EQ(r.ok().data, data);
+          decoded = true;
+        }
+      }
+    }
+    CHECK(decoded);
+    if (reference_symbols.empty()) {
+      reference_symbols = std::move(symbols);
+    } else {
+      ASSERT_TRUE(reference_symbols == symbols);
+    }
+  }
+  td::Simd::set_backend(active_backend);
+}
+
 template <class Encoder, class Decoder>
 void fec_test(td::Slice data, size_t max_symbol_size) {
   LOG(ERROR) << "!";
@@ -0,0 +1,135 @@
+/*
+    This file is part of TON Blockchain source code.
+
+    TON Blockchain is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    TON Blockchain is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with TON Blockchain.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give permission
+    to link the code of portions of this program with the OpenSSL library.
+    You must obey the GNU General Public License in all respects for all
+    of the code used other than OpenSSL. If you modify file(s) with this
+    exception, you may extend this exception to your version of the file(s),
+    but you are not obligated to do so. If you do not wish to do so, delete this
+    exception statement from your version. If you delete this exception statement
+    from all source files in the program, then also delete it here.
+*/
+// Loopback throughput of BufferedUdp with and without UDP segmentation (GSO) and receive (GRO) offloads: bursts of
+// equal datagrams, as produced by an rldp transfer, are sent to a socket on the same host and counted on receive.
+#include "td/utils/BufferedUdp.h"
+#include "td/utils/misc.h"
+#include "td/utils/OptionParser.h"
+#include "td/utils/port/PollFlags.h"
+#include "td/utils/Time.h"
+
+#include <iostream>
+
+#if TD_PORT_POSIX
+static void run(bool gso, bool gro, int port, size_t size, size_t burst, double duration) {
+  td::IPAddress to;
+  to.init_ipv4_port("127.0.0.1", port).ensure();
+  td::IPAddress from;
+  from.init_ipv4_port("127.0.0.1", port + 1).ensure();
+
+  td::BufferedUdp receiver(td::UdpSocketFd::open(to).move_as_ok());
+  td::BufferedUdp sender(td::UdpSocketFd::open(from).move_as_ok());
+  receiver.maximize_rcv_buffer().ensure();
+  sender.maximize_snd_buffer().ensure();
+  if (gso) {
+    auto status = sender.enable_gso();
+    if (status.is_error()) {
+      std::cout << "gso is not available: " << status.message().str() << std::endl;
+      return;
+    }
+  }
+  if (gro) {
+    auto status = receiver.enable_gro();
+    if (status.is_error()) {
+      std::cout << "gro is not available: " << status.message().str() << std::endl;
+      return;
+    }
+  }
+
+  td::BufferSlice payload(size);
+  payload.as_slice().fill('a');
+  td::uint64 sent = 0;
+  td::uint64 received = 0;
+  td::uint64 received_bytes = 0;
+  auto start = td::Time::now();
+  auto deadline = td::Timestamp::in(duration);
+  while (!deadline.is_in_past()) {
+    for (size_t i = 0; i < burst; i++) {
+      sender.send(td::UdpMessage{to, payload.clone(), {}});
+    }
+    sent += burst;
+    // there is no poll, so just try again until the socket buffer has free space
+    while (true) {
+      sender.get_poll_info().add_flags(td::PollFlags::Write());
+      sender.flush_send().ignore();
+      receiver.get_poll_info().add_flags(td::PollFlags::Read());
+      while (true) {
+        auto r_message = receiver.receive();
+        if (r_message.is_error() || !r_message.ok()) {
+          break;
+        }
+        auto message = r_message.move_as_ok();
+        if (message.value().error.is_ok()) {
+          received++;
+          received_bytes += message.value().data.size();
+        }
+      }
+      if (sender.get_poll_info().get_flags_local().can_write()) {
+        break;
+      }
+    }
+  }
+  auto elapsed = td::Time::now() - start;
+  std::cout << "gso=" << gso << " gro=" << gro << " sent=" << sent << " received=" << received
+            << " pps=" << static_cast<td::uint64>(static_cast<double>(received) / elapsed)
+            << " MB/s=" << static_cast<double>(received_bytes) / elapsed / (1 << 20) << std::endl;
+}
+#endif
+
+int main(int argc, char *argv[]) {
+#if TD_PORT_POSIX
+  int port = 17000;
+  size_t size = 1200;
+  size_t burst = 64;
+  double duration = 3.0;
+
+  td::OptionParser p;
+  p.set_description("loopback throughput of udp bursts with and without segmentation and receive offloads");
+  p.add_checked_option('p', "port", "udp port to use, the next one is used too (default: 17000)", [&](td::Slice arg) {
+    TRY_RESULT_ASSIGN(port, td::to_integer_safe<int>(arg));
+    return td::Status::OK();
+  });
+  p.add_checked_option('s', "size", "size of a datagram (default: 1200)", [&](td::Slice arg) {
+    TRY_RESULT_ASSIGN(size, td::to_integer_safe<size_t>(arg));
+    return td::Status::OK();
+  });
+  p.add_checked_option('b', "burst", "datagrams queued before every flush (default: 64)", [&](td::Slice arg) {
+    TRY_RESULT_ASSIGN(burst, td::to_integer_safe<size_t>(arg));
+    return td::Status::OK();
+  });
+  p.add_option('d', "duration", "seconds to measure every configuration (default: 3)",
+               [&](td::Slice arg) { duration = td::to_double(arg); });
+  p.run(argc, argv).ensure();
+
+  run(false, false, port, size, burst, duration);
+  run(true, false, port + 2, size, burst, duration);
+  run(true, true, port + 4, size, burst, duration);
+  return 0;
+#else
+  std::cerr << "not supported on this platform" << std::endl;
+  return 1;
+#endif
+}
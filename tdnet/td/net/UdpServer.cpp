@@ -55,6 +55,11 @@ class UdpServerImpl : public UdpServer {
 void UdpServerImpl::send(td::UdpMessage &&message) {
   //LOG(WARNING) << "TO: " << message.address;
   fd_.send(std::move(message));
+  if (fd_.is_gso_enabled()) {
+    // flush after the whole mailbox is processed, so that consecutive datagrams can be coalesced
+    yield();
+    return;
+  }
   loop();  // TODO: some yield logic
 }
 
@@ -389,11 +394,22 @@ class UdpServerViaTcp : public UdpServer {
 
 }  // namespace detail
 
-Result<actor::ActorOwn<UdpServer>> UdpServer::create(td::Slice name, int32 port, std::unique_ptr<Callback> callback) {
+Result<actor::ActorOwn<UdpServer>> UdpServer::create(td::Slice name, int32 port, std::unique_ptr<Callback> callback,
+                                                     bool reuse_port, bool udp_offload) {
   td::IPAddress from_ip;
   TRY_STATUS(from_ip.init_ipv4_port("0.0.0.0", port));
-  TRY_RESULT(fd, UdpSocketFd::open(from_ip));
+  TRY_RESULT(fd, UdpSocketFd::open(from_ip, reuse_port));
   fd.maximize_rcv_buffer().ensure();
+  if (udp_offload) {
+    auto status = fd.enable_gso();
+    if (status.is_error()) {
+      LOG(WARNING) << "Failed to enable UDP segmentation offload on port " << port << ": " << status;
+    }
+    status = fd.enable_gro();
+    if (status.is_error()) {
+      LOG(WARNING) << "Failed to enable UDP receive offload on port " << port << ": " << status;
+    }
+  }
   return detail::UdpServerImpl::create(name, std::move(fd), std::move(callback));
 }
 Result<actor::ActorOwn<UdpServer>> UdpServer::create_via_tcp(td::Slice name, int32 port,
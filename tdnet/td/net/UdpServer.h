@@ -34,7 +34,9 @@ class UdpServer : public td::actor::Actor {
   };
   virtual void send(td::UdpMessage &&message) = 0;
 
-  static Result<actor::ActorOwn<UdpServer>> create(td::Slice name, int32 port, std::unique_ptr<Callback> callback);
+  // with udp_offload the server tries to enable UDP segmentation and receive offloads of the socket
+  static Result<actor::ActorOwn<UdpServer>> create(td::Slice name, int32 port, std::unique_ptr<Callback> callback,
+                                                   bool reuse_port = false, bool udp_offload = false);
   static Result<actor::ActorOwn<UdpServer>> create_via_tcp(td::Slice name, int32 port,
                                                            std::unique_ptr<Callback> callback);
 };
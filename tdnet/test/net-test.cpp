@@ -18,6 +18,9 @@
 */
 #include "td/actor/actor.h"
 #include "td/net/UdpServer.h"
+#include "td/utils/BufferedUdp.h"
+#include "td/utils/port/PollFlags.h"
+#include "td/utils/port/sleep.h"
 #include "td/utils/tests.h"
 
 class PingPong : public td::actor::Actor {
@@ -167,3 +170,47 @@ TEST(Net, PingPong) {
     b.join();
   }
 }
+
+TEST(Net, UdpOffload) {
+  int port = td::Random::fast(12000, 12999);
+  td::IPAddress to;
+  to.init_ipv4_port("127.0.0.1", port).ensure();
+  td::IPAddress from;
+  from.init_ipv4_port("127.0.0.1", port + 1).ensure();
+  td::BufferedUdp receiver(td::UdpSocketFd::open(to).move_as_ok());
+  td::BufferedUdp sender(td::UdpSocketFd::open(from).move_as_ok());
+  if (sender.enable_gso().is_error() || receiver.enable_gro().is_error()) {
+    LOG(ERROR) << "UDP offloads are not supported, skip the test";
+    return;
+  }
+
+  // a run of equal datagrams with a shorter one at the end, then datagrams of other sizes
+  std::vector<std::string> datagrams;
+  for (int i = 0; i < 20; i++) {
+    datagrams.push_back(td::rand_string('a', 'z', 1000));
+  }
+  datagrams.push_back(td::rand_string('a', 'z', 10));
+  datagrams.push_back(td::rand_string('a', 'z', 1000));
+  datagrams.push_back(td::rand_string('a', 'z', 1200));
+  for (auto &data : datagrams) {
+    sender.send(td::UdpMessage{to, td::BufferSlice(data), {}});
+  }
+  sender.get_poll_info().add_flags(td::PollFlags::Write());
+  sender.flush_send().ensure();
+
+  std::vector<std::string> received;
+  for (int i = 0; i < 100 && received.size() < datagrams.size(); i++) {
+    receiver.get_poll_info().add_flags(td::PollFlags::Read());
+    while (true) {
+      auto message = receiver.receive().move_as_ok();
+      if (!message) {
+        break;
+      }
+      ASSERT_TRUE(message.value().error.is_ok());
+      ASSERT_EQ(from.get_port(), message.value().address.get_port());
+      received.push_back(message.value().data.as_slice().str());
+    }
+    td::usleep_for(1000);
+  }
+  ASSERT_TRUE(datagrams == received);
+}
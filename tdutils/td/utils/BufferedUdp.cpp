@@ -24,6 +24,8 @@ namespace td {
 
 #if TD_PORT_POSIX
 TD_THREAD_LOCAL detail::UdpReader *BufferedUdp::udp_reader_;
+TD_THREAD_LOCAL detail::UdpGroReader *BufferedUdp::udp_gro_reader_;
+TD_THREAD_LOCAL detail::UdpGsoWriter *BufferedUdp::udp_gso_writer_;
 #endif
 
 }  // namespace td
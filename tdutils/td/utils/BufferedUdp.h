@@ -30,6 +30,8 @@
 #include "td/utils/VectorQueue.h"
 
 #include <array>
+#include <cstring>
+#include <vector>
 
 namespace td {
 
@@ -54,6 +56,75 @@ class UdpWriter {
   }
 };
 
+// Coalesces runs of datagrams to the same address into segmented sends; every datagram of a run has the size of the
+// first one, except for the last one, which may be shorter. Used only when segmentation offload is enabled
+class UdpGsoWriter {
+ public:
+  Status write_once(UdpSocketFd &fd, VectorQueue<UdpMessage> &queue) TD_WARN_UNUSED_RESULT {
+    std::array<UdpSocketFd::OutboundMessage, BUFFER_SIZE> messages;
+    std::array<size_t, BUFFER_SIZE> counts;
+    auto to_send = queue.as_span();
+    size_t to_send_n = 0;
+    size_t pos = 0;
+    while (to_send_n < BUFFER_SIZE && pos < to_send.size()) {
+      auto &first = to_send[pos];
+      auto segment_size = first.data.size();
+      size_t run = 1;
+      if (segment_size != 0 && segment_size <= MAX_SEGMENT_SIZE) {
+        while (pos + run < to_send.size() && run < MAX_SEGMENTS && (run + 1) * segment_size <= MAX_SEND_SIZE) {
+          auto &next = to_send[pos + run];
+          if (next.data.empty() || next.data.size() > segment_size || !(next.address == first.address)) {
+            break;
+          }
+          run++;
+          if (next.data.size() < segment_size) {
+            break;
+          }
+        }
+      }
+
+      auto &message = messages[to_send_n];
+      message.to = &first.address;
+      if (run == 1) {
+        message.data = first.data.as_slice();
+        message.segment_size = 0;
+      } else {
+        auto &buffer = buffers_[to_send_n];
+        buffer.resize(MAX_SEND_SIZE);
+        size_t size = 0;
+        for (size_t i = pos; i < pos + run; i++) {
+          auto data = to_send[i].data.as_slice();
+          std::memcpy(&buffer[size], data.data(), data.size());
+          size += data.size();
+        }
+        message.data = Slice(buffer.data(), size);
+        message.segment_size = segment_size;
+      }
+      counts[to_send_n] = run;
+      to_send_n++;
+      pos += run;
+    }
+
+    size_t cnt;
+    auto status = fd.send_messages(::td::Span<UdpSocketFd::OutboundMessage>(messages).truncate(to_send_n), cnt);
+    size_t sent = 0;
+    for (size_t i = 0; i < cnt; i++) {
+      sent += counts[i];
+    }
+    queue.pop_n(sent);
+    return status;
+  }
+
+ private:
+  static constexpr size_t BUFFER_SIZE = 16;
+  // the kernel limits a segmented send to 64 segments and to the maximal size of an IPv4 datagram; the segments must
+  // also fit into the MTU of the output device
+  static constexpr size_t MAX_SEGMENTS = 64;
+  static constexpr size_t MAX_SEND_SIZE = 65507;
+  static constexpr size_t MAX_SEGMENT_SIZE = 1452;
+  std::array<std::vector<char>, BUFFER_SIZE> buffers_;
+};
+
 class UdpReaderHelper {
  public:
   void init_inbound_message(UdpSocketFd::InboundMessage &message) {
@@ -117,6 +188,51 @@ class UdpReader {
   std::array<UdpReaderHelper, BUFFER_SIZE> helpers_;
 };
 
+// Reader for sockets with receive offload: every received message may hold several datagrams, which are split back
+// into separate UdpMessages sharing the receive buffer
+class UdpGroReader {
+ public:
+  Status read_once(UdpSocketFd &fd, VectorQueue<UdpMessage> &queue) TD_WARN_UNUSED_RESULT {
+    for (size_t i = 0; i < messages_.size(); i++) {
+      if (buffers_[i].size() < MAX_PACKET_SIZE) {
+        buffers_[i] = BufferSlice(RESERVED_SIZE);
+      }
+      messages_[i].from = &addresses_[i];
+      messages_[i].data = buffers_[i].as_slice().truncate(MAX_PACKET_SIZE);
+      messages_[i].error = &errors_[i];
+      messages_[i].segment_size = 0;
+    }
+    size_t cnt = 0;
+    auto status = fd.receive_messages(messages_, cnt);
+    for (size_t i = 0; i < cnt; i++) {
+      auto data = messages_[i].data;
+      if (data.empty()) {
+        queue.push(UdpMessage{addresses_[i], BufferSlice(), std::move(errors_[i])});
+        continue;
+      }
+      auto segment_size = messages_[i].segment_size == 0 ? data.size() : messages_[i].segment_size;
+      for (auto part = Slice(data); !part.empty(); part.remove_prefix(td::min(segment_size, part.size()))) {
+        queue.push(UdpMessage{addresses_[i], buffers_[i].from_slice(part.substr(0, segment_size)), errors_[i].clone()});
+      }
+      buffers_[i].confirm_read((data.size() + 7) & ~7);
+    }
+    if (status.is_error() && !UdpSocketFd::is_critical_read_error(status)) {
+      queue.push(UdpMessage{{}, {}, std::move(status)});
+      return td::Status::OK();
+    }
+    return status;
+  }
+
+ private:
+  static constexpr size_t BUFFER_SIZE = 8;
+  static constexpr size_t MAX_PACKET_SIZE = 1 << 16;
+  static constexpr size_t RESERVED_SIZE = MAX_PACKET_SIZE * 2;
+  std::array<UdpSocketFd::InboundMessage, BUFFER_SIZE> messages_;
+  std::array<BufferSlice, BUFFER_SIZE> buffers_;
+  std::array<IPAddress, BUFFER_SIZE> addresses_;
+  std::array<Status, BUFFER_SIZE> errors_;
+};
+
 }  // namespace detail
 
 #endif
@@ -171,15 +287,25 @@ class BufferedUdp : public UdpSocketFd {
   }
 
   Status flush_send_once() TD_WARN_UNUSED_RESULT {
+    if (is_gso_enabled()) {
+      init_thread_local<detail::UdpGsoWriter>(udp_gso_writer_);
+      return udp_gso_writer_->write_once(as_fd(), output_);
+    }
     return detail::UdpWriter::write_once(as_fd(), output_);
   }
 
   Status flush_read_once() TD_WARN_UNUSED_RESULT {
+    if (is_gro_enabled()) {
+      init_thread_local<detail::UdpGroReader>(udp_gro_reader_);
+      return udp_gro_reader_->read_once(as_fd(), input_);
+    }
     init_thread_local<detail::UdpReader>(udp_reader_);
     return udp_reader_->read_once(as_fd(), input_);
   }
 
   static TD_THREAD_LOCAL detail::UdpReader *udp_reader_;
+  static TD_THREAD_LOCAL detail::UdpGroReader *udp_gro_reader_;
+  static TD_THREAD_LOCAL detail::UdpGsoWriter *udp_gso_writer_;
 #endif
 };
 
@@ -93,13 +93,27 @@ BufferAllocator::ReaderPtr BufferAllocator::create_reader(const ReaderPtr &raw)
   return ReaderPtr(raw.get());
 }
 
+BufferAllocator::ReaderPtr BufferAllocator::create_reader_external(MutableSlice data, unique_ptr<Destructor> owner) {
+  auto *buffer_raw = create_buffer_raw(0);
+  buffer_raw->data_size_ = data.size();
+  buffer_raw->data_ptr_ = data.ubegin();
+  buffer_raw->external_owner_ = std::move(owner);
+  buffer_raw->end_.store(data.size(), std::memory_order_relaxed);
+  buffer_raw->has_writer_.store(false, std::memory_order_relaxed);
+  buffer_raw->was_reader_ = true;
+  return ReaderPtr(buffer_raw);
+}
+
 void BufferAllocator::dec_ref_cnt(BufferRaw *ptr) {
   int left = ptr->ref_cnt_.fetch_sub(1, std::memory_order_acq_rel);
   if (left == 1) {
     auto buf_size = max(sizeof(BufferRaw), TD_OFFSETOF(BufferRaw, data_) + ptr->data_size_);
+    if (ptr->data_ptr_ != ptr->data_) {
+      buf_size = sizeof(BufferRaw);
+    }
     buffer_mem -= buf_size;
     ptr->~BufferRaw();
-    delete[] ptr;
+    delete[] reinterpret_cast<char *>(ptr);
   }
 }
 
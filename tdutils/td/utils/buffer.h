@@ -19,6 +19,7 @@
 #pragma once
 
 #include "td/utils/common.h"
+#include "td/utils/Destructor.h"
 #include "td/utils/port/thread_local.h"
 #include "td/utils/Slice.h"
 
@@ -29,10 +30,15 @@
 namespace td {
 
 struct BufferRaw {
-  explicit BufferRaw(size_t size) : data_size_(size) {
+  explicit BufferRaw(size_t size) : data_size_(size), data_ptr_(data_) {
   }
   size_t data_size_;
 
+  // Points to data_, or to external memory owned by external_owner_ (e.g. a memory mapping of a file).
+  // External buffers have no writer and are never written by readers
+  unsigned char *data_ptr_;
+  unique_ptr<Destructor> external_owner_;
+
   // Constant after first reader is created.
   // May be change by writer before it.
   // So writer may do prepends till there is no reader created.
@@ -78,6 +84,9 @@ class BufferAllocator {
 
   static ReaderPtr create_reader(const ReaderPtr &raw);
 
+  // Reader of memory, which isn't allocated by BufferAllocator; owner is destroyed with the last reference
+  static ReaderPtr create_reader_external(MutableSlice data, unique_ptr<Destructor> owner);
+
   static size_t get_buffer_mem();
 
   static void clear_thread_local();
@@ -153,7 +162,7 @@ class BufferSlice {
     if (is_null()) {
       return Slice();
     }
-    return Slice(buffer_->data_ + begin_, size());
+    return Slice(buffer_->data_ptr_ + begin_, size());
   }
 
   operator Slice() const {
@@ -164,7 +173,7 @@ class BufferSlice {
     if (is_null()) {
       return MutableSlice();
     }
-    return MutableSlice(buffer_->data_ + begin_, size());
+    return MutableSlice(buffer_->data_ptr_ + begin_, size());
   }
 
   Slice prepare_read() const {
@@ -191,8 +200,8 @@ class BufferSlice {
 
   BufferSlice from_slice(Slice slice) const {
     auto res = BufferSlice(BufferAllocator::create_reader(buffer_));
-    res.begin_ = static_cast<size_t>(slice.ubegin() - buffer_->data_);
-    res.end_ = static_cast<size_t>(slice.uend() - buffer_->data_);
+    res.begin_ = static_cast<size_t>(slice.ubegin() - buffer_->data_ptr_);
+    res.end_ = static_cast<size_t>(slice.uend() - buffer_->data_ptr_);
     CHECK(buffer_->begin_ <= res.begin_);
     CHECK(res.begin_ <= res.end_);
     CHECK(res.end_ <= buffer_->end_.load(std::memory_order_relaxed));
@@ -18,6 +18,7 @@
 */
 #include "td/utils/port/MemoryMapping.h"
 
+#include "td/utils/Destructor.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 
@@ -28,6 +29,8 @@
 
 #if TD_WINDOWS
 #else
+#include <cerrno>
+
 #include <sys/mman.h>
 #include <unistd.h>
 #endif
@@ -37,6 +40,16 @@ namespace td {
 class MemoryMapping::Impl {
  public:
   Impl(MutableSlice data, int64 offset) : data_(data), offset_(offset) {
+  }
+  Impl(const Impl &) = delete;
+  Impl &operator=(const Impl &) = delete;
+  ~Impl() {
+#if !TD_WINDOWS
+    if (munmap(data_.data(), data_.size()) != 0) {
+      auto munmap_errno = errno;
+      LOG(ERROR) << Status::PosixError(munmap_errno, "munmap call failed");
+    }
+#endif
   }
   Slice as_slice() const {
     return data_.substr(narrow_cast<size_t>(offset_));
@@ -69,10 +82,9 @@ Result<MemoryMapping> MemoryMapping::create_anonymous(const MemoryMapping::Optio
   return Status::Error("Unsupported yet");
 }
 
-Result<MemoryMapping> MemoryMapping::create_from_file(const FileFd &file_fd, const MemoryMapping::Options &options) {
-#if TD_WINDOWS
-  return Status::Error("Unsupported yet");
-#else
+#if !TD_WINDOWS
+static Result<std::pair<MutableSlice, int64>> map_file(const FileFd &file_fd, const MemoryMapping::Options &options,
+                                                       int prot) {
   if (file_fd.empty()) {
     return Status::Error("Can't create memory mapping: file is empty");
   }
@@ -87,7 +99,10 @@ Result<MemoryMapping> MemoryMapping::create_from_file(const FileFd &file_fd, con
   if (options.size < 0) {
     end = stat.size_;
   } else {
-    end = begin + stat.size_;
+    end = td::min(begin + options.size, stat.size_);
+  }
+  if (end <= begin) {
+    return Status::Error(PSLICE() << "Can't create memory mapping: empty range at offset " << begin);
   }
 
   TRY_RESULT(page_size, get_page_size());
@@ -96,12 +111,36 @@ Result<MemoryMapping> MemoryMapping::create_from_file(const FileFd &file_fd, con
   auto data_offset = begin - fixed_begin;
   TRY_RESULT(data_size, narrow_cast_safe<size_t>(end - fixed_begin));
 
-  void *data = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, narrow_cast<off_t>(fixed_begin));
+  void *data = mmap(nullptr, data_size, prot, MAP_PRIVATE, fd, narrow_cast<off_t>(fixed_begin));
   if (data == MAP_FAILED) {
     return OS_ERROR("mmap call failed");
   }
+  return std::make_pair(MutableSlice(static_cast<char *>(data), data_size), data_offset);
+}
+#endif
 
-  return MemoryMapping(make_unique<Impl>(MutableSlice(static_cast<char *>(data), data_size), data_offset));
+Result<MemoryMapping> MemoryMapping::create_from_file(const FileFd &file_fd, const MemoryMapping::Options &options) {
+#if TD_WINDOWS
+  return Status::Error("Unsupported yet");
+#else
+  TRY_RESULT(mapped, map_file(file_fd, options, PROT_READ));
+  return MemoryMapping(make_unique<Impl>(mapped.first, mapped.second));
+#endif
+}
+
+Result<BufferSlice> MemoryMapping::create_buffer_slice_from_file(const FileFd &file_fd,
+                                                                 const MemoryMapping::Options &options) {
+#if TD_WINDOWS
+  return Status::Error("Unsupported yet");
+#else
+  TRY_RESULT(mapped, map_file(file_fd, options, PROT_READ | PROT_WRITE));
+  auto data = mapped.first;
+  auto data_offset = narrow_cast<size_t>(mapped.second);
+  // start reading ahead now, so that the pages are likely in memory when the buffer is used
+  madvise(data.data(), data.size(), MADV_WILLNEED);
+  auto impl = make_unique<Impl>(data, mapped.second);
+  auto owner = create_destructor([impl = std::move(impl)] {});
+  return BufferSlice(BufferAllocator::create_reader_external(data.substr(data_offset), std::move(owner)));
 #endif
 }
 
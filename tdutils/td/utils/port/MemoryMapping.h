@@ -18,6 +18,7 @@
 */
 #pragma once
 
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/port/FileFd.h"
 #include "td/utils/Slice.h"
@@ -45,6 +46,9 @@ class MemoryMapping {
 
   static Result<MemoryMapping> create_anonymous(const Options &options = {});
   static Result<MemoryMapping> create_from_file(const FileFd &file, const Options &options = {});
+  // Maps a range of the file into a BufferSlice without copying it. The mapping is private and copy-on-write,
+  // so changes of the buffer never reach the file. The mapping lives while the BufferSlice or its clones exist
+  static Result<BufferSlice> create_buffer_slice_from_file(const FileFd &file, const Options &options = {});
 
   Slice as_slice() const;
   MutableSlice as_mutable_slice();  // returns empty slice if memory is read-only
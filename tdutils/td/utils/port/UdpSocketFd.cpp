@@ -45,9 +45,11 @@
 
 #if TD_LINUX
 #include <linux/errqueue.h>
+#include <netinet/udp.h>
 #endif
 #endif  // TD_PORT_POSIX
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cstring>
@@ -400,10 +402,19 @@ class UdpSocketReceiveHelper {
   }
 
   void from_native(struct msghdr &message_header, size_t message_size, UdpSocketFd::InboundMessage &message) {
+    message.segment_size = 0;
 #if TD_LINUX
     struct cmsghdr *cmsg;
     struct sock_extended_err *ee = nullptr;
     for (cmsg = CMSG_FIRSTHDR(&message_header); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message_header, cmsg)) {
+#ifdef UDP_GRO
+      if (cmsg->cmsg_type == UDP_GRO && cmsg->cmsg_level == IPPROTO_UDP) {
+        int segment_size;
+        std::memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+        message.segment_size = segment_size > 0 ? static_cast<size_t>(segment_size) : 0;
+        continue;
+      }
+#endif
       if (cmsg->cmsg_type == IP_PKTINFO && cmsg->cmsg_level == IPPROTO_IP) {
         //auto *pi = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
       } else if (cmsg->cmsg_type == IPV6_PKTINFO && cmsg->cmsg_level == IPPROTO_IPV6) {
@@ -464,14 +475,29 @@ class UdpSocketSendHelper {
     io_vec_.iov_len = message.data.size();
     message_header.msg_iov = &io_vec_;
     message_header.msg_iovlen = 1;
-    //TODO
     message_header.msg_control = nullptr;
     message_header.msg_controllen = 0;
     message_header.msg_flags = 0;
+#if TD_LINUX && defined(UDP_SEGMENT)
+    if (message.segment_size != 0 && message.segment_size < message.data.size()) {
+      std::memset(control_buf_.data(), 0, control_buf_.size());
+      message_header.msg_control = control_buf_.data();
+      message_header.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+      auto *cmsg = CMSG_FIRSTHDR(&message_header);
+      cmsg->cmsg_level = IPPROTO_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      auto segment_size = narrow_cast<uint16_t>(message.segment_size);
+      std::memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+    }
+#endif
   }
 
  private:
   struct iovec io_vec_;
+#if TD_LINUX && defined(UDP_SEGMENT)
+  alignas(struct cmsghdr) std::array<char, CMSG_SPACE(sizeof(uint16_t))> control_buf_;
+#endif
 };
 
 class UdpSocketFdImpl {
@@ -496,6 +522,41 @@ class UdpSocketFdImpl {
     get_poll_info().clear_flags(PollFlags::Error());
     return Status::OK();
   }
+
+  Status enable_gso() {
+#if TD_LINUX && defined(UDP_SEGMENT)
+    // there is nothing to switch on, just check that the kernel knows the option
+    int segment_size = 0;
+    socklen_t len = sizeof(segment_size);
+    if (getsockopt(get_native_fd().socket(), IPPROTO_UDP, UDP_SEGMENT, &segment_size, &len) != 0) {
+      return OS_SOCKET_ERROR("Failed to get UDP_SEGMENT");
+    }
+    gso_enabled_ = true;
+    return Status::OK();
+#else
+    return Status::Error("UDP_SEGMENT is not supported");
+#endif
+  }
+  bool is_gso_enabled() const {
+    return gso_enabled_;
+  }
+
+  Status enable_gro() {
+#if TD_LINUX && defined(UDP_GRO)
+    int flags = 1;
+    if (setsockopt(get_native_fd().socket(), IPPROTO_UDP, UDP_GRO, &flags, sizeof(flags)) != 0) {
+      return OS_SOCKET_ERROR("Failed to set UDP_GRO");
+    }
+    gro_enabled_ = true;
+    return Status::OK();
+#else
+    return Status::Error("UDP_GRO is not supported");
+#endif
+  }
+  bool is_gro_enabled() const {
+    return gro_enabled_;
+  }
+
   Status receive_message(UdpSocketFd::InboundMessage &message, bool &is_received) {
     is_received = false;
     int flags = 0;
@@ -572,8 +633,32 @@ class UdpSocketFdImpl {
       is_sent = true;
       return Status::OK();
     }
+    if (process_segmented_send_error(message, sendmsg_errno)) {
+      return Status::OK();
+    }
     return process_sendmsg_error(sendmsg_errno, is_sent);
   }
+
+  // Returns true if the error was caused by a segmented send, which isn't supported for the socket.
+  // The offload is switched off then, and the message is left unsent to be resent by the caller without segmentation
+  bool process_segmented_send_error(const UdpSocketFd::OutboundMessage &message, int sendmsg_errno) {
+    if (message.segment_size == 0 || message.segment_size >= message.data.size()) {
+      return false;
+    }
+    switch (sendmsg_errno) {
+      case EIO:  // no checksum offload on the output device
+      case EINVAL:
+      case EMSGSIZE:
+      case ENOPROTOOPT:
+      case EOPNOTSUPP:
+        LOG(WARNING) << "Disable UDP segmentation offload for " << get_native_fd() << ": "
+                     << Status::PosixError(sendmsg_errno, "segmented send has failed");
+        gso_enabled_ = false;
+        return true;
+      default:
+        return false;
+    }
+  }
   Status process_sendmsg_error(int sendmsg_errno, bool &is_sent) {
     if (sendmsg_errno == EAGAIN
 #if EAGAIN != EWOULDBLOCK
@@ -630,6 +715,9 @@ class UdpSocketFdImpl {
   }
 
   Status send_messages(Span<UdpSocketFd::OutboundMessage> messages, size_t &cnt) {
+    CHECK(gso_enabled_ || std::all_of(messages.begin(), messages.end(), [](auto &message) {
+      return message.segment_size == 0 || message.segment_size >= message.data.size();
+    }));
 #if TD_HAS_MMSG
     return send_messages_fast(messages, cnt);
 #else
@@ -647,6 +735,8 @@ class UdpSocketFdImpl {
 
  private:
   PollableFdInfo info_;
+  bool gso_enabled_{false};
+  bool gro_enabled_{false};
 
   Status send_messages_slow(Span<UdpSocketFd::OutboundMessage> messages, size_t &cnt) {
     cnt = 0;
@@ -656,6 +746,9 @@ class UdpSocketFdImpl {
       auto error = send_message(message, is_sent);
       cnt += is_sent;
       TRY_STATUS(std::move(error));
+      if (!is_sent) {
+        break;
+      }
     }
     return Status::OK();
   }
@@ -682,6 +775,10 @@ class UdpSocketFdImpl {
       cnt = sendmmsg_res;
       return Status::OK();
     }
+    if (process_segmented_send_error(messages[0], sendmmsg_errno)) {
+      cnt = 0;
+      return Status::OK();
+    }
 
     bool is_sent = false;
     auto status = process_sendmsg_error(sendmmsg_errno, is_sent);
@@ -761,7 +858,7 @@ const PollableFdInfo &UdpSocketFd::get_poll_info() const {
   return impl_->get_poll_info();
 }
 
-Result<UdpSocketFd> UdpSocketFd::open(const IPAddress &address) {
+Result<UdpSocketFd> UdpSocketFd::open(const IPAddress &address, bool reuse_port) {
   NativeFd native_fd{socket(address.get_address_family(), SOCK_DGRAM, IPPROTO_UDP)};
   if (!native_fd) {
     return OS_SOCKET_ERROR("Failed to create a socket");
@@ -775,6 +872,15 @@ Result<UdpSocketFd> UdpSocketFd::open(const IPAddress &address) {
   BOOL flags = TRUE;
 #endif
   setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&flags), sizeof(flags));
+  if (reuse_port) {
+#ifdef SO_REUSEPORT
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char *>(&flags), sizeof(flags)) != 0) {
+      return OS_SOCKET_ERROR("Failed to set SO_REUSEPORT");
+    }
+#else
+    return Status::Error("SO_REUSEPORT is not supported");
+#endif
+  }
   // TODO: SO_REUSEADDR, SO_KEEPALIVE, TCP_NODELAY, SO_SNDBUF, SO_RCVBUF, TCP_QUICKACK, SO_LINGER
 
   auto bind_addr = address.get_any_addr();
@@ -842,6 +948,19 @@ Result<uint32> UdpSocketFd::maximize_rcv_buffer(uint32 max) {
 #endif
 
 #if TD_PORT_POSIX
+Status UdpSocketFd::enable_gso() {
+  return impl_->enable_gso();
+}
+bool UdpSocketFd::is_gso_enabled() const {
+  return impl_->is_gso_enabled();
+}
+Status UdpSocketFd::enable_gro() {
+  return impl_->enable_gro();
+}
+bool UdpSocketFd::is_gro_enabled() const {
+  return impl_->is_gro_enabled();
+}
+
 Status UdpSocketFd::send_message(const OutboundMessage &message, bool &is_sent) {
   return impl_->send_message(message, is_sent);
 }
@@ -857,6 +976,19 @@ Status UdpSocketFd::receive_messages(MutableSpan<InboundMessage> messages, size_
 }
 #endif
 #if TD_PORT_WINDOWS
+Status UdpSocketFd::enable_gso() {
+  return Status::Error("UDP segmentation offload is not supported");
+}
+bool UdpSocketFd::is_gso_enabled() const {
+  return false;
+}
+Status UdpSocketFd::enable_gro() {
+  return Status::Error("UDP receive offload is not supported");
+}
+bool UdpSocketFd::is_gro_enabled() const {
+  return false;
+}
+
 Result<optional<UdpMessage>> UdpSocketFd::receive() {
   return impl_->receive();
 }
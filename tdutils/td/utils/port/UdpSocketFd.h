@@ -60,7 +60,17 @@ class UdpSocketFd {
   Result<uint32> maximize_snd_buffer(uint32 max_buffer_size = 0);
   Result<uint32> maximize_rcv_buffer(uint32 max_buffer_size = 0);
 
-  static Result<UdpSocketFd> open(const IPAddress &address) TD_WARN_UNUSED_RESULT;
+  // with reuse_port several sockets can be bound to the same port; the kernel spreads incoming flows between them
+  static Result<UdpSocketFd> open(const IPAddress &address, bool reuse_port = false) TD_WARN_UNUSED_RESULT;
+
+  // UDP segmentation offload (Linux UDP_SEGMENT): an outbound message with non-zero segment_size is sent as a train
+  // of datagrams of that size. Is switched off automatically if the kernel or the device refuses a segmented send
+  Status enable_gso() TD_WARN_UNUSED_RESULT;
+  bool is_gso_enabled() const;
+  // UDP receive offload (Linux UDP_GRO): an inbound message may hold several datagrams of segment_size bytes each,
+  // so receive buffers must be large enough for a coalesced message (up to 64KB)
+  Status enable_gro() TD_WARN_UNUSED_RESULT;
+  bool is_gro_enabled() const;
 
   PollableFdInfo &get_poll_info();
   const PollableFdInfo &get_poll_info() const;
@@ -75,11 +85,13 @@ class UdpSocketFd {
   struct OutboundMessage {
     const IPAddress *to;
     Slice data;
+    size_t segment_size = 0;
   };
   struct InboundMessage {
     IPAddress *from;
     MutableSlice data;
     Status *error;
+    size_t segment_size = 0;
   };
 
   Status send_message(const OutboundMessage &message, bool &is_sent) TD_WARN_UNUSED_RESULT;
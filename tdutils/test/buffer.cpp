@@ -19,6 +19,10 @@
 #include "td/utils/tests.h"
 
 #include "td/utils/buffer.h"
+#include "td/utils/filesystem.h"
+#include "td/utils/port/FileFd.h"
+#include "td/utils/port/MemoryMapping.h"
+#include "td/utils/port/path.h"
 #include "td/utils/Random.h"
 
 using namespace td;
@@ -68,3 +72,34 @@ TEST(Buffer, buffer_builder) {
     ASSERT_EQ(builder.extract().as_slice(), str);
   }
 }
+
+#if !TD_WINDOWS
+TEST(Buffer, memory_mapped_slice) {
+  CSlice path = "test_memory_mapped_slice";
+  unlink(path).ignore();
+  auto content = rand_string('a', 'z', 100000);
+  write_file(path, content).ensure();
+
+  BufferSlice slice;
+  {
+    auto fd = FileFd::open(path, FileFd::Read).move_as_ok();
+    auto options = MemoryMapping::Options().with_offset(5000).with_size(50000);
+    slice = MemoryMapping::create_buffer_slice_from_file(fd, options).move_as_ok();
+    auto tail =
+        MemoryMapping::create_buffer_slice_from_file(fd, MemoryMapping::Options().with_offset(90000).with_size(50000))
+            .move_as_ok();
+    ASSERT_EQ(Slice(content).substr(90000), tail.as_slice());
+  }
+  ASSERT_EQ(Slice(content).substr(5000, 50000), slice.as_slice());
+
+  auto part = slice.from_slice(slice.as_slice().substr(100, 1000));
+  auto copy = slice.clone();
+  slice = BufferSlice();
+  ASSERT_EQ(Slice(content).substr(5100, 1000), part.as_slice());
+  // the mapping is private, writes don't reach the file
+  copy.as_slice()[0] = 'A';
+  ASSERT_EQ('A', copy.as_slice()[0]);
+  ASSERT_EQ(content, read_file_str(path).move_as_ok());
+  unlink(path).ignore();
+}
+#endif
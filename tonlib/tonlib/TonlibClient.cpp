@@ -78,6 +78,12 @@ struct GetAccountState {
   using ReturnType = td::unique_ptr<AccountState>;
 };
 
+struct GetAccountStates {
+  std::vector<block::StdAddress> addresses;
+  td::optional<ton::BlockIdExt> block_id;
+  using ReturnType = std::vector<td::unique_ptr<AccountState>>;
+};
+
 struct GetAccountStateByTransaction {
   block::StdAddress address;
   std::int64_t lt;
@@ -176,6 +182,15 @@ static block::AccountState create_account_state(ton::tl_object_ptr<ton::lite_api
   res.is_virtualized = from->mode_ > 0;
   return res;
 }
+static block::AccountStates create_account_states(ton::tl_object_ptr<ton::lite_api::liteServer_accountStates> from) {
+  block::AccountStates res;
+  res.blk = ton::create_block_id(from->id_);
+  res.shard_blk = ton::create_block_id(from->shardblk_);
+  res.shard_proof = std::move(from->shard_proof_);
+  res.proof = std::move(from->proof_);
+  res.states = std::move(from->states_);
+  return res;
+}
 struct RawAccountState {
   td::int64 balance = -1;
 
@@ -1251,6 +1266,92 @@ class RemoteRunSmcMethod : public td::actor::Actor {
   }
 };
 
+static td::Result<RawAccountState> parse_raw_account_state(ton::BlockIdExt block_id,
+                                                           block::AccountState::Info info) {
+  RawAccountState res;
+  res.block_id = block_id;
+  res.info = std::move(info);
+  auto cell = res.info.root;
+  //std::ostringstream outp;
+  //block::gen::t_Account.print_ref(outp, cell);
+  //LOG(INFO) << outp.str();
+  if (cell.is_null()) {
+    return res;
+  }
+  block::gen::Account::Record_account account;
+  if (!tlb::unpack_cell(cell, account)) {
+    return td::Status::Error("Failed to unpack Account");
+  }
+  {
+    block::gen::StorageInfo::Record storage_info;
+    if (!tlb::csr_unpack(account.storage_stat, storage_info)) {
+      return td::Status::Error("Failed to unpack StorageInfo");
+    }
+    res.storage_last_paid = storage_info.last_paid;
+    td::RefInt256 due_payment;
+    if (storage_info.due_payment->prefetch_ulong(1) == 1) {
+      vm::CellSlice& cs2 = storage_info.due_payment.write();
+      cs2.advance(1);
+      due_payment = block::tlb::t_Grams.as_integer_skip(cs2);
+      if (due_payment.is_null() || !cs2.empty_ext()) {
+        return td::Status::Error("Failed to upack due_payment");
+      }
+    } else {
+      due_payment = td::RefInt256{true, 0};
+    }
+    block::gen::StorageUsed::Record storage_used;
+    if (!tlb::csr_unpack(storage_info.used, storage_used)) {
+      return td::Status::Error("Failed to unpack StorageInfo");
+    }
+    unsigned long long u = 0;
+    vm::CellStorageStat storage_stat;
+    u |= storage_stat.cells = block::tlb::t_VarUInteger_7.as_uint(*storage_used.cells);
+    u |= storage_stat.bits = block::tlb::t_VarUInteger_7.as_uint(*storage_used.bits);
+    u |= storage_stat.public_cells = block::tlb::t_VarUInteger_7.as_uint(*storage_used.public_cells);
+    //LOG(DEBUG) << "last_paid=" << res.storage_last_paid << "; cells=" << storage_stat.cells
+    //<< " bits=" << storage_stat.bits << " public_cells=" << storage_stat.public_cells;
+    if (u == std::numeric_limits<td::uint64>::max()) {
+      return td::Status::Error("Failed to unpack StorageStat");
+    }
+
+    res.storage_stat = storage_stat;
+  }
+
+  block::gen::AccountStorage::Record storage;
+  if (!tlb::csr_unpack(account.storage, storage)) {
+    return td::Status::Error("Failed to unpack AccountStorage");
+  }
+  TRY_RESULT(balance, to_balance(storage.balance));
+  res.balance = balance;
+  auto state_tag = block::gen::t_AccountState.get_tag(*storage.state);
+  if (state_tag < 0) {
+    return td::Status::Error("Failed to parse AccountState tag");
+  }
+  if (state_tag == block::gen::AccountState::account_frozen) {
+    block::gen::AccountState::Record_account_frozen state;
+    if (!tlb::csr_unpack(storage.state, state)) {
+      return td::Status::Error("Failed to parse AccountState");
+    }
+    res.frozen_hash = state.state_hash.as_slice().str();
+    return res;
+  }
+  if (state_tag != block::gen::AccountState::account_active) {
+    return res;
+  }
+  block::gen::AccountState::Record_account_active state;
+  if (!tlb::csr_unpack(storage.state, state)) {
+    return td::Status::Error("Failed to parse AccountState");
+  }
+  block::gen::StateInit::Record state_init;
+  res.state = vm::CellBuilder().append_cellslice(state.x).finalize();
+  if (!tlb::csr_unpack(state.x, state_init)) {
+    return td::Status::Error("Failed to parse StateInit");
+  }
+  state_init.code->prefetch_maybe_ref(res.code);
+  state_init.data->prefetch_maybe_ref(res.data);
+  return res;
+}
+
 class GetRawAccountState : public td::actor::Actor {
  public:
   GetRawAccountState(ExtClientRef ext_client_ref, block::StdAddress address, td::optional<ton::BlockIdExt> block_id,
@@ -1287,113 +1388,195 @@ class GetRawAccountState : public td::actor::Actor {
       ton::tl_object_ptr<ton::lite_api::liteServer_accountState> raw_account_state) {
     auto account_state = create_account_state(std::move(raw_account_state));
     TRY_RESULT(info, account_state.validate(block_id_.value(), address_));
-    auto serialized_state = account_state.state.clone();
-    RawAccountState res;
-    res.block_id = block_id_.value();
-    res.info = std::move(info);
-    auto cell = res.info.root;
-    //std::ostringstream outp;
-    //block::gen::t_Account.print_ref(outp, cell);
-    //LOG(INFO) << outp.str();
-    if (cell.is_null()) {
-      return res;
+    return parse_raw_account_state(block_id_.value(), std::move(info));
+  }
+
+  void with_last_block(td::Result<LastBlockState> r_last_block) {
+    check(do_with_last_block(std::move(r_last_block)));
+  }
+
+  void with_block_id() {
+    client_.send_query(
+        ton::lite_api::liteServer_getAccountState(
+            ton::create_tl_lite_block_id(block_id_.value()),
+            ton::create_tl_object<ton::lite_api::liteServer_accountId>(address_.workchain, address_.addr)),
+        [self = this](auto r_state) { self->with_account_state(std::move(r_state)); });
+  }
+
+  td::Status do_with_last_block(td::Result<LastBlockState> r_last_block) {
+    TRY_RESULT(last_block, std::move(r_last_block));
+    block_id_ = std::move(last_block.last_block_id);
+    with_block_id();
+    return td::Status::OK();
+  }
+
+  void start_up() override {
+    if (block_id_) {
+      with_block_id();
+    } else {
+      client_.with_last_block(
+          [self = this](td::Result<LastBlockState> r_last_block) { self->with_last_block(std::move(r_last_block)); });
     }
-    block::gen::Account::Record_account account;
-    if (!tlb::unpack_cell(cell, account)) {
-      return td::Status::Error("Failed to unpack Account");
+  }
+
+  void check(td::Status status) {
+    if (status.is_error()) {
+      promise_.set_error(std::move(status));
+      stop();
     }
-    {
-      block::gen::StorageInfo::Record storage_info;
-      if (!tlb::csr_unpack(account.storage_stat, storage_info)) {
-        return td::Status::Error("Failed to unpack StorageInfo");
-      }
-      res.storage_last_paid = storage_info.last_paid;
-      td::RefInt256 due_payment;
-      if (storage_info.due_payment->prefetch_ulong(1) == 1) {
-        vm::CellSlice& cs2 = storage_info.due_payment.write();
-        cs2.advance(1);
-        due_payment = block::tlb::t_Grams.as_integer_skip(cs2);
-        if (due_payment.is_null() || !cs2.empty_ext()) {
-          return td::Status::Error("Failed to upack due_payment");
+  }
+  void hangup() override {
+    check(TonlibError::Cancelled());
+  }
+};
+
+// fetches states of many accounts with liteServer.getAccountStates, one query per shard (and per
+// max_account_states_count accounts), each answered by a single proof over the shard state
+class GetRawAccountStates : public td::actor::Actor {
+ public:
+  GetRawAccountStates(ExtClientRef ext_client_ref, std::vector<block::StdAddress> addresses,
+                      td::optional<ton::BlockIdExt> block_id, td::actor::ActorShared<> parent,
+                      td::Promise<std::vector<RawAccountState>>&& promise)
+      : addresses_(std::move(addresses))
+      , block_id_(std::move(block_id))
+      , promise_(std::move(promise))
+      , parent_(std::move(parent)) {
+    client_.set_client(ext_client_ref);
+  }
+
+  static constexpr size_t max_accounts_per_query = 1024;
+
+ private:
+  std::vector<block::StdAddress> addresses_;
+  td::optional<ton::BlockIdExt> block_id_;
+  td::Promise<std::vector<RawAccountState>> promise_;
+  td::actor::ActorShared<> parent_;
+  ExtClient client_;
+  std::vector<RawAccountState> states_;
+  size_t pending_queries_{0};
+
+  void with_shards(td::Result<ton::tl_object_ptr<ton::lite_api::liteServer_allShardsInfo>> r_shards) {
+    check(do_with_shards(std::move(r_shards)));
+  }
+
+  td::Status do_with_shards(td::Result<ton::tl_object_ptr<ton::lite_api::liteServer_allShardsInfo>> r_shards) {
+    TRY_RESULT(shards, std::move(r_shards));
+    // only used to group the accounts: every answer carries its own proof of the shard block
+    TRY_RESULT_PREFIX(root, vm::std_boc_deserialize(shards->data_.as_slice()),
+                      TonlibError::InvalidBagOfCells("shard configuration"));
+    block::ShardConfig sh_conf;
+    if (!sh_conf.unpack(vm::load_cell_slice_ref(root))) {
+      return td::Status::Error("cannot extract shard block list from shard configuration");
+    }
+    return send_queries(&sh_conf);
+  }
+
+  td::Status send_queries(const block::ShardConfig* sh_conf) {
+    std::map<ton::ShardIdFull, std::vector<size_t>> groups;
+    for (size_t i = 0; i < addresses_.size(); i++) {
+      auto& address = addresses_[i];
+      ton::ShardIdFull shard{ton::masterchainId};
+      if (address.workchain != ton::masterchainId) {
+        CHECK(sh_conf);
+        auto ref = sh_conf->get_shard_hash(ton::extract_addr_prefix(address.workchain, address.addr).as_leaf_shard(),
+                                           false);
+        if (ref.is_null()) {
+          return td::Status::Error(PSLICE() << "no shard for account " << address.workchain << ":"
+                                            << address.addr.to_hex());
         }
-      } else {
-        due_payment = td::RefInt256{true, 0};
-      }
-      block::gen::StorageUsed::Record storage_used;
-      if (!tlb::csr_unpack(storage_info.used, storage_used)) {
-        return td::Status::Error("Failed to unpack StorageInfo");
+        shard = ref->shard();
       }
-      unsigned long long u = 0;
-      vm::CellStorageStat storage_stat;
-      u |= storage_stat.cells = block::tlb::t_VarUInteger_7.as_uint(*storage_used.cells);
-      u |= storage_stat.bits = block::tlb::t_VarUInteger_7.as_uint(*storage_used.bits);
-      u |= storage_stat.public_cells = block::tlb::t_VarUInteger_7.as_uint(*storage_used.public_cells);
-      //LOG(DEBUG) << "last_paid=" << res.storage_last_paid << "; cells=" << storage_stat.cells
-      //<< " bits=" << storage_stat.bits << " public_cells=" << storage_stat.public_cells;
-      if (u == std::numeric_limits<td::uint64>::max()) {
-        return td::Status::Error("Failed to unpack StorageStat");
+      groups[shard].push_back(i);
+    }
+    states_.resize(addresses_.size());
+    for (auto& group : groups) {
+      auto& indices = group.second;
+      for (size_t from = 0; from < indices.size(); from += max_accounts_per_query) {
+        std::vector<size_t> chunk(indices.begin() + from,
+                                  indices.begin() + std::min(indices.size(), from + max_accounts_per_query));
+        std::vector<ton::tl_object_ptr<ton::lite_api::liteServer_accountId>> accounts;
+        for (auto i : chunk) {
+          accounts.push_back(
+              ton::create_tl_object<ton::lite_api::liteServer_accountId>(addresses_[i].workchain, addresses_[i].addr));
+        }
+        pending_queries_++;
+        client_.send_query(
+            ton::lite_api::liteServer_getAccountStates(ton::create_tl_lite_block_id(block_id_.value()),
+                                                       std::move(accounts)),
+            [self = this, chunk = std::move(chunk)](auto r_states) mutable {
+              self->with_account_states(std::move(chunk), std::move(r_states));
+            });
       }
-
-      res.storage_stat = storage_stat;
     }
+    return td::Status::OK();
+  }
 
-    block::gen::AccountStorage::Record storage;
-    if (!tlb::csr_unpack(account.storage, storage)) {
-      return td::Status::Error("Failed to unpack AccountStorage");
-    }
-    TRY_RESULT(balance, to_balance(storage.balance));
-    res.balance = balance;
-    auto state_tag = block::gen::t_AccountState.get_tag(*storage.state);
-    if (state_tag < 0) {
-      return td::Status::Error("Failed to parse AccountState tag");
-    }
-    if (state_tag == block::gen::AccountState::account_frozen) {
-      block::gen::AccountState::Record_account_frozen state;
-      if (!tlb::csr_unpack(storage.state, state)) {
-        return td::Status::Error("Failed to parse AccountState");
-      }
-      res.frozen_hash = state.state_hash.as_slice().str();
-      return res;
+  void with_account_states(std::vector<size_t> indices,
+                           td::Result<ton::tl_object_ptr<ton::lite_api::liteServer_accountStates>> r_states) {
+    check(do_with_account_states(std::move(indices), std::move(r_states)));
+  }
+
+  td::Status do_with_account_states(std::vector<size_t> indices,
+                                    td::Result<ton::tl_object_ptr<ton::lite_api::liteServer_accountStates>> r_states) {
+    TRY_RESULT(raw_states, std::move(r_states));
+    TRY_RESULT_PREFIX(states, TRY_VM(do_with_account_states(indices, std::move(raw_states))),
+                      TonlibError::ValidateAccountState());
+    for (size_t j = 0; j < indices.size(); j++) {
+      states_[indices[j]] = std::move(states[j]);
     }
-    if (state_tag != block::gen::AccountState::account_active) {
-      return res;
+    if (--pending_queries_ == 0) {
+      promise_.set_value(std::move(states_));
+      stop();
     }
-    block::gen::AccountState::Record_account_active state;
-    if (!tlb::csr_unpack(storage.state, state)) {
-      return td::Status::Error("Failed to parse AccountState");
+    return td::Status::OK();
+  }
+
+  td::Result<std::vector<RawAccountState>> do_with_account_states(
+      const std::vector<size_t>& indices, ton::tl_object_ptr<ton::lite_api::liteServer_accountStates> raw_states) {
+    auto account_states = create_account_states(std::move(raw_states));
+    std::vector<block::StdAddress> addresses;
+    for (auto i : indices) {
+      addresses.push_back(addresses_[i]);
     }
-    block::gen::StateInit::Record state_init;
-    res.state = vm::CellBuilder().append_cellslice(state.x).finalize();
-    if (!tlb::csr_unpack(state.x, state_init)) {
-      return td::Status::Error("Failed to parse StateInit");
+    TRY_RESULT(infos, account_states.validate(block_id_.value(), addresses));
+    std::vector<RawAccountState> res;
+    for (auto& info : infos) {
+      TRY_RESULT(state, parse_raw_account_state(block_id_.value(), std::move(info)));
+      res.push_back(std::move(state));
     }
-    state_init.code->prefetch_maybe_ref(res.code);
-    state_init.data->prefetch_maybe_ref(res.data);
-    return res;
+    return std::move(res);
   }
 
   void with_last_block(td::Result<LastBlockState> r_last_block) {
     check(do_with_last_block(std::move(r_last_block)));
   }
 
-  void with_block_id() {
-    client_.send_query(
-        ton::lite_api::liteServer_getAccountState(
-            ton::create_tl_lite_block_id(block_id_.value()),
-            ton::create_tl_object<ton::lite_api::liteServer_accountId>(address_.workchain, address_.addr)),
-        [self = this](auto r_state) { self->with_account_state(std::move(r_state)); });
+  td::Status with_block_id() {
+    if (addresses_.empty()) {
+      promise_.set_value({});
+      stop();
+      return td::Status::OK();
+    }
+    bool need_shards = std::any_of(addresses_.begin(), addresses_.end(), [](const block::StdAddress& address) {
+      return address.workchain != ton::masterchainId;
+    });
+    if (!need_shards) {
+      return send_queries(nullptr);
+    }
+    client_.send_query(ton::lite_api::liteServer_getAllShardsInfo(ton::create_tl_lite_block_id(block_id_.value())),
+                       [self = this](auto r_shards) { self->with_shards(std::move(r_shards)); });
+    return td::Status::OK();
   }
 
   td::Status do_with_last_block(td::Result<LastBlockState> r_last_block) {
     TRY_RESULT(last_block, std::move(r_last_block));
     block_id_ = std::move(last_block.last_block_id);
-    with_block_id();
-    return td::Status::OK();
+    return with_block_id();
   }
 
   void start_up() override {
     if (block_id_) {
-      with_block_id();
+      check(with_block_id());
     } else {
       client_.with_last_block(
           [self = this](td::Result<LastBlockState> r_last_block) { self->with_last_block(std::move(r_last_block)); });
@@ -3258,6 +3441,28 @@ td::Status TonlibClient::do_request(tonlib_api::raw_getAccountState& request,
   return td::Status::OK();
 }
 
+td::Status TonlibClient::do_request(tonlib_api::raw_getAccountStates& request,
+                                    td::Promise<object_ptr<tonlib_api::raw_fullAccountStates>>&& promise) {
+  std::vector<block::StdAddress> addresses;
+  for (auto& address : request.account_addresses_) {
+    if (!address) {
+      return TonlibError::EmptyField("account_addresses");
+    }
+    TRY_RESULT(account_address, get_account_address(address->account_address_));
+    addresses.push_back(std::move(account_address));
+  }
+  make_request(int_api::GetAccountStates{std::move(addresses), query_context_.block_id.copy()},
+               promise.wrap([](auto&& res) -> td::Result<object_ptr<tonlib_api::raw_fullAccountStates>> {
+                 std::vector<object_ptr<tonlib_api::raw_fullAccountState>> states;
+                 for (auto& state : res) {
+                   TRY_RESULT(raw_state, state->to_raw_fullAccountState());
+                   states.push_back(std::move(raw_state));
+                 }
+                 return tonlib_api::make_object<tonlib_api::raw_fullAccountStates>(std::move(states));
+               }));
+  return td::Status::OK();
+}
+
 td::Status TonlibClient::do_request(tonlib_api::raw_getAccountStateByTransaction& request,
                                     td::Promise<object_ptr<tonlib_api::raw_fullAccountState>>&& promise) {
   if (!request.account_address_) {
@@ -5233,6 +5438,22 @@ td::Status TonlibClient::do_request(int_api::GetAccountState request,
   return td::Status::OK();
 }
 
+td::Status TonlibClient::do_request(int_api::GetAccountStates request,
+                                    td::Promise<std::vector<td::unique_ptr<AccountState>>>&& promise) {
+  auto actor_id = actor_id_++;
+  actors_[actor_id] = td::actor::create_actor<GetRawAccountStates>(
+      "GetAccountStates", client_.get_client(), request.addresses, std::move(request.block_id),
+      actor_shared(this, actor_id),
+      promise.wrap([addresses = request.addresses, wallet_id = wallet_id_](auto&& states) {
+        std::vector<td::unique_ptr<AccountState>> res;
+        for (size_t i = 0; i < states.size(); i++) {
+          res.push_back(td::make_unique<AccountState>(addresses[i], std::move(states[i]), wallet_id));
+        }
+        return res;
+      }));
+  return td::Status::OK();
+}
+
 td::Status TonlibClient::do_request(int_api::GetAccountStateByTransaction request,
                                     td::Promise<td::unique_ptr<AccountState>>&& promise) {
   auto actor_id = actor_id_++;
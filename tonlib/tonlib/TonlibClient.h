@@ -39,6 +39,7 @@
 namespace tonlib {
 namespace int_api {
 struct GetAccountState;
+struct GetAccountStates;
 struct GetAccountStateByTransaction;
 struct GetPrivateKey;
 struct GetDnsResolver;
@@ -237,6 +238,8 @@ class TonlibClient : public td::actor::Actor {
 
   td::Status do_request(tonlib_api::raw_getAccountState& request,
                         td::Promise<object_ptr<tonlib_api::raw_fullAccountState>>&& promise);
+  td::Status do_request(tonlib_api::raw_getAccountStates& request,
+                        td::Promise<object_ptr<tonlib_api::raw_fullAccountStates>>&& promise);
   td::Status do_request(tonlib_api::raw_getAccountStateByTransaction& request,
                         td::Promise<object_ptr<tonlib_api::raw_fullAccountState>>&& promise);
   td::Status do_request(tonlib_api::raw_getTransactions& request,
@@ -361,6 +364,8 @@ class TonlibClient : public td::actor::Actor {
                           td::Promise<object_ptr<tonlib_api::dns_resolved>>&& promise);
 
   td::Status do_request(int_api::GetAccountState request, td::Promise<td::unique_ptr<AccountState>>&&);
+  td::Status do_request(int_api::GetAccountStates request,
+                        td::Promise<std::vector<td::unique_ptr<AccountState>>>&&);
   td::Status do_request(int_api::GetAccountStateByTransaction request, td::Promise<td::unique_ptr<AccountState>>&&);
   td::Status do_request(int_api::GetPrivateKey request, td::Promise<KeyStorage::PrivateKey>&&);
   td::Status do_request(int_api::GetDnsResolver request, td::Promise<block::StdAddress>&&);
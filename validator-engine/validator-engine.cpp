@@ -73,6 +73,8 @@
 #include "block-parse.h"
 #include "common/delay.h"
 #include "block/precompiled-smc/PrecompiledSmartContract.h"
+#include "block/account-cache.h"
+#include "common/refcnt.hpp"
 
 Config::Config() {
   out_port = 3278;
@@ -1365,8 +1367,18 @@ td::Status ValidatorEngine::load_global_config() {
     validator_options_.write().set_session_logs_file(session_logs_file_);
   }
   validator_options_.write().set_celldb_compress_depth(celldb_compress_depth_);
+  validator_options_.write().set_celldb_prefetch_depth(celldb_prefetch_depth_);
+  validator_options_.write().set_celldb_cell_cache_size(celldb_cell_cache_size_);
+  validator_options_.write().set_celldb_rocksdb_options(celldb_rocksdb_options_);
+  validator_options_.write().set_state_db_rocksdb_options(state_db_rocksdb_options_);
+  validator_options_.write().set_archive_rocksdb_options(archive_rocksdb_options_);
   validator_options_.write().set_max_open_archive_files(max_open_archive_files_);
   validator_options_.write().set_archive_preload_period(archive_preload_period_);
+  validator_options_.write().set_archive_compress_after(archive_compress_after_);
+  validator_options_.write().set_archive_import_depth(archive_import_depth_);
+  validator_options_.write().set_validation_threads(validation_threads_);
+  validator_options_.write().set_collator_threads(collator_threads_);
+  validator_options_.write().set_liteserver_disk_cache_size(liteserver_disk_cache_size_);
 
   std::vector<ton::BlockIdExt> h;
   for (auto &x : conf.validator_->hardforks_) {
@@ -1686,7 +1698,8 @@ void ValidatorEngine::start() {
 }
 
 void ValidatorEngine::start_adnl() {
-  adnl_network_manager_ = ton::adnl::AdnlNetworkManager::create(config_.out_port);
+  adnl_network_manager_ =
+      ton::adnl::AdnlNetworkManager::create(config_.out_port, adnl_receive_sockets_, adnl_udp_offload_);
   adnl_ = ton::adnl::Adnl::create(db_root_, keyring_.get());
   td::actor::send_closure(adnl_, &ton::adnl::Adnl::register_network_manager, adnl_network_manager_.get());
 
@@ -3796,6 +3809,55 @@ int main(int argc, char *argv[]) {
                          });
                          return td::Status::OK();
                        });
+  p.add_checked_option('\0', "celldb-prefetch-depth",
+                       "when a cell is loaded from celldb, read ahead its children up to X levels below (default: 0)",
+                       [&](td::Slice arg) {
+                         TRY_RESULT(value, td::to_integer_safe<td::uint32>(arg));
+                         acts.push_back([&x, value]() {
+                           td::actor::send_closure(x, &ValidatorEngine::set_celldb_prefetch_depth, value);
+                         });
+                         return td::Status::OK();
+                       });
+  p.add_checked_option('\0', "celldb-cell-cache-size",
+                       "size in bytes of the cache of decoded cells shared by celldb readers (default: 0, disabled)",
+                       [&](td::Slice arg) {
+                         TRY_RESULT(value, td::to_integer_safe<td::uint64>(arg));
+                         acts.push_back([&x, value]() {
+                           td::actor::send_closure(x, &ValidatorEngine::set_celldb_cell_cache_size,
+                                                   static_cast<size_t>(value));
+                         });
+                         return td::Status::OK();
+                       });
+  p.add_checked_option('\0', "celldb-rocksdb-options",
+                       "rocksdb options of celldb, comma-separated: cache_size=<bytes>, filter=none|bloom|ribbon, "
+                       "filter_bits=<bits per key>, partitioned_index, point_lookup, compression=<l0>:<l1>:... "
+                       "(none|snappy|lz4|zstd), e.g. \"cache_size=16G,point_lookup,filter=ribbon\"",
+                       [&](td::Slice arg) {
+                         TRY_RESULT(value, td::RocksDbOptions::parse(arg));
+                         acts.push_back([&x, value = std::move(value)]() {
+                           td::actor::send_closure(x, &ValidatorEngine::set_celldb_rocksdb_options, value);
+                         });
+                         return td::Status::OK();
+                       });
+  p.add_checked_option('\0', "statedb-rocksdb-options",
+                       "rocksdb options of the state db, in the format of --celldb-rocksdb-options",
+                       [&](td::Slice arg) {
+                         TRY_RESULT(value, td::RocksDbOptions::parse(arg));
+                         acts.push_back([&x, value = std::move(value)]() {
+                           td::actor::send_closure(x, &ValidatorEngine::set_state_db_rocksdb_options, value);
+                         });
+                         return td::Status::OK();
+                       });
+  p.add_checked_option('\0', "archive-rocksdb-options",
+                       "rocksdb options of the archive index and archive slices, in the format of "
+                       "--celldb-rocksdb-options; all of them share one cache of the given cache_size",
+                       [&](td::Slice arg) {
+                         TRY_RESULT(value, td::RocksDbOptions::parse(arg));
+                         acts.push_back([&x, value = std::move(value)]() {
+                           td::actor::send_closure(x, &ValidatorEngine::set_archive_rocksdb_options, value);
+                         });
+                         return td::Status::OK();
+                       });
   p.add_checked_option(
       '\0', "max-archive-fd", "limit for a number of open file descriptirs in archive manager. 0 is unlimited (default)",
       [&](td::Slice s) -> td::Status {
@@ -3813,9 +3875,93 @@ int main(int argc, char *argv[]) {
         acts.push_back([&x, v]() { td::actor::send_closure(x, &ValidatorEngine::set_archive_preload_period, v); });
         return td::Status::OK();
       });
+  p.add_checked_option(
+      '\0', "archive-compress-after",
+      "compress archive slices with blocks older than X seconds in background, 0 disables it (default: 0)",
+      [&](td::Slice s) -> td::Status {
+        auto v = td::to_double(s);
+        if (v < 0) {
+          return td::Status::Error("archive-compress-after should be non-negative");
+        }
+        acts.push_back([&x, v]() { td::actor::send_closure(x, &ValidatorEngine::set_archive_compress_after, v); });
+        return td::Status::OK();
+      });
+  p.add_checked_option(
+      '\0', "archive-import-depth",
+      "number of masterchain blocks of a downloaded archive slice decoded and checked in parallel ahead of the block "
+      "being applied, 1 imports block by block (default: 1)",
+      [&](td::Slice s) -> td::Status {
+        TRY_RESULT(v, td::to_integer_safe<td::uint32>(s));
+        if (v < 1 || v > 1024) {
+          return td::Status::Error("bad value for --archive-import-depth: should be in range [1..1024]");
+        }
+        acts.push_back([&x, v]() { td::actor::send_closure(x, &ValidatorEngine::set_archive_import_depth, v); });
+        return td::Status::OK();
+      });
+  p.add_checked_option(
+      '\0', "validation-threads",
+      "number of threads checking transactions of a block candidate in parallel (default: 1)",
+      [&](td::Slice s) -> td::Status {
+        TRY_RESULT(v, td::to_integer_safe<td::uint32>(s));
+        if (v < 1 || v > 256) {
+          return td::Status::Error("bad value for --validation-threads: should be in range [1..256]");
+        }
+        acts.push_back([&x, v]() { td::actor::send_closure(x, &ValidatorEngine::set_validation_threads, v); });
+        return td::Status::OK();
+      });
+  p.add_checked_option(
+      '\0', "collator-threads",
+      "number of threads speculatively executing transactions of a collated block in parallel (default: 1)",
+      [&](td::Slice s) -> td::Status {
+        TRY_RESULT(v, td::to_integer_safe<td::uint32>(s));
+        if (v < 1 || v > 256) {
+          return td::Status::Error("bad value for --collator-threads: should be in range [1..256]");
+        }
+        acts.push_back([&x, v]() { td::actor::send_closure(x, &ValidatorEngine::set_collator_threads, v); });
+        return td::Status::OK();
+      });
+  p.add_checked_option(
+      '\0', "adnl-receive-sockets",
+      "number of SO_REUSEPORT sockets receiving udp on every adnl port, each decrypting channel packets on its own "
+      "thread (default: 1)",
+      [&](td::Slice s) -> td::Status {
+        TRY_RESULT(v, td::to_integer_safe<td::uint32>(s));
+        if (v < 1 || v > 256) {
+          return td::Status::Error("bad value for --adnl-receive-sockets: should be in range [1..256]");
+        }
+        acts.push_back([&x, v]() { td::actor::send_closure(x, &ValidatorEngine::set_adnl_receive_sockets, v); });
+        return td::Status::OK();
+      });
+  p.add_option('\0', "adnl-udp-offload",
+               "send bulk adnl traffic with UDP segmentation offload and receive with UDP GRO where the kernel "
+               "supports them (disabled by default)",
+               [&]() {
+                 acts.push_back([&x]() { td::actor::send_closure(x, &ValidatorEngine::set_adnl_udp_offload); });
+               });
+  p.add_checked_option(
+      '\0', "liteserver-disk-cache-size",
+      "size in bytes of the on-disk cache of liteserver responses to queries on fixed blocks (default: 0, disabled)",
+      [&](td::Slice s) -> td::Status {
+        TRY_RESULT(v, td::to_integer_safe<td::uint64>(s));
+        acts.push_back([&x, v]() {
+          td::actor::send_closure(x, &ValidatorEngine::set_liteserver_disk_cache_size, static_cast<size_t>(v));
+        });
+        return td::Status::OK();
+      });
+  p.add_checked_option('\0', "account-cache-size",
+                       "number of unpacked accounts kept between collations and validations of consecutive blocks "
+                       "(default: 0, disabled)",
+                       [](td::Slice s) -> td::Status {
+                         TRY_RESULT(v, td::to_integer_safe<td::uint32>(s));
+                         block::AccountCache::shared().set_capacity(v);
+                         return td::Status::OK();
+                       });
   p.add_option('\0', "enable-precompiled-smc",
                "enable exectuion of precompiled contracts (experimental, disabled by default)",
                []() { block::precompiled::set_precompiled_execution_enabled(true); });
+  p.add_option('\0', "enable-tvm-object-pool",
+               "reuse memory of freed TVM objects during each VM run (experimental, disabled by default)",
+               []() { td::CntPool::set_enabled(true); });
   auto S = p.run(argc, argv);
   if (S.is_error()) {
     LOG(ERROR) << "failed to parse options: " << S.move_as_error();
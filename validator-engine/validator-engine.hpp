@@ -204,8 +204,20 @@ class ValidatorEngine : public td::actor::Actor {
   double archive_ttl_ = 0;
   double key_proof_ttl_ = 0;
   td::uint32 celldb_compress_depth_ = 0;
+  td::uint32 celldb_prefetch_depth_ = 0;
+  size_t celldb_cell_cache_size_ = 0;
+  td::RocksDbOptions celldb_rocksdb_options_;
+  td::RocksDbOptions state_db_rocksdb_options_;
+  td::RocksDbOptions archive_rocksdb_options_;
   size_t max_open_archive_files_ = 0;
   double archive_preload_period_ = 0.0;
+  double archive_compress_after_ = 0.0;
+  td::uint32 archive_import_depth_ = 1;
+  td::uint32 validation_threads_ = 1;
+  td::uint32 collator_threads_ = 1;
+  td::uint32 adnl_receive_sockets_ = 1;
+  bool adnl_udp_offload_ = false;
+  size_t liteserver_disk_cache_size_ = 0;
   bool read_config_ = false;
   bool started_keyring_ = false;
   bool started_ = false;
@@ -266,12 +278,48 @@ class ValidatorEngine : public td::actor::Actor {
   void set_celldb_compress_depth(td::uint32 value) {
     celldb_compress_depth_ = value;
   }
+  void set_celldb_prefetch_depth(td::uint32 value) {
+    celldb_prefetch_depth_ = value;
+  }
+  void set_celldb_cell_cache_size(size_t value) {
+    celldb_cell_cache_size_ = value;
+  }
+  void set_celldb_rocksdb_options(td::RocksDbOptions value) {
+    celldb_rocksdb_options_ = std::move(value);
+  }
+  void set_state_db_rocksdb_options(td::RocksDbOptions value) {
+    state_db_rocksdb_options_ = std::move(value);
+  }
+  void set_archive_rocksdb_options(td::RocksDbOptions value) {
+    archive_rocksdb_options_ = std::move(value);
+  }
   void set_max_open_archive_files(size_t value) {
     max_open_archive_files_ = value;
   }
   void set_archive_preload_period(double value) {
     archive_preload_period_ = value;
   }
+  void set_archive_compress_after(double value) {
+    archive_compress_after_ = value;
+  }
+  void set_archive_import_depth(td::uint32 value) {
+    archive_import_depth_ = value;
+  }
+  void set_validation_threads(td::uint32 value) {
+    validation_threads_ = value;
+  }
+  void set_collator_threads(td::uint32 value) {
+    collator_threads_ = value;
+  }
+  void set_adnl_receive_sockets(td::uint32 value) {
+    adnl_receive_sockets_ = value;
+  }
+  void set_adnl_udp_offload() {
+    adnl_udp_offload_ = true;
+  }
+  void set_liteserver_disk_cache_size(size_t value) {
+    liteserver_disk_cache_size_ = value;
+  }
   void start_up() override;
   ValidatorEngine() {
   }
@@ -0,0 +1,94 @@
+/*
+    This file is part of TON Blockchain source code.
+
+    TON Blockchain is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    TON Blockchain is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with TON Blockchain.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give permission
+    to link the code of portions of this program with the OpenSSL library.
+    You must obey the GNU General Public License in all respects for all
+    of the code used other than OpenSSL. If you modify file(s) with this
+    exception, you may extend this exception to your version of the file(s),
+    but you are not obligated to do so. If you do not wish to do so, delete this
+    exception statement from your version. If you delete this exception statement
+    from all source files in the program, then also delete it here.
+*/
+// Single-threaded benchmark of serving getArchiveSlice: slices of a package file are read with read_file (as before)
+// or with Package::read_raw (memory-mapped), and wrapped into an rldp answer, as the rldp send path does.
+// Prints MB/s served by one core for both ways.
+#include "auto/tl/ton_api.h"
+#include "tl-utils/tl-utils.hpp"
+#include "td/utils/benchmark.h"
+#include "td/utils/filesystem.h"
+#include "td/utils/OptionParser.h"
+#include "td/utils/port/path.h"
+#include "td/utils/Random.h"
+#include "td/utils/Time.h"
+#include "validator/db/package.hpp"
+
+#include <iostream>
+
+int main(int argc, char *argv[]) {
+  std::string path = "archive-slice-benchmark.pack";
+  td::uint64 package_size = 256 << 20;
+  td::uint32 slice_size = 2 << 20;
+  double duration = 3.0;
+
+  td::OptionParser p;
+  p.set_description("MB/s of archive slices served by one core with read_file and with memory-mapped packages");
+  p.add_option('f', "file", "package file to create (default: archive-slice-benchmark.pack)",
+               [&](td::Slice arg) { path = arg.str(); });
+  p.add_checked_option('m', "package-size", "package size in MB (default: 256)", [&](td::Slice arg) {
+    TRY_RESULT(value, td::to_integer_safe<td::uint64>(arg));
+    package_size = value << 20;
+    return td::Status::OK();
+  });
+  p.add_checked_option('s', "slice-size", "slice size in bytes (default: 2097152)", [&](td::Slice arg) {
+    TRY_RESULT_ASSIGN(slice_size, td::to_integer_safe<td::uint32>(arg));
+    return td::Status::OK();
+  });
+  p.add_option('d', "duration", "seconds to measure every way (default: 3)",
+               [&](td::Slice arg) { duration = td::to_double(arg); });
+  p.run(argc, argv).ensure();
+
+  td::unlink(path).ignore();
+  auto package = ton::Package::open(path, false, true).move_as_ok();
+  td::BufferSlice entry(1 << 20);
+  td::Random::secure_bytes(entry.as_slice());
+  for (td::uint64 i = 0; package.size() < package_size; i++) {
+    package.append(PSTRING() << "entry_" << i, entry.as_slice(), false);
+  }
+  package.sync();
+
+  auto run = [&](const char *name, auto read_slice) {
+    td::uint64 served = 0;
+    td::uint64 offset = 0;
+    auto start = td::Time::now();
+    auto deadline = td::Timestamp::in(duration);
+    while (!deadline.is_in_past()) {
+      auto data = read_slice(offset).move_as_ok();
+      offset = data.size() < slice_size ? 0 : offset + data.size();
+      served += data.size();
+      auto answer = ton::serialize_tl_object(
+          ton::create_tl_object<ton::ton_api::rldp_answer>(td::Bits256::zero(), std::move(data)), true);
+      td::do_not_optimize_away(answer.as_slice()[0]);
+    }
+    auto elapsed = td::Time::now() - start;
+    std::cout << name << ": " << static_cast<double>(served) / elapsed / (1 << 20) << " MB/s" << std::endl;
+  };
+  run("read_file", [&](td::uint64 offset) { return td::read_file(path, slice_size, offset); });
+  run("mmap", [&](td::uint64 offset) { return package.read_raw(offset, slice_size); });
+
+  td::unlink(path).ignore();
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+    This file is part of TON Blockchain source code.
+
+    TON Blockchain is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    TON Blockchain is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with TON Blockchain.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give permission
+    to link the code of portions of this program with the OpenSSL library.
+    You must obey the GNU General Public License in all respects for all
+    of the code used other than OpenSSL. If you modify file(s) with this
+    exception, you may extend this exception to your version of the file(s),
+    but you are not obligated to do so. If you do not wish to do so, delete this
+    exception statement from your version. If you delete this exception statement
+    from all source files in the program, then also delete it here.
+*/
+// Compression of archive packages: a package (an existing one, or a generated one with block-like entries: hashes
+// between low-entropy fields) is compressed with Package::compress. Prints the compression ratio and the latency of
+// reading random entries from the original and from the compressed package, which must return the same data.
+#include "td/utils/OptionParser.h"
+#include "td/utils/port/path.h"
+#include "td/utils/Random.h"
+#include "td/utils/Time.h"
+#include "validator/db/package.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+int main(int argc, char *argv[]) {
+  std::string source;
+  std::string path = "package-compression-benchmark.pack";
+  td::uint64 package_size = 256 << 20;
+  td::uint32 reads = 10000;
+
+  td::OptionParser p;
+  p.set_description("compression ratio and random read latency of compressed archive packages");
+  p.add_option('p', "package", "existing package to compress instead of a generated one",
+               [&](td::Slice arg) { source = arg.str(); });
+  p.add_option('f', "file", "package file to create (default: package-compression-benchmark.pack)",
+               [&](td::Slice arg) { path = arg.str(); });
+  p.add_checked_option('m', "package-size", "size of a generated package in MB (default: 256)", [&](td::Slice arg) {
+    TRY_RESULT(value, td::to_integer_safe<td::uint64>(arg));
+    package_size = value << 20;
+    return td::Status::OK();
+  });
+  p.add_checked_option('n', "reads", "number of random reads (default: 10000)", [&](td::Slice arg) {
+    TRY_RESULT_ASSIGN(reads, td::to_integer_safe<td::uint32>(arg));
+    return td::Status::OK();
+  });
+  p.run(argc, argv).ensure();
+
+  if (source.empty()) {
+    td::unlink(path).ignore();
+    auto package = ton::Package::open(path, false, true).move_as_ok();
+    td::Random::Xorshift128plus rnd(123);
+    for (td::uint64 i = 0; package.size() < package_size; i++) {
+      std::string entry(td::Random::fast(1 << 10, 1 << 18), '\0');
+      for (size_t j = 0; j + 64 <= entry.size(); j += 64) {
+        for (size_t k = 0; k < 32; k += 8) {
+          auto x = rnd();
+          std::memcpy(&entry[j + k], &x, 8);
+        }
+        entry[j + 32 + rnd() % 32] = static_cast<char>(rnd() % 16);
+        entry[j + 63] = static_cast<char>(i);
+      }
+      package.append(PSTRING() << "block_" << i, entry, false);
+    }
+    package.sync();
+    source = path;
+  }
+
+  auto package = ton::Package::open(source, true, false).move_as_ok();
+  std::vector<td::uint64> offsets;
+  package.iterate([&](std::string, td::BufferSlice, td::uint64 offset) {
+    offsets.push_back(offset);
+    return true;
+  });
+
+  auto compressed_path = path + ".z";
+  auto start = td::Time::now();
+  auto data_size = package.compress(compressed_path).move_as_ok();
+  auto elapsed = td::Time::now() - start;
+  auto compressed = ton::Package::open(compressed_path, true, false).move_as_ok();
+  CHECK(compressed.is_compressed() && compressed.size() == data_size);
+  size_t idx = 0;
+  compressed.iterate([&](std::string, td::BufferSlice, td::uint64 offset) {
+    CHECK(idx < offsets.size() && offsets[idx++] == offset);
+    return true;
+  });
+  CHECK(idx == offsets.size());
+  auto compressed_size = compressed.fd().get_size().move_as_ok();
+  std::cout << "entries: " << offsets.size() << ", size: " << (data_size >> 20)
+            << " MB, compressed: " << (compressed_size >> 20)
+            << " MB, ratio: " << static_cast<double>(data_size) / static_cast<double>(compressed_size)
+            << ", compression: " << static_cast<double>(data_size) / elapsed / (1 << 20) << " MB/s" << std::endl;
+
+  std::vector<td::uint64> sample;
+  for (td::uint32 i = 0; i < reads && !offsets.empty(); i++) {
+    sample.push_back(offsets[td::Random::fast(0, static_cast<int>(offsets.size()) - 1)]);
+  }
+  auto run = [&](const char *name, const ton::Package &pack) {
+    std::vector<double> latencies;
+    for (auto offset : sample) {
+      auto begin = td::Time::now();
+      auto entry = pack.read(offset).move_as_ok();
+      latencies.push_back(td::Time::now() - begin);
+      auto expected = package.read(offset).move_as_ok();
+      CHECK(entry.first == expected.first && entry.second.as_slice() == expected.second.as_slice());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (auto x : latencies) {
+      total += x;
+    }
+    auto us = [](double x) { return static_cast<td::uint64>(x * 1e6); };
+    std::cout << name << ": avg " << us(total / static_cast<double>(latencies.size())) << "us, p50 "
+              << us(latencies[latencies.size() / 2]) << "us, p99 " << us(latencies[latencies.size() * 99 / 100])
+              << "us" << std::endl;
+  };
+  if (!sample.empty()) {
+    run("plain random read", package);
+    run("compressed random read", compressed);
+  }
+
+  for (td::uint64 offset = 0; offset < package.size() + 4; offset += (1 << 20) + 3) {
+    CHECK(package.read_raw(offset, 1 << 20).ok().as_slice() == compressed.read_raw(offset, 1 << 20).ok().as_slice());
+  }
+  td::unlink(compressed_path).ignore();
+  if (source == path) {
+    td::unlink(path).ignore();
+  }
+  return 0;
+}
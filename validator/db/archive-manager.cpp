@@ -601,7 +601,8 @@ void ArchiveManager::load_package(PackageId id) {
   }
 
   desc.file =
-      td::actor::create_actor<ArchiveSlice>("slice", id.id, id.key, id.temp, false, db_root_, archive_lru_.get());
+      td::actor::create_actor<ArchiveSlice>("slice", id.id, id.key, id.temp, false, db_root_, archive_lru_.get(),
+                                            opts_->get_archive_rocksdb_options());
 
   m.emplace(id, std::move(desc));
   update_permanent_slices();
@@ -636,7 +637,8 @@ const ArchiveManager::FileDescription *ArchiveManager::add_file_desc(ShardIdFull
   td::mkdir(db_root_ + id.path()).ensure();
   std::string prefix = PSTRING() << db_root_ << id.path() << id.name();
   new_desc.file =
-      td::actor::create_actor<ArchiveSlice>("slice", id.id, id.key, id.temp, false, db_root_, archive_lru_.get());
+      td::actor::create_actor<ArchiveSlice>("slice", id.id, id.key, id.temp, false, db_root_, archive_lru_.get(),
+                                            opts_->get_archive_rocksdb_options());
   const FileDescription &desc = f.emplace(id, std::move(new_desc));
   if (!id.temp) {
     update_desc(f, desc, shard, seqno, ts, lt);
@@ -829,7 +831,8 @@ void ArchiveManager::start_up() {
   if (opts_->get_max_open_archive_files() > 0) {
     archive_lru_ = td::actor::create_actor<ArchiveLru>("archive_lru", opts_->get_max_open_archive_files());
   }
-  index_ = std::make_shared<td::RocksDb>(td::RocksDb::open(db_root_ + "/files/globalindex").move_as_ok());
+  index_ = std::make_shared<td::RocksDb>(
+      td::RocksDb::open(db_root_ + "/files/globalindex", opts_->get_archive_rocksdb_options()).move_as_ok());
   std::string value;
   auto v = index_->get(create_serialize_tl_object<ton_api::db_files_index_key>().as_slice(), value);
   v.ensure();
@@ -857,6 +860,14 @@ void ArchiveManager::start_up() {
     finalized_up_to_ = R.move_as_ok();
   }
 
+  v = index_->get("compressedupto", value);
+  v.ensure();
+  if (v.move_as_ok() == td::KeyValue::GetStatus::Ok) {
+    auto R = td::to_integer_safe<td::uint32>(value);
+    R.ensure();
+    compressed_up_to_ = R.move_as_ok();
+  }
+
   td::WalkPath::run(db_root_ + "/archive/states/", [&](td::CSlice fname, td::WalkPath::Type t) -> void {
     if (t == td::WalkPath::Type::NotDir) {
       LOG(ERROR) << "checking file " << fname;
@@ -947,6 +958,51 @@ void ArchiveManager::run_gc(UnixTime mc_ts, UnixTime gc_ts, UnixTime archive_ttl
       }
     }
   }
+
+  compress_packages(mc_ts);
+}
+
+void ArchiveManager::compress_packages(UnixTime mc_ts) {
+  auto compress_after = opts_->get_archive_compress_after();
+  if (compress_after <= 0 || compressing_) {
+    return;
+  }
+  // a slice is compressed when the first masterchain block of the next slice is old enough, the latest slice is never
+  // compressed as blocks are still appended to it
+  for (auto it = files_.lower_bound(PackageId{compressed_up_to_, false, false}); it != files_.end(); ++it) {
+    auto next = std::next(it);
+    if (next == files_.end()) {
+      break;
+    }
+    auto first = next->second.first_blocks.find(ShardIdFull{masterchainId});
+    if (first == next->second.first_blocks.end() || first->second.ts + compress_after >= mc_ts) {
+      break;
+    }
+    if (it->second.deleted) {
+      continue;
+    }
+    compressing_ = true;
+    auto id = it->first;
+    auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), id](td::Result<td::Unit> R) {
+      td::actor::send_closure(SelfId, &ArchiveManager::compressed_packages, id, std::move(R));
+    });
+    td::actor::send_closure(it->second.file_actor_id(), &ArchiveSlice::compress, std::move(P));
+    break;
+  }
+}
+
+void ArchiveManager::compressed_packages(PackageId id, td::Result<td::Unit> R) {
+  compressing_ = false;
+  if (R.is_error()) {
+    // the slice stays readable as is, do not retry it forever
+    LOG(ERROR) << "failed to compress archive slice " << id.id << ": " << R.move_as_error();
+  } else {
+    LOG(INFO) << "compressed archive slice " << id.id;
+  }
+  compressed_up_to_ = std::max(compressed_up_to_, id.id + 1);
+  index_->begin_transaction().ensure();
+  index_->set("compressedupto", td::to_string(compressed_up_to_)).ensure();
+  index_->commit_transaction().ensure();
 }
 
 void ArchiveManager::persistent_state_gc(FileHash last) {
@@ -169,6 +169,9 @@ class ArchiveManager : public td::actor::Actor {
   FileMap files_, key_files_, temp_files_;
   td::actor::ActorOwn<ArchiveLru> archive_lru_;
   BlockSeqno finalized_up_to_{0};
+  // all slices with smaller ids have been compressed
+  td::uint32 compressed_up_to_{0};
+  bool compressing_ = false;
   bool async_mode_ = false;
   bool huge_transaction_started_ = false;
   td::uint32 huge_transaction_size_ = 0;
@@ -206,6 +209,9 @@ class ArchiveManager : public td::actor::Actor {
                                  std::function<void(std::string, td::Promise<std::string>)> create_writer);
   void written_perm_state(FileReferenceShort id);
 
+  void compress_packages(UnixTime mc_ts);
+  void compressed_packages(PackageId id, td::Result<td::Unit> R);
+
   void persistent_state_gc(FileHash last);
   void got_gc_masterchain_handle(ConstBlockHandle handle, FileHash hash);
 
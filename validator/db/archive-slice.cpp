@@ -38,6 +38,10 @@ void PackageWriter::append(std::string filename, td::BufferSlice data,
       promise.set_error(td::Status::Error("Package is closed"));
       return;
     }
+    if (p->is_compressed()) {
+      promise.set_error(td::Status::Error("Package is compressed"));
+      return;
+    }
     offset = p->append(std::move(filename), std::move(data), !async_mode_);
     size = p->size();
   }
@@ -63,6 +67,63 @@ class PackageReader : public td::actor::Actor {
   td::Promise<std::pair<std::string, td::BufferSlice>> promise_;
 };
 
+class PackageSliceReader : public td::actor::Actor {
+ public:
+  PackageSliceReader(std::shared_ptr<Package> package, std::string path, td::uint64 offset, td::uint64 limit,
+                     td::uint64 committed_size, td::Promise<td::BufferSlice> promise)
+      : package_(std::move(package))
+      , path_(std::move(path))
+      , offset_(offset)
+      , limit_(limit)
+      , committed_size_(committed_size)
+      , promise_(std::move(promise)) {
+  }
+  void start_up() override {
+    if (!package_) {
+      auto R = Package::open(path_, true, false);
+      if (R.is_error()) {
+        promise_.set_error(R.move_as_error());
+        stop();
+        return;
+      }
+      package_ = std::make_shared<Package>(R.move_as_ok());
+    }
+    auto result = package_->read_raw(offset_, limit_, committed_size_);
+    package_ = {};
+    promise_.set_result(std::move(result));
+    stop();
+  }
+
+ private:
+  std::shared_ptr<Package> package_;
+  std::string path_;
+  td::uint64 offset_;
+  td::uint64 limit_;
+  td::uint64 committed_size_;
+  td::Promise<td::BufferSlice> promise_;
+};
+
+class PackageCompressor : public td::actor::Actor {
+ public:
+  PackageCompressor(std::shared_ptr<Package> package, std::string path, td::Promise<td::uint64> promise)
+      : package_(std::move(package)), path_(std::move(path)), promise_(std::move(promise)) {
+  }
+  void start_up() override {
+    auto result = package_->compress(path_);
+    package_ = {};
+    if (result.is_error()) {
+      td::unlink(path_).ignore();
+    }
+    promise_.set_result(std::move(result));
+    stop();
+  }
+
+ private:
+  std::shared_ptr<Package> package_;
+  std::string path_;
+  td::Promise<td::uint64> promise_;
+};
+
 void ArchiveSlice::add_handle(BlockHandle handle, td::Promise<td::Unit> promise) {
   if (destroyed_) {
     promise.set_error(td::Status::Error(ErrorCode::notready, "package already gc'd"));
@@ -221,6 +282,9 @@ void ArchiveSlice::add_file_cont(size_t idx, FileReference ref_id, td::uint64 of
     kv_->set(ref_id.hash().to_hex(), td::to_string(offset)).ensure();
   }
   commit_transaction();
+  if (idx < packages_.size()) {
+    packages_[idx].committed_size = std::max(packages_[idx].committed_size, size);
+  }
   promise.set_value(td::Unit());
 }
 
@@ -448,8 +512,62 @@ void ArchiveSlice::get_slice(td::uint64 archive_id, td::uint64 offset, td::uint3
   before_query();
   auto value = static_cast<td::uint32>(archive_id >> 32);
   TRY_RESULT_PROMISE(promise, p, choose_package(value, false));
+  // the data is mapped, not read, and copied only once, into the answer; the pages are faulted in by the reader
   promise = begin_async_query(std::move(promise));
-  td::actor::create_actor<db::ReadFile>("readfile", p->path, offset, limit, 0, std::move(promise)).release();
+  td::actor::create_actor<PackageSliceReader>("slicereader", p->package, p->path, offset, limit, p->committed_size,
+                                              std::move(promise))
+      .release();
+}
+
+void ArchiveSlice::compress(td::Promise<td::Unit> promise) {
+  compress_package(0, std::move(promise));
+}
+
+void ArchiveSlice::compress_package(size_t idx, td::Promise<td::Unit> promise) {
+  if (destroyed_) {
+    promise.set_error(td::Status::Error(ErrorCode::notready, "package already gc'd"));
+    return;
+  }
+  before_query();
+  while (idx < packages_.size() && packages_[idx].package->is_compressed()) {
+    idx++;
+  }
+  if (idx == packages_.size()) {
+    promise.set_value(td::Unit());
+    return;
+  }
+  auto &p = packages_[idx];
+  LOG(INFO) << "Compressing archive package " << p.path;
+  // packages are compressed one by one, the copy replaces the package only if nothing was appended meanwhile
+  td::Promise<td::uint64> P = [SelfId = actor_id(this), idx, promise = std::move(promise)](
+                                     td::Result<td::uint64> R) mutable {
+    td::actor::send_closure(SelfId, &ArchiveSlice::compressed_package, idx, std::move(R), std::move(promise));
+  };
+  td::actor::create_actor<PackageCompressor>("compressor", p.package, p.path + ".z", begin_async_query(std::move(P)))
+      .release();
+}
+
+void ArchiveSlice::compressed_package(size_t idx, td::Result<td::uint64> R, td::Promise<td::Unit> promise) {
+  if (destroyed_) {
+    promise.set_error(td::Status::Error(ErrorCode::notready, "package already gc'd"));
+    return;
+  }
+  before_query();
+  CHECK(idx < packages_.size());
+  auto &p = packages_[idx];
+  if (R.is_ok() && R.ok() != p.package->size()) {
+    R = td::Status::Error(ErrorCode::notready, "package was changed during compression");
+  }
+  if (R.is_error()) {
+    td::unlink(p.path + ".z").ignore();
+    promise.set_error(R.move_as_error_prefix(PSTRING() << "failed to compress " << p.path << ": "));
+    return;
+  }
+  td::rename(p.path + ".z", p.path).ensure();
+  auto pack = std::make_shared<Package>(Package::open(p.path, false, false).move_as_ok());
+  p.package = pack;
+  p.writer = td::actor::create_actor<PackageWriter>("writer", pack, async_mode_);
+  compress_package(idx + 1, std::move(promise));
 }
 
 void ArchiveSlice::get_archive_id(BlockSeqno masterchain_seqno, td::Promise<td::uint64> promise) {
@@ -465,7 +583,7 @@ void ArchiveSlice::get_archive_id(BlockSeqno masterchain_seqno, td::Promise<td::
 void ArchiveSlice::before_query() {
   if (status_ == st_closed) {
     LOG(DEBUG) << "Opening archive slice " << db_path_;
-    kv_ = std::make_unique<td::RocksDb>(td::RocksDb::open(db_path_).move_as_ok());
+    kv_ = std::make_unique<td::RocksDb>(td::RocksDb::open(db_path_, rocksdb_options_).move_as_ok());
     std::string value;
     auto R2 = kv_->get("status", value);
     R2.ensure();
@@ -482,15 +600,19 @@ void ArchiveSlice::before_query() {
         R2.ensure();
         slice_size_ = td::to_integer<td::uint32>(value);
         CHECK(slice_size_ > 0);
+        std::vector<std::string> keys;
+        for (td::uint32 i = 0; i < tot; i++) {
+          keys.push_back(PSTRING() << "status." << i);
+          keys.push_back(PSTRING() << "version." << i);
+        }
+        std::vector<td::Slice> key_slices(keys.begin(), keys.end());
+        std::vector<std::string> values;
+        auto statuses = kv_->get_multi(key_slices, &values).move_as_ok();
         for (td::uint32 i = 0; i < tot; i++) {
-          R2 = kv_->get(PSTRING() << "status." << i, value);
-          R2.ensure();
-          auto len = td::to_integer<td::uint64>(value);
-          R2 = kv_->get(PSTRING() << "version." << i, value);
-          R2.ensure();
+          auto len = td::to_integer<td::uint64>(values[2 * i]);
           td::uint32 ver = 0;
-          if (R2.move_as_ok() == td::KeyValue::GetStatus::Ok) {
-            ver = td::to_integer<td::uint32>(value);
+          if (statuses[2 * i + 1] == td::KeyValue::GetStatus::Ok) {
+            ver = td::to_integer<td::uint32>(values[2 * i + 1]);
           }
           auto v = archive_id_ + slice_size_ * i;
           add_package(v, len, ver);
@@ -604,14 +726,15 @@ void ArchiveSlice::set_async_mode(bool mode, td::Promise<td::Unit> promise) {
 }
 
 ArchiveSlice::ArchiveSlice(td::uint32 archive_id, bool key_blocks_only, bool temp, bool finalized, std::string db_root,
-                           td::actor::ActorId<ArchiveLru> archive_lru)
+                           td::actor::ActorId<ArchiveLru> archive_lru, td::RocksDbOptions rocksdb_options)
     : archive_id_(archive_id)
     , key_blocks_only_(key_blocks_only)
     , temp_(temp)
     , finalized_(finalized)
     , p_id_(archive_id_, key_blocks_only_, temp_)
     , db_root_(std::move(db_root))
-    , archive_lru_(std::move(archive_lru)) {
+    , archive_lru_(std::move(archive_lru))
+    , rocksdb_options_(std::move(rocksdb_options)) {
   db_path_ = PSTRING() << db_root_ << p_id_.path() << p_id_.name() << ".index";
 }
 
@@ -652,6 +775,7 @@ void ArchiveSlice::add_package(td::uint32 seqno, td::uint64 size, td::uint32 ver
   auto idx = td::narrow_cast<td::uint32>(packages_.size());
   if (finalized_) {
     packages_.emplace_back(nullptr, td::actor::ActorOwn<PackageWriter>(), seqno, path, idx, version);
+    packages_.back().committed_size = size;
     return;
   }
   auto pack = std::make_shared<Package>(R.move_as_ok());
@@ -660,6 +784,7 @@ void ArchiveSlice::add_package(td::uint32 seqno, td::uint64 size, td::uint32 ver
   }
   auto writer = td::actor::create_actor<PackageWriter>("writer", pack, async_mode_);
   packages_.emplace_back(std::move(pack), std::move(writer), seqno, path, idx, version);
+  packages_.back().committed_size = size;
 }
 
 namespace {
@@ -690,6 +815,7 @@ void ArchiveSlice::destroy(td::Promise<td::Unit> promise) {
 
   for (auto &p : packages_) {
     td::unlink(p.path).ensure();
+    td::unlink(p.path + ".z").ignore();
   }
 
   packages_.clear();
@@ -889,6 +1015,7 @@ void ArchiveSlice::truncate(BlockSeqno masterchain_seqno, ConstBlockHandle handl
   }
 
   pack->package = new_package;
+  pack->committed_size = new_package->size();
   pack->writer.reset();
   td::unlink(pack->path).ensure();
   td::rename(pack->path + ".new", pack->path).ensure();
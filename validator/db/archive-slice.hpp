@@ -19,6 +19,7 @@
 #pragma once
 
 #include "validator/interfaces/db.h"
+#include "td/db/RocksDb.h"
 #include "package.hpp"
 #include "fileref.hpp"
 #include <map>
@@ -81,7 +82,7 @@ class ArchiveLru;
 class ArchiveSlice : public td::actor::Actor {
  public:
   ArchiveSlice(td::uint32 archive_id, bool key_blocks_only, bool temp, bool finalized, std::string db_root,
-               td::actor::ActorId<ArchiveLru> archive_lru);
+               td::actor::ActorId<ArchiveLru> archive_lru, td::RocksDbOptions rocksdb_options = {});
 
   void get_archive_id(BlockSeqno masterchain_seqno, td::Promise<td::uint64> promise);
 
@@ -105,6 +106,8 @@ class ArchiveSlice : public td::actor::Actor {
 
   void destroy(td::Promise<td::Unit> promise);
   void truncate(BlockSeqno masterchain_seqno, ConstBlockHandle handle, td::Promise<td::Unit> promise);
+  // replaces packages of the slice with compressed copies; offsets in the index stay valid, reads are transparent
+  void compress(td::Promise<td::Unit> promise);
 
   void set_async_mode(bool mode, td::Promise<td::Unit> promise);
 
@@ -123,6 +126,8 @@ class ArchiveSlice : public td::actor::Actor {
 
   void add_file_cont(size_t idx, FileReference ref_id, td::uint64 offset, td::uint64 size,
                      td::Promise<td::Unit> promise);
+  void compress_package(size_t idx, td::Promise<td::Unit> promise);
+  void compressed_package(size_t idx, td::Result<td::uint64> R, td::Promise<td::Unit> promise);
 
   /* ltdb */
   td::BufferSlice get_db_key_lt_desc(ShardIdFull shard);
@@ -151,6 +156,7 @@ class ArchiveSlice : public td::actor::Actor {
 
   std::string db_root_;
   td::actor::ActorId<ArchiveLru> archive_lru_;
+  td::RocksDbOptions rocksdb_options_;
   std::unique_ptr<td::KeyValue> kv_;
 
   struct PackageInfo {
@@ -169,6 +175,7 @@ class ArchiveSlice : public td::actor::Actor {
     std::string path;
     td::uint32 idx;
     td::uint32 version;
+    td::uint64 committed_size{0};  // size of the data recorded in the index, the rest may be truncated on reopen
   };
   std::vector<PackageInfo> packages_;
 
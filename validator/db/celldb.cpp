@@ -64,8 +64,8 @@ void CellDbBase::execute_sync(std::function<void()> f) {
 }
 
 CellDbIn::CellDbIn(td::actor::ActorId<RootDb> root_db, td::actor::ActorId<CellDb> parent, std::string path,
-                   td::Ref<ValidatorManagerOptions> opts)
-    : root_db_(root_db), parent_(parent), path_(std::move(path)), opts_(opts) {
+                   td::Ref<ValidatorManagerOptions> opts, std::shared_ptr<vm::DataCellCache> cell_cache)
+    : root_db_(root_db), parent_(parent), path_(std::move(path)), opts_(opts), cell_cache_(std::move(cell_cache)) {
 }
 
 void CellDbIn::start_up() {
@@ -83,10 +83,12 @@ void CellDbIn::start_up() {
   };
 
   CellDbBase::start_up();
-  cell_db_ = std::make_shared<td::RocksDb>(td::RocksDb::open(path_).move_as_ok());
+  cell_db_ = std::make_shared<td::RocksDb>(td::RocksDb::open(path_, opts_->get_celldb_rocksdb_options()).move_as_ok());
 
   boc_ = vm::DynamicBagOfCellsDb::create();
   boc_->set_celldb_compress_depth(opts_->get_celldb_compress_depth());
+  boc_->set_prefetch_options({opts_->get_celldb_prefetch_depth()}, async_executor);
+  boc_->set_cell_cache(cell_cache_);
   boc_->set_loader(std::make_unique<vm::CellLoader>(cell_db_->snapshot(), on_load_callback_)).ensure();
   td::actor::send_closure(parent_, &CellDb::update_snapshot, cell_db_->snapshot());
 
@@ -166,6 +168,12 @@ void CellDbIn::alarm() {
               << " queue_size=" << cells_to_migrate_.size();
     migration_stats_ = {};
   }
+  if (opts_->get_celldb_prefetch_depth() != 0 && prefetch_stats_log_at_.is_in_past()) {
+    auto stats = boc_->get_prefetch_stats();
+    LOG(INFO) << "CellDb prefetch stats: prefetched=" << stats.prefetched << " hits=" << stats.hits
+              << " misses=" << stats.misses << " read_amplification=" << stats.read_amplification();
+    prefetch_stats_log_at_ = td::Timestamp::in(60.0);
+  }
   auto E = get_block(get_empty_key_hash()).move_as_ok();
   auto N = get_block(E.next).move_as_ok();
   if (N.is_empty()) {
@@ -322,22 +330,37 @@ void CellDbIn::migrate_cells() {
   boc_->set_loader(std::make_unique<vm::CellLoader>(*loader)).ensure();
   cell_db_->begin_write_batch().ensure();
   td::uint32 checked = 0, migrated = 0;
+  std::vector<td::Bits256> hashes;
   for (auto it = cells_to_migrate_.begin(); it != cells_to_migrate_.end() && checked < 128; ) {
     ++checked;
-    td::Bits256 hash = *it;
+    hashes.push_back(*it);
     it = cells_to_migrate_.erase(it);
-    auto R = loader->load(hash.as_slice(), true, boc_->as_ext_cell_creator());
-    if (R.is_error()) {
-      continue;
+  }
+  std::vector<td::Slice> keys;
+  for (auto& hash : hashes) {
+    keys.push_back(hash.as_slice());
+  }
+  auto R = loader->load_multi(keys, true, boc_->as_ext_cell_creator());
+  if (R.is_error()) {
+    // some cell failed to load, skip it and check the others one by one
+    std::vector<vm::CellLoader::LoadResult> results;
+    for (auto& key : keys) {
+      auto R2 = loader->load(key, true, boc_->as_ext_cell_creator());
+      if (R2.is_ok()) {
+        results.push_back(R2.move_as_ok());
+      }
     }
-    if (R.ok().status == vm::CellLoader::LoadResult::NotFound) {
+    R = std::move(results);
+  }
+  for (auto& res : R.ok()) {
+    if (res.status == vm::CellLoader::LoadResult::NotFound) {
       continue;
     }
     bool expected_stored_boc =
-        R.ok().cell_->get_depth() == opts_->get_celldb_compress_depth() && opts_->get_celldb_compress_depth() != 0;
-    if (expected_stored_boc != R.ok().stored_boc_) {
+        res.cell_->get_depth() == opts_->get_celldb_compress_depth() && opts_->get_celldb_compress_depth() != 0;
+    if (expected_stored_boc != res.stored_boc_) {
       ++migrated;
-      stor.set(R.ok().refcnt(), R.ok().cell_, expected_stored_boc).ensure();
+      stor.set(res.refcnt(), res.cell_, expected_stored_boc).ensure();
     }
   }
   cell_db_->commit_write_batch().ensure();
@@ -375,6 +398,18 @@ void CellDb::load_cell(RootHash hash, td::Promise<td::Ref<vm::DataCell>> promise
   }
 }
 
+void CellDb::update_snapshot(std::unique_ptr<td::KeyValueReader> snapshot) {
+  started_ = true;
+  boc_->set_loader(std::make_unique<vm::CellLoader>(std::move(snapshot), on_load_callback_)).ensure();
+  // this boc serves most of the reads, CellDbIn logs the stats of its own boc separately
+  if (opts_->get_celldb_prefetch_depth() != 0 && prefetch_stats_log_at_.is_in_past()) {
+    auto stats = boc_->get_prefetch_stats();
+    LOG(INFO) << "CellDb reader prefetch stats: prefetched=" << stats.prefetched << " hits=" << stats.hits
+              << " misses=" << stats.misses << " read_amplification=" << stats.read_amplification();
+    prefetch_stats_log_at_ = td::Timestamp::in(60.0);
+  }
+}
+
 void CellDb::store_cell(BlockIdExt block_id, td::Ref<vm::Cell> cell, td::Promise<td::Ref<vm::DataCell>> promise) {
   td::actor::send_closure(cell_db_, &CellDbIn::store_cell, block_id, std::move(cell), std::move(promise));
 }
@@ -383,11 +418,37 @@ void CellDb::get_cell_db_reader(td::Promise<std::shared_ptr<vm::CellDbReader>> p
   td::actor::send_closure(cell_db_, &CellDbIn::get_cell_db_reader, std::move(promise));
 }
 
+void CellDb::prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise) {
+  std::vector<std::pair<std::string, std::string>> res;
+  if (cell_cache_) {
+    auto stats = cell_cache_->get_stats();
+    res.emplace_back("cellcache.hits", td::to_string(stats.hits));
+    res.emplace_back("cellcache.misses", td::to_string(stats.misses));
+    res.emplace_back("cellcache.hitratio", td::to_string(stats.hit_ratio()));
+    res.emplace_back("cellcache.evictions", td::to_string(stats.evictions));
+    res.emplace_back("cellcache.cells", td::to_string(stats.cells));
+    res.emplace_back("cellcache.bytes", td::to_string(stats.bytes));
+  }
+  if (opts_->get_celldb_prefetch_depth() != 0) {
+    auto stats = boc_->get_prefetch_stats();
+    res.emplace_back("prefetch.prefetched", td::to_string(stats.prefetched));
+    res.emplace_back("prefetch.hits", td::to_string(stats.hits));
+    res.emplace_back("prefetch.misses", td::to_string(stats.misses));
+    res.emplace_back("prefetch.read_amplification", td::to_string(stats.read_amplification()));
+  }
+  promise.set_value(std::move(res));
+}
+
 void CellDb::start_up() {
   CellDbBase::start_up();
   boc_ = vm::DynamicBagOfCellsDb::create();
   boc_->set_celldb_compress_depth(opts_->get_celldb_compress_depth());
-  cell_db_ = td::actor::create_actor<CellDbIn>("celldbin", root_db_, actor_id(this), path_, opts_);
+  boc_->set_prefetch_options({opts_->get_celldb_prefetch_depth()}, async_executor);
+  if (opts_->get_celldb_cell_cache_size() > 0) {
+    cell_cache_ = std::make_shared<vm::DataCellCache>(vm::DataCellCache::Options{opts_->get_celldb_cell_cache_size()});
+    boc_->set_cell_cache(cell_cache_);
+  }
+  cell_db_ = td::actor::create_actor<CellDbIn>("celldbin", root_db_, actor_id(this), path_, opts_, cell_cache_);
   on_load_callback_ = [actor = std::make_shared<td::actor::ActorOwn<CellDbIn::MigrationProxy>>(
                            td::actor::create_actor<CellDbIn::MigrationProxy>("celldbmigration", cell_db_.get())),
                        compress_depth = opts_->get_celldb_compress_depth()](const vm::CellLoader::LoadResult& res) {
@@ -21,6 +21,7 @@
 #include "td/actor/actor.h"
 #include "crypto/vm/db/DynamicBagOfCellsDb.h"
 #include "crypto/vm/db/CellStorage.h"
+#include "crypto/vm/db/DataCellCache.h"
 #include "td/db/KeyValue.h"
 #include "ton/ton-types.h"
 #include "interfaces/block-handle.h"
@@ -57,7 +58,7 @@ class CellDbIn : public CellDbBase {
   void migrate_cell(td::Bits256 hash);
 
   CellDbIn(td::actor::ActorId<RootDb> root_db, td::actor::ActorId<CellDb> parent, std::string path,
-           td::Ref<ValidatorManagerOptions> opts);
+           td::Ref<ValidatorManagerOptions> opts, std::shared_ptr<vm::DataCellCache> cell_cache);
 
   void start_up() override;
   void alarm() override;
@@ -103,6 +104,7 @@ class CellDbIn : public CellDbBase {
 
   std::unique_ptr<vm::DynamicBagOfCellsDb> boc_;
   std::shared_ptr<vm::KeyValue> cell_db_;
+  std::shared_ptr<vm::DataCellCache> cell_cache_;
 
   std::function<void(const vm::CellLoader::LoadResult&)> on_load_callback_;
   std::set<td::Bits256> cells_to_migrate_;
@@ -118,6 +120,7 @@ class CellDbIn : public CellDbBase {
     double total_time_ = 0.0;
   };
   std::unique_ptr<MigrationStats> migration_stats_;
+  td::Timestamp prefetch_stats_log_at_ = td::Timestamp::in(60.0);
 
  public:
   class MigrationProxy : public td::actor::Actor {
@@ -137,11 +140,9 @@ class CellDb : public CellDbBase {
  public:
   void load_cell(RootHash hash, td::Promise<td::Ref<vm::DataCell>> promise);
   void store_cell(BlockIdExt block_id, td::Ref<vm::Cell> cell, td::Promise<td::Ref<vm::DataCell>> promise);
-  void update_snapshot(std::unique_ptr<td::KeyValueReader> snapshot) {
-    started_ = true;
-    boc_->set_loader(std::make_unique<vm::CellLoader>(std::move(snapshot), on_load_callback_)).ensure();
-  }
+  void update_snapshot(std::unique_ptr<td::KeyValueReader> snapshot);
   void get_cell_db_reader(td::Promise<std::shared_ptr<vm::CellDbReader>> promise);
+  void prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise);
 
   CellDb(td::actor::ActorId<RootDb> root_db, std::string path, td::Ref<ValidatorManagerOptions> opts)
       : root_db_(root_db), path_(path), opts_(opts) {
@@ -157,7 +158,9 @@ class CellDb : public CellDbBase {
   td::actor::ActorOwn<CellDbIn> cell_db_;
 
   std::unique_ptr<vm::DynamicBagOfCellsDb> boc_;
+  std::shared_ptr<vm::DataCellCache> cell_cache_;
   bool started_ = false;
+  td::Timestamp prefetch_stats_log_at_ = td::Timestamp::in(60.0);
 
   std::function<void(const vm::CellLoader::LoadResult&)> on_load_callback_;
 };
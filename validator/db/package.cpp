@@ -18,6 +18,10 @@
 */
 #include "package.hpp"
 #include "common/errorcode.h"
+#include "td/utils/Gzip.h"
+#include "td/utils/port/MemoryMapping.h"
+
+#include <algorithm>
 
 namespace ton {
 
@@ -39,20 +43,105 @@ constexpr td::uint16 entry_header_magic() {
   return 0x1e8b;
 }
 
+// smaller ranges are cheaper to copy than to map
+constexpr td::uint64 min_mapped_size() {
+  return 1 << 16;
+}
+
+// pages of a mapped range are touched with this step, with bigger pages some of them are just touched twice
+constexpr size_t mapped_page_size() {
+  return 1 << 12;
+}
+
 constexpr td::uint32 package_header_magic() {
   return 0xae8fdd01;
 }
+
+/*
+ * compressed package:
+ *   header magic
+ *   frames: groups of whole entries of the original package, each deflated on its own
+ *   frame index: offset of the first entry, position, stored size and flags of every frame
+ *   footer: size of the original data, number of frames, index magic
+ */
+constexpr td::uint32 compressed_package_header_magic() {
+  return 0xae8fdd02;
+}
+
+constexpr td::uint32 compressed_index_magic() {
+  return 0x5e1dc0de;
+}
+
+constexpr td::uint32 compressed_footer_size() {
+  return 16;
+}
+
+// entries are grouped until a frame has at least this size; it is the amount decompressed to read one entry
+constexpr td::uint64 compressed_frame_size() {
+  return 1 << 17;
+}
+
+constexpr td::uint32 frame_flag_deflate() {
+  return 1;
+}
+
+td::Status pwrite_all(td::FileFd &fd, td::Slice data, td::uint64 offset) {
+  while (!data.empty()) {
+    TRY_RESULT(s, fd.pwrite(data, offset));
+    if (s == 0) {
+      return td::Status::Error(ErrorCode::error, "short write");
+    }
+    offset += s;
+    data.remove_prefix(s);
+  }
+  return td::Status::OK();
+}
+
+td::Result<std::pair<std::string, td::BufferSlice>> parse_entry(td::Slice data, td::uint64 offset) {
+  if (data.size() < 8) {
+    return td::Status::Error(ErrorCode::notready, "too short read");
+  }
+  td::uint32 header[2];
+  td::MutableSlice(reinterpret_cast<td::uint8*>(header), 8).copy_from(data.substr(0, 8));
+  if ((header[0] & 0xffff) != entry_header_magic()) {
+    return td::Status::Error(ErrorCode::notready,
+                             PSTRING() << "bad entry magic " << (header[0] & 0xffff) << " offset=" << offset);
+  }
+  data.remove_prefix(8);
+  auto fname_size = header[0] >> 16;
+  auto data_size = header[1];
+  if (data.size() < fname_size) {
+    return td::Status::Error(ErrorCode::notready, "too short read (filename)");
+  }
+  std::string fname = data.substr(0, fname_size).str();
+  data.remove_prefix(fname_size);
+  if (data.size() < data_size) {
+    return td::Status::Error(ErrorCode::notready, "too short read (data)");
+  }
+  return std::pair<std::string, td::BufferSlice>{std::move(fname), td::BufferSlice{data.substr(0, data_size)}};
+}
 }  // namespace
 
 Package::Package(td::FileFd fd) : fd_(std::move(fd)) {
 }
 
+Package::Package(td::FileFd fd, std::vector<Frame> frames, td::uint64 data_size)
+    : fd_(std::move(fd)), compressed_(true), data_size_(data_size), frames_(std::move(frames)) {
+}
+
 td::Status Package::truncate(td::uint64 size) {
+  if (compressed_) {
+    if (size != data_size_) {
+      return td::Status::Error(ErrorCode::error, "compressed package can not be truncated");
+    }
+    return td::Status::OK();
+  }
   TRY_STATUS(fd_.seek(size + header_size()));
   return fd_.truncate_to_current_position(size + header_size());
 }
 
 td::uint64 Package::append(std::string filename, td::Slice data, bool sync) {
+  CHECK(!compressed_);
   CHECK(data.size() <= max_data_size());
   CHECK(filename.size() <= max_filename_size());
   auto size = fd_.get_size().move_as_ok();
@@ -83,10 +172,56 @@ void Package::sync() {
 }
 
 td::uint64 Package::size() const {
+  if (compressed_) {
+    return data_size_;
+  }
   return fd_.get_size().move_as_ok() - header_size();
 }
 
+size_t Package::find_frame(td::uint64 offset) const {
+  CHECK(!frames_.empty());
+  auto it = std::upper_bound(frames_.begin(), frames_.end(), offset,
+                             [](td::uint64 offset, const Frame &frame) { return offset < frame.offset; });
+  return it - frames_.begin() - 1;
+}
+
+td::Result<td::BufferSlice> Package::read_frame(size_t idx) const {
+  const auto &frame = frames_[idx];
+  auto end = idx + 1 < frames_.size() ? frames_[idx + 1].offset : data_size_;
+  td::BufferSlice stored{frame.size};
+  TRY_RESULT(s, fd_.pread(stored.as_slice(), frame.position));
+  if (s != frame.size) {
+    return td::Status::Error(ErrorCode::notready, "too short read (frame)");
+  }
+  if (!(frame.flags & frame_flag_deflate())) {
+    if (frame.size != end - frame.offset) {
+      return td::Status::Error(ErrorCode::notready, PSTRING() << "broken frame at offset " << frame.offset);
+    }
+    return std::move(stored);
+  }
+  td::BufferSlice data{static_cast<size_t>(end - frame.offset)};
+  td::Gzip gzip;
+  TRY_STATUS(gzip.init_decode());
+  gzip.set_input(stored.as_slice());
+  gzip.close_input();
+  gzip.set_output(data.as_slice());
+  TRY_RESULT(state, gzip.run());
+  if (state != td::Gzip::State::Done || gzip.left_output() != 0) {
+    return td::Status::Error(ErrorCode::notready, PSTRING() << "broken frame at offset " << frame.offset);
+  }
+  return std::move(data);
+}
+
 td::Result<std::pair<std::string, td::BufferSlice>> Package::read(td::uint64 offset) const {
+  if (compressed_) {
+    if (offset >= data_size_) {
+      return td::Status::Error(ErrorCode::notready, "too short read");
+    }
+    auto idx = find_frame(offset);
+    TRY_RESULT(frame, read_frame(idx));
+    auto pos = offset - frames_[idx].offset;
+    return parse_entry(frame.as_slice().substr(static_cast<size_t>(pos)), offset + header_size());
+  }
   offset += header_size();
 
   td::uint32 header[2];
@@ -117,7 +252,73 @@ td::Result<std::pair<std::string, td::BufferSlice>> Package::read(td::uint64 off
   return std::pair<std::string, td::BufferSlice>{std::move(fname), std::move(data)};
 }
 
-td::Result<td::uint64> Package::advance(td::uint64 offset) {
+td::Result<td::BufferSlice> Package::read_raw(td::uint64 offset, td::uint64 limit, td::uint64 committed_size) const {
+  if (compressed_) {
+    // rebuild the bytes of the original package, peers never see the compressed format
+    auto size = data_size_ + header_size();
+    if (offset > size) {
+      return td::Status::Error(ErrorCode::notready, PSTRING() << "offset " << offset << " is beyond end of package");
+    }
+    limit = std::min(limit, size - offset);
+    td::BufferSlice data{static_cast<size_t>(limit)};
+    auto dest = data.as_slice();
+    if (offset < header_size()) {
+      td::uint32 header[1];
+      header[0] = package_header_magic();
+      auto s = td::Slice(reinterpret_cast<const td::uint8*>(header), header_size()).substr(static_cast<size_t>(offset));
+      s.truncate(dest.size());
+      dest.copy_from(s);
+      dest.remove_prefix(s.size());
+      offset += s.size();
+    }
+    while (!dest.empty()) {
+      auto pos = offset - header_size();
+      auto idx = find_frame(pos);
+      TRY_RESULT(frame, read_frame(idx));
+      auto s = frame.as_slice().substr(static_cast<size_t>(pos - frames_[idx].offset));
+      s.truncate(dest.size());
+      dest.copy_from(s);
+      dest.remove_prefix(s.size());
+      offset += s.size();
+    }
+    return std::move(data);
+  }
+  // bytes after the committed size may be cut by truncate() while the mapping is still used
+  TRY_RESULT(file_size, fd_.get_size());
+  auto size = static_cast<td::uint64>(file_size);
+  if (size > header_size() && committed_size < size - header_size()) {
+    size = committed_size + header_size();
+  }
+  if (offset > size) {
+    return td::Status::Error(ErrorCode::notready, PSTRING() << "offset " << offset << " is beyond end of package");
+  }
+  limit = std::min(limit, size - offset);
+  if (limit < min_mapped_size()) {
+    td::BufferSlice data{static_cast<size_t>(limit)};
+    TRY_RESULT(s, fd_.pread(data.as_slice(), offset));
+    if (s != limit) {
+      return td::Status::Error(ErrorCode::notready, "too short read");
+    }
+    return std::move(data);
+  }
+  TRY_RESULT(data, td::MemoryMapping::create_buffer_slice_from_file(
+                       fd_, td::MemoryMapping::Options().with_offset(static_cast<td::int64>(offset)).with_size(
+                                static_cast<td::int64>(limit))));
+  // fault the pages in here, so that the disk is read by the caller and not by the thread serializing the answer
+  auto bytes = data.as_slice().ubegin();
+  volatile td::uint8 touched = 0;
+  for (size_t i = 0; i < data.size(); i += mapped_page_size()) {
+    touched = bytes[i];
+  }
+  (void)touched;
+  return std::move(data);
+}
+
+td::Result<td::uint64> Package::advance(td::uint64 offset) const {
+  if (compressed_) {
+    TRY_RESULT(entry, read(offset));
+    return offset + 8 + entry.first.size() + entry.second.size();
+  }
   offset += header_size();
 
   td::uint32 header[2];
@@ -164,6 +365,41 @@ td::Result<Package> Package::open(std::string path, bool read_only, bool create)
     if (s != header_size()) {
       return td::Status::Error(ErrorCode::notready, "db read failed");
     }
+    if (header[0] == compressed_package_header_magic()) {
+      td::uint32 footer[4];
+      if (size < header_size() + compressed_footer_size()) {
+        return td::Status::Error(ErrorCode::notready, "compressed package is too short");
+      }
+      auto footer_pos = size - compressed_footer_size();
+      TRY_RESULT(s1, fd.pread(td::MutableSlice(reinterpret_cast<td::uint8*>(footer), compressed_footer_size()),
+                              footer_pos));
+      if (s1 != compressed_footer_size() || footer[3] != compressed_index_magic()) {
+        return td::Status::Error(ErrorCode::notready, "bad compressed package footer");
+      }
+      td::uint64 data_size = footer[0] | (static_cast<td::uint64>(footer[1]) << 32);
+      auto frames_count = footer[2];
+      auto index_size = static_cast<td::uint64>(frames_count) * sizeof(Frame);
+      if (index_size > footer_pos - header_size()) {
+        return td::Status::Error(ErrorCode::notready, "bad compressed package index");
+      }
+      std::vector<Frame> frames(frames_count);
+      TRY_RESULT(s2, fd.pread(td::MutableSlice(reinterpret_cast<td::uint8*>(frames.data()), index_size),
+                              footer_pos - index_size));
+      if (s2 != index_size) {
+        return td::Status::Error(ErrorCode::notready, "compressed package index read failed");
+      }
+      for (size_t i = 0; i < frames.size(); i++) {
+        auto end = i + 1 < frames.size() ? frames[i + 1].offset : data_size;
+        if (frames[i].offset >= end || (i == 0 && frames[i].offset != 0) ||
+            frames[i].position + frames[i].size > footer_pos - index_size) {
+          return td::Status::Error(ErrorCode::notready, "bad compressed package index");
+        }
+      }
+      if (frames.empty() && data_size != 0) {
+        return td::Status::Error(ErrorCode::notready, "bad compressed package index");
+      }
+      return Package{std::move(fd), std::move(frames), data_size};
+    }
     if (header[0] != package_header_magic()) {
       return td::Status::Error(ErrorCode::notready, "magic mismatch");
     }
@@ -171,7 +407,85 @@ td::Result<Package> Package::open(std::string path, bool read_only, bool create)
   return Package{std::move(fd)};
 }
 
+td::Result<td::uint64> Package::compress(std::string path) const {
+  static_assert(sizeof(Frame) == 24, "unexpected frame index layout");
+  if (compressed_) {
+    return td::Status::Error(ErrorCode::error, "package is already compressed");
+  }
+  auto data_size = size();
+  TRY_RESULT(fd, td::FileFd::open(path, td::FileFd::Write | td::FileFd::Create | td::FileFd::Truncate));
+  td::uint32 header[1];
+  header[0] = compressed_package_header_magic();
+  TRY_STATUS(pwrite_all(fd, td::Slice(reinterpret_cast<const td::uint8*>(header), header_size()), 0));
+  td::uint64 position = header_size();
+
+  std::vector<Frame> frames;
+  td::uint64 offset = 0;
+  while (offset < data_size) {
+    auto end = offset;
+    do {
+      TRY_RESULT_ASSIGN(end, advance(end));
+    } while (end < data_size && end - offset < compressed_frame_size());
+
+    td::BufferSlice data{static_cast<size_t>(end - offset)};
+    TRY_RESULT(s, fd_.pread(data.as_slice(), offset + header_size()));
+    if (s != data.size()) {
+      return td::Status::Error(ErrorCode::notready, "too short read");
+    }
+    Frame frame{offset, position, 0, 0};
+    auto deflated = td::gzencode(data.as_slice(), 0.9);
+    auto stored = data.as_slice();
+    if (!deflated.empty()) {
+      stored = deflated.as_slice();
+      frame.flags |= frame_flag_deflate();
+    }
+    frame.size = td::narrow_cast<td::uint32>(stored.size());
+    TRY_STATUS(pwrite_all(fd, stored, position));
+    position += stored.size();
+    frames.push_back(frame);
+    offset = end;
+  }
+
+  auto index = td::Slice(reinterpret_cast<const td::uint8*>(frames.data()), frames.size() * sizeof(Frame));
+  TRY_STATUS(pwrite_all(fd, index, position));
+  position += index.size();
+  td::uint32 footer[4];
+  footer[0] = static_cast<td::uint32>(data_size);
+  footer[1] = static_cast<td::uint32>(data_size >> 32);
+  footer[2] = td::narrow_cast<td::uint32>(frames.size());
+  footer[3] = compressed_index_magic();
+  TRY_STATUS(pwrite_all(fd, td::Slice(reinterpret_cast<const td::uint8*>(footer), compressed_footer_size()), position));
+  TRY_STATUS(fd.sync());
+  return data_size;
+}
+
 void Package::iterate(std::function<bool(std::string, td::BufferSlice, td::uint64)> func) {
+  if (compressed_) {
+    // every frame is decompressed once
+    for (size_t i = 0; i < frames_.size(); i++) {
+      auto R = read_frame(i);
+      if (R.is_error()) {
+        LOG(ERROR) << "broken archive: " << R.move_as_error();
+        return;
+      }
+      auto frame = R.move_as_ok();
+      td::uint64 pos = 0;
+      while (pos < frame.size()) {
+        auto p = frames_[i].offset + pos;
+        auto E = parse_entry(frame.as_slice().substr(static_cast<size_t>(pos)), p + header_size());
+        if (E.is_error()) {
+          LOG(ERROR) << "broken archive: " << E.move_as_error();
+          return;
+        }
+        auto q = E.move_as_ok();
+        pos += 8 + q.first.size() + q.second.size();
+        if (!func(std::move(q.first), std::move(q.second), p)) {
+          return;
+        }
+      }
+    }
+    return;
+  }
   td::uint64 p = 0;
 
   td::uint64 size = fd_.get_size().move_as_ok();
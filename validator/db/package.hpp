@@ -22,6 +22,8 @@
 #include "td/utils/port/FileFd.h"
 #include "td/utils/buffer.h"
 
+#include <limits>
+
 namespace ton {
 
 class Package {
@@ -38,16 +40,43 @@ class Package {
   void sync();
   td::uint64 size() const;
   td::Result<std::pair<std::string, td::BufferSlice>> read(td::uint64 offset) const;
+  // raw bytes of the package file, as served to other nodes; big ranges are memory-mapped instead of copied.
+  // Only the first committed_size bytes of data are served, they are never truncated while the mapping is alive
+  td::Result<td::BufferSlice> read_raw(td::uint64 offset, td::uint64 limit,
+                                       td::uint64 committed_size = std::numeric_limits<td::uint64>::max()) const;
 
-  td::Result<td::uint64> advance(td::uint64 offset);
+  td::Result<td::uint64> advance(td::uint64 offset) const;
   void iterate(std::function<bool(std::string, td::BufferSlice, td::uint64)> func);
 
+  // writes a compressed copy of the package to path and returns the size of the copied data
+  // entries keep their offsets, so an index referring to this package stays valid for the copy
+  td::Result<td::uint64> compress(std::string path) const;
+  bool is_compressed() const {
+    return compressed_;
+  }
+
   td::FileFd &fd() {
     return fd_;
   }
 
  private:
+  // a group of whole entries, deflated independently of other frames
+  struct Frame {
+    td::uint64 offset;    // offset of the first entry
+    td::uint64 position;  // position of the stored frame in the file
+    td::uint32 size;      // size of the stored frame
+    td::uint32 flags;
+  };
+
   td::FileFd fd_;
+  bool compressed_ = false;
+  td::uint64 data_size_ = 0;
+  std::vector<Frame> frames_;
+
+  Package(td::FileFd fd, std::vector<Frame> frames, td::uint64 data_size);
+
+  size_t find_frame(td::uint64 offset) const;
+  td::Result<td::BufferSlice> read_frame(size_t idx) const;
 };
 
 }  // namespace ton
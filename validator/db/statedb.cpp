@@ -217,11 +217,12 @@ void StateDb::get_hardforks(td::Promise<std::vector<BlockIdExt>> promise) {
   promise.set_value(std::move(vec));
 }
 
-StateDb::StateDb(td::actor::ActorId<RootDb> root_db, std::string db_path) : root_db_(root_db), db_path_(db_path) {
+StateDb::StateDb(td::actor::ActorId<RootDb> root_db, std::string db_path, td::RocksDbOptions rocksdb_options)
+    : root_db_(root_db), db_path_(db_path), rocksdb_options_(std::move(rocksdb_options)) {
 }
 
 void StateDb::start_up() {
-  kv_ = std::make_shared<td::RocksDb>(td::RocksDb::open(db_path_).move_as_ok());
+  kv_ = std::make_shared<td::RocksDb>(td::RocksDb::open(db_path_, rocksdb_options_).move_as_ok());
 
   std::string value;
   auto R = kv_->get(create_serialize_tl_object<ton_api::db_state_key_dbVersion>(), value);
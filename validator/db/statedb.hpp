@@ -20,6 +20,7 @@
 
 #include "td/actor/actor.h"
 #include "td/db/KeyValueAsync.h"
+#include "td/db/RocksDb.h"
 #include "ton/ton-types.h"
 
 #include "validator/interfaces/db.h"
@@ -53,7 +54,7 @@ class StateDb : public td::actor::Actor {
   void update_db_version(td::uint32 version, td::Promise<td::Unit> promise);
   void get_db_version(td::Promise<td::uint32> promise);
 
-  StateDb(td::actor::ActorId<RootDb> root_db, std::string path);
+  StateDb(td::actor::ActorId<RootDb> root_db, std::string path, td::RocksDbOptions rocksdb_options = {});
 
   void start_up() override;
   void truncate(BlockSeqno masterchain_seqno, ConstBlockHandle handle, td::Promise<td::Unit> promise);
@@ -65,6 +66,7 @@ class StateDb : public td::actor::Actor {
 
   td::actor::ActorId<RootDb> root_db_;
   std::string db_path_;
+  td::RocksDbOptions rocksdb_options_;
 };
 
 }  // namespace validator
@@ -30,7 +30,11 @@
 #include "block/output-queue-merger.h"
 #include "vm/cells/MerkleProof.h"
 #include "vm/cells/MerkleUpdate.h"
+#include "td/utils/port/thread.h"
+#include <condition_variable>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <queue>
 #include "common/global-version.h"
 
@@ -89,7 +93,8 @@ class Collator final : public td::actor::Actor {
  public:
   Collator(ShardIdFull shard, bool is_hardfork, td::uint32 min_ts, BlockIdExt min_masterchain_block_id,
            std::vector<BlockIdExt> prev, Ref<ValidatorSet> validator_set, Ed25519_PublicKey collator_id,
-           td::actor::ActorId<ValidatorManager> manager, td::Timestamp timeout, td::Promise<BlockCandidate> promise);
+           td::actor::ActorId<ValidatorManager> manager, td::Timestamp timeout, td::Promise<BlockCandidate> promise,
+           td::uint32 collator_threads = 1);
   ~Collator() override = default;
   bool is_busy() const {
     return busy_;
@@ -198,11 +203,54 @@ class Collator final : public td::actor::Actor {
   std::vector<Ref<vm::Cell>> collated_roots_;
   std::unique_ptr<ton::BlockCandidate> block_candidate;
 
+  // Transaction executed ahead of time on another thread by speculate_transactions().
+  // It is used by create_ordinary_transaction() only if its account has not been touched in this block since then,
+  // so the result is the same as the one of serial execution.
+  struct SpeculativeTransaction {
+    Ref<vm::Cell> msg_root;
+    ton::StdSmcAddress addr;
+    bool external{false};
+    bool is_special{false};
+    ton::LogicalTime after_lt{0};
+    std::unique_ptr<block::Account> account;  // nullptr if the account could not be loaded
+    td::Result<std::unique_ptr<block::transaction::Transaction>> result;
+    vm::CellUsageTree::LoadJournal loads;  // cells of the previous state loaded by the transaction
+  };
+  // Threads executing speculative transactions; they are started once and reused by every speculation window.
+  class SpeculationWorkers {
+   public:
+    explicit SpeculationWorkers(td::uint32 threads);
+    ~SpeculationWorkers();
+    td::uint32 size() const {
+      return static_cast<td::uint32>(threads_.size()) + 1;
+    }
+    // runs f(0) on the calling thread and f(i) on the i-th worker for all i < size(), waits for all of them
+    void run(const std::function<void(td::uint32)>& f);
+
+   private:
+    std::vector<td::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable task_cond_, done_cond_;
+    const std::function<void(td::uint32)>* task_{nullptr};
+    td::uint64 generation_{0};
+    td::uint32 pending_{0};
+    bool stop_{false};
+
+    void loop(td::uint32 idx);
+  };
+  td::uint32 collator_threads_{1};
+  std::unique_ptr<SpeculationWorkers> speculation_workers_;
+  std::map<ton::Bits256, SpeculativeTransaction> speculative_transactions_;  // by message hash
+  std::size_t speculation_window_left_{0};
+  unsigned speculative_total_{0}, speculative_used_{0};
+
   td::PerfWarningTimer perf_timer_;
   //
   block::Account* lookup_account(td::ConstBitPtr addr) const;
   std::unique_ptr<block::Account> make_account_from(td::ConstBitPtr addr, Ref<vm::CellSlice> account,
                                                     bool force_create);
+  std::unique_ptr<block::Account> make_account_from(td::ConstBitPtr addr, Ref<vm::CellSlice> account,
+                                                    bool force_create, bool is_special) const;
   td::Result<block::Account*> make_account(td::ConstBitPtr addr, bool force_create = false);
   td::actor::ActorId<Collator> get_self() {
     return actor_id(this);
@@ -245,6 +293,14 @@ class Collator final : public td::actor::Actor {
   bool create_ticktock_transactions(int mask);
   bool create_ticktock_transaction(const ton::StdSmcAddress& smc_addr, ton::LogicalTime req_start_lt, int mask);
   Ref<vm::Cell> create_ordinary_transaction(Ref<vm::Cell> msg_root, bool is_special_tx = false);
+  bool get_message_destination(Ref<vm::Cell> msg_root, ton::StdSmcAddress& addr, bool& external) const;
+  void speculate_transactions(const std::vector<Ref<vm::Cell>>& msgs);
+  void speculate_inbound_internal_messages();
+  void speculate_inbound_external_messages(std::size_t from);
+  block::Account* adopt_speculative_transaction(Ref<vm::Cell> msg_root, const ton::StdSmcAddress& addr,
+                                                bool external,
+                                                td::Result<std::unique_ptr<block::transaction::Transaction>>& res);
+  void finish_speculation();
   bool check_cur_validator_set();
   bool unpack_last_mc_state();
   bool unpack_last_state();
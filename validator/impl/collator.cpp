@@ -24,6 +24,7 @@
 #include "block/block.h"
 #include "block/block-parse.h"
 #include "block/block-auto.h"
+#include "block/account-cache.h"
 #include "vm/dict.h"
 #include "crypto/openssl/rand.hpp"
 #include "ton/ton-shard.h"
@@ -35,6 +36,9 @@
 #include "top-shard-descr.hpp"
 #include <ctime>
 #include "td/utils/Random.h"
+#include "td/utils/port/thread.h"
+#include <atomic>
+#include <set>
 
 namespace ton {
 
@@ -73,11 +77,12 @@ static inline bool dbg(int c) {
  * @param manager The ActorId of the ValidatorManager.
  * @param timeout The timeout for the collator.
  * @param promise The promise to return the result.
+ * @param collator_threads The number of threads executing transactions of different accounts speculatively.
  */
 Collator::Collator(ShardIdFull shard, bool is_hardfork, UnixTime min_ts, BlockIdExt min_masterchain_block_id,
                    std::vector<BlockIdExt> prev, td::Ref<ValidatorSet> validator_set, Ed25519_PublicKey collator_id,
                    td::actor::ActorId<ValidatorManager> manager, td::Timestamp timeout,
-                   td::Promise<BlockCandidate> promise)
+                   td::Promise<BlockCandidate> promise, td::uint32 collator_threads)
     : shard_(shard)
     , is_hardfork_(is_hardfork)
     , min_ts(min_ts)
@@ -92,6 +97,7 @@ Collator::Collator(ShardIdFull shard, bool is_hardfork, UnixTime min_ts, BlockId
     , soft_timeout_(td::Timestamp::at(timeout.at() - 3.0))
     , medium_timeout_(td::Timestamp::at(timeout.at() - 1.5))
     , main_promise(std::move(promise))
+    , collator_threads_(td::max(collator_threads, 1u))
     , perf_timer_("collate", 0.1, [manager](double duration) {
       send_closure(manager, &ValidatorManager::add_perf_timer_stat, "collate", duration);
     }) {
@@ -2114,6 +2120,7 @@ bool Collator::do_collate() {
   if (!process_inbound_external_messages()) {
     return fatal_error("cannot process inbound external messages");
   }
+  finish_speculation();
   // 6. process newly-generated messages (if space&gas left)
   //    (if we were unable to process all inbound messages, all new messages must be queued)
   LOG(INFO) << "process newly-generated messages";
@@ -2375,6 +2382,23 @@ bool Collator::out_msg_queue_cleanup() {
  */
 std::unique_ptr<block::Account> Collator::make_account_from(td::ConstBitPtr addr, Ref<vm::CellSlice> account,
                                                             bool force_create) {
+  bool is_special = account.not_null() && is_masterchain() && config_->is_special_smartcontract(addr);
+  return make_account_from(addr, std::move(account), force_create, is_special);
+}
+
+/**
+ * Creates a new Account object from the given address and serialized account data.
+ * Does not use the configuration, so it may be called from other threads.
+ *
+ * @param addr A pointer to the 256-bit address of the account.
+ * @param account A cell slice with an account serialized using ShardAccount TLB-scheme.
+ * @param force_create A flag indicating whether to force the creation of a new account if `account` is null.
+ * @param is_special True if the account is a special masterchain smart contract.
+ *
+ * @returns A unique pointer to the created Account object, or nullptr if the creation failed.
+ */
+std::unique_ptr<block::Account> Collator::make_account_from(td::ConstBitPtr addr, Ref<vm::CellSlice> account,
+                                                            bool force_create, bool is_special) const {
   if (account.is_null() && !force_create) {
     return nullptr;
   }
@@ -2383,7 +2407,7 @@ std::unique_ptr<block::Account> Collator::make_account_from(td::ConstBitPtr addr
     if (!ptr->init_new(now_)) {
       return nullptr;
     }
-  } else if (!ptr->unpack(std::move(account), now_, is_masterchain() && config_->is_special_smartcontract(addr))) {
+  } else if (!block::AccountCache::unpack_shared(*ptr, std::move(account), now_, is_special)) {
     return nullptr;
   }
   ptr->block_lt = start_lt;
@@ -2446,6 +2470,8 @@ td::Result<block::Account*> Collator::make_account(td::ConstBitPtr addr, bool fo
  */
 bool Collator::combine_account_transactions() {
   vm::AugmentedDictionary dict{256, block::tlb::aug_ShardAccountBlocks};
+  // `accounts` is sorted by address, so both dictionaries are changed in one pass after the loop
+  std::vector<vm::DictionaryFixed::Update> account_blocks, account_changes;
   for (auto& z : accounts) {
     block::Account& acc = *(z.second);
     CHECK(acc.addr == z.first);
@@ -2474,10 +2500,7 @@ bool Collator::combine_account_transactions() {
         return fatal_error(std::string{"new AccountBlock for "} + z.first.to_hex() +
                            " failed to pass handwritten validation tests");
       }
-      if (!dict.set(z.first, csr, vm::Dictionary::SetMode::Add)) {
-        return fatal_error(std::string{"new AccountBlock for "} + z.first.to_hex() +
-                           " could not be added to ShardAccountBlocks");
-      }
+      account_blocks.push_back({z.first.cbits(), std::move(csr)});
       // update account_dict
       if (acc.total_state->get_hash() != acc.orig_total_state->get_hash()) {
         // account changed
@@ -2485,35 +2508,33 @@ bool Collator::combine_account_transactions() {
           // account created
           CHECK(acc.status != block::Account::acc_nonexist);
           vm::CellBuilder cb;
-          if (!(cb.store_ref_bool(acc.total_state)             // account_descr$_ account:^Account
-                && cb.store_bits_bool(acc.last_trans_hash_)    // last_trans_hash:bits256
-                && cb.store_long_bool(acc.last_trans_lt_, 64)  // last_trans_lt:uint64
-                && account_dict->set_builder(acc.addr, cb, vm::Dictionary::SetMode::Add))) {
+          if (!(cb.store_ref_bool(acc.total_state)                 // account_descr$_ account:^Account
+                && cb.store_bits_bool(acc.last_trans_hash_)        // last_trans_hash:bits256
+                && cb.store_long_bool(acc.last_trans_lt_, 64))) {  // last_trans_lt:uint64
             return fatal_error(std::string{"cannot add newly-created account "} + acc.addr.to_hex() +
                                " into ShardAccounts");
           }
+          account_changes.push_back({z.first.cbits(), vm::load_cell_slice_ref(cb.finalize())});
         } else if (acc.status == block::Account::acc_nonexist) {
           // account deleted
           if (verbosity > 2) {
             std::cerr << "deleting account " << acc.addr.to_hex() << " with empty new value ";
             block::gen::t_Account.print_ref(std::cerr, acc.total_state);
           }
-          if (account_dict->lookup_delete(acc.addr).is_null()) {
-            return fatal_error(std::string{"cannot delete account "} + acc.addr.to_hex() + " from ShardAccounts");
-          }
+          account_changes.push_back({z.first.cbits(), {}});
         } else {
           // existing account modified
           if (verbosity > 4) {
             std::cerr << "modifying account " << acc.addr.to_hex() << " to ";
             block::gen::t_Account.print_ref(std::cerr, acc.total_state);
           }
-          if (!(cb.store_ref_bool(acc.total_state)             // account_descr$_ account:^Account
-                && cb.store_bits_bool(acc.last_trans_hash_)    // last_trans_hash:bits256
-                && cb.store_long_bool(acc.last_trans_lt_, 64)  // last_trans_lt:uint64
-                && account_dict->set_builder(acc.addr, cb, vm::Dictionary::SetMode::Replace))) {
+          if (!(cb.store_ref_bool(acc.total_state)                 // account_descr$_ account:^Account
+                && cb.store_bits_bool(acc.last_trans_hash_)        // last_trans_hash:bits256
+                && cb.store_long_bool(acc.last_trans_lt_, 64))) {  // last_trans_lt:uint64
             return fatal_error(std::string{"cannot modify existing account "} + acc.addr.to_hex() +
                                " in ShardAccounts");
           }
+          account_changes.push_back({z.first.cbits(), vm::load_cell_slice_ref(cb.finalize())});
         }
       }
     } else {
@@ -2523,6 +2544,12 @@ bool Collator::combine_account_transactions() {
       }
     }
   }
+  if (!dict.build_from_sorted(account_blocks)) {
+    return fatal_error("new AccountBlocks could not be added to ShardAccountBlocks");
+  }
+  if (!account_dict->apply_updates(account_changes)) {
+    return fatal_error(PSTRING() << "cannot apply " << account_changes.size() << " account changes to ShardAccounts");
+  }
   vm::CellBuilder cb;
   if (!(cb.append_cellslice_bool(std::move(dict).extract_root()) && cb.finalize_to(shard_account_blocks_))) {
     return fatal_error("cannot serialize ShardAccountBlocks");
@@ -2723,16 +2750,19 @@ Ref<vm::Cell> Collator::create_ordinary_transaction(Ref<vm::Cell> msg_root, bool
     return {};
   }
   LOG(DEBUG) << "inbound message to our smart contract " << addr.to_hex();
-  auto acc_res = make_account(addr.cbits(), true);
-  if (acc_res.is_error()) {
-    fatal_error(acc_res.move_as_error());
-    return {};
+  td::Result<std::unique_ptr<block::transaction::Transaction>> res;
+  block::Account* acc = adopt_speculative_transaction(msg_root, addr, external, res);
+  if (!acc) {
+    auto acc_res = make_account(addr.cbits(), true);
+    if (acc_res.is_error()) {
+      fatal_error(acc_res.move_as_error());
+      return {};
+    }
+    acc = acc_res.move_as_ok();
+    assert(acc);
+    res = impl_create_ordinary_transaction(msg_root, acc, now_, start_lt, &storage_phase_cfg_, &compute_phase_cfg_,
+                                           &action_phase_cfg_, external, last_proc_int_msg_.first);
   }
-  block::Account* acc = acc_res.move_as_ok();
-  assert(acc);
-
-  auto res = impl_create_ordinary_transaction(msg_root, acc, now_, start_lt, &storage_phase_cfg_, &compute_phase_cfg_,
-                                              &action_phase_cfg_, external, last_proc_int_msg_.first);
   if (res.is_error()) {
     auto error = res.move_as_error();
     if (error.code() == -701) {
@@ -2859,6 +2889,296 @@ td::Result<std::unique_ptr<block::transaction::Transaction>> Collator::impl_crea
   return std::move(trans);
 }
 
+/**
+ * Extracts the destination of an inbound message.
+ *
+ * @param msg_root The root of the message serialized using Message TLB-scheme.
+ * @param addr The destination address (output).
+ * @param external Set to true if the message is an inbound external message (output).
+ *
+ * @returns True if the message is addressed to an account of the current shard, false otherwise.
+ */
+bool Collator::get_message_destination(Ref<vm::Cell> msg_root, ton::StdSmcAddress& addr, bool& external) const {
+  auto cs = vm::load_cell_slice(std::move(msg_root));
+  Ref<vm::CellSlice> dest;
+  switch (block::gen::t_CommonMsgInfo.get_tag(cs)) {
+    case block::gen::CommonMsgInfo::ext_in_msg_info: {
+      block::gen::CommonMsgInfo::Record_ext_in_msg_info info;
+      if (!tlb::unpack(cs, info)) {
+        return false;
+      }
+      dest = std::move(info.dest);
+      external = true;
+      break;
+    }
+    case block::gen::CommonMsgInfo::int_msg_info: {
+      block::gen::CommonMsgInfo::Record_int_msg_info info;
+      if (!tlb::unpack(cs, info)) {
+        return false;
+      }
+      dest = std::move(info.dest);
+      external = false;
+      break;
+    }
+    default:
+      return false;
+  }
+  ton::WorkchainId wc;
+  return block::tlb::t_MsgAddressInt.extract_std_address(dest, wc, addr) && wc == workchain() && is_our_address(addr);
+}
+
+/**
+ * Executes transactions for a batch of inbound messages on several threads ahead of time.
+ * Only the first message to each account is executed, and only if the account has not been touched in this block yet;
+ * the results are stored in speculative_transactions_ and are later used by create_ordinary_transaction().
+ *
+ * The transactions run on speculation_workers_, which are started by the first call and reused afterwards.
+ * Every thread uses its own copies of ShardAccounts dictionary and of the compute phase configuration.
+ * A message whose transaction throws is left to serial execution.
+ * Cells of the previous state loaded by a speculative transaction are recorded in its own journal and are marked
+ * in the usage tree only if the transaction is used, so the usage tree ends up the same as after serial execution.
+ *
+ * @param msgs The roots of the messages, in the order in which they are going to be processed.
+ */
+void Collator::speculate_transactions(const std::vector<Ref<vm::Cell>>& msgs) {
+  speculative_transactions_.clear();
+  std::vector<SpeculativeTransaction> batch;
+  std::set<ton::StdSmcAddress> batch_accounts;
+  for (const auto& msg_root : msgs) {
+    SpeculativeTransaction spec;
+    if (!get_message_destination(msg_root, spec.addr, spec.external) || lookup_account(spec.addr.cbits()) ||
+        !batch_accounts.insert(spec.addr).second) {
+      continue;
+    }
+    spec.msg_root = msg_root;
+    spec.after_lt = last_proc_int_msg_.first;
+    if (is_masterchain()) {
+      vm::CellUsageTree::AttachJournal attach{state_usage_tree_.get(), &spec.loads};
+      spec.is_special = config_->is_special_smartcontract(spec.addr);
+    }
+    batch.push_back(std::move(spec));
+  }
+  if (batch.size() < 2) {
+    return;
+  }
+  if (!speculation_workers_) {
+    speculation_workers_ = std::make_unique<SpeculationWorkers>(collator_threads_ - 1);
+  }
+  auto threads = static_cast<td::uint32>(std::min<std::size_t>(speculation_workers_->size(), batch.size()));
+  struct ThreadEnv {
+    vm::AugmentedDictionary account_dict;
+    block::ComputePhaseConfig compute_phase_cfg;
+  };
+  // dictionaries keep a mutable cache of their root, so they are copied here
+  std::vector<std::unique_ptr<ThreadEnv>> thread_envs;
+  for (td::uint32 i = 0; i < threads; i++) {
+    thread_envs.push_back(std::make_unique<ThreadEnv>(ThreadEnv{*account_dict, compute_phase_cfg_.clone()}));
+  }
+  std::atomic<std::size_t> next_idx{0};
+  auto run = [&](ThreadEnv& env) {
+    for (std::size_t idx; (idx = next_idx.fetch_add(1, std::memory_order_relaxed)) < batch.size();) {
+      auto& spec = batch[idx];
+      vm::CellUsageTree::AttachJournal attach{state_usage_tree_.get(), &spec.loads};
+      try {
+        auto dict_entry = env.account_dict.lookup_extra(spec.addr.cbits(), 256);
+        auto acc = make_account_from(spec.addr.cbits(), std::move(dict_entry.first), true, spec.is_special);
+        if (!acc || !acc->belongs_to_shard(shard_)) {
+          continue;
+        }
+        spec.result = impl_create_ordinary_transaction(spec.msg_root, acc.get(), now_, start_lt, &storage_phase_cfg_,
+                                                       &env.compute_phase_cfg, &action_phase_cfg_, spec.external,
+                                                       spec.after_lt);
+        spec.account = std::move(acc);
+      } catch (vm::VmError& err) {
+        // leave the message to serial execution, which reports the error
+        LOG(DEBUG) << "speculative transaction for " << spec.addr.to_hex() << " failed: " << err.get_msg();
+        spec.account = nullptr;
+      } catch (vm::VmVirtError& err) {
+        LOG(DEBUG) << "speculative transaction for " << spec.addr.to_hex() << " failed: " << err.get_msg();
+        spec.account = nullptr;
+      } catch (std::exception& err) {
+        LOG(DEBUG) << "speculative transaction for " << spec.addr.to_hex() << " failed: " << err.what();
+        spec.account = nullptr;
+      } catch (...) {
+        LOG(DEBUG) << "speculative transaction for " << spec.addr.to_hex() << " failed with an unknown exception";
+        spec.account = nullptr;
+      }
+    }
+  };
+  state_usage_tree_->set_concurrent(true);
+  speculation_workers_->run([&](td::uint32 i) {
+    if (i < threads) {
+      run(*thread_envs[i]);
+    }
+  });
+  state_usage_tree_->set_concurrent(false);
+  LOG(DEBUG) << "executed " << batch.size() << " speculative transactions using " << threads << " threads";
+  for (auto& spec : batch) {
+    if (spec.account) {
+      ton::Bits256 hash{spec.msg_root->get_hash().bits()};
+      speculative_transactions_.emplace(hash, std::move(spec));
+      ++speculative_total_;
+    }
+  }
+}
+
+/**
+ * Starts the worker threads for speculative execution.
+ *
+ * @param threads The number of threads to start in addition to the calling one.
+ */
+Collator::SpeculationWorkers::SpeculationWorkers(td::uint32 threads) {
+  for (td::uint32 i = 1; i <= threads; i++) {
+    threads_.emplace_back([this, i] { loop(i); });
+  }
+}
+
+/**
+ * Stops the worker threads and waits for them to exit.
+ */
+Collator::SpeculationWorkers::~SpeculationWorkers() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  task_cond_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+/**
+ * Runs a task on all workers and on the calling thread and waits until every worker has finished it.
+ * The task must not throw.
+ *
+ * @param f The task, called with the index of the worker; index 0 is the calling thread.
+ */
+void Collator::SpeculationWorkers::run(const std::function<void(td::uint32)>& f) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    task_ = &f;
+    pending_ = static_cast<td::uint32>(threads_.size());
+    ++generation_;
+  }
+  task_cond_.notify_all();
+  f(0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cond_.wait(lock, [&] { return pending_ == 0; });
+  task_ = nullptr;
+}
+
+/**
+ * The loop of a worker thread: waits for the next task, runs it and reports its completion.
+ *
+ * @param idx The index of the worker.
+ */
+void Collator::SpeculationWorkers::loop(td::uint32 idx) {
+  td::uint64 seen_generation = 0;
+  while (true) {
+    const std::function<void(td::uint32)>* task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_cond_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+      if (stop_) {
+        return;
+      }
+      seen_generation = generation_;
+      task = task_;
+    }
+    (*task)(idx);
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (--pending_ == 0) {
+      done_cond_.notify_one();
+    }
+  }
+}
+
+/**
+ * Speculatively executes transactions for the next inbound internal messages from the neighbors' queues.
+ */
+void Collator::speculate_inbound_internal_messages() {
+  std::size_t window = collator_threads_ * 16;
+  std::vector<Ref<vm::Cell>> msgs;
+  std::size_t offset = 0;
+  for (; offset < window; offset++) {
+    auto kv = nb_out_msgs_->peek(offset);
+    if (!kv) {
+      break;
+    }
+    if (kv->msg.is_null() || kv->msg->size_refs() != 1) {
+      continue;
+    }
+    block::tlb::MsgEnvelope::Record_std env;
+    if (tlb::unpack_cell(kv->msg->prefetch_ref(), env)) {
+      msgs.push_back(std::move(env.msg));
+    }
+  }
+  speculation_window_left_ = offset;
+  speculate_transactions(msgs);
+}
+
+/**
+ * Speculatively executes transactions for the next inbound external messages.
+ *
+ * @param from The index of the first message in ext_msg_list_.
+ */
+void Collator::speculate_inbound_external_messages(std::size_t from) {
+  std::size_t to = std::min(ext_msg_list_.size(), from + collator_threads_ * 16);
+  std::vector<Ref<vm::Cell>> msgs;
+  for (std::size_t i = from; i < to; i++) {
+    msgs.push_back(ext_msg_list_[i].first);
+  }
+  speculation_window_left_ = to - from;
+  speculate_transactions(msgs);
+}
+
+/**
+ * Takes the speculatively executed transaction for a message, if it is still valid.
+ * The transaction is valid if its account has not been touched in this block since it was executed,
+ * and for external messages also if the last processed internal message is the same.
+ *
+ * @param msg_root The root of the message.
+ * @param addr The address of the destination account.
+ * @param external True if the message is an inbound external message.
+ * @param res The result of the speculative transaction (output).
+ *
+ * @returns The account of the transaction, now owned by the collator, or nullptr if there is no valid result.
+ */
+block::Account* Collator::adopt_speculative_transaction(
+    Ref<vm::Cell> msg_root, const ton::StdSmcAddress& addr, bool external,
+    td::Result<std::unique_ptr<block::transaction::Transaction>>& res) {
+  if (speculative_transactions_.empty()) {
+    return nullptr;
+  }
+  auto it = speculative_transactions_.find(ton::Bits256{msg_root->get_hash().bits()});
+  if (it == speculative_transactions_.end()) {
+    return nullptr;
+  }
+  SpeculativeTransaction spec = std::move(it->second);
+  speculative_transactions_.erase(it);
+  if (spec.addr != addr || spec.external != external || (external && spec.after_lt != last_proc_int_msg_.first) ||
+      lookup_account(addr.cbits())) {
+    return nullptr;
+  }
+  state_usage_tree_->apply_journal(spec.loads);
+  auto ins = accounts.emplace(addr, std::move(spec.account));
+  CHECK(ins.second);
+  res = std::move(spec.result);
+  ++speculative_used_;
+  return ins.first->second.get();
+}
+
+/**
+ * Drops the remaining speculative transactions.
+ */
+void Collator::finish_speculation() {
+  speculative_transactions_.clear();
+  speculation_window_left_ = 0;
+  if (speculative_total_) {
+    LOG(INFO) << "used " << speculative_used_ << " of " << speculative_total_ << " speculative transactions";
+  }
+}
+
 /**
  * Updates the maximum logical time if the given logical time is greater than the current maximum logical time.
  *
@@ -3379,6 +3699,12 @@ bool Collator::process_inbound_internal_messages() {
       LOG(WARNING) << "soft timeout reached, stop processing inbound internal messages";
       break;
     }
+    if (collator_threads_ > 1 && !speculation_window_left_) {
+      speculate_inbound_internal_messages();
+    }
+    if (speculation_window_left_) {
+      --speculation_window_left_;
+    }
     auto kv = nb_out_msgs_->extract_cur();
     CHECK(kv && kv->msg.not_null());
     LOG(DEBUG) << "processing inbound message with (lt,hash)=(" << kv->lt << "," << kv->key.to_hex()
@@ -3398,6 +3724,7 @@ bool Collator::process_inbound_internal_messages() {
     nb_out_msgs_->next();
   }
   inbound_queues_empty_ = nb_out_msgs_->is_eof();
+  speculation_window_left_ = 0;
   return true;
 }
 
@@ -3418,7 +3745,8 @@ bool Collator::process_inbound_external_messages() {
     return true;
   }
   bool full = !block_limit_status_->fits(block::ParamLimits::cl_soft);
-  for (auto& ext_msg_pair : ext_msg_list_) {
+  for (std::size_t i = 0; i < ext_msg_list_.size(); i++) {
+    auto& ext_msg_pair = ext_msg_list_[i];
     if (full) {
       LOG(INFO) << "BLOCK FULL, stop processing external messages";
       break;
@@ -3427,6 +3755,12 @@ bool Collator::process_inbound_external_messages() {
       LOG(WARNING) << "medium timeout reached, stop processing inbound external messages";
       break;
     }
+    if (collator_threads_ > 1 && !speculation_window_left_) {
+      speculate_inbound_external_messages(i);
+    }
+    if (speculation_window_left_) {
+      --speculation_window_left_;
+    }
     auto ext_msg = ext_msg_pair.first;
     ton::Bits256 hash{ext_msg->get_hash().bits()};
     int r = process_external_message(std::move(ext_msg));
@@ -4556,7 +4890,8 @@ bool Collator::create_shard_state() {
     CHECK(block::tlb::t_ShardState.validate_ref(1000000, state_root));
   }
   LOG(INFO) << "creating Merkle update for the ShardState";
-  state_update = vm::MerkleUpdate::generate(prev_state_root_, state_root, state_usage_tree_.get());
+  // the previous state is walked without usage cells, and its cells reused by the new state are not loaded
+  state_update = vm::MerkleUpdate::generate_fast(prev_state_root_pure_, state_root, state_usage_tree_.get());
   if (state_update.is_null()) {
     return fatal_error("cannot create Merkle update for ShardState");
   }
@@ -5038,6 +5373,9 @@ void Collator::return_block_candidate(td::Result<td::Unit> saved) {
   } else {
     CHECK(block_candidate);
     LOG(WARNING) << "sending new BlockCandidate to Promise";
+    if (block::AccountCache::shared().capacity() > 0) {
+      LOG(INFO) << "account cache: " << block::AccountCache::shared().get_stats().to_str();
+    }
     main_promise(block_candidate->clone());
     busy_ = false;
     stop();
@@ -46,8 +46,10 @@ td::actor::ActorOwn<Db> create_db_actor(td::actor::ActorId<ValidatorManager> man
 }
 
 td::actor::ActorOwn<LiteServerCache> create_liteserver_cache_actor(td::actor::ActorId<ValidatorManager> manager,
-                                                                   std::string db_root) {
-  return td::actor::create_actor<LiteServerCacheImpl>("cache");
+                                                                   std::string db_root,
+                                                                   td::Ref<ValidatorManagerOptions> opts) {
+  return td::actor::create_actor<LiteServerCacheImpl>("cache", std::move(db_root),
+                                                      opts->get_liteserver_disk_cache_size());
 }
 
 td::Result<td::Ref<BlockData>> create_block(BlockIdExt block_id, td::BufferSlice data) {
@@ -196,7 +198,8 @@ void run_check_proof_link_query(BlockIdExt id, td::Ref<ProofLink> proof, td::act
 void run_validate_query(ShardIdFull shard, UnixTime min_ts, BlockIdExt min_masterchain_block_id,
                         std::vector<BlockIdExt> prev, BlockCandidate candidate, td::Ref<ValidatorSet> validator_set,
                         td::actor::ActorId<ValidatorManager> manager, td::Timestamp timeout,
-                        td::Promise<ValidateCandidateResult> promise, bool is_fake) {
+                        td::Promise<ValidateCandidateResult> promise, bool is_fake,
+                        td::uint32 validation_threads) {
   BlockSeqno seqno = 0;
   for (auto& p : prev) {
     if (p.seqno() > seqno) {
@@ -208,14 +211,14 @@ void run_validate_query(ShardIdFull shard, UnixTime min_ts, BlockIdExt min_maste
                                                    << ":" << (seqno + 1) << "#" << idx.fetch_add(1),
                                          shard, min_ts, min_masterchain_block_id, std::move(prev), std::move(candidate),
                                          std::move(validator_set), std::move(manager), timeout, std::move(promise),
-                                         is_fake)
+                                         is_fake, validation_threads)
       .release();
 }
 
 void run_collate_query(ShardIdFull shard, td::uint32 min_ts, const BlockIdExt& min_masterchain_block_id,
                        std::vector<BlockIdExt> prev, Ed25519_PublicKey collator_id, td::Ref<ValidatorSet> validator_set,
                        td::actor::ActorId<ValidatorManager> manager, td::Timestamp timeout,
-                       td::Promise<BlockCandidate> promise) {
+                       td::Promise<BlockCandidate> promise, td::uint32 collator_threads) {
   BlockSeqno seqno = 0;
   for (auto& p : prev) {
     if (p.seqno() > seqno) {
@@ -224,7 +227,7 @@ void run_collate_query(ShardIdFull shard, td::uint32 min_ts, const BlockIdExt& m
   }
   td::actor::create_actor<Collator>(PSTRING() << "collate" << shard.to_str() << ":" << (seqno + 1), shard, false,
                                     min_ts, min_masterchain_block_id, std::move(prev), std::move(validator_set),
-                                    collator_id, std::move(manager), timeout, std::move(promise))
+                                    collator_id, std::move(manager), timeout, std::move(promise), collator_threads)
       .release();
 }
 
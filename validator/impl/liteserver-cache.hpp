@@ -17,45 +17,116 @@
 #pragma once
 
 #include "interfaces/liteserver.h"
+#include "td/db/RocksDb.h"
+#include "td/utils/misc.h"
+#include "tl-utils/lite-utils.hpp"
 #include <map>
 
 namespace ton::validator {
 
+// Two-tier cache of liteserver responses: an in-memory LRU and an optional RocksDb store in db_root/lscache/
+// bounded by disk_cache_size bytes. Disk entries are evicted in the order they were written.
+// Only responses which never change are cached (see LiteQuery::use_cache), so the disk tier survives restarts.
 class LiteServerCacheImpl : public LiteServerCache {
  public:
+  LiteServerCacheImpl(std::string db_root, size_t disk_cache_size)
+      : db_root_(std::move(db_root)), disk_cache_size_(disk_cache_size) {
+  }
+
   void start_up() override {
+    if (disk_cache_size_ > 0) {
+      open_disk_cache();
+    }
     alarm();
   }
 
   void alarm() override {
     alarm_timestamp() = td::Timestamp::in(60.0);
     if (queries_cnt_ > 0 || !send_message_cache_.empty()) {
-      LOG(WARNING) << "LS Cache stats: " << queries_cnt_ << " queries, " << queries_hit_cnt_ << " hits; "
-                   << cache_.size() << " entries, size=" << total_size_ << "/" << MAX_CACHE_SIZE << ";   "
-                   << send_message_cache_.size() << " different sendMessage queries, " << send_message_error_cnt_
-                   << " duplicates";
+      LOG(WARNING) << "LS Cache stats: " << queries_cnt_ << " queries, " << queries_hit_cnt_ << " hits, "
+                   << queries_disk_hit_cnt_ << " disk hits; " << cache_.size() << " entries, size=" << total_size_
+                   << "/" << MAX_CACHE_SIZE << "; " << disk_entries_.size() << " disk entries, size="
+                   << disk_total_size_ << "/" << disk_cache_size_ << ";   " << send_message_cache_.size()
+                   << " different sendMessage queries, " << send_message_error_cnt_ << " duplicates";
       queries_cnt_ = 0;
       queries_hit_cnt_ = 0;
+      queries_disk_hit_cnt_ = 0;
       send_message_cache_.clear();
       send_message_error_cnt_ = 0;
     }
   }
 
-  void lookup(td::Bits256 key, td::Promise<td::BufferSlice> promise) override {
+  void lookup(td::Bits256 key, int method, td::Promise<td::BufferSlice> promise) override {
     ++queries_cnt_;
+    auto &stats = method_stats_[method];
     auto it = cache_.find(key);
-    if (it == cache_.end()) {
-      promise.set_error(td::Status::Error("not found"));
+    if (it != cache_.end()) {
+      ++queries_hit_cnt_;
+      ++stats.hits;
+      auto entry = it->second.get();
+      entry->remove();
+      lru_.put(entry);
+      promise.set_value(entry->value_.clone());
       return;
     }
-    ++queries_hit_cnt_;
-    auto entry = it->second.get();
-    entry->remove();
-    lru_.put(entry);
-    promise.set_value(entry->value_.clone());
+    auto value = disk_lookup(key);
+    if (!value.empty()) {
+      ++queries_disk_hit_cnt_;
+      ++stats.disk_hits;
+      promise.set_value(value.clone());
+      put(key, std::move(value));
+      return;
+    }
+    ++stats.misses;
+    promise.set_error(td::Status::Error("not found"));
   }
 
   void update(td::Bits256 key, td::BufferSlice value) override {
+    disk_update(key, value.as_slice());
+    put(key, std::move(value));
+  }
+
+  void process_send_message(td::Bits256 key, td::Promise<td::Unit> promise) override {
+    if (send_message_cache_.insert(key).second) {
+      promise.set_result(td::Unit());
+    } else {
+      ++send_message_error_cnt_;
+      promise.set_error(td::Status::Error("duplicate message"));
+    }
+  }
+
+  void drop_send_message_from_cache(td::Bits256 key) override {
+    send_message_cache_.erase(key);
+  }
+
+  void prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise) override {
+    std::vector<std::pair<std::string, std::string>> vec;
+    vec.emplace_back("entries", td::to_string(cache_.size()));
+    vec.emplace_back("size", td::to_string(total_size_));
+    vec.emplace_back("diskentries", td::to_string(disk_entries_.size()));
+    vec.emplace_back("disksize", td::to_string(disk_total_size_));
+    for (const auto &p : method_stats_) {
+      auto name = lite_query_name_by_id(p.first);
+      vec.emplace_back(name + ".hits", td::to_string(p.second.hits));
+      vec.emplace_back(name + ".diskhits", td::to_string(p.second.disk_hits));
+      vec.emplace_back(name + ".misses", td::to_string(p.second.misses));
+    }
+    promise.set_value(std::move(vec));
+  }
+
+ private:
+  struct CacheEntry : public td::ListNode {
+    explicit CacheEntry(td::Bits256 key, td::BufferSlice value) : key_(key), value_(std::move(value)) {
+    }
+    td::Bits256 key_;
+    td::BufferSlice value_;
+
+    size_t size() const {
+      return value_.size() + 32 * 2;
+    }
+  };
+
+  void put(td::Bits256 key, td::BufferSlice value) {
     std::unique_ptr<CacheEntry> &entry = cache_[key];
     if (entry == nullptr) {
       entry = std::make_unique<CacheEntry>(key, std::move(value));
@@ -76,36 +147,122 @@ class LiteServerCacheImpl : public LiteServerCache {
     }
   }
 
-  void process_send_message(td::Bits256 key, td::Promise<td::Unit> promise) override {
-    if (send_message_cache_.insert(key).second) {
-      promise.set_result(td::Unit());
-    } else {
-      ++send_message_error_cnt_;
-      promise.set_error(td::Status::Error("duplicate message"));
+  // Disk entries are stored as "e" + key -> 8-byte write sequence number + response
+  static std::string disk_key(const td::Bits256 &key) {
+    return PSTRING() << 'e' << key.as_slice();
+  }
+
+  void open_disk_cache() {
+    auto path = db_root_ + "/lscache/";
+    auto R = td::RocksDb::open(path);
+    if (R.is_error()) {
+      LOG(ERROR) << "failed to open liteserver disk cache at " << path << ", disk cache is disabled: " << R.error();
+      return;
+    }
+    disk_db_ = std::make_unique<td::RocksDb>(R.move_as_ok());
+    auto S = disk_db_->for_each("e", [&](td::Slice key, td::Slice value) {
+      if (key.size() != 33 || value.size() < 8) {
+        return td::Status::Error("invalid liteserver disk cache entry");
+      }
+      td::Bits256 hash{td::ConstBitPtr{key.ubegin() + 1}};
+      auto seqno = td::as<td::uint64>(value.data());
+      disk_entries_[hash] = {seqno, value.size()};
+      disk_order_[seqno] = hash;
+      disk_total_size_ += value.size();
+      disk_seqno_ = std::max(disk_seqno_, seqno + 1);
+      return td::Status::OK();
+    });
+    if (S.is_error()) {
+      LOG(ERROR) << "failed to read liteserver disk cache, disk cache is disabled: " << S;
+      disk_db_ = nullptr;
+      disk_entries_.clear();
+      disk_order_.clear();
+      disk_total_size_ = 0;
+      return;
     }
+    disk_shrink();
+    LOG(INFO) << "loaded liteserver disk cache: " << disk_entries_.size() << " entries, size=" << disk_total_size_;
   }
 
-  void drop_send_message_from_cache(td::Bits256 key) override {
-    send_message_cache_.erase(key);
+  td::BufferSlice disk_lookup(const td::Bits256 &key) {
+    if (!disk_db_ || !disk_entries_.count(key)) {
+      return {};
+    }
+    std::string value;
+    auto R = disk_db_->get(disk_key(key), value);
+    if (R.is_error() || R.ok() != td::KeyValue::GetStatus::Ok || value.size() < 8) {
+      return {};
+    }
+    return td::BufferSlice{td::Slice{value}.substr(8)};
   }
 
- private:
-  struct CacheEntry : public td::ListNode {
-    explicit CacheEntry(td::Bits256 key, td::BufferSlice value) : key_(key), value_(std::move(value)) {
+  void disk_update(const td::Bits256 &key, td::Slice value) {
+    // a single response may not take more than 1/16 of the disk budget
+    if (!disk_db_ || (value.size() + 8) * 16 > disk_cache_size_) {
+      return;
     }
-    td::Bits256 key_;
-    td::BufferSlice value_;
+    auto it = disk_entries_.find(key);
+    if (it != disk_entries_.end()) {
+      disk_order_.erase(it->second.seqno);
+      disk_total_size_ -= it->second.size;
+    }
+    auto seqno = disk_seqno_++;
+    std::string data(8 + value.size(), '\0');
+    td::as<td::uint64>(&data[0]) = seqno;
+    td::MutableSlice(data).substr(8).copy_from(value);
+    auto S = disk_db_->set(disk_key(key), data);
+    if (S.is_error()) {
+      LOG(WARNING) << "failed to write to liteserver disk cache: " << S;
+      if (it != disk_entries_.end()) {
+        disk_entries_.erase(it);
+      }
+      return;
+    }
+    disk_entries_[key] = {seqno, data.size()};
+    disk_order_[seqno] = key;
+    disk_total_size_ += data.size();
+    disk_shrink();
+  }
 
-    size_t size() const {
-      return value_.size() + 32 * 2;
+  void disk_shrink() {
+    if (disk_total_size_ <= disk_cache_size_) {
+      return;
     }
-  };
+    disk_db_->begin_write_batch().ensure();
+    while (disk_total_size_ > disk_cache_size_) {
+      CHECK(!disk_order_.empty());
+      auto key = disk_order_.begin()->second;
+      disk_order_.erase(disk_order_.begin());
+      auto it = disk_entries_.find(key);
+      CHECK(it != disk_entries_.end());
+      disk_total_size_ -= it->second.size;
+      disk_entries_.erase(it);
+      disk_db_->erase(disk_key(key)).ensure();
+    }
+    disk_db_->commit_write_batch().ensure();
+  }
 
   std::map<td::Bits256, std::unique_ptr<CacheEntry>> cache_;
   td::ListNode lru_;
   size_t total_size_ = 0;
 
-  size_t queries_cnt_ = 0, queries_hit_cnt_ = 0;
+  std::string db_root_;
+  size_t disk_cache_size_;
+  std::unique_ptr<td::KeyValue> disk_db_;
+  struct DiskEntry {
+    td::uint64 seqno;
+    size_t size;
+  };
+  std::map<td::Bits256, DiskEntry> disk_entries_;
+  std::map<td::uint64, td::Bits256> disk_order_;
+  size_t disk_total_size_ = 0;
+  td::uint64 disk_seqno_ = 0;
+
+  size_t queries_cnt_ = 0, queries_hit_cnt_ = 0, queries_disk_hit_cnt_ = 0;
+  struct MethodStats {
+    td::uint64 hits = 0, disk_hits = 0, misses = 0;
+  };
+  std::map<int, MethodStats> method_stats_;  // lite_api ID -> cumulative counters
 
   std::set<td::Bits256> send_message_cache_;
   size_t send_message_error_cnt_ = 0;
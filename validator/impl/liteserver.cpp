@@ -41,6 +41,7 @@
 #include "validator-set.hpp"
 #include "signature-set.hpp"
 #include "fabric.h"
+#include <algorithm>
 #include <ctime>
 
 namespace ton {
@@ -159,20 +160,23 @@ void LiteQuery::start_up() {
   }
   use_cache_ = use_cache();
   if (use_cache_) {
-    cache_key_ = td::sha256_bits256(query_);
-    td::actor::send_closure(
-        cache_, &LiteServerCache::lookup, cache_key_, [SelfId = actor_id(this)](td::Result<td::BufferSlice> R) {
-          if (R.is_error()) {
-            td::actor::send_closure(SelfId, &LiteQuery::perform);
-          } else {
-            td::actor::send_closure(SelfId, &LiteQuery::finish_query, R.move_as_ok(), true);
-          }
-        });
+    // the key is computed from the normalized parsed query, so that different encodings of it share an entry
+    cache_key_ = td::sha256_bits256(serialize_tl_object(query_obj_.get(), true));
+    td::actor::send_closure(cache_, &LiteServerCache::lookup, cache_key_, query_obj_->get_id(),
+                            [SelfId = actor_id(this)](td::Result<td::BufferSlice> R) {
+                              if (R.is_error()) {
+                                td::actor::send_closure(SelfId, &LiteQuery::perform);
+                              } else {
+                                td::actor::send_closure(SelfId, &LiteQuery::finish_query, R.move_as_ok(), true);
+                              }
+                            });
   } else {
     perform();
   }
 }
 
+// Queries with a fully specified block id always return the same result, so they are cached.
+// Fields that do not affect the result are normalized here, before the cache key is computed.
 bool LiteQuery::use_cache()  {
   if (cache_.empty()) {
     return false;
@@ -185,6 +189,27 @@ bool LiteQuery::use_cache()  {
             // wc=-1, seqno=-1 means "use latest mc block"
             use = q.id_->workchain_ != masterchainId || q.id_->seqno_ != -1;
           },
+          [&](lite_api::liteServer_getAccountStates& q) {
+            use = q.id_->workchain_ != masterchainId || q.id_->seqno_ != -1;
+          },
+          [&](lite_api::liteServer_getBlock& q) { use = true; },
+          [&](lite_api::liteServer_getBlockHeader& q) { use = true; },
+          [&](lite_api::liteServer_getShardInfo& q) { use = true; },
+          [&](lite_api::liteServer_getAllShardsInfo& q) { use = true; },
+          [&](lite_api::liteServer_getOneTransaction& q) { use = true; },
+          [&](lite_api::liteServer_listBlockTransactions& q) { use = true; },
+          [&](lite_api::liteServer_listBlockTransactionsExt& q) { use = true; },
+          [&](lite_api::liteServer_getConfigParams& q) {
+            q.mode_ &= 0xffff;
+            // the proof does not depend on the order in which parameters are visited
+            std::sort(q.param_list_.begin(), q.param_list_.end());
+            q.param_list_.erase(std::unique(q.param_list_.begin(), q.param_list_.end()), q.param_list_.end());
+            use = true;
+          },
+          [&](lite_api::liteServer_getConfigAll& q) {
+            q.mode_ &= 0xffff;
+            use = true;
+          },
           [&](auto& obj) { use = false; }));
   return use;
 }
@@ -213,6 +238,9 @@ void LiteQuery::perform() {
             this->perform_getAccountState(ton::create_block_id(q.id_), static_cast<WorkchainId>(q.account_->workchain_),
                                           q.account_->id_, 0x40000000);
           },
+          [&](lite_api::liteServer_getAccountStates& q) {
+            this->perform_getAccountStates(ton::create_block_id(q.id_), std::move(q.accounts_));
+          },
           [&](lite_api::liteServer_getOneTransaction& q) {
             this->perform_getOneTransaction(ton::create_block_id(q.id_),
                                             static_cast<WorkchainId>(q.account_->workchain_), q.account_->id_,
@@ -848,7 +876,13 @@ void LiteQuery::continue_getAccountState_0(Ref<ton::validator::MasterchainState>
   CHECK(mc_state.not_null());
   mc_state_ = Ref<MasterchainStateQ>(std::move(mc_state));
   CHECK(mc_state_.not_null());
-  set_continuation([&]() -> void { continue_getAccountState(); });
+  set_continuation([&]() -> void {
+    if (acc_addrs_.empty()) {
+      continue_getAccountState();
+    } else {
+      continue_getAccountStates();
+    }
+  });
   request_mc_block_data(blkid);
 }
 
@@ -1313,6 +1347,153 @@ void LiteQuery::finish_getAccountState(td::BufferSlice shard_proof) {
   finish_query(std::move(b));
 }
 
+void LiteQuery::perform_getAccountStates(BlockIdExt blkid,
+                                         std::vector<tl_object_ptr<lite_api::liteServer_accountId>> accounts) {
+  LOG(INFO) << "started a getAccountStates(" << blkid.to_str() << ", <" << accounts.size()
+            << " accounts>) liteserver query";
+  if (accounts.empty() || accounts.size() > max_account_states_count) {
+    fatal_error(PSTRING() << "getAccountStates() must request from 1 to " << max_account_states_count << " accounts");
+    return;
+  }
+  acc_workchain_ = accounts[0]->workchain_;
+  for (auto& account : accounts) {
+    if (account->workchain_ != acc_workchain_) {
+      fatal_error("all accounts requested by getAccountStates() must belong to the same workchain");
+      return;
+    }
+    acc_addrs_.push_back(account->id_);
+  }
+  acc_addr_ = acc_addrs_[0];
+  if (blkid.id.workchain != masterchainId && blkid.id.workchain != acc_workchain_) {
+    fatal_error("reference block for a getAccountStates() must belong to the masterchain");
+    return;
+  }
+  if (!blkid.is_valid()) {
+    fatal_error("reference block id for a getAccountStates() is invalid");
+    return;
+  }
+  if (acc_workchain_ == blkid.id.workchain) {
+    for (auto& addr : acc_addrs_) {
+      if (!ton::shard_contains(blkid.shard_full(), extract_addr_prefix(acc_workchain_, addr))) {
+        fatal_error("requested account id is not contained in the shard of the reference block");
+        return;
+      }
+    }
+  }
+  if (blkid.id.workchain != masterchainId) {
+    base_blk_id_ = blkid;
+    set_continuation([&]() -> void { finish_getAccountStates({}); });
+    request_block_data_state(blkid);
+  } else if (blkid.id.seqno != ~0U) {
+    set_continuation([&]() -> void { continue_getAccountStates(); });
+    request_mc_block_data_state(blkid);
+  } else {
+    td::actor::send_closure_later(
+        manager_, &ton::validator::ValidatorManager::get_last_liteserver_state_block,
+        [Self = actor_id(this)](td::Result<std::pair<Ref<ton::validator::MasterchainState>, BlockIdExt>> res) -> void {
+          if (res.is_error()) {
+            td::actor::send_closure(Self, &LiteQuery::abort_query, res.move_as_error());
+          } else {
+            auto pair = res.move_as_ok();
+            td::actor::send_closure_later(Self, &LiteQuery::continue_getAccountState_0, std::move(pair.first),
+                                          pair.second);
+          }
+        });
+  }
+}
+
+void LiteQuery::continue_getAccountStates() {
+  LOG(INFO) << "continue getAccountStates() query";
+  if (acc_workchain_ == masterchainId) {
+    blk_id_ = base_blk_id_;
+    block_ = mc_block_;
+    state_ = mc_state_;
+    finish_getAccountStates({});
+    return;
+  }
+  Ref<vm::Cell> proof3, proof4;
+  Ref<block::McShardHash> info;
+  if (!(make_mc_state_root_proof(proof3) &&
+        make_shard_info_proof(proof4, info, extract_addr_prefix(acc_workchain_, acc_addr_)))) {
+    return;
+  }
+  auto proof = vm::std_boc_serialize_multi({std::move(proof3), std::move(proof4)});
+  if (proof.is_error()) {
+    fatal_error(proof.move_as_error());
+    return;
+  }
+  if (info.is_null()) {
+    // no shard with requested addresses found
+    LOG(INFO) << "getAccountStates(" << acc_workchain_ << ":<" << acc_addrs_.size()
+              << " accounts>) query completed (unknown workchain/shard)";
+    auto b = ton::create_serialize_tl_object<ton::lite_api::liteServer_accountStates>(
+        ton::create_tl_lite_block_id(base_blk_id_), ton::create_tl_lite_block_id(BlockIdExt{}), proof.move_as_ok(),
+        td::BufferSlice{}, std::vector<td::BufferSlice>(acc_addrs_.size()));
+    finish_query(std::move(b));
+    return;
+  }
+  // one state and one Merkle proof serve all accounts, so they must be in the same shard
+  for (auto& addr : acc_addrs_) {
+    if (!ton::shard_contains(info->shard(), extract_addr_prefix(acc_workchain_, addr))) {
+      fatal_error("accounts requested by getAccountStates() belong to different shards");
+      return;
+    }
+  }
+  shard_proof_ = proof.move_as_ok();
+  set_continuation([this]() -> void { finish_getAccountStates(std::move(shard_proof_)); });
+  request_block_data_state(info->top_block_id());
+}
+
+void LiteQuery::finish_getAccountStates(td::BufferSlice shard_proof) {
+  LOG(INFO) << "completing getAccountStates() query";
+  Ref<vm::Cell> proof1, proof2;
+  if (!make_state_root_proof(proof1)) {
+    return;
+  }
+  vm::MerkleProofBuilder pb{state_->root_cell()};
+  block::gen::ShardStateUnsplit::Record sstate;
+  if (!tlb::unpack_cell(pb.root(), sstate)) {
+    fatal_error("cannot unpack state header");
+    return;
+  }
+  vm::AugmentedDictionary accounts_dict{vm::load_cell_slice_ref(sstate.accounts), 256, block::tlb::aug_ShardAccounts};
+  std::vector<Ref<vm::Cell>> acc_roots;
+  acc_roots.reserve(acc_addrs_.size());
+  for (auto& addr : acc_addrs_) {
+    auto acc_csr = accounts_dict.lookup(addr);
+    acc_roots.push_back(acc_csr.not_null() ? acc_csr->prefetch_ref() : Ref<vm::Cell>{});
+  }
+  if (!pb.extract_proof_to(proof2)) {
+    fatal_error("unknown error creating Merkle proof");
+    return;
+  }
+  auto proof = vm::std_boc_serialize_multi({std::move(proof1), std::move(proof2)});
+  pb.clear();
+  if (proof.is_error()) {
+    fatal_error(proof.move_as_error());
+    return;
+  }
+  std::vector<td::BufferSlice> states;
+  states.reserve(acc_roots.size());
+  for (auto& acc_root : acc_roots) {
+    td::BufferSlice data;
+    if (acc_root.not_null()) {
+      auto res = vm::std_boc_serialize(std::move(acc_root));
+      if (res.is_error()) {
+        fatal_error(res.move_as_error());
+        return;
+      }
+      data = res.move_as_ok();
+    }
+    states.push_back(std::move(data));
+  }
+  LOG(INFO) << "getAccountStates(" << acc_workchain_ << ":<" << acc_addrs_.size() << " accounts>) query completed";
+  auto b = ton::create_serialize_tl_object<ton::lite_api::liteServer_accountStates>(
+      ton::create_tl_lite_block_id(base_blk_id_), ton::create_tl_lite_block_id(blk_id_), std::move(shard_proof),
+      proof.move_as_ok(), std::move(states));
+  finish_query(std::move(b));
+}
+
 // same as in lite-client/lite-client-common.cpp
 static td::Ref<vm::Tuple> prepare_vm_c7(ton::UnixTime now, ton::LogicalTime lt, td::Ref<vm::CellSlice> my_addr,
                                         const block::CurrencyCollection& balance,
@@ -51,6 +51,7 @@ class LiteQuery : public td::actor::Actor {
   int mode_{0};
   WorkchainId acc_workchain_;
   StdSmcAddress acc_addr_;
+  std::vector<StdSmcAddress> acc_addrs_;  // getAccountStates
   LogicalTime trans_lt_;
   Bits256 trans_hash_;
   BlockIdExt base_blk_id_, base_blk_id_alt_, blk_id_;
@@ -73,12 +74,13 @@ class LiteQuery : public td::actor::Actor {
   enum {
     default_timeout_msec = 4500,      // 4.5 seconds
     max_transaction_count = 16,       // fetch at most 16 transactions in one query
+    max_account_states_count = 1024,  // return at most 1024 accounts in one getAccountStates query
     client_method_gas_limit = 300000  // gas limit for liteServer.runSmcMethod
   };
   enum {
     ls_version = 0x101,
-    ls_capabilities = 7
-  };  // version 1.1; +1 = build block proof chains, +2 = masterchainInfoExt, +4 = runSmcMethod
+    ls_capabilities = 15
+  };  // version 1.1; +1 = build block proof chains, +2 = masterchainInfoExt, +4 = runSmcMethod, +8 = getAccountStates
   LiteQuery(td::BufferSlice data, td::actor::ActorId<ton::validator::ValidatorManager> manager,
             td::actor::ActorId<LiteServerCache> cache, td::Promise<td::BufferSlice> promise);
   LiteQuery(WorkchainId wc, StdSmcAddress  acc_addr, td::actor::ActorId<ton::validator::ValidatorManager> manager,
@@ -117,6 +119,9 @@ class LiteQuery : public td::actor::Actor {
   void continue_getAccountState_0(Ref<MasterchainState> mc_state, BlockIdExt blkid);
   void continue_getAccountState();
   void finish_getAccountState(td::BufferSlice shard_proof);
+  void perform_getAccountStates(BlockIdExt blkid, std::vector<tl_object_ptr<lite_api::liteServer_accountId>> accounts);
+  void continue_getAccountStates();
+  void finish_getAccountStates(td::BufferSlice shard_proof);
   void perform_fetchAccountState();
   void perform_runSmcMethod(BlockIdExt blkid, WorkchainId workchain, StdSmcAddress addr, int mode, td::int64 method_id,
                             td::BufferSlice params);
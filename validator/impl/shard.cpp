@@ -27,6 +27,7 @@
 #include "block/block-parse.h"
 #include "block/block-auto.h"
 #include "td/utils/filesystem.h"
+#include "td/utils/port/thread.h"
 
 #define LAZY_STATE_DESERIALIZE 1
 
@@ -146,7 +147,8 @@ td::Status ShardStateQ::validate_deep() const {
     return td::Status::Error(-668,
                              "cannot validate serialized shard state because no serialized shard state is present");
   }
-  auto res = vm::std_boc_deserialize(data.as_slice());
+  // downloaded persistent states may contain many millions of cells; hash them on all cores
+  auto res = vm::std_boc_deserialize(data.as_slice(), false, false, td::max(1u, td::thread::hardware_concurrency()));
   if (res.is_error()) {
     return res.move_as_error();
   }
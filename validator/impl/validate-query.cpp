@@ -28,9 +28,13 @@
 #include "block/block-parse.h"
 #include "block/block-auto.h"
 #include "block/output-queue-merger.h"
+#include "block/account-cache.h"
 #include "vm/cells/MerkleProof.h"
 #include "vm/cells/MerkleUpdate.h"
 #include "common/errorlog.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/Timer.h"
+#include <atomic>
 #include <ctime>
 
 namespace ton {
@@ -70,7 +74,7 @@ std::string ErrorCtx::as_string() const {
 ValidateQuery::ValidateQuery(ShardIdFull shard, UnixTime min_ts, BlockIdExt min_masterchain_block_id,
                              std::vector<BlockIdExt> prev, BlockCandidate candidate, Ref<ValidatorSet> validator_set,
                              td::actor::ActorId<ValidatorManager> manager, td::Timestamp timeout,
-                             td::Promise<ValidateCandidateResult> promise, bool is_fake)
+                             td::Promise<ValidateCandidateResult> promise, bool is_fake, td::uint32 validation_threads)
     : shard_(shard)
     , id_(candidate.id)
     , min_ts(min_ts)
@@ -84,6 +88,7 @@ ValidateQuery::ValidateQuery(ShardIdFull shard, UnixTime min_ts, BlockIdExt min_
     , is_fake_(is_fake)
     , shard_pfx_(shard_.shard)
     , shard_pfx_len_(ton::shard_prefix_length(shard_))
+    , validation_threads_(td::max(validation_threads, 1u))
     , perf_timer_("validateblock", 0.1, [manager](double duration) {
       send_closure(manager, &ValidatorManager::add_perf_timer_stat, "validateblock", duration);
     }) {
@@ -235,6 +240,9 @@ bool ValidateQuery::fatal_error(std::string err_msg, int err_code) {
 void ValidateQuery::finish_query() {
   if (main_promise) {
     LOG(WARNING) << "validate query done";
+    if (block::AccountCache::shared().capacity() > 0) {
+      LOG(INFO) << "account cache: " << block::AccountCache::shared().get_stats().to_str();
+    }
     main_promise.set_result(now_);
   }
   stop();
@@ -4621,16 +4629,18 @@ bool ValidateQuery::check_delivered_dequeued() {
  *
  * @param addr A pointer to the 256-bit address of the account.
  * @param account A cell slice with an account serialized using ShardAccount TLB-scheme.
+ * @param is_special True if the account is a special masterchain smart contract.
  *
  * @returns A unique pointer to the created Account object, or nullptr if the creation failed.
  */
-std::unique_ptr<block::Account> ValidateQuery::make_account_from(td::ConstBitPtr addr, Ref<vm::CellSlice> account) {
+std::unique_ptr<block::Account> ValidateQuery::make_account_from(td::ConstBitPtr addr, Ref<vm::CellSlice> account,
+                                                                 bool is_special) const {
   auto ptr = std::make_unique<block::Account>(workchain(), addr);
   if (account.is_null()) {
     if (!ptr->init_new(now_)) {
       return nullptr;
     }
-  } else if (!ptr->unpack(std::move(account), now_, is_masterchain() && config_->is_special_smartcontract(addr))) {
+  } else if (!block::AccountCache::unpack_shared(*ptr, std::move(account), now_, is_special)) {
     return nullptr;
   }
   ptr->block_lt = start_lt_;
@@ -4639,23 +4649,25 @@ std::unique_ptr<block::Account> ValidateQuery::make_account_from(td::ConstBitPtr
 
 /**
  * Retreives an Account object from the data in the shard state.
- * Accounts are cached in the ValidatorQuery's map.
  * Similar to Collator::make_account()
  *
- * @param addr The 256-bit address of the account.
+ * @param check The state of checking the transactions of the account.
+ * @param env The dictionaries used by the current thread.
  *
  * @returns Pointer to the account if found or created successfully.
  *          Returns nullptr if an error occured.
  */
-std::unique_ptr<block::Account> ValidateQuery::unpack_account(td::ConstBitPtr addr) {
-  auto dict_entry = ps_.account_dict_->lookup_extra(addr, 256);
-  auto new_acc = make_account_from(addr, std::move(dict_entry.first));
+std::unique_ptr<block::Account> ValidateQuery::unpack_account(AccountTransactionsCheck& check,
+                                                              const TransactionCheckEnv& env) const {
+  td::ConstBitPtr addr = check.addr.cbits();
+  auto dict_entry = env.account_dict->lookup_extra(addr, 256);
+  auto new_acc = make_account_from(addr, std::move(dict_entry.first), check.is_special);
   if (!new_acc) {
-    reject_query("cannot load state of account "s + addr.to_hex(256) + " from previous shardchain state");
+    check.reject("cannot load state of account "s + addr.to_hex(256) + " from previous shardchain state");
     return {};
   }
   if (!new_acc->belongs_to_shard(shard_)) {
-    reject_query(PSTRING() << "old state of account " << addr.to_hex(256)
+    check.reject(PSTRING() << "old state of account " << addr.to_hex(256)
                            << " does not really belong to current shard");
     return {};
   }
@@ -4666,6 +4678,8 @@ std::unique_ptr<block::Account> ValidateQuery::unpack_account(td::ConstBitPtr ad
  * Checks the validity of a single transaction for a given account.
  * Performs transaction execution.
  *
+ * @param check The state of checking the transactions of the account; receives the results and errors.
+ * @param env The dictionaries and configuration used by the current thread.
  * @param account The account of the transaction.
  * @param lt The logical time of the transaction.
  * @param trans_root The root of the transaction.
@@ -4674,10 +4688,11 @@ std::unique_ptr<block::Account> ValidateQuery::unpack_account(td::ConstBitPtr ad
  *
  * @returns True if the transaction is valid, false otherwise.
  */
-bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalTime lt, Ref<vm::Cell> trans_root,
-                                          bool is_first, bool is_last) {
-  if (!check_timeout()) {
-    return false;
+bool ValidateQuery::check_one_transaction(AccountTransactionsCheck& check, const TransactionCheckEnv& env,
+                                          block::Account& account, ton::LogicalTime lt, Ref<vm::Cell> trans_root,
+                                          bool is_first, bool is_last) const {
+  if (timeout && timeout.is_in_past()) {
+    return check.fatal("timeout", ErrorCode::timeout);
   }
   LOG(DEBUG) << "checking transaction " << lt << " of account " << account.addr.to_hex();
   const StdSmcAddress& addr = account.addr;
@@ -4691,16 +4706,16 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
   block::CurrencyCollection money_imported(0), money_exported(0);
   bool is_special_tx = false;  // recover/mint transaction
   if (in_msg_root.not_null()) {
-    auto in_descr_cs = in_msg_dict_->lookup(in_msg_root->get_hash().as_bitslice());
+    auto in_descr_cs = env.in_msg_dict->lookup(in_msg_root->get_hash().as_bitslice());
     if (in_descr_cs.is_null()) {
-      return reject_query(PSTRING() << "inbound message with hash " << in_msg_root->get_hash().to_hex()
+      return check.reject(PSTRING() << "inbound message with hash " << in_msg_root->get_hash().to_hex()
                                     << " of transaction " << lt << " of account " << addr.to_hex()
                                     << " does not have a corresponding InMsg record");
     }
     auto tag = block::gen::t_InMsg.get_tag(*in_descr_cs);
     if (tag != block::gen::InMsg::msg_import_ext && tag != block::gen::InMsg::msg_import_fin &&
         tag != block::gen::InMsg::msg_import_imm && tag != block::gen::InMsg::msg_import_ihr) {
-      return reject_query(PSTRING() << "inbound message with hash " << in_msg_root->get_hash().to_hex()
+      return check.reject(PSTRING() << "inbound message with hash " << in_msg_root->get_hash().to_hex()
                                     << " of transaction " << lt << " of account " << addr.to_hex()
                                     << " has an invalid InMsg record (not one of msg_import_ext, msg_import_fin, "
                                        "msg_import_imm or msg_import_ihr)");
@@ -4719,12 +4734,12 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
       block::gen::CommonMsgInfo::Record_int_msg_info info;
       CHECK(tlb::unpack_cell_inexact(in_msg_root, info));
       if (info.created_lt >= lt) {
-        return reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
+        return check.reject(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
                                       << " processed inbound message created later at logical time "
                                       << info.created_lt);
       }
       if (info.created_lt != start_lt_ || !is_special_tx) {
-        msg_proc_lt_.emplace_back(addr, lt, info.created_lt);
+        check.msg_proc_lt.emplace_back(addr, lt, info.created_lt);
       }
       dest = std::move(info.dest);
       CHECK(money_imported.validate_unpack(info.value));
@@ -4738,13 +4753,13 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     StdSmcAddress d_addr;
     CHECK(block::tlb::t_MsgAddressInt.extract_std_address(dest, d_wc, d_addr));
     if (d_wc != workchain() || d_addr != addr) {
-      return reject_query(PSTRING() << "inbound message of transaction " << lt << " of account " << addr.to_hex()
+      return check.reject(PSTRING() << "inbound message of transaction " << lt << " of account " << addr.to_hex()
                                     << " has a different destination address " << d_wc << ":" << d_addr.to_hex());
     }
     auto in_msg_trans = in_descr_cs->prefetch_ref(1);  // trans:^Transaction
     CHECK(in_msg_trans.not_null());
     if (in_msg_trans->get_hash() != trans_root->get_hash()) {
-      return reject_query(PSTRING() << "InMsg record for inbound message with hash " << in_msg_root->get_hash().to_hex()
+      return check.reject(PSTRING() << "InMsg record for inbound message with hash " << in_msg_root->get_hash().to_hex()
                                     << " of transaction " << lt << " of account " << addr.to_hex()
                                     << " refers to a different processing transaction");
     }
@@ -4754,16 +4769,16 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
   for (int i = 0; i < trans.outmsg_cnt; i++) {
     auto out_msg_root = out_dict.lookup_ref(td::BitArray<15>{i});
     CHECK(out_msg_root.not_null());  // we have pre-checked this
-    auto out_descr_cs = out_msg_dict_->lookup(out_msg_root->get_hash().as_bitslice());
+    auto out_descr_cs = env.out_msg_dict->lookup(out_msg_root->get_hash().as_bitslice());
     if (out_descr_cs.is_null()) {
-      return reject_query(PSTRING() << "outbound message #" << i + 1 << " with hash "
+      return check.reject(PSTRING() << "outbound message #" << i + 1 << " with hash "
                                     << out_msg_root->get_hash().to_hex() << " of transaction " << lt << " of account "
                                     << addr.to_hex() << " does not have a corresponding OutMsg record");
     }
     auto tag = block::gen::t_OutMsg.get_tag(*out_descr_cs);
     if (tag != block::gen::OutMsg::msg_export_ext && tag != block::gen::OutMsg::msg_export_new &&
         tag != block::gen::OutMsg::msg_export_imm) {
-      return reject_query(
+      return check.reject(
           PSTRING() << "outbound message #" << i + 1 << " with hash " << out_msg_root->get_hash().to_hex()
                     << " of transaction " << lt << " of account " << addr.to_hex()
                     << " has an invalid OutMsg record (not one of msg_export_ext, msg_export_new or msg_export_imm)");
@@ -4794,14 +4809,14 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     StdSmcAddress ss_addr;  // s_addr is some macros in Windows
     CHECK(block::tlb::t_MsgAddressInt.extract_std_address(src, s_wc, ss_addr));
     if (s_wc != workchain() || ss_addr != addr) {
-      return reject_query(PSTRING() << "outbound message #" << i + 1 << " of transaction " << lt << " of account "
+      return check.reject(PSTRING() << "outbound message #" << i + 1 << " of transaction " << lt << " of account "
                                     << addr.to_hex() << " has a different source address " << s_wc << ":"
                                     << ss_addr.to_hex());
     }
     auto out_msg_trans = out_descr_cs->prefetch_ref(1);  // trans:^Transaction
     CHECK(out_msg_trans.not_null());
     if (out_msg_trans->get_hash() != trans_root->get_hash()) {
-      return reject_query(PSTRING() << "OutMsg record for outbound message #" << i + 1 << " with hash "
+      return check.reject(PSTRING() << "OutMsg record for outbound message #" << i + 1 << " with hash "
                                     << out_msg_root->get_hash().to_hex() << " of transaction " << lt << " of account "
                                     << addr.to_hex() << " refers to a different processing transaction");
     }
@@ -4817,70 +4832,70 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
       tag == block::gen::TransactionDescr::trans_split_prepare ||
       tag == block::gen::TransactionDescr::trans_split_install) {
     if (is_masterchain()) {
-      return reject_query(
+      return check.reject(
           PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                     << " is a split/merge prepare/install transaction, which is impossible in a masterchain block");
     }
     bool split = (tag == block::gen::TransactionDescr::trans_split_prepare ||
                   tag == block::gen::TransactionDescr::trans_split_install);
     if (split && !before_split_) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+      return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                     << " is a split prepare/install transaction, but this block is not before a split");
     }
     if (split && !is_last) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+      return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                     << " is a split prepare/install transaction, but it is not the last transaction "
                                        "for this account in this block");
     }
     if (!split && !after_merge_) {
-      return reject_query(
+      return check.reject(
           PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                     << " is a merge prepare/install transaction, but this block is not immediately after a merge");
     }
     if (!split && !is_first) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+      return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                     << " is a merge prepare/install transaction, but it is not the first transaction "
                                        "for this account in this block");
     }
     // check later a global configuration flag in config_.global_flags_
     // (for now, split/merge transactions are always globally disabled)
-    return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+    return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                   << " is a split/merge prepare/install transaction, which are globally disabled");
   }
   if (tag == block::gen::TransactionDescr::trans_tick_tock) {
     if (!is_masterchain()) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+      return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                     << " is a tick-tock transaction, which is impossible outside a masterchain block");
     }
     if (!account.is_special) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+      return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                     << " is a tick-tock transaction, but this account is not listed as special");
     }
     bool is_tock = td_cs.prefetch_ulong(4) & 1;  // trans_tick_tock$001 is_tock:Bool ...
     if (!is_tock) {
       if (!is_first) {
-        return reject_query(
+        return check.reject(
             PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                       << " is a tick transaction, but this is not the first transaction of this account");
       }
       if (lt != start_lt_ + 1) {
-        return reject_query(
+        return check.reject(
             PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                       << " is a tick transaction, but its logical start time differs from block's start time "
                       << start_lt_ << " by more than one");
       }
       if (!account.tick) {
-        return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                       << " is a tick transaction, but this account has not enabled tick transactions");
       }
     } else {
       if (!is_last) {
-        return reject_query(
+        return check.reject(
             PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                       << " is a tock transaction, but this is not the last transaction of this account");
       }
       if (!account.tock) {
-        return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                       << " is a tock transaction, but this account has not enabled tock transactions");
       }
     }
@@ -4888,26 +4903,26 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
   if (is_first && is_masterchain() && account.is_special && account.tick &&
       (tag != block::gen::TransactionDescr::trans_tick_tock || (td_cs.prefetch_ulong(4) & 1)) &&
       account.orig_status == block::Account::acc_active) {
-    return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+    return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                   << " is the first transaction for this special tick account in this block, but the "
                                      "transaction is not a tick transaction");
   }
   if (is_last && is_masterchain() && account.is_special && account.tock &&
       (tag != block::gen::TransactionDescr::trans_tick_tock || !(td_cs.prefetch_ulong(4) & 1)) &&
       trans.end_status == block::gen::AccountStatus::acc_state_active) {
-    return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+    return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                   << " is the last transaction for this special tock account in this block, but the "
                                      "transaction is not a tock transaction");
   }
   if (tag == block::gen::TransactionDescr::trans_storage && !is_first) {
-    return reject_query(
+    return check.reject(
         PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                   << " is a storage transaction, but it is not the first transaction for this account in this block");
   }
   // check that the original account state has correct hash
   CHECK(account.total_state.not_null());
   if (hash_upd.old_hash != account.total_state->get_hash().bits()) {
-    return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+    return check.reject(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                                   << " claims that the original account state hash must be "
                                   << hash_upd.old_hash.to_hex() << " but the actual value is "
                                   << account.total_state->get_hash().to_hex());
@@ -4918,7 +4933,7 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     case block::gen::TransactionDescr::trans_ord: {
       trans_type = block::transaction::Transaction::tr_ord;
       if (in_msg_root.is_null()) {
-        return reject_query(PSTRING() << "ordinary transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "ordinary transaction " << lt << " of account " << addr.to_hex()
                                       << " has no inbound message");
       }
       need_credit_phase = !external;
@@ -4927,15 +4942,15 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     case block::gen::TransactionDescr::trans_storage: {
       trans_type = block::transaction::Transaction::tr_storage;
       if (in_msg_root.not_null()) {
-        return reject_query(PSTRING() << "storage transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "storage transaction " << lt << " of account " << addr.to_hex()
                                       << " has an inbound message");
       }
       if (trans.outmsg_cnt) {
-        return reject_query(PSTRING() << "storage transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "storage transaction " << lt << " of account " << addr.to_hex()
                                       << " has at least one outbound message");
       }
       // FIXME
-      return reject_query(PSTRING() << "unable to verify storage transaction " << lt << " of account "
+      return check.reject(PSTRING() << "unable to verify storage transaction " << lt << " of account "
                                     << addr.to_hex());
       break;
     }
@@ -4943,7 +4958,7 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
       bool is_tock = (td_cs.prefetch_ulong(4) & 1);
       trans_type = is_tock ? block::transaction::Transaction::tr_tock : block::transaction::Transaction::tr_tick;
       if (in_msg_root.not_null()) {
-        return reject_query(PSTRING() << (is_tock ? "tock" : "tick") << " transaction " << lt << " of account "
+        return check.reject(PSTRING() << (is_tock ? "tock" : "tick") << " transaction " << lt << " of account "
                                       << addr.to_hex() << " has an inbound message");
       }
       break;
@@ -4951,53 +4966,53 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     case block::gen::TransactionDescr::trans_merge_prepare: {
       trans_type = block::transaction::Transaction::tr_merge_prepare;
       if (in_msg_root.not_null()) {
-        return reject_query(PSTRING() << "merge prepare transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "merge prepare transaction " << lt << " of account " << addr.to_hex()
                                       << " has an inbound message");
       }
       if (trans.outmsg_cnt != 1) {
-        return reject_query(PSTRING() << "merge prepare transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "merge prepare transaction " << lt << " of account " << addr.to_hex()
                                       << " must have exactly one outbound message");
       }
       // FIXME
-      return reject_query(PSTRING() << "unable to verify merge prepare transaction " << lt << " of account "
+      return check.reject(PSTRING() << "unable to verify merge prepare transaction " << lt << " of account "
                                     << addr.to_hex());
       break;
     }
     case block::gen::TransactionDescr::trans_merge_install: {
       trans_type = block::transaction::Transaction::tr_merge_install;
       if (in_msg_root.is_null()) {
-        return reject_query(PSTRING() << "merge install transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "merge install transaction " << lt << " of account " << addr.to_hex()
                                       << " has no inbound message");
       }
       need_credit_phase = true;
       // FIXME
-      return reject_query(PSTRING() << "unable to verify merge install transaction " << lt << " of account "
+      return check.reject(PSTRING() << "unable to verify merge install transaction " << lt << " of account "
                                     << addr.to_hex());
       break;
     }
     case block::gen::TransactionDescr::trans_split_prepare: {
       trans_type = block::transaction::Transaction::tr_split_prepare;
       if (in_msg_root.not_null()) {
-        return reject_query(PSTRING() << "split prepare transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "split prepare transaction " << lt << " of account " << addr.to_hex()
                                       << " has an inbound message");
       }
       if (trans.outmsg_cnt > 1) {
-        return reject_query(PSTRING() << "split prepare transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "split prepare transaction " << lt << " of account " << addr.to_hex()
                                       << " must have exactly one outbound message");
       }
       // FIXME
-      return reject_query(PSTRING() << "unable to verify split prepare transaction " << lt << " of account "
+      return check.reject(PSTRING() << "unable to verify split prepare transaction " << lt << " of account "
                                     << addr.to_hex());
       break;
     }
     case block::gen::TransactionDescr::trans_split_install: {
       trans_type = block::transaction::Transaction::tr_split_install;
       if (in_msg_root.is_null()) {
-        return reject_query(PSTRING() << "split install transaction " << lt << " of account " << addr.to_hex()
+        return check.reject(PSTRING() << "split install transaction " << lt << " of account " << addr.to_hex()
                                       << " has no inbound message");
       }
       // FIXME
-      return reject_query(PSTRING() << "unable to verify split install transaction " << lt << " of account "
+      return check.reject(PSTRING() << "unable to verify split install transaction " << lt << " of account "
                                     << addr.to_hex());
       break;
     }
@@ -5011,60 +5026,60 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
   if (in_msg_root.not_null()) {
     if (!trs->unpack_input_msg(ihr_delivered, &action_phase_cfg_)) {
       // inbound external message was not accepted
-      return reject_query(PSTRING() << "could not unpack inbound " << (external ? "external" : "internal")
+      return check.reject(PSTRING() << "could not unpack inbound " << (external ? "external" : "internal")
                                     << " message processed by ordinary transaction " << lt << " of account "
                                     << addr.to_hex());
     }
   }
   if (trs->bounce_enabled) {
     if (!trs->prepare_storage_phase(storage_phase_cfg_, true)) {
-      return reject_query(PSTRING() << "cannot re-create storage phase of transaction " << lt << " for smart contract "
+      return check.reject(PSTRING() << "cannot re-create storage phase of transaction " << lt << " for smart contract "
                                     << addr.to_hex());
     }
     if (need_credit_phase && !trs->prepare_credit_phase()) {
-      return reject_query(PSTRING() << "cannot create re-credit phase of transaction " << lt << " for smart contract "
+      return check.reject(PSTRING() << "cannot create re-credit phase of transaction " << lt << " for smart contract "
                                     << addr.to_hex());
     }
   } else {
     if (need_credit_phase && !trs->prepare_credit_phase()) {
-      return reject_query(PSTRING() << "cannot re-create credit phase of transaction " << lt << " for smart contract "
+      return check.reject(PSTRING() << "cannot re-create credit phase of transaction " << lt << " for smart contract "
                                     << addr.to_hex());
     }
     if (!trs->prepare_storage_phase(storage_phase_cfg_, true, need_credit_phase)) {
-      return reject_query(PSTRING() << "cannot re-create storage phase of transaction " << lt << " for smart contract "
+      return check.reject(PSTRING() << "cannot re-create storage phase of transaction " << lt << " for smart contract "
                                     << addr.to_hex());
     }
   }
-  if (!trs->prepare_compute_phase(compute_phase_cfg_)) {
-    return reject_query(PSTRING() << "cannot re-create compute phase of transaction " << lt << " for smart contract "
+  if (!trs->prepare_compute_phase(*env.compute_phase_cfg)) {
+    return check.reject(PSTRING() << "cannot re-create compute phase of transaction " << lt << " for smart contract "
                                   << addr.to_hex());
   }
   if (!trs->compute_phase->accepted) {
     if (external) {
-      return reject_query(PSTRING() << "inbound external message claimed to be processed by ordinary transaction " << lt
+      return check.reject(PSTRING() << "inbound external message claimed to be processed by ordinary transaction " << lt
                                     << " of account " << addr.to_hex()
                                     << " was in fact rejected (such transaction cannot appear in valid blocks)");
     } else if (trs->compute_phase->skip_reason == block::ComputePhase::sk_none) {
-      return reject_query(PSTRING() << "inbound internal message processed by ordinary transaction " << lt
+      return check.reject(PSTRING() << "inbound internal message processed by ordinary transaction " << lt
                                     << " of account " << addr.to_hex() << " was not processed without any reason");
     }
   }
   if (trs->compute_phase->success && !trs->prepare_action_phase(action_phase_cfg_)) {
-    return reject_query(PSTRING() << "cannot re-create action phase of transaction " << lt << " for smart contract "
+    return check.reject(PSTRING() << "cannot re-create action phase of transaction " << lt << " for smart contract "
                                   << addr.to_hex());
   }
   if (trs->bounce_enabled &&
       (!trs->compute_phase->success || trs->action_phase->state_exceeds_limits || trs->action_phase->bounce) &&
       !trs->prepare_bounce_phase(action_phase_cfg_)) {
-    return reject_query(PSTRING() << "cannot re-create bounce phase of  transaction " << lt << " for smart contract "
+    return check.reject(PSTRING() << "cannot re-create bounce phase of  transaction " << lt << " for smart contract "
                                   << addr.to_hex());
   }
   if (!trs->serialize()) {
-    return reject_query(PSTRING() << "cannot re-create the serialization of  transaction " << lt
+    return check.reject(PSTRING() << "cannot re-create the serialization of  transaction " << lt
                                   << " for smart contract " << addr.to_hex());
   }
-  if (!trs->update_limits(*block_limit_status_, /* with_gas = */ false, /* with_size = */ false)) {
-    return fatal_error(PSTRING() << "cannot update block limit status to include transaction " << lt << " of account "
+  if (!trs->update_limits(check.limit_status, /* with_gas = */ false, /* with_size = */ false)) {
+    return check.fatal(PSTRING() << "cannot update block limit status to include transaction " << lt << " of account "
                                  << addr.to_hex());
   }
 
@@ -5072,25 +5087,29 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
   // ticktocks and mint/recover.
   // Here Validator checks a weaker condition
   if (!is_special_tx && !trs->gas_limit_overridden && trans_type == block::transaction::Transaction::tr_ord) {
-    (account.is_special ? total_special_gas_used_ : total_gas_used_) += trs->gas_used();
-  }
-  if (total_gas_used_ > block_limits_->gas.hard() + compute_phase_cfg_.gas_limit) {
-    return reject_query(PSTRING() << "gas block limits are exceeded: total_gas_used > gas_limit_hard + trx_gas_limit ("
-                                  << "total_gas_used=" << total_gas_used_
+    (account.is_special ? check.special_gas_used : check.gas_used) += trs->gas_used();
+  }
+  // only the gas of this account and of the accounts merged before it are known here,
+  // merge_account_transactions() checks the totals again
+  td::uint64 total_gas_used = check.base_gas_used + check.gas_used;
+  td::uint64 total_special_gas_used = check.base_special_gas_used + check.special_gas_used;
+  if (total_gas_used > block_limits_->gas.hard() + compute_phase_cfg_.gas_limit) {
+    return check.reject(PSTRING() << "gas block limits are exceeded: total_gas_used > gas_limit_hard + trx_gas_limit ("
+                                  << "total_gas_used=" << total_gas_used
                                   << ", gas_limit_hard=" << block_limits_->gas.hard()
                                   << ", trx_gas_limit=" << compute_phase_cfg_.gas_limit << ")");
   }
-  if (total_special_gas_used_ > block_limits_->gas.hard() + compute_phase_cfg_.special_gas_limit) {
-    return reject_query(
+  if (total_special_gas_used > block_limits_->gas.hard() + compute_phase_cfg_.special_gas_limit) {
+    return check.reject(
         PSTRING() << "gas block limits are exceeded: total_special_gas_used > gas_limit_hard + special_gas_limit ("
-                  << "total_special_gas_used=" << total_special_gas_used_
+                  << "total_special_gas_used=" << total_special_gas_used
                   << ", gas_limit_hard=" << block_limits_->gas.hard()
                   << ", special_gas_limit=" << compute_phase_cfg_.special_gas_limit << ")");
   }
 
   auto trans_root2 = trs->commit(account);
   if (trans_root2.is_null()) {
-    return reject_query(PSTRING() << "the re-created transaction " << lt << " for smart contract " << addr.to_hex()
+    return check.reject(PSTRING() << "the re-created transaction " << lt << " for smart contract " << addr.to_hex()
                                   << " could not be committed");
   }
   // now compare the re-created transaction with the one we have
@@ -5101,7 +5120,7 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
       std::cerr << "re-created transaction " << lt << " of " << addr.to_hex() << ": ";
       block::gen::t_Transaction.print_ref(std::cerr, trans_root2);
     }
-    return reject_query(PSTRING() << "the transaction " << lt << " of " << addr.to_hex() << " has hash "
+    return check.reject(PSTRING() << "the transaction " << lt << " of " << addr.to_hex() << " has hash "
                                   << trans_root->get_hash().to_hex()
                                   << " different from that of the recreated transaction "
                                   << trans_root2->get_hash().to_hex());
@@ -5110,39 +5129,39 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
   block::gen::HASH_UPDATE::Record hash_upd2;
   if (!(tlb::unpack_cell(trans_root2, trans2) &&
         tlb::type_unpack_cell(std::move(trans2.state_update), block::gen::t_HASH_UPDATE_Account, hash_upd2))) {
-    return fatal_error(PSTRING() << "cannot unpack the re-created transaction " << lt << " of " << addr.to_hex());
+    return check.fatal(PSTRING() << "cannot unpack the re-created transaction " << lt << " of " << addr.to_hex());
   }
   if (hash_upd2.old_hash != hash_upd.old_hash) {
-    return fatal_error(PSTRING() << "the re-created transaction " << lt << " of " << addr.to_hex()
+    return check.fatal(PSTRING() << "the re-created transaction " << lt << " of " << addr.to_hex()
                                  << " is invalid: it starts from account state with different hash");
   }
   if (hash_upd2.new_hash != account.total_state->get_hash().bits()) {
-    return fatal_error(
+    return check.fatal(
         PSTRING() << "the re-created transaction " << lt << " of " << addr.to_hex()
                   << " is invalid: its claimed new account hash differs from the actual new account state");
   }
   if (hash_upd.new_hash != account.total_state->get_hash().bits()) {
-    return reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
+    return check.reject(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
                                   << " is invalid: it claims that the new account state hash is "
                                   << hash_upd.new_hash.to_hex() << " but the re-computed value is "
                                   << hash_upd2.new_hash.to_hex());
   }
   if (!trans.r1.out_msgs->contents_equal(*trans2.r1.out_msgs)) {
-    return reject_query(
+    return check.reject(
         PSTRING()
         << "transaction " << lt << " of " << addr.to_hex()
         << " is invalid: it has produced a set of outbound messages different from that listed in the transaction");
   }
-  total_burned_ += trs->blackhole_burned;
+  check.burned += trs->blackhole_burned;
   // check new balance and value flow
   auto new_balance = account.get_balance();
   block::CurrencyCollection total_fees;
   if (!total_fees.validate_unpack(trans.total_fees)) {
-    return reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
+    return check.reject(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
                                   << " has an invalid total_fees value");
   }
   if (old_balance + money_imported != new_balance + money_exported + total_fees + trs->blackhole_burned) {
-    return reject_query(
+    return check.reject(
         PSTRING() << "transaction " << lt << " of " << addr.to_hex()
                   << " violates the currency flow condition: old balance=" << old_balance.to_str()
                   << " + imported=" << money_imported.to_str() << " does not equal new balance=" << new_balance.to_str()
@@ -5157,17 +5176,18 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
  * Checks the validity of transactions for a given account block.
  * NB: may be run in parallel for different accounts
  *
- * @param acc_addr The address of the account.
- * @param acc_blk_root The root of the AccountBlock.
+ * @param check The state of checking the transactions of the account; receives the results and errors.
+ * @param env The dictionaries and configuration used by the current thread.
  *
  * @returns True if the account transactions are valid, false otherwise.
  */
-bool ValidateQuery::check_account_transactions(const StdSmcAddress& acc_addr, Ref<vm::CellSlice> acc_blk_root) {
+bool ValidateQuery::check_account_transactions(AccountTransactionsCheck& check, const TransactionCheckEnv& env) const {
+  const StdSmcAddress& acc_addr = check.addr;
   block::gen::AccountBlock::Record acc_blk;
-  CHECK(tlb::csr_unpack(std::move(acc_blk_root), acc_blk) && acc_blk.account_addr == acc_addr);
-  auto account_p = unpack_account(acc_addr.cbits());
+  CHECK(tlb::csr_unpack(check.acc_blk_root, acc_blk) && acc_blk.account_addr == acc_addr);
+  auto account_p = unpack_account(check, env);
   if (!account_p) {
-    return reject_query("cannot unpack old state of account "s + acc_addr.to_hex());
+    return check.reject("cannot unpack old state of account "s + acc_addr.to_hex());
   }
   auto& account = *account_p;
   CHECK(account.addr == acc_addr);
@@ -5176,35 +5196,191 @@ bool ValidateQuery::check_account_transactions(const StdSmcAddress& acc_addr, Re
   td::BitArray<64> min_trans, max_trans;
   CHECK(trans_dict.get_minmax_key(min_trans).not_null() && trans_dict.get_minmax_key(max_trans, true).not_null());
   ton::LogicalTime min_trans_lt = min_trans.to_ulong(), max_trans_lt = max_trans.to_ulong();
-  if (!trans_dict.check_for_each_extra([this, &account, min_trans_lt, max_trans_lt](Ref<vm::CellSlice> value,
-                                                                                    Ref<vm::CellSlice> extra,
-                                                                                    td::ConstBitPtr key, int key_len) {
+  if (!trans_dict.check_for_each_extra([this, &check, &env, &account, min_trans_lt, max_trans_lt](
+                                           Ref<vm::CellSlice> value, Ref<vm::CellSlice> extra, td::ConstBitPtr key,
+                                           int key_len) {
         CHECK(key_len == 64);
         ton::LogicalTime lt = key.get_uint(64);
         extra.clear();
-        return check_one_transaction(account, lt, value->prefetch_ref(), lt == min_trans_lt, lt == max_trans_lt);
+        return check_one_transaction(check, env, account, lt, value->prefetch_ref(), lt == min_trans_lt,
+                                     lt == max_trans_lt);
       })) {
-    return reject_query("at least one Transaction of account "s + acc_addr.to_hex() + " is invalid");
+    return check.reject("at least one Transaction of account "s + acc_addr.to_hex() + " is invalid");
   }
   if (is_masterchain() && account.libraries_changed()) {
-    return scan_account_libraries(account.orig_library, account.library, acc_addr);
+    return scan_account_libraries(check, account.orig_library, account.library, acc_addr);
   } else {
     return true;
   }
 }
 
+/**
+ * Applies the results of check_account_transactions() to the state of the query.
+ * Must be called for the accounts in the order of their addresses.
+ *
+ * @param check The finished check of the account transactions.
+ *
+ * @returns True if the transactions of the account are valid and fit into the block limits, false otherwise.
+ */
+bool ValidateQuery::merge_account_transactions(AccountTransactionsCheck& check) {
+  if (check.error.is_error()) {
+    if (check.rejected) {
+      return reject_query(check.error.message().str());
+    }
+    return fatal_error(check.error.code(), check.error.message().str());
+  }
+  block_limit_status_->update_lt(check.limit_status.cur_lt);
+  total_gas_used_ += check.gas_used;
+  total_special_gas_used_ += check.special_gas_used;
+  total_burned_ += check.burned;
+  std::move(check.msg_proc_lt.begin(), check.msg_proc_lt.end(), std::back_inserter(msg_proc_lt_));
+  std::move(check.lib_publishers.begin(), check.lib_publishers.end(), std::back_inserter(lib_publishers_));
+  if (total_gas_used_ > block_limits_->gas.hard() + compute_phase_cfg_.gas_limit) {
+    return reject_query(PSTRING() << "gas block limits are exceeded: total_gas_used > gas_limit_hard + trx_gas_limit ("
+                                  << "total_gas_used=" << total_gas_used_
+                                  << ", gas_limit_hard=" << block_limits_->gas.hard()
+                                  << ", trx_gas_limit=" << compute_phase_cfg_.gas_limit << ")");
+  }
+  if (total_special_gas_used_ > block_limits_->gas.hard() + compute_phase_cfg_.special_gas_limit) {
+    return reject_query(
+        PSTRING() << "gas block limits are exceeded: total_special_gas_used > gas_limit_hard + special_gas_limit ("
+                  << "total_special_gas_used=" << total_special_gas_used_
+                  << ", gas_limit_hard=" << block_limits_->gas.hard()
+                  << ", special_gas_limit=" << compute_phase_cfg_.special_gas_limit << ")");
+  }
+  return true;
+}
+
 /**
  * Checks all transactions in the account blocks.
+ * If validation_threads_ is greater than one, transactions of different accounts are checked on several threads.
  *
  * @returns True if all transactions pass the check, False otherwise.
  */
 bool ValidateQuery::check_transactions() {
   LOG(INFO) << "checking all transactions";
-  return account_blocks_dict_->check_for_each_extra(
-      [this](Ref<vm::CellSlice> value, Ref<vm::CellSlice> extra, td::ConstBitPtr key, int key_len) {
-        CHECK(key_len == 256);
-        return check_account_transactions(key, std::move(value));
-      });
+  td::Timer timer;
+  std::vector<AccountTransactionsCheck> checks;
+  if (!account_blocks_dict_->check_for_each_extra(
+          [&](Ref<vm::CellSlice> value, Ref<vm::CellSlice> extra, td::ConstBitPtr key, int key_len) {
+            CHECK(key_len == 256);
+            checks.emplace_back(key, std::move(value), *block_limits_);
+            checks.back().is_special = is_masterchain() && config_->is_special_smartcontract(key);
+            return true;
+          })) {
+    return reject_query("cannot enumerate account blocks of the new block");
+  }
+  if (validation_threads_ > 1 && checks.size() > 1) {
+    if (!check_transactions_parallel(checks, validation_threads_)) {
+      return false;
+    }
+  } else {
+    TransactionCheckEnv env{in_msg_dict_.get(), out_msg_dict_.get(), ps_.account_dict_.get(), &compute_phase_cfg_};
+    for (auto& check : checks) {
+      check.base_gas_used = total_gas_used_;
+      check.base_special_gas_used = total_special_gas_used_;
+      check_account_transactions(check, env);
+      if (!merge_account_transactions(check)) {
+        return false;
+      }
+    }
+  }
+  LOG(INFO) << "checked transactions of " << checks.size() << " accounts in " << timer.elapsed() << " s using "
+            << std::min<size_t>(std::max(validation_threads_, 1u), checks.size()) << " threads";
+  return true;
+}
+
+/**
+ * Checks transactions of the account blocks on several threads.
+ * Every thread uses its own copies of the dictionaries, the results are merged in the order of accounts.
+ * The workers do not know the gas used by the previous accounts, so an account that failed (or threw an exception)
+ * or crosses the block gas limits is checked again on the actor thread, exactly as the sequential mode does it;
+ * thus the outcome (including the reported error) does not depend on the number of threads.
+ *
+ * @param checks The accounts to be checked, in the order of their addresses.
+ * @param threads The number of threads to use, including the current one.
+ *
+ * @returns True if all transactions pass the check, False otherwise.
+ */
+bool ValidateQuery::check_transactions_parallel(std::vector<AccountTransactionsCheck>& checks, td::uint32 threads) {
+  threads = static_cast<td::uint32>(std::min<size_t>(threads, checks.size()));
+  LOG(DEBUG) << "checking transactions of " << checks.size() << " accounts using " << threads << " threads";
+  struct ThreadEnv {
+    vm::AugmentedDictionary in_msg_dict, out_msg_dict, account_dict;
+    block::ComputePhaseConfig compute_phase_cfg;
+  };
+  // dictionaries keep a mutable cache of their root, so they are copied here, on the actor thread
+  std::vector<std::unique_ptr<ThreadEnv>> thread_envs;
+  for (td::uint32 i = 0; i < threads; i++) {
+    thread_envs.push_back(std::make_unique<ThreadEnv>(ThreadEnv{*in_msg_dict_, *out_msg_dict_, *ps_.account_dict_,
+                                                                compute_phase_cfg_.clone()}));
+  }
+  std::atomic<size_t> next_idx{0}, first_failed_idx{checks.size()};
+  auto run = [&](ThreadEnv& thread_env) {
+    TransactionCheckEnv env{&thread_env.in_msg_dict, &thread_env.out_msg_dict, &thread_env.account_dict,
+                            &thread_env.compute_phase_cfg};
+    while (true) {
+      size_t idx = next_idx.fetch_add(1, std::memory_order_relaxed);
+      if (idx >= checks.size() || idx > first_failed_idx.load(std::memory_order_relaxed)) {
+        break;
+      }
+      auto& check = checks[idx];
+      bool ok;
+      // an exception must not escape the thread; the account is checked again by the merge loop below
+      try {
+        ok = check_account_transactions(check, env);
+      } catch (vm::VmError& err) {
+        ok = check.fatal(err.get_msg());
+      } catch (vm::VmVirtError& err) {
+        ok = check.fatal(err.get_msg());
+      } catch (std::exception& err) {
+        ok = check.fatal(PSTRING() << "exception while checking transactions of account " << check.addr.to_hex()
+                                   << ": " << err.what());
+      } catch (...) {
+        ok = check.fatal("unknown exception while checking transactions of account "s + check.addr.to_hex());
+      }
+      if (!ok) {
+        size_t failed = first_failed_idx.load(std::memory_order_relaxed);
+        while (idx < failed && !first_failed_idx.compare_exchange_weak(failed, idx, std::memory_order_relaxed)) {
+        }
+      }
+    }
+  };
+  std::vector<td::thread> workers;
+  for (td::uint32 i = 1; i < threads; i++) {
+    workers.emplace_back([&run, &thread_env = *thread_envs[i]] { run(thread_env); });
+  }
+  run(*thread_envs[0]);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  size_t failed_idx = first_failed_idx.load();
+  TransactionCheckEnv env{in_msg_dict_.get(), out_msg_dict_.get(), ps_.account_dict_.get(), &compute_phase_cfg_};
+  for (size_t i = 0; i < checks.size() && i <= failed_idx; i++) {
+    auto& check = checks[i];
+    bool within_gas_limits =
+        total_gas_used_ + check.gas_used <= block_limits_->gas.hard() + compute_phase_cfg_.gas_limit &&
+        total_special_gas_used_ + check.special_gas_used <=
+            block_limits_->gas.hard() + compute_phase_cfg_.special_gas_limit;
+    if (check.error.is_ok() && within_gas_limits) {
+      if (!merge_account_transactions(check)) {
+        return false;
+      }
+      continue;
+    }
+    // the same error as in the sequential mode: the gas limits are checked after every transaction, and
+    // an exception reaches try_validate()
+    LOG(DEBUG) << "checking transactions of account " << check.addr.to_hex() << " again on the actor thread";
+    AccountTransactionsCheck serial_check{check.addr, check.acc_blk_root, *block_limits_};
+    serial_check.is_special = check.is_special;
+    serial_check.base_gas_used = total_gas_used_;
+    serial_check.base_special_gas_used = total_special_gas_used_;
+    check_account_transactions(serial_check, env);
+    if (!merge_account_transactions(serial_check)) {
+      return false;
+    }
+  }
+  return true;
 }
 
 /**
@@ -5212,27 +5388,29 @@ bool ValidateQuery::check_transactions() {
  * Used in masterchain validation.
  * Similar to Collator::update_account_public_libraries()
  *
+ * @param check The state of checking the transactions of the account; receives the changed public libraries.
  * @param orig_libs The original libraries of the account.
  * @param final_libs The final libraries of the account.
  * @param addr The address of the account.
  *
  * @returns True if the update was successful, false otherwise.
  */
-bool ValidateQuery::scan_account_libraries(Ref<vm::Cell> orig_libs, Ref<vm::Cell> final_libs, const td::Bits256& addr) {
+bool ValidateQuery::scan_account_libraries(AccountTransactionsCheck& check, Ref<vm::Cell> orig_libs,
+                                           Ref<vm::Cell> final_libs, const td::Bits256& addr) const {
   vm::Dictionary dict1{std::move(orig_libs), 256}, dict2{std::move(final_libs), 256};
   return dict1.scan_diff(
              dict2,
-             [this, &addr](td::ConstBitPtr key, int n, Ref<vm::CellSlice> val1, Ref<vm::CellSlice> val2) -> bool {
+             [&check, &addr](td::ConstBitPtr key, int n, Ref<vm::CellSlice> val1, Ref<vm::CellSlice> val2) -> bool {
                CHECK(n == 256);
                bool f = block::is_public_library(key, std::move(val1));
                bool g = block::is_public_library(key, val2);
                if (f != g) {
-                 lib_publishers_.emplace_back(key, addr, g);
+                 check.lib_publishers.emplace_back(key, addr, g);
                }
                return true;
              },
              3) ||
-         reject_query("error scanning old and new libraries of account "s + addr.to_hex());
+         check.reject("error scanning old and new libraries of account "s + addr.to_hex());
 }
 
 /**
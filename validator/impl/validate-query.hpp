@@ -119,7 +119,7 @@ class ValidateQuery : public td::actor::Actor {
   ValidateQuery(ShardIdFull shard, UnixTime min_ts, BlockIdExt min_masterchain_block_id, std::vector<BlockIdExt> prev,
                 BlockCandidate candidate, td::Ref<ValidatorSet> validator_set,
                 td::actor::ActorId<ValidatorManager> manager, td::Timestamp timeout,
-                td::Promise<ValidateCandidateResult> promise, bool is_fake = false);
+                td::Promise<ValidateCandidateResult> promise, bool is_fake = false, td::uint32 validation_threads = 1);
 
  private:
   int verbosity{3 * 1};
@@ -230,6 +230,50 @@ class ValidateQuery : public td::actor::Actor {
 
   std::vector<std::tuple<Bits256, Bits256, bool>> lib_publishers_, lib_publishers2_;
 
+  td::uint32 validation_threads_{1};
+
+  // Everything check_account_transactions() produces for one account.
+  // It does not touch the shared state of the query, so different accounts can be checked on different threads;
+  // the results are then merged in the order of accounts by merge_account_transactions().
+  struct AccountTransactionsCheck {
+    StdSmcAddress addr;
+    Ref<vm::CellSlice> acc_blk_root;
+    bool is_special{false};
+    td::uint64 base_gas_used{0}, base_special_gas_used{0};  // gas used by the previous accounts, if already known
+    td::uint64 gas_used{0}, special_gas_used{0};
+    block::CurrencyCollection burned{0};
+    block::BlockLimitStatus limit_status;
+    std::vector<std::tuple<Bits256, LogicalTime, LogicalTime>> msg_proc_lt;
+    std::vector<std::tuple<Bits256, Bits256, bool>> lib_publishers;
+    td::Status error;
+    bool rejected{false};
+
+    AccountTransactionsCheck(const StdSmcAddress& addr, Ref<vm::CellSlice> acc_blk_root,
+                             const block::BlockLimits& limits)
+        : addr(addr), acc_blk_root(std::move(acc_blk_root)), limit_status(limits) {
+    }
+    bool reject(std::string err_msg) {
+      if (error.is_ok()) {
+        error = td::Status::Error(std::move(err_msg));
+        rejected = true;
+      }
+      return false;
+    }
+    bool fatal(std::string err_msg, int err_code = -666) {
+      if (error.is_ok()) {
+        error = td::Status::Error(err_code, std::move(err_msg));
+      }
+      return false;
+    }
+  };
+  // Dictionaries and configuration used by check_account_transactions(); every thread needs its own objects.
+  struct TransactionCheckEnv {
+    vm::AugmentedDictionary* in_msg_dict;
+    vm::AugmentedDictionary* out_msg_dict;
+    vm::AugmentedDictionary* account_dict;
+    const block::ComputePhaseConfig* compute_phase_cfg;
+  };
+
   td::PerfWarningTimer perf_timer_;
 
   static constexpr td::uint32 priority() {
@@ -343,13 +387,17 @@ class ValidateQuery : public td::actor::Actor {
                                        const block::McShardDescr& src_nb, bool& unprocessed);
   bool check_in_queue();
   bool check_delivered_dequeued();
-  std::unique_ptr<block::Account> make_account_from(td::ConstBitPtr addr, Ref<vm::CellSlice> account);
-  std::unique_ptr<block::Account> unpack_account(td::ConstBitPtr addr);
-  bool check_one_transaction(block::Account& account, LogicalTime lt, Ref<vm::Cell> trans_root, bool is_first,
-                             bool is_last);
-  bool check_account_transactions(const StdSmcAddress& acc_addr, Ref<vm::CellSlice> acc_tr);
+  std::unique_ptr<block::Account> make_account_from(td::ConstBitPtr addr, Ref<vm::CellSlice> account,
+                                                    bool is_special) const;
+  std::unique_ptr<block::Account> unpack_account(AccountTransactionsCheck& check, const TransactionCheckEnv& env) const;
+  bool check_one_transaction(AccountTransactionsCheck& check, const TransactionCheckEnv& env, block::Account& account,
+                             LogicalTime lt, Ref<vm::Cell> trans_root, bool is_first, bool is_last) const;
+  bool check_account_transactions(AccountTransactionsCheck& check, const TransactionCheckEnv& env) const;
+  bool merge_account_transactions(AccountTransactionsCheck& check);
   bool check_transactions();
-  bool scan_account_libraries(Ref<vm::Cell> orig_libs, Ref<vm::Cell> final_libs, const td::Bits256& addr);
+  bool check_transactions_parallel(std::vector<AccountTransactionsCheck>& checks, td::uint32 threads);
+  bool scan_account_libraries(AccountTransactionsCheck& check, Ref<vm::Cell> orig_libs, Ref<vm::Cell> final_libs,
+                              const td::Bits256& addr) const;
   bool check_all_ticktock_processed();
   bool check_message_processing_order();
   bool check_special_message(Ref<vm::Cell> in_msg_root, const block::CurrencyCollection& amount,
@@ -40,44 +40,23 @@ bool ValidatorSetQ::is_validator(NodeIdShort id) const {
 
 td::Result<ValidatorWeight> ValidatorSetQ::check_signatures(RootHash root_hash, FileHash file_hash,
                                                             td::Ref<BlockSignatureSet> signatures) const {
-  auto &sigs = signatures->signatures();
-
   auto block = create_serialize_tl_object<ton_api::ton_blockId>(root_hash, file_hash);
-
-  ValidatorWeight weight = 0;
-
-  std::set<NodeIdShort> nodes;
-  for (auto &sig : sigs) {
-    if (nodes.count(sig.node) == 1) {
-      return td::Status::Error(ErrorCode::protoviolation, "duplicate node to sign");
-    }
-    nodes.insert(sig.node);
-
-    auto vdescr = find_validator(sig.node);
-    if (!vdescr) {
-      return td::Status::Error(ErrorCode::protoviolation, "unknown node to sign");
-    }
-
-    auto E = ValidatorFullId{vdescr->key}.create_encryptor().move_as_ok();
-    TRY_STATUS(E->check_signature(block.as_slice(), sig.signature.as_slice()));
-    weight += vdescr->weight;
-  }
-
-  if (weight * 3 <= total_weight_ * 2) {
-    return td::Status::Error(ErrorCode::protoviolation, "too small sig weight");
-  }
-  return weight;
+  return check_signed_message(block.as_slice(), signatures->signatures());
 }
 
 td::Result<ValidatorWeight> ValidatorSetQ::check_approve_signatures(RootHash root_hash, FileHash file_hash,
                                                                     td::Ref<BlockSignatureSet> signatures) const {
-  auto &sigs = signatures->signatures();
-
   auto block = create_serialize_tl_object<ton_api::ton_blockIdApprove>(root_hash, file_hash);
+  return check_signed_message(block.as_slice(), signatures->signatures());
+}
 
+td::Result<ValidatorWeight> ValidatorSetQ::check_signed_message(td::Slice message,
+                                                                const std::vector<BlockSignature> &sigs) const {
   ValidatorWeight weight = 0;
 
   std::set<NodeIdShort> nodes;
+  std::vector<std::unique_ptr<Encryptor>> encryptors;
+  std::vector<Encryptor::SignatureCheck> checks;
   for (auto &sig : sigs) {
     if (nodes.count(sig.node) == 1) {
       return td::Status::Error(ErrorCode::protoviolation, "duplicate node to sign");
@@ -89,11 +68,18 @@ td::Result<ValidatorWeight> ValidatorSetQ::check_approve_signatures(RootHash roo
       return td::Status::Error(ErrorCode::protoviolation, "unknown node to sign");
     }
 
-    auto E = ValidatorFullId{vdescr->key}.create_encryptor().move_as_ok();
-    TRY_STATUS(E->check_signature(block.as_slice(), sig.signature.as_slice()));
+    encryptors.push_back(ValidatorFullId{vdescr->key}.create_encryptor().move_as_ok());
+    checks.push_back(Encryptor::SignatureCheck{encryptors.back().get(), message, sig.signature.as_slice()});
     weight += vdescr->weight;
   }
 
+  // checked on the calling thread: this runs inside actors, which must not start threads or block on them
+  auto bad = Encryptor::check_signatures(checks);
+  if (!bad.empty()) {
+    auto &check = checks[bad[0]];
+    return check.encryptor->check_signature(check.message, check.signature);
+  }
+
   if (weight * 3 <= total_weight_ * 2) {
     return td::Status::Error(ErrorCode::protoviolation, "too small sig weight");
   }
@@ -64,6 +64,7 @@ class ValidatorSetQ : public ValidatorSet {
   std::vector<std::pair<NodeIdShort, size_t>> ids_map_;
 
   const ValidatorDescr* find_validator(const NodeIdShort& id) const;
+  td::Result<ValidatorWeight> check_signed_message(td::Slice message, const std::vector<BlockSignature>& sigs) const;
 };
 
 class ValidatorSetCompute {
@@ -25,11 +25,58 @@
 #include "td/utils/port/path.h"
 #include "ton/ton-io.hpp"
 #include "downloaders/download-state.hpp"
+#include "td/utils/Time.h"
 
 namespace ton {
 
 namespace validator {
 
+namespace {
+
+class BlockDecoder : public td::actor::Actor {
+ public:
+  BlockDecoder(std::shared_ptr<Package> package, BlockIdExt block_id, std::array<td::uint64, 2> offsets,
+               td::Promise<ArchiveImporter::DecodedBlock> promise)
+      : package_(std::move(package)), block_id_(block_id), offsets_(offsets), promise_(std::move(promise)) {
+  }
+  void start_up() override {
+    auto start = td::Time::now();
+    auto R = decode();
+    package_ = {};
+    if (R.is_ok()) {
+      R.ok_ref().decode_time = td::Time::now() - start;
+    }
+    promise_.set_result(std::move(R));
+    stop();
+  }
+
+ private:
+  std::shared_ptr<Package> package_;
+  BlockIdExt block_id_;
+  std::array<td::uint64, 2> offsets_;
+  td::Promise<ArchiveImporter::DecodedBlock> promise_;
+
+  td::Result<ArchiveImporter::DecodedBlock> decode() {
+    ArchiveImporter::DecodedBlock res;
+    TRY_RESULT(proof, package_->read(offsets_[0]));
+    TRY_RESULT(data, package_->read(offsets_[1]));
+    res.size = proof.second.size() + data.second.size();
+    if (block_id_.is_masterchain()) {
+      TRY_RESULT_ASSIGN(res.proof, create_proof(block_id_, std::move(proof.second)));
+      TRY_RESULT_ASSIGN(res.prev_key_seqno, res.proof->prev_key_mc_seqno());
+    } else {
+      TRY_RESULT_ASSIGN(res.proof_link, create_proof_link(block_id_, std::move(proof.second)));
+    }
+    if (sha256_bits256(data.second.as_slice()) != block_id_.file_hash) {
+      return td::Status::Error(ErrorCode::protoviolation, "bad block file hash");
+    }
+    TRY_RESULT_ASSIGN(res.data, create_block(block_id_, std::move(data.second)));
+    return std::move(res);
+  }
+};
+
+}  // namespace
+
 ArchiveImporter::ArchiveImporter(std::string path, td::Ref<MasterchainState> state, BlockSeqno shard_client_seqno,
                                  td::Ref<ValidatorManagerOptions> opts, td::actor::ActorId<ValidatorManager> manager,
                                  td::Promise<std::vector<BlockSeqno>> promise)
@@ -42,6 +89,10 @@ ArchiveImporter::ArchiveImporter(std::string path, td::Ref<MasterchainState> sta
 }
 
 void ArchiveImporter::start_up() {
+  depth_ = std::max<td::uint32>(opts_->get_archive_import_depth(), 1);
+  start_time_ = td::Time::now();
+  alarm_timestamp() = td::Timestamp::in(10.0);
+
   auto R = Package::open(path_, false, false);
   if (R.is_error()) {
     abort_query(R.move_as_error());
@@ -105,9 +156,124 @@ void ArchiveImporter::start_up() {
     return;
   }
 
+  if (depth_ > 1) {
+    // shard blocks are applied after all masterchain blocks, roughly in the order of their seqnos
+    for (auto &b : blocks_) {
+      if (!b.first.is_masterchain()) {
+        prefetch_order_.push_back(b.first);
+      }
+    }
+    std::stable_sort(prefetch_order_.begin(), prefetch_order_.end(),
+                     [](const BlockIdExt &a, const BlockIdExt &b) { return a.seqno() < b.seqno(); });
+  }
+
   check_masterchain_block(seqno);
 }
 
+void ArchiveImporter::alarm() {
+  log_progress("in progress");
+  alarm_timestamp() = td::Timestamp::in(10.0);
+}
+
+void ArchiveImporter::log_progress(td::Slice what) {
+  auto elapsed = std::max(td::Time::now() - start_time_, 1e-9);
+  auto blocks = applied_mc_blocks_ + applied_shard_blocks_;
+  LOG(INFO) << "archive import " << what << ": applied " << applied_mc_blocks_ << " masterchain and "
+            << applied_shard_blocks_ << " shard blocks in " << elapsed << "s, "
+            << static_cast<double>(blocks) / elapsed << " blocks/s, "
+            << static_cast<double>(decoded_bytes_) / elapsed / (1 << 20) << " MB/s decoded; stage occupancy: decode "
+            << decode_busy_ / elapsed / depth_ << ", check " << check_busy_ / elapsed / depth_ << ", apply "
+            << apply_busy_ / elapsed;
+}
+
+void ArchiveImporter::get_decoded_block(BlockIdExt block_id, td::Promise<DecodedBlock> promise) {
+  auto it = decoded_.find(block_id);
+  if (it != decoded_.end()) {
+    auto R = std::move(it->second);
+    decoded_.erase(it);
+    promise.set_result(std::move(R));
+    run_decoders();
+    return;
+  }
+  auto &waiters = decode_waiters_[block_id];
+  waiters.push_back(std::move(promise));
+  if (waiters.size() == 1 && !decoding_.count(block_id)) {
+    decode_queue_.push_back(block_id);
+  }
+  run_decoders();
+}
+
+void ArchiveImporter::run_decoders() {
+  // prefetched blocks of chains that are already applied will never be asked for
+  for (auto it = decoded_.begin(); it != decoded_.end();) {
+    auto s = shard_applied_seqno_.find(it->first.shard_full());
+    if (s != shard_applied_seqno_.end() && it->first.seqno() <= s->second) {
+      it = decoded_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  while (decoding_.size() < depth_) {
+    BlockIdExt block_id;
+    if (!decode_queue_.empty()) {
+      block_id = decode_queue_.front();
+      decode_queue_.pop_front();
+    } else if (prefetch_pos_ < prefetch_order_.size() && decoded_.size() + decoding_.size() < 4 * depth_) {
+      block_id = prefetch_order_[prefetch_pos_++];
+      auto s = shard_applied_seqno_.find(block_id.shard_full());
+      if (decoded_.count(block_id) || decoding_.count(block_id) ||
+          (s != shard_applied_seqno_.end() && block_id.seqno() <= s->second)) {
+        continue;
+      }
+    } else {
+      break;
+    }
+    auto it = blocks_.find(block_id);
+    if (it == blocks_.end()) {
+      auto w = decode_waiters_.find(block_id);
+      if (w != decode_waiters_.end()) {
+        auto waiters = std::move(w->second);
+        decode_waiters_.erase(w);
+        for (auto &promise : waiters) {
+          promise.set_error(td::Status::Error(ErrorCode::notready, PSTRING() << "no block " << block_id));
+        }
+      }
+      continue;
+    }
+    decoding_.insert(block_id);
+    td::actor::create_actor<BlockDecoder>(
+        "blockdecoder", package_, block_id, it->second,
+        [SelfId = actor_id(this), block_id](td::Result<DecodedBlock> R) {
+          td::actor::send_closure(SelfId, &ArchiveImporter::decoded_block, block_id, std::move(R));
+        })
+        .release();
+  }
+}
+
+void ArchiveImporter::decoded_block(BlockIdExt block_id, td::Result<DecodedBlock> R) {
+  decoding_.erase(block_id);
+  if (R.is_ok()) {
+    decoded_blocks_++;
+    decoded_bytes_ += R.ok().size;
+    decode_busy_ += R.ok().decode_time;
+  }
+  auto it = decode_waiters_.find(block_id);
+  if (it == decode_waiters_.end()) {
+    decoded_.emplace(block_id, std::move(R));
+  } else {
+    auto waiters = std::move(it->second);
+    decode_waiters_.erase(it);
+    for (auto &promise : waiters) {
+      if (R.is_ok()) {
+        promise.set_value(DecodedBlock{R.ok()});
+      } else {
+        promise.set_error(R.error().clone());
+      }
+    }
+  }
+  run_decoders();
+}
+
 void ArchiveImporter::check_masterchain_block(BlockSeqno seqno) {
   auto it = masterchain_blocks_.find(seqno);
   if (it == masterchain_blocks_.end()) {
@@ -141,70 +307,99 @@ void ArchiveImporter::check_masterchain_block(BlockSeqno seqno) {
     abort_query(td::Status::Error(ErrorCode::protoviolation, "hole in masterchain seqno"));
     return;
   }
-  auto it2 = blocks_.find(it->second);
-  CHECK(it2 != blocks_.end());
 
-  auto R1 = package_->read(it2->second[0]);
-  if (R1.is_error()) {
-    abort_query(R1.move_as_error());
-    return;
+  mc_start_prev_id_ = state_->get_block_id();
+  next_check_seqno_ = next_apply_seqno_ = seqno;
+  mc_end_seqno_ = seqno;
+  while (masterchain_blocks_.count(mc_end_seqno_)) {
+    mc_end_seqno_++;
   }
+  process_masterchain_blocks();
+}
 
-  auto proofR = create_proof(it->second, std::move(R1.move_as_ok().second));
-  if (proofR.is_error()) {
-    abort_query(proofR.move_as_error());
-    return;
+void ArchiveImporter::process_masterchain_blocks() {
+  auto window_end = std::min<BlockSeqno>(mc_end_seqno_, next_apply_seqno_ + depth_);
+  for (auto seqno = next_apply_seqno_; seqno < window_end; seqno++) {
+    auto &b = mc_pipeline_[seqno];
+    if (!b.requested) {
+      b.requested = true;
+      get_decoded_block(masterchain_blocks_[seqno], [SelfId = actor_id(this), seqno](td::Result<DecodedBlock> R) {
+        td::actor::send_closure(SelfId, &ArchiveImporter::got_decoded_masterchain_block, seqno, std::move(R));
+      });
+    }
   }
 
-  auto R2 = package_->read(it2->second[1]);
-  if (R2.is_error()) {
-    abort_query(R2.move_as_error());
-    return;
+  // a proof is checked against the last applied state, which has to be at least the previous key block;
+  // the signatures of each proof are verified as one batch inside CheckProof (ValidatorSetQ::check_signatures)
+  while (next_check_seqno_ < window_end && checking_ < depth_) {
+    auto &b = mc_pipeline_[next_check_seqno_];
+    if (!b.decoded || b.block.prev_key_seqno > state_->get_seqno()) {
+      break;
+    }
+    auto block_id = masterchain_blocks_[next_check_seqno_];
+    auto P = td::PromiseCreator::lambda(
+        [SelfId = actor_id(this), seqno = next_check_seqno_](td::Result<BlockHandle> R) {
+          if (R.is_error()) {
+            td::actor::send_closure(SelfId, &ArchiveImporter::abort_query, R.move_as_error());
+            return;
+          }
+          td::actor::send_closure(SelfId, &ArchiveImporter::checked_masterchain_proof, seqno, R.move_as_ok());
+        });
+    checking_++;
+    b.check_start_time = td::Time::now();
+    run_check_proof_query(block_id, b.block.proof, manager_, td::Timestamp::in(2.0 * depth_), std::move(P), state_,
+                          opts_->is_hardfork(block_id));
+    next_check_seqno_++;
   }
 
-  if (sha256_bits256(R2.ok().second.as_slice()) != it->second.file_hash) {
-    abort_query(td::Status::Error(ErrorCode::protoviolation, "bad block file hash"));
+  if (applying_) {
     return;
   }
-  auto dataR = create_block(it->second, std::move(R2.move_as_ok().second));
-  if (dataR.is_error()) {
-    abort_query(dataR.move_as_error());
+  auto it = mc_pipeline_.find(next_apply_seqno_);
+  if (it == mc_pipeline_.end() || !it->second.handle) {
     return;
   }
-
-  auto proof = proofR.move_as_ok();
-  auto data = dataR.move_as_ok();
-
-  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), id = state_->get_block_id(),
-                                       data](td::Result<BlockHandle> R) mutable {
-    if (R.is_error()) {
-      td::actor::send_closure(SelfId, &ArchiveImporter::abort_query, R.move_as_error());
-      return;
-    }
-    auto handle = R.move_as_ok();
-    CHECK(!handle->merge_before());
-    if (handle->one_prev(true) != id) {
-      td::actor::send_closure(SelfId, &ArchiveImporter::abort_query,
-                              td::Status::Error(ErrorCode::protoviolation, "prev block mismatch"));
-      return;
-    }
-    td::actor::send_closure(SelfId, &ArchiveImporter::checked_masterchain_proof, std::move(handle), std::move(data));
-  });
-
-  run_check_proof_query(it->second, std::move(proof), manager_, td::Timestamp::in(2.0), std::move(P), state_,
-                        opts_->is_hardfork(it->second));
-}
-
-void ArchiveImporter::checked_masterchain_proof(BlockHandle handle, td::Ref<BlockData> data) {
+  applying_ = true;
+  auto handle = it->second.handle;
+  auto data = std::move(it->second.block.data);
   CHECK(data.not_null());
   auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), handle](td::Result<td::Unit> R) {
     R.ensure();
     td::actor::send_closure(SelfId, &ArchiveImporter::applied_masterchain_block, std::move(handle));
   });
+  apply_start_time_ = td::Time::now();
   run_apply_block_query(handle->id(), std::move(data), handle->id(), manager_, td::Timestamp::in(600.0), std::move(P));
 }
 
+void ArchiveImporter::got_decoded_masterchain_block(BlockSeqno seqno, td::Result<DecodedBlock> R) {
+  if (R.is_error()) {
+    abort_query(R.move_as_error());
+    return;
+  }
+  auto &b = mc_pipeline_[seqno];
+  b.decoded = true;
+  b.block = R.move_as_ok();
+  process_masterchain_blocks();
+}
+
+void ArchiveImporter::checked_masterchain_proof(BlockSeqno seqno, BlockHandle handle) {
+  CHECK(checking_ > 0);
+  checking_--;
+  auto &b = mc_pipeline_[seqno];
+  check_busy_ += td::Time::now() - b.check_start_time;
+  CHECK(!handle->merge_before());
+  auto prev_id = seqno - 1 == mc_start_prev_id_.seqno() ? mc_start_prev_id_ : masterchain_blocks_[seqno - 1];
+  if (handle->one_prev(true) != prev_id) {
+    abort_query(td::Status::Error(ErrorCode::protoviolation, "prev block mismatch"));
+    return;
+  }
+  b.handle = std::move(handle);
+  process_masterchain_blocks();
+}
+
 void ArchiveImporter::applied_masterchain_block(BlockHandle handle) {
+  apply_busy_ += td::Time::now() - apply_start_time_;
+  applied_mc_blocks_++;
   auto P = td::PromiseCreator::lambda([SelfId = actor_id(this)](td::Result<td::Ref<ShardState>> R) {
     R.ensure();
     td::actor::send_closure(SelfId, &ArchiveImporter::got_new_materchain_state,
@@ -215,7 +410,15 @@ void ArchiveImporter::applied_masterchain_block(BlockHandle handle) {
 
 void ArchiveImporter::got_new_materchain_state(td::Ref<MasterchainState> state) {
   state_ = std::move(state);
-  check_masterchain_block(state_->get_block_id().seqno() + 1);
+  CHECK(state_->get_seqno() == next_apply_seqno_);
+  mc_pipeline_.erase(next_apply_seqno_);
+  next_apply_seqno_++;
+  applying_ = false;
+  if (next_apply_seqno_ == mc_end_seqno_) {
+    checked_all_masterchain_blocks(next_apply_seqno_ - 1);
+    return;
+  }
+  process_masterchain_blocks();
 }
 
 void ArchiveImporter::checked_all_masterchain_blocks(BlockSeqno seqno) {
@@ -280,6 +483,7 @@ void ArchiveImporter::apply_shard_block(BlockIdExt block_id, BlockIdExt masterch
 void ArchiveImporter::apply_shard_block_cont1(BlockHandle handle, BlockIdExt masterchain_block_id,
                                               td::Promise<td::Unit> promise) {
   if (handle->is_applied()) {
+    mark_shard_block_applied(handle->id());
     promise.set_value(td::Unit());
     return;
   }
@@ -293,40 +497,43 @@ void ArchiveImporter::apply_shard_block_cont1(BlockHandle handle, BlockIdExt mas
     return;
   }
 
-  auto it = blocks_.find(handle->id());
-  if (it == blocks_.end()) {
+  if (!blocks_.count(handle->id())) {
     promise.set_error(td::Status::Error(ErrorCode::notready, PSTRING() << "no proof for shard block " << handle->id()));
     return;
   }
-  TRY_RESULT_PROMISE(promise, data, package_->read(it->second[0]));
-  TRY_RESULT_PROMISE(promise, proof, create_proof_link(handle->id(), std::move(data.second)));
-  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), handle, masterchain_block_id,
-                                       promise = std::move(promise)](td::Result<BlockHandle> R) mutable {
-    if (R.is_error()) {
-      promise.set_error(R.move_as_error());
-    } else {
-      td::actor::send_closure(SelfId, &ArchiveImporter::apply_shard_block_cont2, std::move(handle),
-                              masterchain_block_id, std::move(promise));
-    }
+  get_decoded_block(handle->id(), [SelfId = actor_id(this), handle, masterchain_block_id, manager = manager_,
+                                   promise = std::move(promise)](td::Result<DecodedBlock> R) mutable {
+    TRY_RESULT_PROMISE(promise, block, std::move(R));
+    auto proof = block.proof_link;
+    auto P = td::PromiseCreator::lambda([SelfId, handle, masterchain_block_id, block = std::move(block),
+                                         promise = std::move(promise)](td::Result<BlockHandle> R) mutable {
+      if (R.is_error()) {
+        promise.set_error(R.move_as_error());
+      } else {
+        td::actor::send_closure(SelfId, &ArchiveImporter::apply_shard_block_cont2, std::move(handle),
+                                masterchain_block_id, std::move(block), std::move(promise));
+      }
+    });
+    run_check_proof_link_query(handle->id(), std::move(proof), manager, td::Timestamp::in(10.0), std::move(P));
   });
-  run_check_proof_link_query(handle->id(), std::move(proof), manager_, td::Timestamp::in(10.0), std::move(P));
 }
 
-void ArchiveImporter::apply_shard_block_cont2(BlockHandle handle, BlockIdExt masterchain_block_id,
+void ArchiveImporter::apply_shard_block_cont2(BlockHandle handle, BlockIdExt masterchain_block_id, DecodedBlock block,
                                               td::Promise<td::Unit> promise) {
   if (handle->is_applied()) {
+    mark_shard_block_applied(handle->id());
     promise.set_value(td::Unit());
     return;
   }
   CHECK(handle->id().seqno() > 0);
 
-  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), handle, masterchain_block_id,
+  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), handle, masterchain_block_id, block = std::move(block),
                                        promise = std::move(promise)](td::Result<td::Unit> R) mutable {
     if (R.is_error()) {
       promise.set_error(R.move_as_error());
     } else {
       td::actor::send_closure(SelfId, &ArchiveImporter::apply_shard_block_cont3, std::move(handle),
-                              masterchain_block_id, std::move(promise));
+                              masterchain_block_id, std::move(block), std::move(promise));
     }
   });
   if (!handle->merge_before() && handle->one_prev(true).shard_full() == handle->id().shard_full()) {
@@ -342,19 +549,28 @@ void ArchiveImporter::apply_shard_block_cont2(BlockHandle handle, BlockIdExt mas
   }
 }
 
-void ArchiveImporter::apply_shard_block_cont3(BlockHandle handle, BlockIdExt masterchain_block_id,
+void ArchiveImporter::apply_shard_block_cont3(BlockHandle handle, BlockIdExt masterchain_block_id, DecodedBlock block,
                                               td::Promise<td::Unit> promise) {
-  auto it = blocks_.find(handle->id());
-  CHECK(it != blocks_.end());
-  TRY_RESULT_PROMISE(promise, data, package_->read(it->second[1]));
-  if (sha256_bits256(data.second.as_slice()) != handle->id().file_hash) {
-    promise.set_error(td::Status::Error(ErrorCode::protoviolation, "bad block file hash"));
-    return;
-  }
-  TRY_RESULT_PROMISE(promise, block, create_block(handle->id(), std::move(data.second)));
+  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), block_id = handle->id(), start = td::Time::now(),
+                                       promise = std::move(promise)](td::Result<td::Unit> R) mutable {
+    if (R.is_ok()) {
+      td::actor::send_closure(SelfId, &ArchiveImporter::applied_shard_block, block_id, td::Time::now() - start);
+    }
+    promise.set_result(std::move(R));
+  });
+  run_apply_block_query(handle->id(), std::move(block.data), masterchain_block_id, manager_, td::Timestamp::in(600.0),
+                        std::move(P));
+}
+
+void ArchiveImporter::applied_shard_block(BlockIdExt block_id, double apply_time) {
+  applied_shard_blocks_++;
+  apply_busy_ += apply_time;
+  mark_shard_block_applied(block_id);
+}
 
-  run_apply_block_query(handle->id(), std::move(block), masterchain_block_id, manager_, td::Timestamp::in(600.0),
-                        std::move(promise));
+void ArchiveImporter::mark_shard_block_applied(BlockIdExt block_id) {
+  auto &seqno = shard_applied_seqno_[block_id.shard_full()];
+  seqno = std::max(seqno, block_id.seqno());
 }
 
 void ArchiveImporter::check_shard_block_applied(BlockIdExt block_id, td::Promise<td::Unit> promise) {
@@ -380,6 +596,7 @@ void ArchiveImporter::abort_query(td::Status error) {
 }
 void ArchiveImporter::finish_query() {
   if (promise_) {
+    log_progress("finished");
     promise_.set_value(
         std::vector<BlockSeqno>{state_->get_seqno(), std::min<BlockSeqno>(state_->get_seqno(), shard_client_seqno_)});
   }
@@ -22,6 +22,9 @@
 #include "validator/interfaces/validator-manager.h"
 #include "validator/db/package.hpp"
 
+#include <deque>
+#include <set>
+
 namespace ton {
 
 namespace validator {
@@ -36,8 +39,24 @@ class ArchiveImporter : public td::actor::Actor {
   void abort_query(td::Status error);
   void finish_query();
 
+  void alarm() override;
+
+  // proof and data of a block, read from the package and deserialized by a worker
+  struct DecodedBlock {
+    td::Ref<Proof> proof;
+    td::Ref<ProofLink> proof_link;
+    td::Ref<BlockData> data;
+    BlockSeqno prev_key_seqno = 0;
+    td::uint64 size = 0;
+    double decode_time = 0.0;
+  };
+  void get_decoded_block(BlockIdExt block_id, td::Promise<DecodedBlock> promise);
+  void decoded_block(BlockIdExt block_id, td::Result<DecodedBlock> R);
+
   void check_masterchain_block(BlockSeqno seqno);
-  void checked_masterchain_proof(BlockHandle handle, td::Ref<BlockData> data);
+  void process_masterchain_blocks();
+  void got_decoded_masterchain_block(BlockSeqno seqno, td::Result<DecodedBlock> R);
+  void checked_masterchain_proof(BlockSeqno seqno, BlockHandle handle);
   void applied_masterchain_block(BlockHandle handle);
   void got_new_materchain_state(td::Ref<MasterchainState> state);
   void checked_all_masterchain_blocks(BlockSeqno seqno);
@@ -47,8 +66,12 @@ class ArchiveImporter : public td::actor::Actor {
   void got_masterchain_state(td::Ref<MasterchainState> state);
   void apply_shard_block(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::Promise<td::Unit> promise);
   void apply_shard_block_cont1(BlockHandle handle, BlockIdExt masterchain_block_id, td::Promise<td::Unit> promise);
-  void apply_shard_block_cont2(BlockHandle handle, BlockIdExt masterchain_block_id, td::Promise<td::Unit> promise);
-  void apply_shard_block_cont3(BlockHandle handle, BlockIdExt masterchain_block_id, td::Promise<td::Unit> promise);
+  void apply_shard_block_cont2(BlockHandle handle, BlockIdExt masterchain_block_id, DecodedBlock block,
+                               td::Promise<td::Unit> promise);
+  void apply_shard_block_cont3(BlockHandle handle, BlockIdExt masterchain_block_id, DecodedBlock block,
+                               td::Promise<td::Unit> promise);
+  void applied_shard_block(BlockIdExt block_id, double apply_time);
+  void mark_shard_block_applied(BlockIdExt block_id);
   void check_shard_block_applied(BlockIdExt block_id, td::Promise<td::Unit> promise);
 
  private:
@@ -65,6 +88,51 @@ class ArchiveImporter : public td::actor::Actor {
 
   std::map<BlockSeqno, BlockIdExt> masterchain_blocks_;
   std::map<BlockIdExt, std::array<td::uint64, 2>> blocks_;
+
+  /*
+   * Import is pipelined: blocks are decoded by workers on the scheduler threads, proofs of up to depth_ masterchain
+   * blocks are checked ahead against the last applied state, and blocks are applied strictly in order.
+   * With depth 1 every masterchain block goes through all stages before the next one is started.
+   */
+  td::uint32 depth_ = 1;
+
+  // stage 1: decoding, requested blocks first, then shard blocks prefetched in seqno order
+  std::set<BlockIdExt> decoding_;
+  std::deque<BlockIdExt> decode_queue_;
+  std::map<BlockIdExt, std::vector<td::Promise<DecodedBlock>>> decode_waiters_;
+  std::map<BlockIdExt, td::Result<DecodedBlock>> decoded_;
+  std::vector<BlockIdExt> prefetch_order_;
+  size_t prefetch_pos_ = 0;
+  std::map<ShardIdFull, BlockSeqno> shard_applied_seqno_;
+  void run_decoders();
+
+  // stages 2 and 3 for masterchain blocks
+  struct MasterchainBlock {
+    bool requested = false;
+    bool decoded = false;
+    DecodedBlock block;
+    BlockHandle handle;
+    double check_start_time = 0.0;
+  };
+  std::map<BlockSeqno, MasterchainBlock> mc_pipeline_;
+  BlockIdExt mc_start_prev_id_;
+  BlockSeqno mc_end_seqno_ = 0;
+  BlockSeqno next_check_seqno_ = 0;
+  BlockSeqno next_apply_seqno_ = 0;
+  td::uint32 checking_ = 0;
+  bool applying_ = false;
+
+  // progress metrics
+  double start_time_ = 0.0;
+  double apply_start_time_ = 0.0;
+  td::uint64 decoded_blocks_ = 0;
+  td::uint64 decoded_bytes_ = 0;
+  td::uint64 applied_mc_blocks_ = 0;
+  td::uint64 applied_shard_blocks_ = 0;
+  double decode_busy_ = 0.0;
+  double check_busy_ = 0.0;
+  double apply_busy_ = 0.0;
+  void log_progress(td::Slice what);
 };
 
 }  // namespace validator
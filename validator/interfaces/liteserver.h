@@ -28,11 +28,14 @@ class LiteServerCache : public td::actor::Actor {
  public:
   ~LiteServerCache() override = default;
 
-  virtual void lookup(td::Bits256 key, td::Promise<td::BufferSlice> promise) = 0;
+  // method is the lite_api id of the query, it is used only for statistics
+  virtual void lookup(td::Bits256 key, int method, td::Promise<td::BufferSlice> promise) = 0;
   virtual void update(td::Bits256 key, td::BufferSlice value) = 0;
 
   virtual void process_send_message(td::Bits256 key, td::Promise<td::Unit> promise) = 0;
   virtual void drop_send_message_from_cache(td::Bits256 key) = 0;
+
+  virtual void prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise) = 0;
 };
 
 } // namespace ton::validator
\ No newline at end of file
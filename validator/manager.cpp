@@ -1483,7 +1483,7 @@ void ValidatorManagerImpl::send_block_broadcast(BlockBroadcast broadcast) {
 
 void ValidatorManagerImpl::start_up() {
   db_ = create_db_actor(actor_id(this), db_root_, opts_);
-  lite_server_cache_ = create_liteserver_cache_actor(actor_id(this), db_root_);
+  lite_server_cache_ = create_liteserver_cache_actor(actor_id(this), db_root_, opts_);
   token_manager_ = td::actor::create_actor<TokenManager>("tokenmanager");
   td::mkdir(db_root_ + "/tmp/").ensure();
   td::mkdir(db_root_ + "/catchains/").ensure();
@@ -2102,7 +2102,8 @@ td::actor::ActorOwn<ValidatorGroup> ValidatorManagerImpl::create_validator_group
     auto G = td::actor::create_actor<ValidatorGroup>(
         "validatorgroup", shard, validator_id, session_id, validator_set, opts, keyring_, adnl_, rldp_, overlays_,
         db_root_, actor_id(this), init_session,
-        opts_->check_unsafe_resync_allowed(validator_set->get_catchain_seqno()));
+        opts_->check_unsafe_resync_allowed(validator_set->get_catchain_seqno()), opts_->get_validation_threads(),
+        opts_->get_collator_threads());
     return G;
   }
 }
@@ -2627,6 +2628,9 @@ void ValidatorManagerImpl::prepare_stats(td::Promise<std::vector<std::pair<std::
   merger.make_promise("").set_value(std::move(vec));
 
   td::actor::send_closure(db_, &Db::prepare_stats, merger.make_promise("db."));
+  if (!lite_server_cache_.empty()) {
+    td::actor::send_closure(lite_server_cache_, &LiteServerCache::prepare_stats, merger.make_promise("lscache."));
+  }
 }
 
 void ValidatorManagerImpl::prepare_perf_timer_stats(td::Promise<std::vector<PerfTimerStats>> promise) {
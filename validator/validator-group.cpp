@@ -49,7 +49,8 @@ void ValidatorGroup::generate_block_candidate(td::uint32 round_id, td::Promise<B
       Ed25519_PublicKey{local_id_full_.ed25519_value().raw()}, validator_set_, manager_, td::Timestamp::in(10.0),
       [SelfId = actor_id(this), cache = cached_collated_block_](td::Result<BlockCandidate> R) {
         td::actor::send_closure(SelfId, &ValidatorGroup::generated_block_candidate, std::move(cache), std::move(R));
-      });
+      },
+      collator_threads_);
 }
 
 void ValidatorGroup::generated_block_candidate(std::shared_ptr<CachedCollatedBlock> cache, td::Result<BlockCandidate> R) {
@@ -123,7 +124,7 @@ void ValidatorGroup::validate_block_candidate(td::uint32 round_id, BlockCandidat
   VLOG(VALIDATOR_DEBUG) << "validating block candidate " << next_block_id;
   block.id = next_block_id;
   run_validate_query(shard_, min_ts_, min_masterchain_block_id_, prev_block_ids_, std::move(block), validator_set_,
-                     manager_, td::Timestamp::in(15.0), std::move(P));
+                     manager_, td::Timestamp::in(15.0), std::move(P), false, validation_threads_);
 }
 
 void ValidatorGroup::update_approve_cache(CacheKey key, UnixTime value) {
@@ -63,7 +63,8 @@ class ValidatorGroup : public td::actor::Actor {
                  td::actor::ActorId<keyring::Keyring> keyring, td::actor::ActorId<adnl::Adnl> adnl,
                  td::actor::ActorId<rldp::Rldp> rldp, td::actor::ActorId<overlay::Overlays> overlays,
                  std::string db_root, td::actor::ActorId<ValidatorManager> validator_manager, bool create_session,
-                 bool allow_unsafe_self_blocks_resync)
+                 bool allow_unsafe_self_blocks_resync, td::uint32 validation_threads,
+                 td::uint32 collator_threads)
       : shard_(shard)
       , local_id_(std::move(local_id))
       , session_id_(session_id)
@@ -76,7 +77,9 @@ class ValidatorGroup : public td::actor::Actor {
       , db_root_(std::move(db_root))
       , manager_(validator_manager)
       , init_(create_session)
-      , allow_unsafe_self_blocks_resync_(allow_unsafe_self_blocks_resync) {
+      , allow_unsafe_self_blocks_resync_(allow_unsafe_self_blocks_resync)
+      , validation_threads_(validation_threads)
+      , collator_threads_(collator_threads) {
   }
 
  private:
@@ -117,6 +120,8 @@ class ValidatorGroup : public td::actor::Actor {
   bool init_ = false;
   bool started_ = false;
   bool allow_unsafe_self_blocks_resync_;
+  td::uint32 validation_threads_;
+  td::uint32 collator_threads_;
   td::uint32 last_known_round_id_ = 0;
 
   struct CachedCollatedBlock {
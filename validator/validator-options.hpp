@@ -117,12 +117,42 @@ struct ValidatorManagerOptionsImpl : public ValidatorManagerOptions {
   td::uint32 get_celldb_compress_depth() const override {
     return celldb_compress_depth_;
   }
+  td::uint32 get_celldb_prefetch_depth() const override {
+    return celldb_prefetch_depth_;
+  }
+  size_t get_celldb_cell_cache_size() const override {
+    return celldb_cell_cache_size_;
+  }
+  td::RocksDbOptions get_celldb_rocksdb_options() const override {
+    return celldb_rocksdb_options_;
+  }
+  td::RocksDbOptions get_state_db_rocksdb_options() const override {
+    return state_db_rocksdb_options_;
+  }
+  td::RocksDbOptions get_archive_rocksdb_options() const override {
+    return archive_rocksdb_options_;
+  }
   size_t get_max_open_archive_files() const override {
     return max_open_archive_files_;
   }
   double get_archive_preload_period() const override {
     return archive_preload_period_;
   }
+  double get_archive_compress_after() const override {
+    return archive_compress_after_;
+  }
+  td::uint32 get_archive_import_depth() const override {
+    return archive_import_depth_;
+  }
+  td::uint32 get_validation_threads() const override {
+    return validation_threads_;
+  }
+  td::uint32 get_collator_threads() const override {
+    return collator_threads_;
+  }
+  size_t get_liteserver_disk_cache_size() const override {
+    return liteserver_disk_cache_size_;
+  }
 
   void set_zero_block_id(BlockIdExt block_id) override {
     zero_block_id_ = block_id;
@@ -179,12 +209,42 @@ struct ValidatorManagerOptionsImpl : public ValidatorManagerOptions {
   void set_celldb_compress_depth(td::uint32 value) override {
     celldb_compress_depth_ = value;
   }
+  void set_celldb_prefetch_depth(td::uint32 value) override {
+    celldb_prefetch_depth_ = value;
+  }
+  void set_celldb_cell_cache_size(size_t value) override {
+    celldb_cell_cache_size_ = value;
+  }
+  void set_celldb_rocksdb_options(td::RocksDbOptions value) override {
+    celldb_rocksdb_options_ = std::move(value);
+  }
+  void set_state_db_rocksdb_options(td::RocksDbOptions value) override {
+    state_db_rocksdb_options_ = std::move(value);
+  }
+  void set_archive_rocksdb_options(td::RocksDbOptions value) override {
+    archive_rocksdb_options_ = std::move(value);
+  }
   void set_max_open_archive_files(size_t value) override {
     max_open_archive_files_ = value;
   }
   void set_archive_preload_period(double value) override {
     archive_preload_period_ = value;
   }
+  void set_archive_compress_after(double value) override {
+    archive_compress_after_ = value;
+  }
+  void set_archive_import_depth(td::uint32 value) override {
+    archive_import_depth_ = value;
+  }
+  void set_validation_threads(td::uint32 value) override {
+    validation_threads_ = value;
+  }
+  void set_collator_threads(td::uint32 value) override {
+    collator_threads_ = value;
+  }
+  void set_liteserver_disk_cache_size(size_t value) override {
+    liteserver_disk_cache_size_ = value;
+  }
 
   ValidatorManagerOptionsImpl *make_copy() const override {
     return new ValidatorManagerOptionsImpl(*this);
@@ -228,8 +288,18 @@ struct ValidatorManagerOptionsImpl : public ValidatorManagerOptions {
   BlockSeqno sync_upto_{0};
   std::string session_logs_file_;
   td::uint32 celldb_compress_depth_{0};
+  td::uint32 celldb_prefetch_depth_{0};
+  size_t celldb_cell_cache_size_{0};
+  td::RocksDbOptions celldb_rocksdb_options_;
+  td::RocksDbOptions state_db_rocksdb_options_;
+  td::RocksDbOptions archive_rocksdb_options_;
   size_t max_open_archive_files_ = 0;
   double archive_preload_period_ = 0.0;
+  double archive_compress_after_ = 0.0;
+  td::uint32 archive_import_depth_ = 1;
+  td::uint32 validation_threads_ = 1;
+  td::uint32 collator_threads_ = 1;
+  size_t liteserver_disk_cache_size_ = 0;
 };
 
 }  // namespace validator
@@ -22,6 +22,7 @@
 #include <deque>
 
 #include "td/actor/actor.h"
+#include "td/db/RocksDb.h"
 
 #include "ton/ton-types.h"
 
@@ -82,8 +83,25 @@ struct ValidatorManagerOptions : public td::CntObject {
   virtual BlockSeqno sync_upto() const = 0;
   virtual std::string get_session_logs_file() const = 0;
   virtual td::uint32 get_celldb_compress_depth() const = 0;
+  virtual td::uint32 get_celldb_prefetch_depth() const = 0;
+  // memory budget of the decoded cell cache shared by celldb readers, 0 disables it
+  virtual size_t get_celldb_cell_cache_size() const = 0;
+  virtual td::RocksDbOptions get_celldb_rocksdb_options() const = 0;
+  virtual td::RocksDbOptions get_state_db_rocksdb_options() const = 0;
+  // used by the archive index and all archive slices
+  virtual td::RocksDbOptions get_archive_rocksdb_options() const = 0;
   virtual size_t get_max_open_archive_files() const = 0;
   virtual double get_archive_preload_period() const = 0;
+  // archive slices older than this many seconds are compressed in background, 0 disables it
+  virtual double get_archive_compress_after() const = 0;
+  // masterchain blocks of a downloaded archive slice decoded and checked ahead of the one being applied
+  virtual td::uint32 get_archive_import_depth() const = 0;
+  // number of threads checking transactions of different accounts of a block candidate
+  virtual td::uint32 get_validation_threads() const = 0;
+  // number of threads speculatively executing transactions of different accounts during collation
+  virtual td::uint32 get_collator_threads() const = 0;
+  // byte budget of the on-disk liteserver response cache, 0 disables it
+  virtual size_t get_liteserver_disk_cache_size() const = 0;
 
   virtual void set_zero_block_id(BlockIdExt block_id) = 0;
   virtual void set_init_block_id(BlockIdExt block_id) = 0;
@@ -104,8 +122,18 @@ struct ValidatorManagerOptions : public td::CntObject {
   virtual void set_sync_upto(BlockSeqno seqno) = 0;
   virtual void set_session_logs_file(std::string f) = 0;
   virtual void set_celldb_compress_depth(td::uint32 value) = 0;
+  virtual void set_celldb_prefetch_depth(td::uint32 value) = 0;
+  virtual void set_celldb_cell_cache_size(size_t value) = 0;
+  virtual void set_celldb_rocksdb_options(td::RocksDbOptions value) = 0;
+  virtual void set_state_db_rocksdb_options(td::RocksDbOptions value) = 0;
+  virtual void set_archive_rocksdb_options(td::RocksDbOptions value) = 0;
   virtual void set_max_open_archive_files(size_t value) = 0;
   virtual void set_archive_preload_period(double value) = 0;
+  virtual void set_archive_compress_after(double value) = 0;
+  virtual void set_archive_import_depth(td::uint32 value) = 0;
+  virtual void set_validation_threads(td::uint32 value) = 0;
+  virtual void set_collator_threads(td::uint32 value) = 0;
+  virtual void set_liteserver_disk_cache_size(size_t value) = 0;
 
   static td::Ref<ValidatorManagerOptions> create(
       BlockIdExt zero_block_id, BlockIdExt init_block_id,